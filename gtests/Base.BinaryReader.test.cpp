@@ -0,0 +1,134 @@
+﻿#include <gtest/gtest.h>
+
+#include <Saba/Base/BinaryReader.h>
+
+#ifndef TEST_DATA_PATH
+
+#define TEST_DATA_PATH "./Data"
+
+#endif // !TEST_DATA_PATH
+
+#define __u8(x) u8 ## x
+
+#define _u8(x)	__u8(x)
+
+TEST(BaseTest, MappedFileTest)
+{
+	std::string dataPath = _u8(TEST_DATA_PATH);
+
+	saba::MappedFile file;
+
+	// 初期状態のテスト
+	EXPECT_EQ(false, file.IsOpen());
+	EXPECT_EQ(nullptr, file.GetData());
+	EXPECT_EQ(0, file.GetSize());
+
+	EXPECT_EQ(true, file.Open(dataPath + u8"/日本語.txt"));
+	EXPECT_EQ(true, file.IsOpen());
+	EXPECT_NE(nullptr, file.GetData());
+	EXPECT_EQ(4, file.GetSize());
+	if (file.GetData() != nullptr)
+	{
+		EXPECT_EQ('1', file.GetData()[0]);
+		EXPECT_EQ('4', file.GetData()[3]);
+	}
+
+	file.Close();
+	EXPECT_EQ(false, file.IsOpen());
+	EXPECT_EQ(nullptr, file.GetData());
+	EXPECT_EQ(0, file.GetSize());
+
+	EXPECT_EQ(false, file.Open(dataPath + u8"/not_found.txt"));
+	EXPECT_EQ(false, file.IsOpen());
+}
+
+TEST(BaseTest, BinaryReaderTest)
+{
+	std::string dataPath = _u8(TEST_DATA_PATH);
+
+	saba::BinaryReader reader;
+
+	// 初期状態のテスト
+	EXPECT_EQ(false, reader.IsOpen());
+	EXPECT_EQ(-1, reader.Tell());
+	EXPECT_EQ(false, reader.IsBad());
+	EXPECT_EQ(0, reader.GetSize());
+
+	EXPECT_EQ(true, reader.Open(dataPath + u8"/日本語.txt"));
+	EXPECT_EQ(true, reader.IsOpen());
+	EXPECT_EQ(false, reader.IsBad());
+	EXPECT_EQ(4, reader.GetSize());
+
+	// Read のテスト
+	char ch = 0;
+	EXPECT_EQ(true, reader.Read(&ch));
+	EXPECT_EQ('1', ch);
+	EXPECT_EQ(1, reader.Tell());
+
+	EXPECT_EQ(true, reader.Seek(1, saba::BinaryReader::SeekDir::Current));
+	EXPECT_EQ(2, reader.Tell());
+	EXPECT_EQ(true, reader.Read(&ch));
+	EXPECT_EQ('3', ch);
+
+	// 範囲外の読み込みは失敗し、位置は変わらない
+	uint16_t u16 = 0;
+	EXPECT_EQ(false, reader.Read(&u16));
+	EXPECT_EQ(true, reader.IsBad());
+	EXPECT_EQ(3, reader.Tell());
+	reader.ClearBadFlag();
+	EXPECT_EQ(false, reader.IsBad());
+
+	// File と異なり、範囲外にはシークできない
+	EXPECT_EQ(true, reader.Seek(0, saba::BinaryReader::SeekDir::End));
+	EXPECT_EQ(4, reader.Tell());
+	EXPECT_EQ(true, reader.IsEOF());
+	EXPECT_EQ(false, reader.Seek(10, saba::BinaryReader::SeekDir::End));
+	EXPECT_EQ(true, reader.IsBad());
+	EXPECT_EQ(4, reader.Tell());
+	reader.ClearBadFlag();
+	EXPECT_EQ(false, reader.Seek(-10, saba::BinaryReader::SeekDir::Begin));
+	EXPECT_EQ(true, reader.IsBad());
+	reader.ClearBadFlag();
+
+	EXPECT_EQ(true, reader.Seek(0, saba::BinaryReader::SeekDir::Begin));
+	char buffer[4] = {};
+	EXPECT_EQ(true, reader.Read(buffer, 4));
+	EXPECT_EQ('1', buffer[0]);
+	EXPECT_EQ('2', buffer[1]);
+	EXPECT_EQ('3', buffer[2]);
+	EXPECT_EQ('4', buffer[3]);
+	EXPECT_EQ(true, reader.IsEOF());
+
+	// ReadSpan のテスト
+	EXPECT_EQ(true, reader.Seek(-3, saba::BinaryReader::SeekDir::End));
+	const char* span = reader.ReadSpan(2);
+	EXPECT_NE(nullptr, span);
+	if (span != nullptr)
+	{
+		EXPECT_EQ('2', span[0]);
+		EXPECT_EQ('3', span[1]);
+	}
+	EXPECT_EQ(3, reader.Tell());
+	EXPECT_EQ(nullptr, reader.ReadSpan(2));
+	EXPECT_EQ(true, reader.IsBad());
+	EXPECT_EQ(3, reader.Tell());
+
+	// Closeのテスト
+	reader.Close();
+	EXPECT_EQ(false, reader.IsOpen());
+	EXPECT_EQ(-1, reader.Tell());
+	EXPECT_EQ(false, reader.IsBad());
+	EXPECT_EQ(0, reader.GetSize());
+	EXPECT_EQ(false, reader.Read(&ch));
+
+	// メモリ上のデータ
+	const uint32_t data[2] = { 1, 2 };
+	reader.SetData(data, sizeof(data));
+	EXPECT_EQ(true, reader.IsOpen());
+	EXPECT_EQ(8, reader.GetSize());
+	uint32_t values[2] = {};
+	EXPECT_EQ(true, reader.Read(values, 2));
+	EXPECT_EQ(1u, values[0]);
+	EXPECT_EQ(2u, values[1]);
+	EXPECT_EQ(false, reader.Read(values));
+}
@@ -0,0 +1,97 @@
+﻿#include <gtest/gtest.h>
+
+#include <Saba/Base/MeshOptimizer.h>
+
+#include <algorithm>
+#include <array>
+#include <random>
+#include <vector>
+
+namespace
+{
+	// w x h のグリッドを三角形に分割する
+	std::vector<uint32_t> MakeGridIndices(uint32_t w, uint32_t h)
+	{
+		std::vector<uint32_t> indices;
+		for (uint32_t y = 0; y < h; y++)
+		{
+			for (uint32_t x = 0; x < w; x++)
+			{
+				uint32_t v0 = y * (w + 1) + x;
+				uint32_t v1 = v0 + 1;
+				uint32_t v2 = v0 + (w + 1);
+				uint32_t v3 = v2 + 1;
+				indices.insert(indices.end(), { v0, v2, v1 });
+				indices.insert(indices.end(), { v1, v2, v3 });
+			}
+		}
+		return indices;
+	}
+
+	// 三角形を回転させて先頭を最小の頂点にそろえる (表裏は維持)
+	std::vector<std::array<uint32_t, 3>> MakeTriangleList(const std::vector<uint32_t>& indices)
+	{
+		std::vector<std::array<uint32_t, 3>> tris;
+		for (size_t i = 0; i < indices.size(); i += 3)
+		{
+			std::array<uint32_t, 3> tri = { indices[i], indices[i + 1], indices[i + 2] };
+			auto minIt = std::min_element(tri.begin(), tri.end());
+			std::rotate(tri.begin(), minIt, tri.end());
+			tris.push_back(tri);
+		}
+		std::sort(tris.begin(), tris.end());
+		return tris;
+	}
+}
+
+TEST(BaseTest, MeshOptimizerVertexCache)
+{
+	auto indices = MakeGridIndices(64, 64);
+
+	// 三角形の順番をばらばらにする
+	std::vector<std::array<uint32_t, 3>> tris;
+	for (size_t i = 0; i < indices.size(); i += 3)
+	{
+		tris.push_back({ indices[i], indices[i + 1], indices[i + 2] });
+	}
+	std::mt19937 rand(1234);
+	std::shuffle(tris.begin(), tris.end(), rand);
+	indices.clear();
+	for (const auto& tri : tris)
+	{
+		indices.insert(indices.end(), tri.begin(), tri.end());
+	}
+
+	auto original = indices;
+	float acmrBefore = saba::CalcACMR(indices.data(), indices.size());
+	saba::OptimizeVertexCache(indices.data(), indices.size());
+	float acmrAfter = saba::CalcACMR(indices.data(), indices.size());
+
+	EXPECT_EQ(original.size(), indices.size());
+	EXPECT_EQ(MakeTriangleList(original), MakeTriangleList(indices));
+	EXPECT_LT(acmrAfter, acmrBefore);
+	EXPECT_LT(acmrAfter, 0.8f);
+
+	// 縮退した三角形や少ない三角形でも壊れないこと
+	std::vector<uint32_t> degenerate = { 5, 5, 7, 7, 8, 5, 9, 9, 9 };
+	auto degenerateOriginal = degenerate;
+	saba::OptimizeVertexCache(degenerate.data(), degenerate.size());
+	EXPECT_EQ(MakeTriangleList(degenerateOriginal), MakeTriangleList(degenerate));
+
+	std::vector<uint32_t> single = { 2, 1, 0 };
+	saba::OptimizeVertexCache(single.data(), single.size());
+	EXPECT_EQ(std::vector<uint32_t>({ 2, 1, 0 }), single);
+}
+
+TEST(BaseTest, MeshOptimizerVertexFetchRemap)
+{
+	std::vector<uint32_t> indices = { 4, 2, 0, 0, 2, 3 };
+	std::vector<uint32_t> remap;
+	size_t usedCount = saba::MakeVertexFetchRemap(&remap, indices.data(), indices.size(), 6);
+
+	EXPECT_EQ(4, usedCount);
+	EXPECT_EQ(std::vector<uint32_t>({ 2, 4, 1, 3, 0, 5 }), remap);
+
+	EXPECT_EQ(2.0f, saba::CalcACMR(indices.data(), indices.size()));
+	EXPECT_EQ(0.0f, saba::CalcACMR(nullptr, 0));
+}
@@ -17,6 +17,52 @@ TEST(BaseTest, UnicodeUtil)
 	EXPECT_EQ(wStr, wStrRet);
 }
 
+TEST(BaseTest, UnicodeUtilAsciiBlock)
+{
+	// ASCII のみのブロックと ASCII 以外を含むブロックが混在する場合
+	std::string utf8Str =
+		u8"0123456789abcdefghijklmnopqrstuvwxyz"
+		u8"日本語ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789"
+		u8"\u00e9\U0001F600end";
+	std::u16string utf16Str =
+		u"0123456789abcdefghijklmnopqrstuvwxyz"
+		u"日本語ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789"
+		u"\u00e9\U0001F600end";
+	std::u32string utf32Str =
+		U"0123456789abcdefghijklmnopqrstuvwxyz"
+		U"日本語ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789"
+		U"\u00e9\U0001F600end";
+
+	std::u16string u16Ret;
+	EXPECT_TRUE(saba::ConvU8ToU16(utf8Str, u16Ret));
+	EXPECT_EQ(utf16Str, u16Ret);
+
+	std::u32string u32Ret;
+	EXPECT_TRUE(saba::ConvU8ToU32(utf8Str, u32Ret));
+	EXPECT_EQ(utf32Str, u32Ret);
+
+	std::string u8Ret;
+	EXPECT_TRUE(saba::ConvU16ToU8(utf16Str, u8Ret));
+	EXPECT_EQ(utf8Str, u8Ret);
+
+	u8Ret.clear();
+	EXPECT_TRUE(saba::ConvU32ToU8(utf32Str, u8Ret));
+	EXPECT_EQ(utf8Str, u8Ret);
+
+	// 0 は 1 文字ずつ変換する場合と同じく出力しない
+	std::u16string withNull(u"0123456789abcdef0123456789abcdef");
+	withNull[3] = 0;
+	u8Ret.clear();
+	EXPECT_TRUE(saba::ConvU16ToU8(withNull, u8Ret));
+	EXPECT_EQ(std::string("012456789abcdef0123456789abcdef"), u8Ret);
+
+	// 不正な UTF-8
+	std::string badUtf8("0123456789abcdef0123456789abcde");
+	badUtf8.push_back(char(0xE6));
+	u16Ret.clear();
+	EXPECT_FALSE(saba::ConvU8ToU16(badUtf8, u16Ret));
+}
+
 #include <Saba/Model/MMD/SjisToUnicode.h>
 
 TEST(BaseTest, MMSSjisToUnicode)
@@ -80,3 +126,54 @@ TEST(BaseTest, MMSSjisToUnicode)
 		EXPECT_EQ(convStr, U"\u30FB");
 	}
 }
+
+TEST(BaseTest, MMDSjisToU8)
+{
+	{
+		// Test Ascii and 2byte sjis.
+		const char testStr[] = {
+			'0', '1', '2', '3', '4', '5', '6', '7',
+			'8', '9', 'a', 'b', 'c', 'd', 'e', 'f',
+			char(0x83), // ア
+			char(0x41),
+			char(0xB1), // ｱ
+			char(0x95), // 表
+			char(0x5c),
+			'x', 'y', 'z',
+			char(0x00)
+		};
+		EXPECT_EQ(saba::ConvertSjisToU8String(testStr), std::string(u8"0123456789abcdefアｱ表xyz"));
+	}
+	{
+		// Test bad sjis code.
+		const char badSjis[] = {
+			char(0x81),
+			char(0x00),
+		};
+		EXPECT_EQ(saba::ConvertSjisToU8String(badSjis), std::string(u8"\u30FB"));
+	}
+	{
+		// 長さの指定で 2 バイト文字の途中で終わる場合
+		const char testStr[] = {
+			'a',
+			char(0x83),
+			char(0x41),
+		};
+		char u8Buffer[sizeof(testStr) * saba::SjisToU8MaxBytesPerByte];
+		size_t u8Length = saba::ConvertSjisToU8(testStr, 2, u8Buffer);
+		EXPECT_EQ(std::string(u8Buffer, u8Length), std::string(u8"a\u30FB"));
+	}
+	{
+		// すべての 2 バイト文字が UTF-16 を経由した変換と一致すること
+		for (int ch1 = 0x81; ch1 <= 0xEF; ch1++)
+		{
+			for (int ch2 = 0x40; ch2 <= 0xFC; ch2++)
+			{
+				const char testStr[] = { char(ch1), char(ch2), 'a', char(0x00) };
+				std::string u8Str;
+				saba::ConvU16ToU8(saba::ConvertSjisToU16String(testStr), u8Str);
+				EXPECT_EQ(saba::ConvertSjisToU8String(testStr), u8Str);
+			}
+		}
+	}
+}
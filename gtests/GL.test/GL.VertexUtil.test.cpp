@@ -90,3 +90,69 @@ TEST(GLTest, VertexUtilTest)
 	EXPECT_EQ(0, mb.GetPolygonCount());
 	EXPECT_EQ(0, mb.GetComponentCount());
 }
+
+TEST(GLTest, VertexUtilWeldTest)
+{
+	saba::MeshBuilder mb;
+
+	std::vector<glm::vec3>* positions;
+	std::vector<glm::vec2>* uvs;
+	auto posID = mb.AddComponent(&positions);
+	auto uvID = mb.AddComponent(&uvs);
+
+	// 同じ値の頂点が別のインデックスで登録されている四角形
+	positions->push_back(glm::vec3(0, 0, 0));
+	positions->push_back(glm::vec3(1, 0, 0));
+	positions->push_back(glm::vec3(0, 1, 0));
+	positions->push_back(glm::vec3(1, 0, 0));
+	positions->push_back(glm::vec3(1, 1, 0));
+	positions->push_back(glm::vec3(0, 1, 0));
+	uvs->push_back(glm::vec2(0, 0));
+	uvs->push_back(glm::vec2(1, 0));
+	uvs->push_back(glm::vec2(0, 1));
+	uvs->push_back(glm::vec2(1, 1));
+
+	auto poly1ID = mb.AddPolygon();
+	auto poly2ID = mb.AddPolygon();
+	auto poly3ID = mb.AddPolygon();
+	mb.SetPolygon(poly1ID, posID, 0, 1, 2);
+	mb.SetPolygon(poly1ID, uvID, 0, 1, 2);
+	mb.SetPolygon(poly2ID, posID, 3, 4, 5);
+	mb.SetPolygon(poly2ID, uvID, 1, 3, 2);
+	// UV が違う頂点は共有しない
+	mb.SetPolygon(poly3ID, posID, 3, 4, 5);
+	mb.SetPolygon(poly3ID, uvID, 0, 0, 0);
+	mb.SetFaceMaterial(poly3ID, 1);
+
+	mb.SortFaces();
+	EXPECT_FALSE(mb.IsWelded());
+	EXPECT_EQ(9, mb.GetVertexCount());
+
+	mb.Weld();
+	EXPECT_TRUE(mb.IsWelded());
+	EXPECT_EQ(7, mb.GetVertexCount());
+	EXPECT_EQ(GL_UNSIGNED_SHORT, mb.GetIndexType());
+	EXPECT_EQ(sizeof(uint16_t), mb.GetIndexTypeSize());
+
+	const auto& indices = mb.GetIndices();
+	ASSERT_EQ(9, indices.size());
+	// 頂点は参照順に並んでいる
+	uint32_t maxIndex = 0;
+	for (auto index : indices)
+	{
+		EXPECT_LE(index, maxIndex);
+		maxIndex = std::max(maxIndex, index + 1);
+	}
+
+	std::vector<saba::MeshBuilder::SubMesh> subMeshes;
+	mb.MakeSubMeshList(&subMeshes);
+	ASSERT_EQ(2, subMeshes.size());
+	EXPECT_EQ(0, subMeshes[0].m_startIndex);
+	EXPECT_EQ(6, subMeshes[0].m_numVertices);
+	EXPECT_EQ(6, subMeshes[1].m_startIndex);
+	EXPECT_EQ(3, subMeshes[1].m_numVertices);
+
+	mb.Clear();
+	EXPECT_FALSE(mb.IsWelded());
+	EXPECT_TRUE(mb.GetIndices().empty());
+}
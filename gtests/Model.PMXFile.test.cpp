@@ -0,0 +1,158 @@
+﻿#include <gtest/gtest.h>
+
+#include <Saba/Model/MMD/PMXFile.h>
+
+#include <cstdio>
+#include <string>
+
+namespace
+{
+	// テスト用の一時ファイル (スコープを抜けると削除する)
+	class TempFile
+	{
+	public:
+		explicit TempFile(const char* name) : m_path(::testing::TempDir() + name) {}
+		~TempFile() { std::remove(m_path.c_str()); }
+
+		TempFile(const TempFile&) = delete;
+		TempFile& operator = (const TempFile&) = delete;
+
+		const char* GetPath() const { return m_path.c_str(); }
+
+	private:
+		std::string	m_path;
+	};
+
+	saba::PMXFile MakePMXFile(size_t vertexCount, size_t boneCount, size_t materialCount)
+	{
+		saba::PMXFile pmx;
+		pmx.m_header.m_version = 2.0f;
+		pmx.m_header.m_dataSize = 8;
+		pmx.m_header.m_encode = 1;
+		pmx.m_header.m_addUVNum = 0;
+		pmx.m_header.m_vertexIndexSize = 4;
+		pmx.m_header.m_textureIndexSize = 4;
+		pmx.m_header.m_materialIndexSize = 4;
+		pmx.m_header.m_boneIndexSize = 4;
+		pmx.m_header.m_morphIndexSize = 4;
+		pmx.m_header.m_rigidbodyIndexSize = 4;
+		pmx.m_info.m_modelName = "test";
+
+		for (size_t i = 0; i < vertexCount; i++)
+		{
+			saba::PMXVertex vertex = {};
+			vertex.m_position = glm::vec3(float(i), 0.0f, 0.0f);
+			vertex.m_normal = glm::vec3(0.0f, 1.0f, 0.0f);
+			vertex.m_weightType = saba::PMXVertexWeight::BDEF1;
+			vertex.m_boneIndices[0] = int32_t(i % boneCount);
+			vertex.m_boneWeights[0] = 1.0f;
+			vertex.m_edgeMag = 1.0f;
+			pmx.m_vertices.push_back(vertex);
+		}
+
+		for (size_t i = 0; i + 2 < vertexCount; i += 3)
+		{
+			saba::PMXFace face;
+			face.m_vertices[0] = uint32_t(i);
+			face.m_vertices[1] = uint32_t(i + 1);
+			face.m_vertices[2] = uint32_t(i + 2);
+			pmx.m_faces.push_back(face);
+		}
+
+		for (size_t i = 0; i < materialCount; i++)
+		{
+			saba::PMXMaterial mat;
+			mat.m_name = "mat" + std::to_string(i);
+			mat.m_diffuse = glm::vec4(1.0f);
+			mat.m_specular = glm::vec3(0.0f);
+			mat.m_specularPower = 1.0f;
+			mat.m_ambient = glm::vec3(0.5f);
+			mat.m_drawMode = saba::PMXDrawModeFlags::BothFace;
+			mat.m_edgeColor = glm::vec4(0.0f);
+			mat.m_edgeSize = 1.0f;
+			mat.m_textureIndex = -1;
+			mat.m_sphereTextureIndex = -1;
+			mat.m_sphereMode = saba::PMXSphereMode::None;
+			mat.m_toonMode = saba::PMXToonMode::Separate;
+			mat.m_toonTextureIndex = -1;
+			mat.m_numFaceVertices = i == 0 ? int32_t(pmx.m_faces.size() * 3) : 0;
+			pmx.m_materials.push_back(mat);
+		}
+
+		for (size_t i = 0; i < boneCount; i++)
+		{
+			saba::PMXBone bone = {};
+			bone.m_name = "bone" + std::to_string(i);
+			bone.m_position = glm::vec3(0.0f, float(i), 0.0f);
+			bone.m_parentBoneIndex = int32_t(i) - 1;
+			bone.m_deformDepth = 0;
+			bone.m_boneFlag = saba::PMXBoneFlags::AllowRotate;
+			bone.m_positionOffset = glm::vec3(0.0f, 1.0f, 0.0f);
+			pmx.m_bones.push_back(bone);
+		}
+
+		return pmx;
+	}
+
+	bool WriteAndRead(const saba::PMXFile& src, saba::PMXFile* dst)
+	{
+		TempFile file("PMXFileTest.pmx");
+		return saba::WritePMXFile(&src, file.GetPath()) &&
+			saba::ReadPMXFile(dst, file.GetPath());
+	}
+}
+
+TEST(ModelTest, PMXFileSmallIndexSize)
+{
+	auto src = MakePMXFile(6, 4, 2);
+
+	saba::PMXFile pmx;
+	ASSERT_TRUE(WriteAndRead(src, &pmx));
+
+	EXPECT_EQ(1, pmx.m_header.m_vertexIndexSize);
+	EXPECT_EQ(1, pmx.m_header.m_textureIndexSize);
+	EXPECT_EQ(1, pmx.m_header.m_materialIndexSize);
+	EXPECT_EQ(1, pmx.m_header.m_boneIndexSize);
+	EXPECT_EQ(1, pmx.m_header.m_morphIndexSize);
+	EXPECT_EQ(1, pmx.m_header.m_rigidbodyIndexSize);
+	EXPECT_FLOAT_EQ(2.0f, pmx.m_header.m_version);
+
+	ASSERT_EQ(4u, pmx.m_bones.size());
+	EXPECT_EQ(-1, pmx.m_bones[0].m_parentBoneIndex);
+	EXPECT_EQ(2, pmx.m_bones[3].m_parentBoneIndex);
+	ASSERT_EQ(2u, pmx.m_materials.size());
+	EXPECT_EQ(-1, pmx.m_materials[1].m_textureIndex);
+}
+
+TEST(ModelTest, PMXFileLargeIndexSize)
+{
+	// 符号付きインデックスは 128 個で 2 バイトになる
+	auto src = MakePMXFile(255, 128, 128);
+	src.m_header.m_version = 2.1f;
+
+	saba::PMXFile pmx;
+	ASSERT_TRUE(WriteAndRead(src, &pmx));
+
+	// 頂点インデックスは符号なしなので 255 個から 2 バイト
+	EXPECT_EQ(2, pmx.m_header.m_vertexIndexSize);
+	EXPECT_EQ(2, pmx.m_header.m_materialIndexSize);
+	EXPECT_EQ(2, pmx.m_header.m_boneIndexSize);
+	EXPECT_FLOAT_EQ(2.1f, pmx.m_header.m_version);
+
+	ASSERT_EQ(128u, pmx.m_bones.size());
+	EXPECT_EQ(-1, pmx.m_bones[0].m_parentBoneIndex);
+	EXPECT_EQ(126, pmx.m_bones[127].m_parentBoneIndex);
+	ASSERT_EQ(255u, pmx.m_vertices.size());
+	EXPECT_EQ(127, pmx.m_vertices[127].m_boneIndices[0]);
+	ASSERT_EQ(85u, pmx.m_faces.size());
+	EXPECT_EQ(254u, pmx.m_faces[84].m_vertices[2]);
+	ASSERT_EQ(128u, pmx.m_materials.size());
+	EXPECT_EQ(-1, pmx.m_materials[127].m_textureIndex);
+
+	// 頂点数 254 なら 1 バイトのまま
+	auto src2 = MakePMXFile(254, 4, 2);
+	saba::PMXFile pmx2;
+	ASSERT_TRUE(WriteAndRead(src2, &pmx2));
+	EXPECT_EQ(1, pmx2.m_header.m_vertexIndexSize);
+	EXPECT_EQ(1, pmx2.m_header.m_boneIndexSize);
+}
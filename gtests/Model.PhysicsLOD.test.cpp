@@ -0,0 +1,167 @@
+﻿#include <gtest/gtest.h>
+
+#include <Saba/Model/MMD/PMXFile.h>
+#include <Saba/Model/MMD/PMXModel.h>
+
+#include <cstdio>
+#include <string>
+
+namespace
+{
+	// テスト用の一時ファイル (スコープを抜けると削除する)
+	class TempFile
+	{
+	public:
+		explicit TempFile(const char* name) : m_path(::testing::TempDir() + name) {}
+		~TempFile() { std::remove(m_path.c_str()); }
+
+		TempFile(const TempFile&) = delete;
+		TempFile& operator = (const TempFile&) = delete;
+
+		const char* GetPath() const { return m_path.c_str(); }
+
+	private:
+		std::string	m_path;
+	};
+
+	saba::PMXBone MakeBone(const char* name, const glm::vec3& position, int32_t parent)
+	{
+		saba::PMXBone bone = {};
+		bone.m_name = name;
+		bone.m_position = position;
+		bone.m_parentBoneIndex = parent;
+		bone.m_deformDepth = 0;
+		bone.m_boneFlag = saba::PMXBoneFlags(
+			uint16_t(saba::PMXBoneFlags::AllowRotate) |
+			uint16_t(saba::PMXBoneFlags::AllowTranslate) |
+			uint16_t(saba::PMXBoneFlags::Visible) |
+			uint16_t(saba::PMXBoneFlags::AllowControl)
+		);
+		bone.m_positionOffset = glm::vec3(0.0f, 1.0f, 0.0f);
+		return bone;
+	}
+
+	// センター (ボーン追従なし) と、その子ボーンに物理演算の剛体が 1 つ付いたモデル
+	saba::PMXFile MakeHairModel()
+	{
+		saba::PMXFile pmx;
+		pmx.m_header.m_version = 2.0f;
+		pmx.m_header.m_encode = 1;
+		pmx.m_header.m_addUVNum = 0;
+		pmx.m_info.m_modelName = "test";
+
+		for (int i = 0; i < 3; i++)
+		{
+			saba::PMXVertex vertex = {};
+			vertex.m_position = glm::vec3(float(i), 0.0f, 0.0f);
+			vertex.m_normal = glm::vec3(0.0f, 1.0f, 0.0f);
+			vertex.m_weightType = saba::PMXVertexWeight::BDEF1;
+			vertex.m_boneIndices[0] = 0;
+			vertex.m_boneWeights[0] = 1.0f;
+			vertex.m_edgeMag = 1.0f;
+			pmx.m_vertices.push_back(vertex);
+		}
+		saba::PMXFace face;
+		face.m_vertices[0] = 0;
+		face.m_vertices[1] = 1;
+		face.m_vertices[2] = 2;
+		pmx.m_faces.push_back(face);
+
+		saba::PMXMaterial mat;
+		mat.m_name = "mat";
+		mat.m_diffuse = glm::vec4(1.0f);
+		mat.m_specular = glm::vec3(0.0f);
+		mat.m_specularPower = 1.0f;
+		mat.m_ambient = glm::vec3(0.5f);
+		mat.m_drawMode = saba::PMXDrawModeFlags::BothFace;
+		mat.m_edgeColor = glm::vec4(0.0f);
+		mat.m_edgeSize = 1.0f;
+		mat.m_textureIndex = -1;
+		mat.m_sphereTextureIndex = -1;
+		mat.m_sphereMode = saba::PMXSphereMode::None;
+		mat.m_toonMode = saba::PMXToonMode::Separate;
+		mat.m_toonTextureIndex = -1;
+		mat.m_numFaceVertices = 3;
+		pmx.m_materials.push_back(mat);
+
+		pmx.m_bones.push_back(MakeBone("center", glm::vec3(0.0f), -1));
+		pmx.m_bones.push_back(MakeBone("hair", glm::vec3(0.0f, 1.0f, 0.0f), 0));
+
+		saba::PMXRigidbody rb;
+		rb.m_name = "hair";
+		rb.m_boneIndex = 1;
+		rb.m_group = 0;
+		rb.m_collisionGroup = 0;
+		rb.m_shape = saba::PMXRigidbody::Shape::Sphere;
+		rb.m_shapeSize = glm::vec3(0.2f);
+		rb.m_translate = glm::vec3(0.0f, 1.0f, 0.0f);
+		rb.m_rotate = glm::vec3(0.0f);
+		rb.m_mass = 1.0f;
+		rb.m_translateDimmer = 0.0f;
+		rb.m_rotateDimmer = 0.0f;
+		rb.m_repulsion = 0.0f;
+		rb.m_friction = 0.5f;
+		rb.m_op = saba::PMXRigidbody::Operation::Dynamic;
+		pmx.m_rigidbodies.push_back(rb);
+
+		return pmx;
+	}
+
+	void UpdateModel(saba::PMXModel* model)
+	{
+		model->BeginAnimation();
+		model->UpdateAllAnimation(nullptr, 0.0f, 1.0f / 30.0f);
+		model->EndAnimation();
+	}
+}
+
+TEST(ModelTest, PhysicsLODKinematicFollowsMovedModel)
+{
+	TempFile file("PhysicsLODTest.pmx");
+	const auto pmx = MakeHairModel();
+	ASSERT_TRUE(saba::WritePMXFile(&pmx, file.GetPath()));
+
+	saba::PMXModel model;
+	ASSERT_TRUE(model.Load(file.GetPath(), ::testing::TempDir()));
+	model.InitializeAnimation();
+
+	auto nodeMan = model.GetNodeManager();
+	auto center = nodeMan->GetMMDNode(size_t(0));
+	auto hair = nodeMan->GetMMDNode(size_t(1));
+	auto physicsMan = model.GetPhysicsManager();
+	ASSERT_EQ(1u, physicsMan->GetRigidBodys()->size());
+
+	// 動的な剛体として落下させる
+	for (int i = 0; i < 10; i++)
+	{
+		UpdateModel(&model);
+	}
+	const glm::vec3 fallenPos = glm::vec3(hair->GetGlobalTransform()[3]);
+	ASSERT_LT(fallenPos.y, 0.5f);
+
+	// ボーン追従にした後でモデルを動かすと、剛体のボーンはアニメーションに従う
+	saba::MMDPhysicsLOD lod;
+	lod.m_sleep = true;
+	lod.m_blendFrameCount = 0;
+	physicsMan->SetLOD(lod);
+	UpdateModel(&model);
+	ASSERT_TRUE(physicsMan->IsLODKinematic(0));
+
+	center->SetAnimationTranslate(glm::vec3(10.0f, 0.0f, 0.0f));
+	for (int i = 0; i < 3; i++)
+	{
+		UpdateModel(&model);
+		const glm::vec3 hairPos = glm::vec3(hair->GetGlobalTransform()[3]);
+		EXPECT_NEAR(10.0f, hairPos.x, 1.0e-3f);
+		EXPECT_NEAR(1.0f, hairPos.y, 1.0e-3f);
+		EXPECT_NEAR(0.0f, hairPos.z, 1.0e-3f);
+	}
+
+	// 物理演算に戻すと、剛体は移動後のアニメーションの姿勢から再開する
+	physicsMan->SetLOD(saba::MMDPhysicsLOD());
+	UpdateModel(&model);
+	ASSERT_FALSE(physicsMan->IsLODKinematic(0));
+	const glm::vec3 resumedPos = glm::vec3(hair->GetGlobalTransform()[3]);
+	EXPECT_NEAR(10.0f, resumedPos.x, 1.0e-2f);
+	EXPECT_GT(resumedPos.y, fallenPos.y);
+}
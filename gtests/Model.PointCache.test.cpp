@@ -0,0 +1,259 @@
+﻿#include <gtest/gtest.h>
+
+#include <Saba/Model/PointCache/PointCache.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+namespace
+{
+	// テスト用の一時ファイル (スコープを抜けると削除する)
+	class TempFile
+	{
+	public:
+		explicit TempFile(const char* name) : m_path(::testing::TempDir() + name) {}
+		~TempFile() { std::remove(m_path.c_str()); }
+
+		TempFile(const TempFile&) = delete;
+		TempFile& operator = (const TempFile&) = delete;
+
+		const char* GetPath() const { return m_path.c_str(); }
+
+	private:
+		std::string	m_path;
+	};
+
+	const size_t TestVertexCount = 4;
+	const size_t TestFrameCount = 3;
+
+	saba::PointCacheMesh MakeMesh()
+	{
+		saba::PointCacheMesh mesh;
+		mesh.m_vertexCount = TestVertexCount;
+		mesh.m_indices = { 0, 1, 2, 0, 2, 3 };
+		for (size_t i = 0; i < TestVertexCount; i++)
+		{
+			mesh.m_uvs.push_back(glm::vec2(float(i) * 0.25f, 1.0f - float(i) * 0.25f));
+		}
+
+		saba::PointCacheSubMesh subMesh;
+		subMesh.m_beginIndex = 0;
+		subMesh.m_indexCount = 6;
+		subMesh.m_materialID = 0;
+		mesh.m_subMeshes.push_back(subMesh);
+
+		saba::PointCacheMaterial mat;
+		mat.m_name = "mat";
+		mat.m_diffuse = glm::vec4(1.0f, 0.5f, 0.25f, 1.0f);
+		mat.m_specular = glm::vec3(0.1f);
+		mat.m_specularPower = 5.0f;
+		mat.m_ambient = glm::vec3(0.2f);
+		mat.m_texture = "tex.png";
+		mesh.m_materials.push_back(mat);
+		return mesh;
+	}
+
+	glm::vec3 FramePosition(size_t frame, size_t i)
+	{
+		return glm::vec3(float(i) - 1.5f, float(frame) * 0.5f, float(i * frame) * 0.125f);
+	}
+
+	glm::vec3 FrameNormal(size_t frame, size_t i)
+	{
+		float angle = float(frame + i) * 0.3f;
+		return glm::vec3(std::cos(angle), std::sin(angle), 0.0f);
+	}
+
+	bool WriteFrames(saba::PointCacheWriter* writer)
+	{
+		for (size_t frame = 0; frame < TestFrameCount; frame++)
+		{
+			glm::vec3 positions[TestVertexCount];
+			glm::vec3 normals[TestVertexCount];
+			for (size_t i = 0; i < TestVertexCount; i++)
+			{
+				positions[i] = FramePosition(frame, i);
+				normals[i] = FrameNormal(frame, i);
+			}
+			if (!writer->WriteFrame(positions, normals))
+			{
+				return false;
+			}
+		}
+		return writer->Close();
+	}
+
+	void CheckFrames(const saba::PointCache& cache, bool normal, float eps)
+	{
+		for (size_t frame = 0; frame < TestFrameCount; frame++)
+		{
+			glm::vec3 positions[TestVertexCount];
+			glm::vec3 normals[TestVertexCount];
+			ASSERT_TRUE(cache.ReadFrame(frame, positions, normal ? normals : nullptr));
+			for (size_t i = 0; i < TestVertexCount; i++)
+			{
+				const glm::vec3 p = FramePosition(frame, i);
+				EXPECT_NEAR(p.x, positions[i].x, eps);
+				EXPECT_NEAR(p.y, positions[i].y, eps);
+				EXPECT_NEAR(p.z, positions[i].z, eps);
+				if (normal)
+				{
+					const glm::vec3 n = FrameNormal(frame, i);
+					EXPECT_NEAR(n.x, normals[i].x, eps);
+					EXPECT_NEAR(n.y, normals[i].y, eps);
+					EXPECT_NEAR(n.z, normals[i].z, eps);
+				}
+			}
+		}
+		EXPECT_FALSE(cache.ReadFrame(TestFrameCount, nullptr, nullptr));
+	}
+
+	bool ReadBytes(const char* filename, std::vector<uint8_t>* data)
+	{
+		saba::File file;
+		return file.Open(filename) && file.ReadAll(data);
+	}
+
+	bool WriteBytes(const char* filename, const uint8_t* data, size_t size)
+	{
+		saba::File file;
+		return file.Create(filename) && file.Write(data, size);
+	}
+}
+
+TEST(ModelTest, PointCacheRoundTrip)
+{
+	TempFile file("PointCacheTest.spc");
+	const char* filename = file.GetPath();
+	const uint32_t flagsList[] = {
+		0,
+		saba::PointCacheFlags::Normal,
+		saba::PointCacheFlags::Quantize,
+		saba::PointCacheFlags::Normal | saba::PointCacheFlags::Quantize,
+	};
+	for (auto flags : flagsList)
+	{
+		SCOPED_TRACE(flags);
+
+		const auto mesh = MakeMesh();
+		{
+			saba::PointCacheWriter writer;
+			ASSERT_TRUE(writer.Create(filename, mesh, flags, 10.0f, 2.0f));
+			ASSERT_TRUE(WriteFrames(&writer));
+		}
+
+		saba::PointCache cache;
+		ASSERT_TRUE(cache.Open(filename));
+		EXPECT_EQ(flags, cache.GetFlags());
+		EXPECT_EQ(TestVertexCount, cache.GetVertexCount());
+		EXPECT_EQ(TestFrameCount, cache.GetFrameCount());
+		EXPECT_EQ(10.0f, cache.GetStartFrame());
+		EXPECT_EQ(2.0f, cache.GetFrameStep());
+
+		const auto& readMesh = cache.GetMesh();
+		EXPECT_EQ(mesh.m_indices, readMesh.m_indices);
+		ASSERT_EQ(mesh.m_uvs.size(), readMesh.m_uvs.size());
+		for (size_t i = 0; i < mesh.m_uvs.size(); i++)
+		{
+			EXPECT_EQ(mesh.m_uvs[i], readMesh.m_uvs[i]);
+		}
+		ASSERT_EQ(1u, readMesh.m_subMeshes.size());
+		EXPECT_EQ(6u, readMesh.m_subMeshes[0].m_indexCount);
+		ASSERT_EQ(1u, readMesh.m_materials.size());
+		EXPECT_EQ("mat", readMesh.m_materials[0].m_name);
+		EXPECT_EQ("tex.png", readMesh.m_materials[0].m_texture);
+		EXPECT_EQ(mesh.m_materials[0].m_diffuse, readMesh.m_materials[0].m_diffuse);
+
+		const bool quantize = (flags & saba::PointCacheFlags::Quantize) != 0;
+		const bool normal = (flags & saba::PointCacheFlags::Normal) != 0;
+		EXPECT_EQ(normal, cache.HasNormal());
+		CheckFrames(cache, normal, quantize ? 1.0e-3f : 0.0f);
+		if (quantize)
+		{
+			EXPECT_EQ(nullptr, cache.GetFramePositions(0));
+		}
+		else
+		{
+			ASSERT_NE(nullptr, cache.GetFramePositions(1));
+			EXPECT_EQ(FramePosition(1, 2), cache.GetFramePositions(1)[2]);
+			EXPECT_EQ(normal, cache.GetFrameNormals(1) != nullptr);
+		}
+
+		cache.Close();
+	}
+}
+
+TEST(ModelTest, PointCachePC2)
+{
+	TempFile file("PointCacheTest.pc2");
+	const char* filename = file.GetPath();
+	{
+		saba::PointCacheWriter writer;
+		ASSERT_TRUE(writer.CreatePC2(filename, TestVertexCount, 1.0f, 0.5f));
+		ASSERT_TRUE(WriteFrames(&writer));
+	}
+
+	std::vector<uint8_t> data;
+	ASSERT_TRUE(ReadBytes(filename, &data));
+	ASSERT_EQ(32 + sizeof(float) * 3 * TestVertexCount * TestFrameCount, data.size());
+	EXPECT_EQ(0, std::memcmp(data.data(), "POINTCACHE2\0", 12));
+
+	int32_t version, numPoints, numSamples;
+	float startFrame, sampleRate;
+	std::memcpy(&version, &data[12], sizeof(version));
+	std::memcpy(&numPoints, &data[16], sizeof(numPoints));
+	std::memcpy(&startFrame, &data[20], sizeof(startFrame));
+	std::memcpy(&sampleRate, &data[24], sizeof(sampleRate));
+	std::memcpy(&numSamples, &data[28], sizeof(numSamples));
+	EXPECT_EQ(1, version);
+	EXPECT_EQ(int32_t(TestVertexCount), numPoints);
+	EXPECT_EQ(1.0f, startFrame);
+	EXPECT_EQ(0.5f, sampleRate);
+	EXPECT_EQ(int32_t(TestFrameCount), numSamples);
+
+	saba::PointCache cache;
+	ASSERT_TRUE(cache.Open(filename));
+	EXPECT_EQ(0u, cache.GetFlags());
+	EXPECT_EQ(TestFrameCount, cache.GetFrameCount());
+	EXPECT_TRUE(cache.GetMesh().m_indices.empty());
+	CheckFrames(cache, false, 0.0f);
+
+	cache.Close();
+}
+
+TEST(ModelTest, PointCacheTruncated)
+{
+	TempFile file("PointCacheTest.spc");
+	TempFile truncatedFile("PointCacheTest.truncated.spc");
+	TempFile pc2File("PointCacheTest.pc2");
+	const char* filename = file.GetPath();
+	const char* truncatedFilename = truncatedFile.GetPath();
+	const char* pc2Filename = pc2File.GetPath();
+	{
+		saba::PointCacheWriter writer;
+		ASSERT_TRUE(writer.Create(filename, MakeMesh(), saba::PointCacheFlags::Normal, 0.0f, 1.0f));
+		ASSERT_TRUE(WriteFrames(&writer));
+	}
+	std::vector<uint8_t> data;
+	ASSERT_TRUE(ReadBytes(filename, &data));
+
+	saba::PointCache cache;
+	// 最後のフレームが欠けている
+	ASSERT_TRUE(WriteBytes(truncatedFilename, data.data(), data.size() - 4));
+	EXPECT_FALSE(cache.Open(truncatedFilename));
+	// ヘッダーの途中まで
+	ASSERT_TRUE(WriteBytes(truncatedFilename, data.data(), 16));
+	EXPECT_FALSE(cache.Open(truncatedFilename));
+
+	{
+		saba::PointCacheWriter writer;
+		ASSERT_TRUE(writer.CreatePC2(pc2Filename, TestVertexCount, 0.0f, 1.0f));
+		ASSERT_TRUE(WriteFrames(&writer));
+	}
+	ASSERT_TRUE(ReadBytes(pc2Filename, &data));
+
+	ASSERT_TRUE(WriteBytes(truncatedFilename, data.data(), data.size() - 4));
+	EXPECT_FALSE(cache.Open(truncatedFilename));
+}
@@ -5,22 +5,240 @@
 
 #include <Saba/Base/UnicodeUtil.h>
 #include <Saba/Base/Path.h>
+#include <Saba/Base/File.h>
 #include <Saba/Model/MMD/MMDModel.h>
 #include <Saba/Model/MMD/PMDModel.h>
 #include <Saba/Model/MMD/PMXModel.h>
 #include <Saba/Model/MMD/VMDFile.h>
 #include <Saba/Model/MMD/VMDAnimation.h>
+#include <Saba/Model/MMD/MMDPhysicsCache.h>
 #include <Saba/Model/MMD/VPDFile.h>
+#include <Saba/Model/PointCache/PointCache.h>
 
 #include <iostream>
 #include <fstream>
 #include <vector>
 #include <string>
 #include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
 
 void Usage()
 {
-	std::cout << "mmd2obj <pmd/pmx file> [-vmd <vmd file>] [-t <animation time (sec)>] [-vpd <vpd file>]\n";
+	std::cout << "mmd2obj <pmd/pmx file> [-vmd <vmd file>] [-t <animation time (sec)>] [-vpd <vpd file>] [-physcache <physics cache file>]\n";
+	std::cout << "        [-start <frame>] [-end <frame>] [-step <frame>] [-j <writer threads>]\n";
+	std::cout << "        [-cache <point cache file>] [-quantize] [-pc2 <pc2 file>]\n";
+	std::cout << "  -start/-end/-step : Export frames (30fps) to output_<frame>.obj.\n";
+	std::cout << "  -cache/-pc2 : Write frames to a binary point cache instead of OBJ files.\n";
+}
+
+namespace
+{
+	// Fast float formatter (6 fractional digits, trailing zeros are removed).
+	void AppendFloat(std::string* out, float value)
+	{
+		if (!std::isfinite(value) || std::abs(value) >= 1.0e9f)
+		{
+			char buf[32];
+			int len = snprintf(buf, sizeof(buf), "%g", value);
+			out->append(buf, len);
+			return;
+		}
+
+		double absValue = std::abs(double(value));
+		uint64_t scaled = uint64_t(absValue * 1000000.0 + 0.5);
+		if (value < 0.0f && scaled != 0)
+		{
+			out->push_back('-');
+		}
+
+		char buf[32];
+		char* end = buf + sizeof(buf);
+		char* p = end;
+		uint32_t frac = uint32_t(scaled % 1000000);
+		uint64_t integer = scaled / 1000000;
+		if (frac != 0)
+		{
+			int digits = 6;
+			while (frac % 10 == 0)
+			{
+				frac /= 10;
+				digits--;
+			}
+			for (int i = 0; i < digits; i++)
+			{
+				*--p = char('0' + frac % 10);
+				frac /= 10;
+			}
+			*--p = '.';
+		}
+		do
+		{
+			*--p = char('0' + integer % 10);
+			integer /= 10;
+		} while (integer != 0);
+		out->append(p, end - p);
+	}
+
+	void AppendUInt(std::string* out, size_t value)
+	{
+		char buf[32];
+		char* end = buf + sizeof(buf);
+		char* p = end;
+		do
+		{
+			*--p = char('0' + value % 10);
+			value /= 10;
+		} while (value != 0);
+		out->append(p, end - p);
+	}
+
+	struct ObjFrame
+	{
+		std::string				m_path;
+		std::vector<glm::vec3>	m_positions;
+		std::vector<glm::vec3>	m_normals;
+		std::vector<glm::vec2>	m_uvs;
+	};
+
+	// Serializes and writes OBJ files on worker threads.
+	// The face section is the same for all frames, so it is formatted once and shared.
+	class ObjWriter
+	{
+	public:
+		ObjWriter(size_t threadCount, std::string faceText)
+			: m_faceText(std::move(faceText))
+			, m_maxQueueSize(threadCount * 2)
+			, m_finished(false)
+			, m_failed(false)
+		{
+			for (size_t i = 0; i < threadCount; i++)
+			{
+				m_threads.emplace_back([this]() { Run(); });
+			}
+		}
+
+		~ObjWriter()
+		{
+			Finish();
+		}
+
+		// Blocks while the queue is full so that the simulation does not outrun the writers.
+		void Push(std::unique_ptr<ObjFrame> frame)
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_popCond.wait(lock, [this]() { return m_queue.size() < m_maxQueueSize; });
+			m_queue.emplace_back(std::move(frame));
+			m_pushCond.notify_one();
+		}
+
+		bool Finish()
+		{
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_finished = true;
+			}
+			m_pushCond.notify_all();
+			for (auto& thread : m_threads)
+			{
+				thread.join();
+			}
+			m_threads.clear();
+			return !m_failed;
+		}
+
+	private:
+		void Run()
+		{
+			std::string text;
+			while (true)
+			{
+				std::unique_ptr<ObjFrame> frame;
+				{
+					std::unique_lock<std::mutex> lock(m_mutex);
+					m_pushCond.wait(lock, [this]() { return !m_queue.empty() || m_finished; });
+					if (m_queue.empty())
+					{
+						return;
+					}
+					frame = std::move(m_queue.front());
+					m_queue.pop_front();
+				}
+				m_popCond.notify_one();
+
+				if (!Write(*frame, &text))
+				{
+					std::unique_lock<std::mutex> lock(m_mutex);
+					std::cout << "Failed to write OBJ file. " << frame->m_path << "\n";
+					m_failed = true;
+				}
+			}
+		}
+
+		bool Write(const ObjFrame& frame, std::string* text)
+		{
+			text->clear();
+			text->reserve(frame.m_positions.size() * 96 + m_faceText.size());
+			text->append("# mmmd2obj\n");
+			text->append("mtllib output.mtl\n");
+
+			// Write positions.
+			for (const auto& pos : frame.m_positions)
+			{
+				text->append("v ");
+				AppendFloat(text, pos.x);
+				text->push_back(' ');
+				AppendFloat(text, pos.y);
+				text->push_back(' ');
+				AppendFloat(text, pos.z);
+				text->push_back('\n');
+			}
+			for (const auto& nor : frame.m_normals)
+			{
+				text->append("vn ");
+				AppendFloat(text, nor.x);
+				text->push_back(' ');
+				AppendFloat(text, nor.y);
+				text->push_back(' ');
+				AppendFloat(text, nor.z);
+				text->push_back('\n');
+			}
+			for (const auto& uv : frame.m_uvs)
+			{
+				text->append("vt ");
+				AppendFloat(text, uv.x);
+				text->push_back(' ');
+				AppendFloat(text, uv.y);
+				text->push_back('\n');
+			}
+			text->append(m_faceText);
+
+			std::ofstream objFile(frame.m_path, std::ios::binary);
+			if (!objFile.is_open())
+			{
+				return false;
+			}
+			objFile.write(text->data(), text->size());
+			return !objFile.fail();
+		}
+
+	private:
+		std::string		m_faceText;
+		size_t			m_maxQueueSize;
+		bool			m_finished;
+		bool			m_failed;
+
+		std::vector<std::thread>				m_threads;
+		std::deque<std::unique_ptr<ObjFrame>>	m_queue;
+		std::mutex								m_mutex;
+		std::condition_variable					m_pushCond;
+		std::condition_variable					m_popCond;
+	};
 }
 
 bool MMD2Obj(const std::vector<std::string>& args)
@@ -35,7 +253,15 @@ bool MMD2Obj(const std::vector<std::string>& args)
 	const std::string& modelPath = args[1];
 	std::vector<std::string> vmdPaths;
 	std::string vpdPath;
+	std::string physicsCachePath;
 	double	animTime = 0.0;
+	int		startFrame = -1;
+	int		endFrame = -1;
+	int		frameStep = 1;
+	size_t	threadCount = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+	std::string pointCachePath;
+	std::string pc2Path;
+	bool	quantize = false;
 
 	for (size_t i = 2; i < args.size(); i++)
 	{
@@ -78,6 +304,101 @@ bool MMD2Obj(const std::vector<std::string>& args)
 				return false;
 			}
 		}
+		else if (args[i] == "-physcache")
+		{
+			i++;
+			if (i < args.size())
+			{
+				physicsCachePath = args[i];
+			}
+			else
+			{
+				Usage();
+				return false;
+			}
+		}
+		else if (args[i] == "-start")
+		{
+			i++;
+			if (i < args.size())
+			{
+				startFrame = std::stoi(args[i]);
+			}
+			else
+			{
+				Usage();
+				return false;
+			}
+		}
+		else if (args[i] == "-end")
+		{
+			i++;
+			if (i < args.size())
+			{
+				endFrame = std::stoi(args[i]);
+			}
+			else
+			{
+				Usage();
+				return false;
+			}
+		}
+		else if (args[i] == "-step")
+		{
+			i++;
+			if (i < args.size())
+			{
+				frameStep = std::stoi(args[i]);
+			}
+			else
+			{
+				Usage();
+				return false;
+			}
+		}
+		else if (args[i] == "-j")
+		{
+			i++;
+			if (i < args.size())
+			{
+				threadCount = size_t(std::max(std::stoi(args[i]), 1));
+			}
+			else
+			{
+				Usage();
+				return false;
+			}
+		}
+		else if (args[i] == "-cache")
+		{
+			i++;
+			if (i < args.size())
+			{
+				pointCachePath = args[i];
+			}
+			else
+			{
+				Usage();
+				return false;
+			}
+		}
+		else if (args[i] == "-pc2")
+		{
+			i++;
+			if (i < args.size())
+			{
+				pc2Path = args[i];
+			}
+			else
+			{
+				Usage();
+				return false;
+			}
+		}
+		else if (args[i] == "-quantize")
+		{
+			quantize = true;
+		}
 		else
 		{
 			Usage();
@@ -86,13 +407,19 @@ bool MMD2Obj(const std::vector<std::string>& args)
 	}
 
 	// Load model.
+	// Physics is not needed when exporting the bind pose.
+	uint32_t readFlags = saba::MMDReadFlags::All;
+	if (vmdPaths.empty() && vpdPath.empty())
+	{
+		readFlags &= ~saba::MMDReadFlags::Physics;
+	}
 	std::shared_ptr<saba::MMDModel> mmdModel;
 	std::string mmdDataPath = "";	// Set MMD data path(default toon texture path).
 	std::string ext = saba::PathUtil::GetExt(modelPath);
 	if (ext == "pmd")
 	{
 		auto pmdModel = std::make_unique<saba::PMDModel>();
-		if (!pmdModel->Load(modelPath, mmdDataPath))
+		if (!pmdModel->Load(modelPath, mmdDataPath, readFlags))
 		{
 			std::cout << "Failed to load PMDModel.\n";
 			return false;
@@ -102,7 +429,7 @@ bool MMD2Obj(const std::vector<std::string>& args)
 	else if (ext == "pmx")
 	{
 		auto pmxModel = std::make_unique<saba::PMXModel>();
-		if (!pmxModel->Load(modelPath, mmdDataPath))
+		if (!pmxModel->Load(modelPath, mmdDataPath, readFlags))
 		{
 			std::cout << "Failed to load PMXModel.\n";
 			return false;
@@ -125,17 +452,11 @@ bool MMD2Obj(const std::vector<std::string>& args)
 	}
 	for (const auto& vmdPath : vmdPaths)
 	{
-		saba::VMDFile vmdFile;
-		if (!saba::ReadVMDFile(&vmdFile, vmdPath.c_str()))
+		if (!vmdAnim->AddFile(vmdPath))
 		{
 			std::cout << "Failed to read VMD file.\n";
 			return false;
 		}
-		if (!vmdAnim->Add(vmdFile))
-		{
-			std::cout << "Failed to add VMDAnimation.\n";
-			return false;
-		}
 	}
 
 	// Load pose.
@@ -157,13 +478,80 @@ bool MMD2Obj(const std::vector<std::string>& args)
 		}
 	}
 
+	// Frame range.
+	bool exportRange = startFrame >= 0 || endFrame >= 0;
+	if (exportRange)
+	{
+		if (!useVMDAnimation)
+		{
+			std::cout << "-start/-end requires VMD animation.\n";
+			return false;
+		}
+		if (startFrame < 0)
+		{
+			startFrame = 0;
+		}
+		if (endFrame < 0)
+		{
+			endFrame = vmdAnim->GetMaxKeyTime();
+		}
+		if (endFrame < startFrame || frameStep < 1)
+		{
+			Usage();
+			return false;
+		}
+		// Do not simulate frames after the last exported frame.
+		endFrame = startFrame + (endFrame - startFrame) / frameStep * frameStep;
+	}
+
+	// Load or bake physics cache.
+	std::unique_ptr<saba::MMDPhysicsCache> physicsCache;
+	if (useVMDAnimation && !physicsCachePath.empty())
+	{
+		uint64_t modelHash = saba::CalcFileHash(modelPath);
+		uint64_t motionHash = 0;
+		for (const auto& vmdPath : vmdPaths)
+		{
+			motionHash = saba::CombineHash(motionHash, saba::CalcFileHash(vmdPath));
+		}
+
+		physicsCache = std::make_unique<saba::MMDPhysicsCache>();
+		if (!physicsCache->Load(physicsCachePath, mmdModel.get(), modelHash, motionHash))
+		{
+			std::cout << "Bake physics cache.\n";
+			physicsCache->Create(mmdModel.get(), modelHash, motionHash);
+			physicsCache->Bake(vmdAnim.get(), vmdAnim->GetMaxKeyTime());
+			if (!physicsCache->Save(physicsCachePath))
+			{
+				std::cout << "Failed to save physics cache.\n";
+			}
+		}
+
+		if (exportRange)
+		{
+			if (!physicsCache->IsRecorded(startFrame) || !physicsCache->IsRecorded(endFrame))
+			{
+				physicsCache.reset();
+			}
+		}
+		else if (!physicsCache->IsRecorded(int32_t(animTime * 30.0)))
+		{
+			physicsCache.reset();
+		}
+	}
+
 	// Initialize pose.
+	float firstFrame = exportRange ? float(startFrame) : float(animTime * 30.0);
 	{
 		// Sync physics animation.
 		mmdModel->InitializeAnimation();
 		if (useVMDAnimation)
 		{
-			vmdAnim->SyncPhysics((float)animTime * 30.0f);
+			// The physics cache does not need to sync physics.
+			if (physicsCache == nullptr)
+			{
+				vmdAnim->SyncPhysics(firstFrame);
+			}
 		}
 		else
 		{
@@ -171,52 +559,27 @@ bool MMD2Obj(const std::vector<std::string>& args)
 		}
 	}
 
-	// Update animation(animation loop).
+	auto updateAnimation = [&](float frame, float physicsElapsed)
 	{
-		// Update animation.
 		mmdModel->BeginAnimation();
-		if (useVMDAnimation)
+		if (physicsCache != nullptr)
+		{
+			vmdAnim->Evaluate(frame);
+			mmdModel->UpdateMorphAnimation();
+			mmdModel->UpdateNodeAnimation(false);
+			physicsCache->Apply(frame);
+			mmdModel->UpdateNodeAnimation(true);
+		}
+		else if (useVMDAnimation)
 		{
-			mmdModel->UpdateAllAnimation(vmdAnim.get(), (float)animTime * 30.0f, 1.0f / 60.0f);
+			mmdModel->UpdateAllAnimation(vmdAnim.get(), frame, physicsElapsed);
 		}
 		else
 		{
-			mmdModel->UpdateAllAnimation(nullptr, 0, 1.0f / 60.0f);
+			mmdModel->UpdateAllAnimation(nullptr, 0, physicsElapsed);
 		}
 		mmdModel->EndAnimation();
-
-		// Update vertices.
-		mmdModel->Update();
-	}
-
-	// Output OBJ file.
-	std::ofstream objFile;
-	objFile.open("output.obj");
-	if (!objFile.is_open())
-	{
-		std::cout << "Failed to open OBJ file.\n";
-		return false;
-	}
-	objFile << "# mmmd2obj\n";
-	objFile << "mtllib output.mtl\n";
-
-	// Write positions.
-	size_t vtxCount = mmdModel->GetVertexCount();
-	const glm::vec3* positions = mmdModel->GetUpdatePositions();
-	for (size_t i = 0; i < vtxCount; i++)
-	{
-		objFile << "v " << positions[i].x << " " << positions[i].y << " " << positions[i].z << "\n";
-	}
-	const glm::vec3* normals = mmdModel->GetUpdateNormals();
-	for (size_t i = 0; i < vtxCount; i++)
-	{
-		objFile << "vn " << normals[i].x << " " << normals[i].y << " " << normals[i].z << "\n";
-	}
-	const glm::vec2* uvs = mmdModel->GetUpdateUVs();
-	for (size_t i = 0; i < vtxCount; i++)
-	{
-		objFile << "vt " << uvs[i].x << " " << uvs[i].y << "\n";
-	}
+	};
 
 	// Copy vertex indices.
 	std::vector<size_t> indices(mmdModel->GetIndexCount());
@@ -249,27 +612,206 @@ bool MMD2Obj(const std::vector<std::string>& args)
 		return false;
 	}
 
-	// Write faces.
+	// Format faces.
+	std::string faceText;
 	size_t subMeshCount = mmdModel->GetSubMeshCount();
 	const saba::MMDSubMesh* subMeshes = mmdModel->GetSubMeshes();
 	for (size_t i = 0; i < subMeshCount; i++)
 	{
-		objFile << "\n";
-		objFile << "usemtl " << subMeshes[i].m_materialID << "\n";
+		faceText.append("\nusemtl ");
+		AppendUInt(&faceText, size_t(subMeshes[i].m_materialID));
+		faceText.push_back('\n');
 
 		for (size_t j = 0; j < subMeshes[i].m_vertexCount; j += 3)
 		{
 			auto vtxIdx = subMeshes[i].m_beginIndex + j;
-			auto vi0 = indices[vtxIdx + 0] + 1;
-			auto vi1 = indices[vtxIdx + 1] + 1;
-			auto vi2 = indices[vtxIdx + 2] + 1;
-			objFile << "f "
-				<< vi0 << "/" << vi0 << "/" << vi0 << " "
-				<< vi1 << "/" << vi1 << "/" << vi1 << " "
-				<< vi2 << "/" << vi2 << "/" << vi2 << "\n";
+			faceText.push_back('f');
+			for (size_t k = 0; k < 3; k++)
+			{
+				auto vi = indices[vtxIdx + k] + 1;
+				faceText.push_back(' ');
+				AppendUInt(&faceText, vi);
+				faceText.push_back('/');
+				AppendUInt(&faceText, vi);
+				faceText.push_back('/');
+				AppendUInt(&faceText, vi);
+			}
+			faceText.push_back('\n');
+		}
+	}
+
+	auto makeFrame = [&mmdModel](const std::string& path)
+	{
+		size_t vtxCount = mmdModel->GetVertexCount();
+		auto frame = std::make_unique<ObjFrame>();
+		frame->m_path = path;
+		frame->m_positions.assign(mmdModel->GetUpdatePositions(), mmdModel->GetUpdatePositions() + vtxCount);
+		frame->m_normals.assign(mmdModel->GetUpdateNormals(), mmdModel->GetUpdateNormals() + vtxCount);
+		frame->m_uvs.assign(mmdModel->GetUpdateUVs(), mmdModel->GetUpdateUVs() + vtxCount);
+		return frame;
+	};
+
+	// Point cache stores the topology once, so OBJ files are not written.
+	bool exportObj = pointCachePath.empty() && pc2Path.empty();
+	std::unique_ptr<ObjWriter> objWriter;
+	if (exportObj)
+	{
+		objWriter = std::make_unique<ObjWriter>(threadCount, std::move(faceText));
+	}
+
+	saba::PointCacheWriter pointCacheWriter;
+	saba::PointCacheWriter pc2Writer;
+	float cacheStartFrame = firstFrame;
+	float cacheFrameStep = exportRange ? float(frameStep) : 1.0f;
+	auto createPointCache = [&]()
+	{
+		if (!pointCachePath.empty())
+		{
+			saba::PointCacheMesh mesh;
+			mesh.m_vertexCount = mmdModel->GetVertexCount();
+			mesh.m_indices.assign(indices.begin(), indices.end());
+			mesh.m_uvs.assign(mmdModel->GetUpdateUVs(), mmdModel->GetUpdateUVs() + mesh.m_vertexCount);
+			for (size_t i = 0; i < subMeshCount; i++)
+			{
+				saba::PointCacheSubMesh subMesh;
+				subMesh.m_beginIndex = uint32_t(subMeshes[i].m_beginIndex);
+				subMesh.m_indexCount = uint32_t(subMeshes[i].m_vertexCount);
+				subMesh.m_materialID = int32_t(subMeshes[i].m_materialID);
+				mesh.m_subMeshes.push_back(subMesh);
+			}
+			const saba::MMDMaterial* materials = mmdModel->GetMaterials();
+			for (size_t i = 0; i < mmdModel->GetMaterialCount(); i++)
+			{
+				const auto& m = materials[i];
+				saba::PointCacheMaterial mat;
+				mat.m_name = std::to_string(i);
+				mat.m_diffuse = glm::vec4(m.m_diffuse, m.m_alpha);
+				mat.m_specular = m.m_specular;
+				mat.m_specularPower = m.m_specularPower;
+				mat.m_ambient = m.m_ambient;
+				mat.m_texture = m.m_texture;
+				mesh.m_materials.emplace_back(std::move(mat));
+			}
+
+			uint32_t flags = saba::PointCacheFlags::Normal;
+			if (quantize)
+			{
+				flags |= saba::PointCacheFlags::Quantize;
+			}
+			if (!pointCacheWriter.Create(pointCachePath.c_str(), mesh, flags, cacheStartFrame, cacheFrameStep))
+			{
+				std::cout << "Failed to create point cache file.\n";
+				return false;
+			}
+		}
+		if (!pc2Path.empty())
+		{
+			if (!pc2Writer.CreatePC2(pc2Path.c_str(), mmdModel->GetVertexCount(), cacheStartFrame, cacheFrameStep))
+			{
+				std::cout << "Failed to create PC2 file.\n";
+				return false;
+			}
+		}
+		return true;
+	};
+
+	bool pointCacheCreated = false;
+	auto outputFrame = [&](const std::string& objPath)
+	{
+		if (exportObj)
+		{
+			objWriter->Push(makeFrame(objPath));
+			return true;
+		}
+
+		// UVs are taken from the first frame.
+		if (!pointCacheCreated)
+		{
+			if (!createPointCache())
+			{
+				return false;
+			}
+			pointCacheCreated = true;
+		}
+		if (!pointCachePath.empty() &&
+			!pointCacheWriter.WriteFrame(mmdModel->GetUpdatePositions(), mmdModel->GetUpdateNormals()))
+		{
+			std::cout << "Failed to write point cache file.\n";
+			return false;
+		}
+		if (!pc2Path.empty() &&
+			!pc2Writer.WriteFrame(mmdModel->GetUpdatePositions(), nullptr))
+		{
+			std::cout << "Failed to write PC2 file.\n";
+			return false;
+		}
+		return true;
+	};
+
+	// Update animation and output frames.
+	if (!exportRange)
+	{
+		updateAnimation(firstFrame, 1.0f / 60.0f);
+
+		// Update vertices.
+		mmdModel->Update();
+
+		if (!outputFrame("output.obj"))
+		{
+			return false;
 		}
 	}
-	objFile.close();
+	else
+	{
+		// Physics is simulated on every frame, even if it is not exported.
+		for (int frame = startFrame; frame <= endFrame; frame++)
+		{
+			bool exportFrame = (frame - startFrame) % frameStep == 0;
+			if (!exportFrame && physicsCache != nullptr)
+			{
+				continue;
+			}
+
+			float physicsElapsed = frame == startFrame ? 1.0f / 60.0f : 1.0f / 30.0f;
+			updateAnimation(float(frame), physicsElapsed);
+			if (!exportFrame)
+			{
+				continue;
+			}
+
+			// Update vertices.
+			mmdModel->Update();
+
+			char objPath[64];
+			snprintf(objPath, sizeof(objPath), "output_%05d.obj", frame);
+			if (!outputFrame(objPath))
+			{
+				return false;
+			}
+		}
+	}
+	if (objWriter != nullptr && !objWriter->Finish())
+	{
+		return false;
+	}
+	if (!pointCachePath.empty() && !pointCacheWriter.Close())
+	{
+		std::cout << "Failed to write point cache file.\n";
+		return false;
+	}
+	if (!pc2Path.empty() && !pc2Writer.Close())
+	{
+		std::cout << "Failed to write PC2 file.\n";
+		return false;
+	}
+	if (exportRange)
+	{
+		std::cout << "Exported " << ((endFrame - startFrame) / frameStep + 1) << " frames.\n";
+	}
+	if (!exportObj)
+	{
+		return true;
+	}
 
 	// Write materials.
 	std::ofstream mtlFile;
@@ -280,7 +822,7 @@ bool MMD2Obj(const std::vector<std::string>& args)
 		return false;
 	}
 
-	objFile << "# mmmd2obj\n";
+	mtlFile << "# mmmd2obj\n";
 	size_t materialCount = mmdModel->GetMaterialCount();
 	const saba::MMDMaterial* materials = mmdModel->GetMaterials();
 	for (size_t i = 0; i < materialCount; i++)
@@ -0,0 +1,802 @@
+﻿//
+// Copyright(c) 2016-2017 benikabocha.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+//
+
+#include <Saba/Base/UnicodeUtil.h>
+#include <Saba/Base/Path.h>
+#include <Saba/Base/File.h>
+#include <Saba/Model/MMD/PMXModel.h>
+#include <Saba/Model/MMD/VMDAnimation.h>
+
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <nlohmann/json.hpp>
+
+#define	STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+#define	STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb_image_write.h>
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <memory>
+#include <map>
+#include <unordered_map>
+#include <algorithm>
+#include <cmath>
+
+void Usage()
+{
+	std::cout << "pmx2glb <pmx file> [-vmd <vmd file>] [-start <frame>] [-end <frame>] [-step <frame>] [-o <glb file>]\n";
+	std::cout << "  Without -vmd, only the mesh and skeleton are exported.\n";
+}
+
+namespace
+{
+	const int GLTFArrayBuffer = 34962;
+	const int GLTFElementArrayBuffer = 34963;
+	const int GLTFUnsignedShort = 5123;
+	const int GLTFUnsignedInt = 5125;
+	const int GLTFFloat = 5126;
+	const int GLTFLinear = 9729;
+	const int GLTFLinearMipmapLinear = 9987;
+	const int GLTFRepeat = 10497;
+
+	class GLBBuilder
+	{
+	public:
+		GLBBuilder()
+		{
+			m_json["asset"] = { { "version", "2.0" }, { "generator", "saba pmx2glb" } };
+		}
+
+		nlohmann::json& GetJson() { return m_json; }
+
+		size_t AddBufferView(const void* data, size_t size, int target)
+		{
+			m_bin.resize((m_bin.size() + 3) & ~size_t(3), 0);
+
+			nlohmann::json view = {
+				{ "buffer", 0 },
+				{ "byteOffset", m_bin.size() },
+				{ "byteLength", size },
+			};
+			if (target != 0)
+			{
+				view["target"] = target;
+			}
+			const uint8_t* bytes = (const uint8_t*)data;
+			m_bin.insert(m_bin.end(), bytes, bytes + size);
+			return Push("bufferViews", std::move(view));
+		}
+
+		template <typename T>
+		size_t AddBufferView(const std::vector<T>& data, int target)
+		{
+			return AddBufferView(data.data(), sizeof(T) * data.size(), target);
+		}
+
+		size_t AddAccessor(size_t bufferView, size_t byteOffset, int componentType, size_t count, const char* type)
+		{
+			nlohmann::json accessor = {
+				{ "bufferView", bufferView },
+				{ "componentType", componentType },
+				{ "count", count },
+				{ "type", type },
+			};
+			if (byteOffset != 0)
+			{
+				accessor["byteOffset"] = byteOffset;
+			}
+			return Push("accessors", std::move(accessor));
+		}
+
+		size_t Push(const char* key, nlohmann::json value)
+		{
+			auto& array = m_json[key];
+			array.push_back(std::move(value));
+			return array.size() - 1;
+		}
+
+		bool Write(const std::string& filename)
+		{
+			if (!m_bin.empty())
+			{
+				m_bin.resize((m_bin.size() + 3) & ~size_t(3), 0);
+				m_json["buffers"] = nlohmann::json::array({ { { "byteLength", m_bin.size() } } });
+			}
+
+			std::string jsonText = m_json.dump();
+			jsonText.resize((jsonText.size() + 3) & ~size_t(3), ' ');
+
+			uint32_t jsonLength = uint32_t(jsonText.size());
+			uint32_t binLength = uint32_t(m_bin.size());
+			uint32_t totalLength = 12 + 8 + jsonLength + (m_bin.empty() ? 0 : 8 + binLength);
+
+			std::ofstream file(filename, std::ios::binary);
+			if (!file.is_open())
+			{
+				return false;
+			}
+			const uint32_t header[3] = { 0x46546C67, 2, totalLength };	// "glTF"
+			const uint32_t jsonChunk[2] = { jsonLength, 0x4E4F534A };	// "JSON"
+			file.write((const char*)header, sizeof(header));
+			file.write((const char*)jsonChunk, sizeof(jsonChunk));
+			file.write(jsonText.data(), jsonText.size());
+			if (!m_bin.empty())
+			{
+				const uint32_t binChunk[2] = { binLength, 0x004E4942 };	// "BIN"
+				file.write((const char*)binChunk, sizeof(binChunk));
+				file.write((const char*)m_bin.data(), m_bin.size());
+			}
+			return !file.fail();
+		}
+
+	private:
+		nlohmann::json			m_json;
+		std::vector<uint8_t>	m_bin;
+	};
+
+	nlohmann::json ToJson(const glm::vec3& v)
+	{
+		return { v.x, v.y, v.z };
+	}
+
+	nlohmann::json ToJson(const glm::quat& q)
+	{
+		return { q.x, q.y, q.z, q.w };
+	}
+
+	void DecomposeTransform(const glm::mat4& m, glm::vec3* t, glm::quat* r)
+	{
+		// MMD nodes do not have scale.
+		*t = glm::vec3(m[3]);
+		*r = glm::normalize(glm::quat_cast(glm::mat3(m)));
+	}
+
+	struct ImageData
+	{
+		int		m_image = -1;
+		bool	m_hasAlpha = false;
+	};
+
+	void AppendBytes(void* context, void* data, int size)
+	{
+		auto* buffer = (std::vector<uint8_t>*)context;
+		const uint8_t* bytes = (const uint8_t*)data;
+		buffer->insert(buffer->end(), bytes, bytes + size);
+	}
+
+	// PNG and JPEG are embedded as they are. Other formats readable by stb_image are converted to PNG.
+	ImageData AddImage(GLBBuilder* glb, const std::string& path)
+	{
+		ImageData imageData;
+
+		saba::File file;
+		std::vector<uint8_t> data;
+		if (!file.Open(path) || !file.ReadAll(&data) || data.empty())
+		{
+			std::cout << "Warning : Failed to read texture. " << path << "\n";
+			return imageData;
+		}
+
+		int x, y, comp;
+		if (stbi_info_from_memory(data.data(), int(data.size()), &x, &y, &comp) == 0)
+		{
+			std::cout << "Warning : Unsupported texture format. " << path << "\n";
+			return imageData;
+		}
+		imageData.m_hasAlpha = comp == 2 || comp == 4;
+
+		std::string ext = saba::PathUtil::GetExt(path);
+		std::string mimeType;
+		if (ext == "png")
+		{
+			mimeType = "image/png";
+		}
+		else if (ext == "jpg" || ext == "jpeg")
+		{
+			mimeType = "image/jpeg";
+		}
+		else
+		{
+			stbi_uc* image = stbi_load_from_memory(data.data(), int(data.size()), &x, &y, &comp, 0);
+			if (image == nullptr)
+			{
+				std::cout << "Warning : Failed to decode texture. " << path << "\n";
+				return imageData;
+			}
+			std::vector<uint8_t> png;
+			int ret = stbi_write_png_to_func(AppendBytes, &png, x, y, comp, image, x * comp);
+			stbi_image_free(image);
+			if (ret == 0)
+			{
+				std::cout << "Warning : Failed to encode texture. " << path << "\n";
+				return imageData;
+			}
+			data.swap(png);
+			mimeType = "image/png";
+		}
+
+		size_t bufferView = glb->AddBufferView(data.data(), data.size(), 0);
+		imageData.m_image = int(glb->Push("images", {
+			{ "name", saba::PathUtil::GetFilenameWithoutExt(path) },
+			{ "bufferView", bufferView },
+			{ "mimeType", mimeType },
+		}));
+		return imageData;
+	}
+}
+
+bool PMX2GLB(const std::vector<std::string>& args)
+{
+	if (args.size() <= 1)
+	{
+		Usage();
+		return false;
+	}
+
+	// Analyze commad line.
+	const std::string& modelPath = args[1];
+	std::vector<std::string> vmdPaths;
+	std::string outputPath = "output.glb";
+	int startFrame = -1;
+	int endFrame = -1;
+	int frameStep = 1;
+
+	for (size_t i = 2; i < args.size(); i++)
+	{
+		if (args[i] == "-vmd")
+		{
+			i++;
+			if (i < args.size())
+			{
+				vmdPaths.push_back(args[i]);
+			}
+			else
+			{
+				Usage();
+				return false;
+			}
+		}
+		else if (args[i] == "-start")
+		{
+			i++;
+			if (i < args.size())
+			{
+				startFrame = std::stoi(args[i]);
+			}
+			else
+			{
+				Usage();
+				return false;
+			}
+		}
+		else if (args[i] == "-end")
+		{
+			i++;
+			if (i < args.size())
+			{
+				endFrame = std::stoi(args[i]);
+			}
+			else
+			{
+				Usage();
+				return false;
+			}
+		}
+		else if (args[i] == "-step")
+		{
+			i++;
+			if (i < args.size())
+			{
+				frameStep = std::stoi(args[i]);
+			}
+			else
+			{
+				Usage();
+				return false;
+			}
+		}
+		else if (args[i] == "-o")
+		{
+			i++;
+			if (i < args.size())
+			{
+				outputPath = args[i];
+			}
+			else
+			{
+				Usage();
+				return false;
+			}
+		}
+		else
+		{
+			Usage();
+			return false;
+		}
+	}
+
+	// Load model.
+	bool useVMDAnimation = !vmdPaths.empty();
+	uint32_t readFlags = saba::MMDReadFlags::All;
+	if (!useVMDAnimation)
+	{
+		readFlags &= ~saba::MMDReadFlags::Physics;
+	}
+	auto pmxModel = std::make_shared<saba::PMXModel>();
+	if (!pmxModel->Load(modelPath, "", readFlags))
+	{
+		std::cout << "Failed to load PMXModel.\n";
+		return false;
+	}
+
+	// Load animation.
+	auto vmdAnim = std::make_unique<saba::VMDAnimation>();
+	if (!vmdAnim->Create(pmxModel))
+	{
+		std::cout << "Failed to create VMDAnimation.\n";
+		return false;
+	}
+	for (const auto& vmdPath : vmdPaths)
+	{
+		if (!vmdAnim->AddFile(vmdPath))
+		{
+			std::cout << "Failed to read VMD file.\n";
+			return false;
+		}
+	}
+	if (useVMDAnimation)
+	{
+		if (startFrame < 0)
+		{
+			startFrame = 0;
+		}
+		if (endFrame < 0)
+		{
+			endFrame = vmdAnim->GetMaxKeyTime();
+		}
+		if (endFrame < startFrame || frameStep < 1)
+		{
+			Usage();
+			return false;
+		}
+		endFrame = startFrame + (endFrame - startFrame) / frameStep * frameStep;
+	}
+
+	GLBBuilder glb;
+	auto& json = glb.GetJson();
+
+	auto nodeMan = pmxModel->GetNodeManager();
+	const size_t nodeCount = nodeMan->GetNodeCount();
+	const size_t vtxCount = pmxModel->GetVertexCount();
+
+	// Vertices.
+	// Positions and normals are already converted to the right-handed coordinate system by PMXModel.
+	std::vector<glm::vec3> positions(pmxModel->GetPositions(), pmxModel->GetPositions() + vtxCount);
+	std::vector<glm::vec3> normals(pmxModel->GetNormals(), pmxModel->GetNormals() + vtxCount);
+	for (auto& n : normals)
+	{
+		// glTF requires unit length normals.
+		const float len = glm::length(n);
+		n = len > 0.0f ? n / len : glm::vec3(0.0f, 1.0f, 0.0f);
+	}
+	std::vector<glm::vec2> uvs(vtxCount);
+	for (size_t i = 0; i < vtxCount; i++)
+	{
+		// glTF has the UV origin at the top left like PMX.
+		const auto& uv = pmxModel->GetUVs()[i];
+		uvs[i] = glm::vec2(uv.x, 1.0f - uv.y);
+	}
+
+	// Skin weights. SDEF and QDEF are exported as linear blend skinning.
+	std::vector<uint16_t> joints(vtxCount * 4, 0);
+	std::vector<float> weights(vtxCount * 4, 0.0f);
+	const saba::PMXModel::VertexBoneInfo* boneInfos = pmxModel->GetVertexBoneInfos();
+	for (size_t i = 0; i < vtxCount; i++)
+	{
+		const auto& info = boneInfos[i];
+		int32_t boneIndices[4] = { -1, -1, -1, -1 };
+		float boneWeights[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		switch (info.m_skinningType)
+		{
+		case saba::PMXModel::SkinningType::Weight1:
+			boneIndices[0] = info.m_boneIndex[0];
+			boneWeights[0] = 1.0f;
+			break;
+		case saba::PMXModel::SkinningType::Weight2:
+			for (int j = 0; j < 2; j++)
+			{
+				boneIndices[j] = info.m_boneIndex[j];
+				boneWeights[j] = info.m_boneWeight[j];
+			}
+			break;
+		case saba::PMXModel::SkinningType::Weight4:
+		case saba::PMXModel::SkinningType::DualQuaternion:
+			for (int j = 0; j < 4; j++)
+			{
+				boneIndices[j] = info.m_boneIndex[j];
+				boneWeights[j] = info.m_boneWeight[j];
+			}
+			break;
+		case saba::PMXModel::SkinningType::SDEF:
+			boneIndices[0] = info.m_sdef.m_boneIndex[0];
+			boneIndices[1] = info.m_sdef.m_boneIndex[1];
+			boneWeights[0] = info.m_sdef.m_boneWeight;
+			boneWeights[1] = 1.0f - info.m_sdef.m_boneWeight;
+			break;
+		default:
+			break;
+		}
+
+		float totalWeight = 0.0f;
+		for (int j = 0; j < 4; j++)
+		{
+			if (boneIndices[j] < 0 || size_t(boneIndices[j]) >= nodeCount || boneWeights[j] <= 0.0f)
+			{
+				boneIndices[j] = 0;
+				boneWeights[j] = 0.0f;
+			}
+			totalWeight += boneWeights[j];
+		}
+		if (totalWeight <= 0.0f)
+		{
+			boneWeights[0] = 1.0f;
+			totalWeight = 1.0f;
+		}
+		for (int j = 0; j < 4; j++)
+		{
+			joints[i * 4 + j] = uint16_t(boneIndices[j]);
+			weights[i * 4 + j] = boneWeights[j] / totalWeight;
+		}
+	}
+
+	glm::vec3 posMin = vtxCount != 0 ? positions[0] : glm::vec3(0);
+	glm::vec3 posMax = posMin;
+	for (const auto& pos : positions)
+	{
+		posMin = glm::min(posMin, pos);
+		posMax = glm::max(posMax, pos);
+	}
+
+	nlohmann::json attributes;
+	size_t posAccessor = glb.AddAccessor(glb.AddBufferView(positions, GLTFArrayBuffer), 0, GLTFFloat, vtxCount, "VEC3");
+	json["accessors"][posAccessor]["min"] = ToJson(posMin);
+	json["accessors"][posAccessor]["max"] = ToJson(posMax);
+	attributes["POSITION"] = posAccessor;
+	attributes["NORMAL"] = glb.AddAccessor(glb.AddBufferView(normals, GLTFArrayBuffer), 0, GLTFFloat, vtxCount, "VEC3");
+	attributes["TEXCOORD_0"] = glb.AddAccessor(glb.AddBufferView(uvs, GLTFArrayBuffer), 0, GLTFFloat, vtxCount, "VEC2");
+	if (nodeCount != 0)
+	{
+		attributes["JOINTS_0"] = glb.AddAccessor(glb.AddBufferView(joints, GLTFArrayBuffer), 0, GLTFUnsignedShort, vtxCount, "VEC4");
+		attributes["WEIGHTS_0"] = glb.AddAccessor(glb.AddBufferView(weights, GLTFArrayBuffer), 0, GLTFFloat, vtxCount, "VEC4");
+	}
+
+	// Indices.
+	std::vector<uint32_t> indices(pmxModel->GetIndexCount());
+	for (size_t i = 0; i < indices.size(); i++)
+	{
+		switch (pmxModel->GetIndexElementSize())
+		{
+		case 1:
+			indices[i] = ((const uint8_t*)pmxModel->GetIndices())[i];
+			break;
+		case 2:
+			indices[i] = ((const uint16_t*)pmxModel->GetIndices())[i];
+			break;
+		default:
+			indices[i] = ((const uint32_t*)pmxModel->GetIndices())[i];
+			break;
+		}
+	}
+	size_t indexView;
+	int indexType;
+	size_t indexSize;
+	if (vtxCount <= 65535)
+	{
+		std::vector<uint16_t> indices16(indices.begin(), indices.end());
+		indexView = glb.AddBufferView(indices16, GLTFElementArrayBuffer);
+		indexType = GLTFUnsignedShort;
+		indexSize = sizeof(uint16_t);
+	}
+	else
+	{
+		indexView = glb.AddBufferView(indices, GLTFElementArrayBuffer);
+		indexType = GLTFUnsignedInt;
+		indexSize = sizeof(uint32_t);
+	}
+
+	// Materials and textures.
+	glb.Push("samplers", {
+		{ "magFilter", GLTFLinear },
+		{ "minFilter", GLTFLinearMipmapLinear },
+		{ "wrapS", GLTFRepeat },
+		{ "wrapT", GLTFRepeat },
+	});
+	std::map<std::string, ImageData> images;
+	const saba::MMDMaterial* materials = pmxModel->GetMaterials();
+	for (size_t i = 0; i < pmxModel->GetMaterialCount(); i++)
+	{
+		const auto& m = materials[i];
+		// MMD diffuse often exceeds 1.0, but glTF requires factors in [0, 1].
+		const glm::vec3 diffuse = glm::clamp(m.m_diffuse, glm::vec3(0.0f), glm::vec3(1.0f));
+		const float alpha = glm::clamp(m.m_alpha, 0.0f, 1.0f);
+		nlohmann::json pbr = {
+			{ "baseColorFactor", { diffuse.r, diffuse.g, diffuse.b, alpha } },
+			{ "metallicFactor", 0.0f },
+			{ "roughnessFactor", std::sqrt(2.0f / (std::max(m.m_specularPower, 0.0f) + 2.0f)) },
+		};
+
+		bool hasAlpha = m.m_alpha < 1.0f;
+		if (!m.m_texture.empty())
+		{
+			auto imageIt = images.find(m.m_texture);
+			if (imageIt == images.end())
+			{
+				imageIt = images.emplace(m.m_texture, AddImage(&glb, m.m_texture)).first;
+			}
+			if (imageIt->second.m_image != -1)
+			{
+				size_t texture = glb.Push("textures", { { "sampler", 0 }, { "source", imageIt->second.m_image } });
+				pbr["baseColorTexture"] = { { "index", texture } };
+				hasAlpha = hasAlpha || imageIt->second.m_hasAlpha;
+			}
+		}
+
+		glb.Push("materials", {
+			{ "name", "material_" + std::to_string(i) },
+			{ "pbrMetallicRoughness", pbr },
+			{ "doubleSided", m.m_bothFace },
+			{ "alphaMode", hasAlpha ? "BLEND" : "OPAQUE" },
+		});
+	}
+
+	// Mesh.
+	nlohmann::json primitives = nlohmann::json::array();
+	const saba::MMDSubMesh* subMeshes = pmxModel->GetSubMeshes();
+	for (size_t i = 0; i < pmxModel->GetSubMeshCount(); i++)
+	{
+		const auto& subMesh = subMeshes[i];
+		if (subMesh.m_vertexCount == 0)
+		{
+			continue;
+		}
+		size_t indexAccessor = glb.AddAccessor(
+			indexView,
+			size_t(subMesh.m_beginIndex) * indexSize,
+			indexType,
+			size_t(subMesh.m_vertexCount),
+			"SCALAR"
+		);
+		primitives.push_back({
+			{ "attributes", attributes },
+			{ "indices", indexAccessor },
+			{ "material", subMesh.m_materialID },
+		});
+	}
+	glb.Push("meshes", { { "name", saba::PathUtil::GetFilenameWithoutExt(modelPath) }, { "primitives", primitives } });
+
+	// Skeleton.
+	// Bones are nodes [0, nodeCount) in PMX bone order, the mesh node follows them.
+	std::unordered_map<const saba::MMDNode*, size_t> nodeIndices;
+	std::vector<glm::mat4> bindGlobals(nodeCount);
+	std::vector<int> parents(nodeCount, -1);
+	for (size_t i = 0; i < nodeCount; i++)
+	{
+		auto node = nodeMan->GetMMDNode(i);
+		nodeIndices[node] = i;
+		bindGlobals[i] = glm::inverse(node->GetInverseInitTransform());
+	}
+	for (size_t i = 0; i < nodeCount; i++)
+	{
+		auto parent = nodeMan->GetMMDNode(i)->GetParent();
+		if (parent != nullptr)
+		{
+			parents[i] = int(nodeIndices[parent]);
+		}
+	}
+
+	std::vector<glm::vec3> bindTranslates(nodeCount);
+	std::vector<glm::quat> bindRotates(nodeCount);
+	std::vector<nlohmann::json> nodes(nodeCount);
+	nlohmann::json sceneNodes = nlohmann::json::array();
+	for (size_t i = 0; i < nodeCount; i++)
+	{
+		glm::mat4 local = bindGlobals[i];
+		if (parents[i] != -1)
+		{
+			local = glm::inverse(bindGlobals[parents[i]]) * bindGlobals[i];
+			nodes[parents[i]]["children"].push_back(i);
+		}
+		else
+		{
+			sceneNodes.push_back(i);
+		}
+		DecomposeTransform(local, &bindTranslates[i], &bindRotates[i]);
+		nodes[i]["name"] = nodeMan->GetMMDNode(i)->GetName();
+		nodes[i]["translation"] = ToJson(bindTranslates[i]);
+		nodes[i]["rotation"] = ToJson(bindRotates[i]);
+	}
+	for (auto& node : nodes)
+	{
+		glb.Push("nodes", std::move(node));
+	}
+	nlohmann::json meshNode = { { "name", "mesh" }, { "mesh", 0 } };
+	if (nodeCount != 0)
+	{
+		std::vector<glm::mat4> inverseBinds(nodeCount);
+		for (size_t i = 0; i < nodeCount; i++)
+		{
+			inverseBinds[i] = nodeMan->GetMMDNode(i)->GetInverseInitTransform();
+		}
+		size_t ibmAccessor = glb.AddAccessor(glb.AddBufferView(inverseBinds, 0), 0, GLTFFloat, nodeCount, "MAT4");
+
+		nlohmann::json jointList = nlohmann::json::array();
+		for (size_t i = 0; i < nodeCount; i++)
+		{
+			jointList.push_back(i);
+		}
+		glb.Push("skins", { { "joints", jointList }, { "inverseBindMatrices", ibmAccessor } });
+		meshNode["skin"] = 0;
+	}
+	sceneNodes.push_back(glb.Push("nodes", meshNode));
+	json["scenes"] = nlohmann::json::array({ { { "nodes", sceneNodes } } });
+	json["scene"] = 0;
+
+	// Bake animation.
+	// IK, append rotations and physics are included because the sampled values come from the global transforms.
+	size_t frameCount = 0;
+	size_t channelCount = 0;
+	if (useVMDAnimation && nodeCount != 0)
+	{
+		std::vector<float> times;
+		std::vector<std::vector<glm::vec3>> translates(nodeCount);
+		std::vector<std::vector<glm::quat>> rotates(nodeCount);
+
+		pmxModel->InitializeAnimation();
+		vmdAnim->SyncPhysics(float(startFrame));
+
+		// Physics is simulated on every frame, even if it is not sampled.
+		for (int frame = startFrame; frame <= endFrame; frame++)
+		{
+			float physicsElapsed = frame == startFrame ? 1.0f / 60.0f : 1.0f / 30.0f;
+			pmxModel->BeginAnimation();
+			pmxModel->UpdateAllAnimation(vmdAnim.get(), float(frame), physicsElapsed);
+			pmxModel->EndAnimation();
+
+			if ((frame - startFrame) % frameStep != 0)
+			{
+				continue;
+			}
+
+			times.push_back(float(frame - startFrame) / 30.0f);
+			for (size_t i = 0; i < nodeCount; i++)
+			{
+				auto node = nodeMan->GetMMDNode(i);
+				glm::mat4 local = node->GetGlobalTransform();
+				if (node->GetParent() != nullptr)
+				{
+					local = glm::inverse(node->GetParent()->GetGlobalTransform()) * local;
+				}
+
+				glm::vec3 t;
+				glm::quat r;
+				DecomposeTransform(local, &t, &r);
+				// Keep quaternions in the same hemisphere for linear interpolation.
+				const glm::quat& prevR = rotates[i].empty() ? bindRotates[i] : rotates[i].back();
+				if (glm::dot(prevR, r) < 0.0f)
+				{
+					r = -r;
+				}
+				translates[i].push_back(t);
+				rotates[i].push_back(r);
+			}
+		}
+		frameCount = times.size();
+
+		size_t timeAccessor = glb.AddAccessor(glb.AddBufferView(times, 0), 0, GLTFFloat, times.size(), "SCALAR");
+		json["accessors"][timeAccessor]["min"] = { times.front() };
+		json["accessors"][timeAccessor]["max"] = { times.back() };
+
+		nlohmann::json samplers = nlohmann::json::array();
+		nlohmann::json channels = nlohmann::json::array();
+		auto addChannel = [&](size_t node, const char* path, size_t output)
+		{
+			samplers.push_back({ { "input", timeAccessor }, { "output", output }, { "interpolation", "LINEAR" } });
+			channels.push_back({ { "sampler", samplers.size() - 1 }, { "target", { { "node", node }, { "path", path } } } });
+		};
+		for (size_t i = 0; i < nodeCount; i++)
+		{
+			// Channels that never leave the bind pose are omitted.
+			bool translateAnimated = std::any_of(
+				translates[i].begin(),
+				translates[i].end(),
+				[&](const glm::vec3& t) { return glm::length(t - bindTranslates[i]) > 1.0e-5f; }
+			);
+			bool rotateAnimated = std::any_of(
+				rotates[i].begin(),
+				rotates[i].end(),
+				[&](const glm::quat& r) { return std::abs(glm::dot(r, bindRotates[i])) < 1.0f - 1.0e-6f; }
+			);
+			if (translateAnimated)
+			{
+				size_t output = glb.AddAccessor(glb.AddBufferView(translates[i], 0), 0, GLTFFloat, frameCount, "VEC3");
+				addChannel(i, "translation", output);
+			}
+			if (rotateAnimated)
+			{
+				std::vector<glm::vec4> values(frameCount);
+				for (size_t j = 0; j < frameCount; j++)
+				{
+					const auto& r = rotates[i][j];
+					values[j] = glm::vec4(r.x, r.y, r.z, r.w);
+				}
+				size_t output = glb.AddAccessor(glb.AddBufferView(values, 0), 0, GLTFFloat, frameCount, "VEC4");
+				addChannel(i, "rotation", output);
+			}
+		}
+		channelCount = channels.size();
+		if (!channels.empty())
+		{
+			glb.Push("animations", {
+				{ "name", saba::PathUtil::GetFilenameWithoutExt(vmdPaths[0]) },
+				{ "samplers", samplers },
+				{ "channels", channels },
+			});
+		}
+	}
+
+	if (!glb.Write(outputPath))
+	{
+		std::cout << "Failed to write GLB file.\n";
+		return false;
+	}
+
+	std::cout << "Vertices : " << vtxCount << "\n";
+	std::cout << "Bones    : " << nodeCount << "\n";
+	std::cout << "Frames   : " << frameCount << " (" << channelCount << " channels)\n";
+
+	return true;
+}
+
+#if _WIN32
+#include <Windows.h>
+#include <shellapi.h>
+#endif
+
+int main(int argc, char** argv)
+{
+	std::vector<std::string> args(argc);
+#if _WIN32
+	{
+		WCHAR* cmdline = GetCommandLineW();
+		int wArgc;
+		WCHAR** wArgs = CommandLineToArgvW(cmdline, &wArgc);
+		for (int i = 0; i < argc; i++)
+		{
+			args[i] = saba::ToUtf8String(wArgs[i]);
+		}
+	}
+#else // _WIN32
+	for (int i = 0; i < argc; i++)
+	{
+		args[i] = argv[i];
+	}
+#endif
+
+	if (!PMX2GLB(args))
+	{
+		std::cout << "Failed to convert model data.\n";
+		return 1;
+	}
+
+	return 0;
+}
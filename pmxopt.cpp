@@ -0,0 +1,278 @@
+﻿//
+// Copyright(c) 2016-2017 benikabocha.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+//
+
+#include <Saba/Base/UnicodeUtil.h>
+#include <Saba/Base/MeshOptimizer.h>
+#include <Saba/Model/MMD/PMXFile.h>
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cstdint>
+
+void Usage()
+{
+	std::cout << "pmxopt <input pmx file> <output pmx file> [-boneOrder]\n";
+	std::cout << "  -boneOrder : Sort vertices by dominant bone in each material (improves skinning locality).\n";
+}
+
+namespace
+{
+	bool IsTriangleMaterial(const saba::PMXMaterial& mat)
+	{
+		// Point/Line 描画 (PMX 2.1) の材質は面の並びに意味があるため並び替えない
+		auto drawMode = uint8_t(mat.m_drawMode);
+		return (drawMode & (uint8_t(saba::PMXDrawModeFlags::DrawPoint) | uint8_t(saba::PMXDrawModeFlags::DrawLine))) == 0;
+	}
+
+	int32_t GetDominantBone(const saba::PMXVertex& vtx)
+	{
+		int numBones = 1;
+		switch (vtx.m_weightType)
+		{
+		case saba::PMXVertexWeight::BDEF1:
+			numBones = 1;
+			break;
+		case saba::PMXVertexWeight::BDEF2:
+		case saba::PMXVertexWeight::SDEF:
+			// 2 つ目のボーンのウェイトは 1 - m_boneWeights[0]
+			return vtx.m_boneWeights[0] >= 0.5f ? vtx.m_boneIndices[0] : vtx.m_boneIndices[1];
+		case saba::PMXVertexWeight::BDEF4:
+		case saba::PMXVertexWeight::QDEF:
+			numBones = 4;
+			break;
+		default:
+			break;
+		}
+
+		int dominant = 0;
+		for (int i = 1; i < numBones; i++)
+		{
+			if (vtx.m_boneWeights[i] > vtx.m_boneWeights[dominant])
+			{
+				dominant = i;
+			}
+		}
+		return vtx.m_boneIndices[dominant];
+	}
+
+	bool RemapVertexIndex(int32_t* vertexIndex, const std::vector<uint32_t>& remap)
+	{
+		if (*vertexIndex < 0 || size_t(*vertexIndex) >= remap.size())
+		{
+			return false;
+		}
+		*vertexIndex = int32_t(remap[*vertexIndex]);
+		return true;
+	}
+}
+
+bool PMXOpt(const std::vector<std::string>& args)
+{
+	if (args.size() <= 2)
+	{
+		Usage();
+		return false;
+	}
+
+	// Analyze commad line.
+	const std::string& inputPath = args[1];
+	const std::string& outputPath = args[2];
+	bool boneOrder = false;
+
+	for (size_t i = 3; i < args.size(); i++)
+	{
+		if (args[i] == "-boneOrder")
+		{
+			boneOrder = true;
+		}
+		else
+		{
+			Usage();
+			return false;
+		}
+	}
+
+	saba::PMXFile pmx;
+	if (!saba::ReadPMXFile(&pmx, inputPath.c_str()))
+	{
+		std::cout << "Failed to read PMX file.\n";
+		return false;
+	}
+
+	const size_t vertexCount = pmx.m_vertices.size();
+	std::vector<uint32_t> indices;
+	indices.reserve(pmx.m_faces.size() * 3);
+	for (const auto& face : pmx.m_faces)
+	{
+		indices.insert(indices.end(), face.m_vertices, face.m_vertices + 3);
+	}
+	for (auto index : indices)
+	{
+		if (index >= vertexCount)
+		{
+			std::cout << "Invalid vertex index in faces.\n";
+			return false;
+		}
+	}
+
+	// 材質ごとの範囲
+	std::vector<std::pair<size_t, size_t>> materialRanges;
+	size_t beginIndex = 0;
+	for (const auto& mat : pmx.m_materials)
+	{
+		size_t endIndex = beginIndex + size_t(std::max(mat.m_numFaceVertices, 0));
+		if (endIndex > indices.size())
+		{
+			std::cout << "Material face count exceeds face data.\n";
+			return false;
+		}
+		materialRanges.emplace_back(beginIndex, endIndex);
+		beginIndex = endIndex;
+	}
+
+	float acmrBefore = saba::CalcACMR(indices.data(), indices.size());
+
+	// 三角形の並び替え (材質の範囲は変えない)
+	for (size_t matIdx = 0; matIdx < pmx.m_materials.size(); matIdx++)
+	{
+		if (!IsTriangleMaterial(pmx.m_materials[matIdx]))
+		{
+			continue;
+		}
+		const auto& range = materialRanges[matIdx];
+		saba::OptimizeVertexCache(&indices[range.first], range.second - range.first);
+	}
+
+	float acmrAfter = saba::CalcACMR(indices.data(), indices.size());
+
+	// 頂点の並び替え
+	// 面から参照される順に並べ、参照されない頂点は主ボーン順に末尾に並べる
+	std::vector<uint32_t> remap;
+	size_t usedCount = saba::MakeVertexFetchRemap(&remap, indices.data(), indices.size(), vertexCount);
+
+	std::vector<uint32_t> order(vertexCount);
+	for (size_t vi = 0; vi < vertexCount; vi++)
+	{
+		order[remap[vi]] = uint32_t(vi);
+	}
+	auto byDominantBone = [&pmx](uint32_t a, uint32_t b)
+	{
+		return GetDominantBone(pmx.m_vertices[a]) < GetDominantBone(pmx.m_vertices[b]);
+	};
+	std::stable_sort(order.begin() + usedCount, order.end(), byDominantBone);
+
+	if (boneOrder)
+	{
+		// 材質内の初出頂点を主ボーン順に並べる (スキニングのボーン参照が連続する代わりに、頂点フェッチの局所性は下がる)
+		size_t groupBegin = 0;
+		for (const auto& range : materialRanges)
+		{
+			size_t groupEnd = groupBegin;
+			for (size_t i = range.first; i < range.second; i++)
+			{
+				groupEnd = std::max(groupEnd, size_t(remap[indices[i]]) + 1);
+			}
+			std::stable_sort(order.begin() + groupBegin, order.begin() + groupEnd, byDominantBone);
+			groupBegin = groupEnd;
+		}
+	}
+
+	for (size_t newIndex = 0; newIndex < vertexCount; newIndex++)
+	{
+		remap[order[newIndex]] = uint32_t(newIndex);
+	}
+
+	// 頂点参照の書き換え
+	std::vector<saba::PMXVertex> vertices(vertexCount);
+	for (size_t vi = 0; vi < vertexCount; vi++)
+	{
+		vertices[remap[vi]] = pmx.m_vertices[vi];
+	}
+	pmx.m_vertices.swap(vertices);
+
+	for (size_t faceIdx = 0; faceIdx < pmx.m_faces.size(); faceIdx++)
+	{
+		for (int i = 0; i < 3; i++)
+		{
+			pmx.m_faces[faceIdx].m_vertices[i] = remap[indices[faceIdx * 3 + i]];
+		}
+	}
+
+	size_t invalidRefCount = 0;
+	for (auto& morph : pmx.m_morphs)
+	{
+		for (auto& positionMorph : morph.m_positionMorph)
+		{
+			invalidRefCount += RemapVertexIndex(&positionMorph.m_vertexIndex, remap) ? 0 : 1;
+		}
+		for (auto& uvMorph : morph.m_uvMorph)
+		{
+			invalidRefCount += RemapVertexIndex(&uvMorph.m_vertexIndex, remap) ? 0 : 1;
+		}
+	}
+	for (auto& softbody : pmx.m_softbodies)
+	{
+		for (auto& anchor : softbody.m_anchorRigidbodies)
+		{
+			invalidRefCount += RemapVertexIndex(&anchor.m_vertexIndex, remap) ? 0 : 1;
+		}
+		for (auto& pinVertex : softbody.m_pinVertexIndices)
+		{
+			invalidRefCount += RemapVertexIndex(&pinVertex, remap) ? 0 : 1;
+		}
+	}
+	if (invalidRefCount != 0)
+	{
+		std::cout << "Warning: " << invalidRefCount << " invalid vertex references were left unchanged.\n";
+	}
+
+	if (!saba::WritePMXFile(&pmx, outputPath.c_str()))
+	{
+		std::cout << "Failed to write PMX file.\n";
+		return false;
+	}
+
+	std::cout << "Vertices : " << vertexCount << " (" << (vertexCount - usedCount) << " unreferenced)\n";
+	std::cout << "Faces    : " << pmx.m_faces.size() << "\n";
+	std::cout << "ACMR     : " << acmrBefore << " -> " << acmrAfter << "\n";
+
+	return true;
+}
+
+#if _WIN32
+#include <Windows.h>
+#include <shellapi.h>
+#endif
+
+int main(int argc, char** argv)
+{
+	std::vector<std::string> args(argc);
+#if _WIN32
+	{
+		WCHAR* cmdline = GetCommandLineW();
+		int wArgc;
+		WCHAR** wArgs = CommandLineToArgvW(cmdline, &wArgc);
+		for (int i = 0; i < argc; i++)
+		{
+			args[i] = saba::ToUtf8String(wArgs[i]);
+		}
+	}
+#else // _WIN32
+	for (int i = 0; i < argc; i++)
+	{
+		args[i] = argv[i];
+	}
+#endif
+
+	if (!PMXOpt(args))
+	{
+		std::cout << "Failed to optimize model data.\n";
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,122 @@
+﻿//
+// Copyright(c) 2016-2017 benikabocha.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+//
+
+#include "BinaryReader.h"
+
+namespace saba
+{
+	BinaryReader::BinaryReader()
+		: m_data(nullptr)
+		, m_size(0)
+		, m_pos(0)
+		, m_isOpen(false)
+		, m_badFlag(false)
+	{
+	}
+
+	BinaryReader::BinaryReader(const void * data, size_t size)
+		: BinaryReader()
+	{
+		SetData(data, size);
+	}
+
+	bool BinaryReader::Open(const char * filepath)
+	{
+		Close();
+
+		if (m_mappedFile.Open(filepath))
+		{
+			SetData(m_mappedFile.GetData(), m_mappedFile.GetSize());
+			return true;
+		}
+
+		File file;
+		if (!file.Open(filepath))
+		{
+			return false;
+		}
+		if (!file.ReadAll(&m_buffer))
+		{
+			m_buffer.clear();
+			return false;
+		}
+		SetData(m_buffer.data(), m_buffer.size());
+		return true;
+	}
+
+	void BinaryReader::SetData(const void * data, size_t size)
+	{
+		m_data = reinterpret_cast<const uint8_t*>(data);
+		m_size = data != nullptr ? size : 0;
+		m_pos = 0;
+		m_isOpen = true;
+		m_badFlag = false;
+	}
+
+	void BinaryReader::Close()
+	{
+		m_mappedFile.Close();
+		m_buffer.clear();
+		m_data = nullptr;
+		m_size = 0;
+		m_pos = 0;
+		m_isOpen = false;
+		m_badFlag = false;
+	}
+
+	bool BinaryReader::Seek(Offset offset, SeekDir origin)
+	{
+		if (!m_isOpen)
+		{
+			return false;
+		}
+
+		Offset base = 0;
+		switch (origin)
+		{
+		case SeekDir::Begin:
+			base = 0;
+			break;
+		case SeekDir::Current:
+			base = Offset(m_pos);
+			break;
+		case SeekDir::End:
+			base = Offset(m_size);
+			break;
+		default:
+			return false;
+		}
+
+		// File と異なり、データの範囲外には移動できない
+		if ((offset < 0 && -offset > base) || (offset > 0 && offset > Offset(m_size) - base))
+		{
+			m_badFlag = true;
+			return false;
+		}
+		m_pos = size_t(base + offset);
+		return true;
+	}
+
+	BinaryReader::Offset BinaryReader::Tell() const
+	{
+		if (!m_isOpen)
+		{
+			return -1;
+		}
+		return Offset(m_pos);
+	}
+
+	const char * BinaryReader::ReadSpan(size_t size)
+	{
+		if (!m_isOpen || size > m_size - m_pos)
+		{
+			m_badFlag = true;
+			return nullptr;
+		}
+		const char* data = reinterpret_cast<const char*>(m_data + m_pos);
+		m_pos += size;
+		return data;
+	}
+}
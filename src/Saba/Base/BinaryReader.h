@@ -0,0 +1,86 @@
+﻿//
+// Copyright(c) 2016-2017 benikabocha.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+//
+
+#ifndef SABA_BASE_BINARYREADER_H_
+#define SABA_BASE_BINARYREADER_H_
+
+#include "File.h"
+
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace saba
+{
+	/*
+	メモリ上のデータ (マップしたファイル) から範囲チェックを行いながら読み込む。
+	File と同じように Read, Seek, Tell を使用できる。
+	*/
+	class BinaryReader
+	{
+	public:
+		using Offset = File::Offset;
+		using SeekDir = File::SeekDir;
+
+		BinaryReader();
+		BinaryReader(const void* data, size_t size);
+
+		BinaryReader(const BinaryReader&) = delete;
+		BinaryReader& operator = (const BinaryReader&) = delete;
+
+		// ファイルをメモリにマップする。マップできない場合はファイル全体を読み込む
+		bool Open(const char* filepath);
+		bool Open(const std::string& filepath) { return Open(filepath.c_str()); }
+		// data は BinaryReader より長く有効である必要がある
+		void SetData(const void* data, size_t size);
+		void Close();
+		bool IsOpen() const { return m_isOpen; }
+
+		Offset GetSize() const { return Offset(m_size); }
+		bool IsBad() const { return m_badFlag; }
+		void ClearBadFlag() { m_badFlag = false; }
+		bool IsEOF() const { return m_pos >= m_size; }
+
+		bool Seek(Offset offset, SeekDir origin);
+		Offset Tell() const;
+
+		template <typename T>
+		bool Read(T* buffer, size_t count = 1)
+		{
+			if (buffer == nullptr || !m_isOpen)
+			{
+				return false;
+			}
+			if (count > (m_size - m_pos) / sizeof(T))
+			{
+				m_badFlag = true;
+				return false;
+			}
+			const size_t size = sizeof(T) * count;
+			if (size != 0)
+			{
+				memcpy(buffer, m_data + m_pos, size);
+			}
+			m_pos += size;
+			return true;
+		}
+
+		// 読み込み位置のデータをコピーせずに参照し、size だけ進める
+		// 範囲外の場合は nullptr を返す
+		const char* ReadSpan(size_t size);
+
+	private:
+		MappedFile				m_mappedFile;
+		std::vector<uint8_t>	m_buffer;
+		const uint8_t*			m_data;
+		size_t					m_size;
+		size_t					m_pos;
+		bool					m_isOpen;
+		bool					m_badFlag;
+	};
+}
+
+#endif // !SABA_BASE_BINARYREADER_H_
@@ -7,9 +7,25 @@
 #include "UnicodeUtil.h"
 
 #include <iterator>
+#include <algorithm>
+
+#if _WIN32
+#include <Windows.h>
+#else // _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif // _WIN32
 
 namespace saba
 {
+	namespace
+	{
+		const uint64_t	FNVOffsetBasis = 14695981039346656037ull;
+		const uint64_t	FNVPrime = 1099511628211ull;
+	}
+
 	File::File()
 		: m_fp(nullptr)
 		, m_fileSize(0)
@@ -226,6 +242,138 @@ namespace saba
 #endif // _WIN32
 	}
 
+	MappedFile::MappedFile()
+		: m_data(nullptr)
+		, m_size(0)
+		, m_isOpen(false)
+#if _WIN32
+		, m_fileHandle(nullptr)
+		, m_mapHandle(nullptr)
+#endif // _WIN32
+	{
+	}
+
+	MappedFile::~MappedFile()
+	{
+		Close();
+	}
+
+	bool MappedFile::Open(const char * filepath)
+	{
+		Close();
+
+#if _WIN32
+		std::wstring wFilepath;
+		if (!TryToWString(filepath, wFilepath))
+		{
+			return false;
+		}
+		HANDLE fileHandle = CreateFileW(
+			wFilepath.c_str(),
+			GENERIC_READ,
+			FILE_SHARE_READ,
+			nullptr,
+			OPEN_EXISTING,
+			FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+			nullptr
+		);
+		if (fileHandle == INVALID_HANDLE_VALUE)
+		{
+			return false;
+		}
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(fileHandle, &fileSize))
+		{
+			CloseHandle(fileHandle);
+			return false;
+		}
+		m_fileHandle = fileHandle;
+		m_size = size_t(fileSize.QuadPart);
+		m_isOpen = true;
+		if (m_size == 0)
+		{
+			return true;
+		}
+
+		m_mapHandle = CreateFileMappingW(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (m_mapHandle == nullptr)
+		{
+			Close();
+			return false;
+		}
+		m_data = reinterpret_cast<const uint8_t*>(MapViewOfFile(m_mapHandle, FILE_MAP_READ, 0, 0, 0));
+		if (m_data == nullptr)
+		{
+			Close();
+			return false;
+		}
+#else // _WIN32
+		int fd = open(filepath, O_RDONLY);
+		if (fd == -1)
+		{
+			return false;
+		}
+		struct stat st;
+		if (fstat(fd, &st) != 0)
+		{
+			close(fd);
+			return false;
+		}
+		m_size = size_t(st.st_size);
+		m_isOpen = true;
+		if (m_size == 0)
+		{
+			close(fd);
+			return true;
+		}
+
+		void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		// マップした後はファイルディスクリプタは不要
+		close(fd);
+		if (data == MAP_FAILED)
+		{
+			Close();
+			return false;
+		}
+		m_data = reinterpret_cast<const uint8_t*>(data);
+#endif // _WIN32
+
+		return true;
+	}
+
+	void MappedFile::Close()
+	{
+#if _WIN32
+		if (m_data != nullptr)
+		{
+			UnmapViewOfFile(m_data);
+		}
+		if (m_mapHandle != nullptr)
+		{
+			CloseHandle(m_mapHandle);
+			m_mapHandle = nullptr;
+		}
+		if (m_fileHandle != nullptr)
+		{
+			CloseHandle(m_fileHandle);
+			m_fileHandle = nullptr;
+		}
+#else // _WIN32
+		if (m_data != nullptr)
+		{
+			munmap(const_cast<uint8_t*>(m_data), m_size);
+		}
+#endif // _WIN32
+		m_data = nullptr;
+		m_size = 0;
+		m_isOpen = false;
+	}
+
+	bool MappedFile::IsOpen() const
+	{
+		return m_isOpen;
+	}
+
 	TextFileReader::TextFileReader(const char * filepath)
 	{
 		Open(filepath);
@@ -332,5 +480,88 @@ namespace saba
 		}
 		return m_file.IsEOF();
 	}
+
+	uint64_t CalcFileHash(const char* filepath)
+	{
+		File file;
+		if (!file.Open(filepath))
+		{
+			return 0;
+		}
+
+		uint64_t hash = FNVOffsetBasis;
+		std::vector<uint8_t> buffer(64 * 1024);
+		File::Offset remaining = file.GetSize();
+		while (remaining > 0)
+		{
+			const size_t readSize = size_t((std::min)(remaining, File::Offset(buffer.size())));
+			if (!file.Read(buffer.data(), readSize))
+			{
+				return 0;
+			}
+			for (size_t i = 0; i < readSize; i++)
+			{
+				hash = (hash ^ buffer[i]) * FNVPrime;
+			}
+			remaining -= readSize;
+		}
+
+		return hash;
+	}
+
+	uint64_t CombineHash(uint64_t hash0, uint64_t hash1)
+	{
+		uint64_t hash = hash0;
+		for (int i = 0; i < 8; i++)
+		{
+			hash = (hash ^ ((hash1 >> (i * 8)) & 0xFF)) * FNVPrime;
+		}
+		return hash;
+	}
+
+	uint64_t CalcStringHash(const std::string& str)
+	{
+		uint64_t hash = FNVOffsetBasis;
+		for (char ch : str)
+		{
+			hash = (hash ^ uint8_t(ch)) * FNVPrime;
+		}
+		return hash;
+	}
+
+	bool GetFileStamp(const char* filepath, uint64_t* size, uint64_t* modifiedTime)
+	{
+		if (size == nullptr || modifiedTime == nullptr)
+		{
+			return false;
+		}
+#if _WIN32
+		std::wstring wFilepath;
+		if (!TryToWString(filepath, wFilepath))
+		{
+			return false;
+		}
+		WIN32_FILE_ATTRIBUTE_DATA attr;
+		if (!GetFileAttributesExW(wFilepath.c_str(), GetFileExInfoStandard, &attr))
+		{
+			return false;
+		}
+		*size = (uint64_t(attr.nFileSizeHigh) << 32) | attr.nFileSizeLow;
+		*modifiedTime = (uint64_t(attr.ftLastWriteTime.dwHighDateTime) << 32) | attr.ftLastWriteTime.dwLowDateTime;
+#else // _WIN32
+		struct stat st;
+		if (stat(filepath, &st) != 0)
+		{
+			return false;
+		}
+		*size = uint64_t(st.st_size);
+#if defined(__linux__)
+		*modifiedTime = uint64_t(st.st_mtim.tv_sec) * 1000000000ull + uint64_t(st.st_mtim.tv_nsec);
+#else // __linux__
+		*modifiedTime = uint64_t(st.st_mtime);
+#endif // __linux__
+#endif // _WIN32
+		return true;
+	}
 }
 
@@ -114,6 +114,36 @@ namespace saba
 		bool	m_badFlag;
 	};
 
+	/*
+	ファイルを読み込み専用でメモリにマップする (Windows : MapViewOfFile, その他 : mmap)
+	*/
+	class MappedFile
+	{
+	public:
+		MappedFile();
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator = (const MappedFile&) = delete;
+
+		bool Open(const char* filepath);
+		bool Open(const std::string& filepath) { return Open(filepath.c_str()); }
+		void Close();
+		bool IsOpen() const;
+
+		const uint8_t* GetData() const { return m_data; }
+		size_t GetSize() const { return m_size; }
+
+	private:
+		const uint8_t*	m_data;
+		size_t			m_size;
+		bool			m_isOpen;
+#if _WIN32
+		void*			m_fileHandle;
+		void*			m_mapHandle;
+#endif // _WIN32
+	};
+
 	class TextFileReader
 	{
 	public:
@@ -134,6 +164,17 @@ namespace saba
 	private:
 		saba::File	m_file;
 	};
+
+	// ファイル内容のハッシュ (FNV-1a 64bit, 読み込みに失敗した場合は 0)
+	uint64_t CalcFileHash(const char* filepath);
+	inline uint64_t CalcFileHash(const std::string& filepath) { return CalcFileHash(filepath.c_str()); }
+	uint64_t CombineHash(uint64_t hash0, uint64_t hash1);
+	// 文字列のハッシュ (FNV-1a 64bit)
+	uint64_t CalcStringHash(const std::string& str);
+
+	// ファイルサイズと更新時刻を取得する (ファイルを開かずに変更を検出するために使う)
+	bool GetFileStamp(const char* filepath, uint64_t* size, uint64_t* modifiedTime);
+	inline bool GetFileStamp(const std::string& filepath, uint64_t* size, uint64_t* modifiedTime) { return GetFileStamp(filepath.c_str(), size, modifiedTime); }
 }
 
 #endif // !BASE_FILE_H_
@@ -0,0 +1,258 @@
+﻿//
+// Copyright(c) 2016-2017 benikabocha.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+//
+
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+
+namespace saba
+{
+	namespace
+	{
+		// Tom Forsyth, "Linear-Speed Vertex Cache Optimisation"
+		const size_t	ForsythCacheSize = 32;
+		const float		ForsythCacheDecayPower = 1.5f;
+		const float		ForsythLastTriScore = 0.75f;
+		const float		ForsythValenceBoostScale = 2.0f;
+		const float		ForsythValenceBoostPower = 0.5f;
+
+		float CalcVertexScore(int cachePos, uint32_t remainingTris)
+		{
+			if (remainingTris == 0)
+			{
+				return -1.0f;
+			}
+
+			float score = 0.0f;
+			if (cachePos >= 0)
+			{
+				if (cachePos < 3)
+				{
+					// 直前の三角形の頂点は連続で使うと効率が悪いため固定値
+					score = ForsythLastTriScore;
+				}
+				else
+				{
+					const float scaler = 1.0f / float(ForsythCacheSize - 3);
+					score = 1.0f - float(cachePos - 3) * scaler;
+					score = std::pow(score, ForsythCacheDecayPower);
+				}
+			}
+
+			// 残りの三角形が少ない頂点を優先して、孤立した三角形を作らないようにする
+			score += ForsythValenceBoostScale * std::pow(float(remainingTris), -ForsythValenceBoostPower);
+			return score;
+		}
+	}
+
+	void OptimizeVertexCache(uint32_t* indices, size_t indexCount)
+	{
+		const size_t triCount = indexCount / 3;
+		if (triCount < 2)
+		{
+			return;
+		}
+
+		// 範囲内だけの頂点番号に置き換える
+		std::vector<uint32_t> vertices(indices, indices + triCount * 3);
+		std::sort(vertices.begin(), vertices.end());
+		vertices.erase(std::unique(vertices.begin(), vertices.end()), vertices.end());
+		const size_t vertexCount = vertices.size();
+
+		std::vector<uint32_t> localIndices(triCount * 3);
+		for (size_t i = 0; i < triCount * 3; i++)
+		{
+			auto it = std::lower_bound(vertices.begin(), vertices.end(), indices[i]);
+			localIndices[i] = uint32_t(it - vertices.begin());
+		}
+
+		// 頂点から三角形への隣接リスト
+		std::vector<uint32_t> remainingTris(vertexCount, 0);
+		for (auto vi : localIndices)
+		{
+			remainingTris[vi]++;
+		}
+		std::vector<uint32_t> adjOffsets(vertexCount + 1, 0);
+		for (size_t vi = 0; vi < vertexCount; vi++)
+		{
+			adjOffsets[vi + 1] = adjOffsets[vi] + remainingTris[vi];
+		}
+		std::vector<uint32_t> adjacency(triCount * 3);
+		{
+			std::vector<uint32_t> writePos(adjOffsets.begin(), adjOffsets.end() - 1);
+			for (size_t ti = 0; ti < triCount; ti++)
+			{
+				for (size_t k = 0; k < 3; k++)
+				{
+					auto vi = localIndices[ti * 3 + k];
+					adjacency[writePos[vi]++] = uint32_t(ti);
+				}
+			}
+		}
+
+		std::vector<int> cachePos(vertexCount, -1);
+		std::vector<float> vertexScores(vertexCount);
+		for (size_t vi = 0; vi < vertexCount; vi++)
+		{
+			vertexScores[vi] = CalcVertexScore(-1, remainingTris[vi]);
+		}
+
+		std::vector<char> triAdded(triCount, 0);
+		size_t bestTri = 0;
+		float bestScore = -1.0f;
+		for (size_t ti = 0; ti < triCount; ti++)
+		{
+			const uint32_t* tri = &localIndices[ti * 3];
+			float score = vertexScores[tri[0]] + vertexScores[tri[1]] + vertexScores[tri[2]];
+			if (score > bestScore)
+			{
+				bestScore = score;
+				bestTri = ti;
+			}
+		}
+
+		std::vector<uint32_t> cache;
+		std::vector<uint32_t> newCache;
+		cache.reserve(ForsythCacheSize + 3);
+		newCache.reserve(ForsythCacheSize + 3);
+		size_t outPos = 0;
+		size_t scanPos = 0;
+		for (size_t n = 0; n < triCount; n++)
+		{
+			if (bestScore < 0.0f)
+			{
+				// キャッシュ内の頂点に候補が無いので、未出力の三角形を先頭から探す
+				while (triAdded[scanPos] != 0)
+				{
+					scanPos++;
+				}
+				bestTri = scanPos;
+			}
+
+			triAdded[bestTri] = 1;
+			const uint32_t* tri = &localIndices[bestTri * 3];
+			for (size_t k = 0; k < 3; k++)
+			{
+				auto vi = tri[k];
+				indices[outPos++] = vertices[vi];
+
+				// 隣接リストから取り除く
+				uint32_t* adjBegin = &adjacency[adjOffsets[vi]];
+				uint32_t* adjEnd = adjBegin + remainingTris[vi];
+				auto it = std::find(adjBegin, adjEnd, uint32_t(bestTri));
+				*it = *(adjEnd - 1);
+				remainingTris[vi]--;
+			}
+
+			// LRU キャッシュの更新
+			newCache.clear();
+			for (size_t k = 0; k < 3; k++)
+			{
+				if (std::find(newCache.begin(), newCache.end(), tri[k]) == newCache.end())
+				{
+					newCache.push_back(tri[k]);
+				}
+			}
+			for (auto vi : cache)
+			{
+				if (vi != tri[0] && vi != tri[1] && vi != tri[2])
+				{
+					newCache.push_back(vi);
+				}
+			}
+			for (size_t i = 0; i < newCache.size(); i++)
+			{
+				auto vi = newCache[i];
+				cachePos[vi] = i < ForsythCacheSize ? int(i) : -1;
+				vertexScores[vi] = CalcVertexScore(cachePos[vi], remainingTris[vi]);
+			}
+
+			// キャッシュ内の頂点に隣接する三角形から次の三角形を選ぶ
+			bestScore = -1.0f;
+			for (auto vi : newCache)
+			{
+				const uint32_t* adjBegin = &adjacency[adjOffsets[vi]];
+				const uint32_t* adjEnd = adjBegin + remainingTris[vi];
+				for (auto adj = adjBegin; adj != adjEnd; ++adj)
+				{
+					const uint32_t* adjTri = &localIndices[*adj * 3];
+					float score = vertexScores[adjTri[0]] + vertexScores[adjTri[1]] + vertexScores[adjTri[2]];
+					if (score > bestScore)
+					{
+						bestScore = score;
+						bestTri = *adj;
+					}
+				}
+			}
+
+			if (newCache.size() > ForsythCacheSize)
+			{
+				newCache.resize(ForsythCacheSize);
+			}
+			cache.swap(newCache);
+		}
+	}
+
+	size_t MakeVertexFetchRemap(
+		std::vector<uint32_t>* remap,
+		const uint32_t* indices,
+		size_t indexCount,
+		size_t vertexCount
+	)
+	{
+		const uint32_t unused = uint32_t(-1);
+		remap->assign(vertexCount, unused);
+
+		uint32_t nextIndex = 0;
+		for (size_t i = 0; i < indexCount; i++)
+		{
+			auto vi = indices[i];
+			if ((*remap)[vi] == unused)
+			{
+				(*remap)[vi] = nextIndex;
+				nextIndex++;
+			}
+		}
+
+		size_t usedCount = nextIndex;
+		for (auto& newIndex : *remap)
+		{
+			if (newIndex == unused)
+			{
+				newIndex = nextIndex;
+				nextIndex++;
+			}
+		}
+		return usedCount;
+	}
+
+	float CalcACMR(const uint32_t* indices, size_t indexCount, size_t cacheSize)
+	{
+		const size_t triCount = indexCount / 3;
+		if (triCount == 0)
+		{
+			return 0.0f;
+		}
+
+		std::deque<uint32_t> cache;
+		size_t missCount = 0;
+		for (size_t i = 0; i < triCount * 3; i++)
+		{
+			auto vi = indices[i];
+			if (std::find(cache.begin(), cache.end(), vi) == cache.end())
+			{
+				missCount++;
+				cache.push_back(vi);
+				if (cache.size() > cacheSize)
+				{
+					cache.pop_front();
+				}
+			}
+		}
+		return float(missCount) / float(triCount);
+	}
+}
@@ -0,0 +1,34 @@
+﻿//
+// Copyright(c) 2016-2017 benikabocha.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+//
+
+#ifndef SABA_BASE_MESHOPTIMIZER_H_
+#define SABA_BASE_MESHOPTIMIZER_H_
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace saba
+{
+	// 頂点キャッシュのヒット率が上がるように三角形の順番を並び替える (Forsyth)
+	// 各三角形の頂点の順番 (表裏) はそのまま
+	void OptimizeVertexCache(uint32_t* indices, size_t indexCount);
+
+	// インデックスから参照される順に頂点を並べるための変換テーブルを作る
+	// (*remap)[oldIndex] = newIndex
+	// 参照されない頂点は末尾に元の順番で配置する
+	// 戻り値は参照されている頂点数
+	size_t MakeVertexFetchRemap(
+		std::vector<uint32_t>* remap,
+		const uint32_t* indices,
+		size_t indexCount,
+		size_t vertexCount
+	);
+
+	// 三角形あたりの平均キャッシュミス数 (ACMR) を FIFO キャッシュで計算する
+	float CalcACMR(const uint32_t* indices, size_t indexCount, size_t cacheSize = 16);
+}
+
+#endif // !SABA_BASE_MESHOPTIMIZER_H_
@@ -5,9 +5,15 @@
 
 #include "UnicodeUtil.h"
 
+#include <algorithm>
 #include <stdexcept>
 #include <stdint.h>
 
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SABA_UNICODE_SSE2 1
+#include <emmintrin.h>
+#endif
+
 namespace saba
 {
 	std::wstring ToWString(const std::string & utf8Str)
@@ -108,6 +114,86 @@ namespace saba
 		bool IsU16HighSurrogate(char16_t ch) { return 0xD800 <= ch && ch < 0xDC00; }
 
 		bool IsU16LowSurrogate(char16_t ch) { return 0xDC00 <= ch && ch < 0xE000; }
+
+		// ASCII が続く部分は 16 文字単位でまとめて変換する
+		const size_t AsciiBlockSize = 16;
+
+		// 16 バイトがすべて ASCII (0x00 - 0x7F) の場合は true
+		bool IsAsciiBlock(const char* src) {
+#if SABA_UNICODE_SSE2
+			__m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+			return _mm_movemask_epi8(data) == 0;
+#else // SABA_UNICODE_SSE2
+			uint8_t bits = 0;
+			for (size_t i = 0; i < AsciiBlockSize; i++) {
+				bits |= uint8_t(src[i]);
+			}
+			return (bits & 0x80) == 0;
+#endif // SABA_UNICODE_SSE2
+		}
+
+		/*
+		16 文字がすべて ASCII (0x01 - 0x7F) の場合は UTF-8 にして true を返す。
+		0 は 1 文字ずつ変換する場合と同じく出力しないため、ここでは対象にしない。
+		*/
+#if SABA_UNICODE_SSE2
+		bool NarrowAsciiBlock(__m128i bytes, char* dst) {
+			__m128i zero = _mm_cmpeq_epi8(bytes, _mm_setzero_si128());
+			if (_mm_movemask_epi8(_mm_or_si128(bytes, zero)) != 0) {
+				return false;
+			}
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst), bytes);
+			return true;
+		}
+#endif // SABA_UNICODE_SSE2
+
+		template <typename CharT>
+		bool NarrowAsciiBlockScalar(const CharT* src, char* dst) {
+			for (size_t i = 0; i < AsciiBlockSize; i++) {
+				if (src[i] == 0 || src[i] >= 0x80) {
+					return false;
+				}
+			}
+			for (size_t i = 0; i < AsciiBlockSize; i++) {
+				dst[i] = char(src[i]);
+			}
+			return true;
+		}
+
+		bool NarrowAsciiBlock(const char16_t* src, char* dst) {
+#if SABA_UNICODE_SSE2
+			// 0xFF を超える値は飽和して 0xFF になるので、ASCII 以外として判定できる
+			__m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+			__m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 8));
+			return NarrowAsciiBlock(_mm_packus_epi16(lo, hi), dst);
+#else // SABA_UNICODE_SSE2
+			return NarrowAsciiBlockScalar(src, dst);
+#endif // SABA_UNICODE_SSE2
+		}
+
+		bool NarrowAsciiBlock(const char32_t* src, char* dst) {
+#if SABA_UNICODE_SSE2
+			// 符号付きで飽和させるため、0x80000000 以上の値は 0 になり ASCII 以外として扱われる
+			__m128i v0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+			__m128i v1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 4));
+			__m128i v2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 8));
+			__m128i v3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 12));
+			__m128i lo = _mm_packs_epi32(v0, v1);
+			__m128i hi = _mm_packs_epi32(v2, v3);
+			return NarrowAsciiBlock(_mm_packus_epi16(lo, hi), dst);
+#else // SABA_UNICODE_SSE2
+			return NarrowAsciiBlockScalar(src, dst);
+#endif // SABA_UNICODE_SSE2
+		}
+
+		template <typename CharT>
+		void AppendAsciiBlock(const char* src, std::basic_string<CharT>& dst) {
+			CharT buffer[AsciiBlockSize];
+			for (size_t i = 0; i < AsciiBlockSize; i++) {
+				buffer[i] = CharT(uint8_t(src[i]));
+			}
+			dst.append(buffer, AsciiBlockSize);
+		}
 	}  // namespace
 
 	bool ConvChU8ToU16(const std::array<char, 4>& u8Ch,
@@ -268,93 +354,132 @@ namespace saba
 	}
 
 	bool ConvU8ToU16(const std::string& u8Str, std::u16string& u16Str) {
-		for (auto u8It = u8Str.begin(); u8It != u8Str.end(); ++u8It) {
-			auto numBytes = GetU8ByteCount((*u8It));
-			if (numBytes == 0) {
-				return false;
-			}
-
-			std::array<char, 4> u8Ch;
-			u8Ch[0] = (*u8It);
-			for (int i = 1; i < numBytes; i++) {
-				++u8It;
-				if (u8It == u8Str.end()) {
+		const char* u8Data = u8Str.data();
+		const size_t u8Size = u8Str.size();
+		u16Str.reserve(u16Str.size() + u8Size);
+		size_t u8Pos = 0;
+		while (u8Pos < u8Size) {
+			if (u8Pos + AsciiBlockSize <= u8Size && IsAsciiBlock(u8Data + u8Pos)) {
+				AppendAsciiBlock(u8Data + u8Pos, u16Str);
+				u8Pos += AsciiBlockSize;
+				continue;
+			}
+
+			const size_t blockEnd = std::min(u8Pos + AsciiBlockSize, u8Size);
+			while (u8Pos < blockEnd) {
+				auto numBytes = GetU8ByteCount(u8Data[u8Pos]);
+				if (numBytes == 0) {
+					return false;
+				}
+				if (u8Pos + numBytes > u8Size) {
 					return false;
 				}
-				u8Ch[i] = (*u8It);
-			}
 
-			std::array<char16_t, 2> u16Ch;
-			if (!ConvChU8ToU16(u8Ch, u16Ch)) {
-				return false;
-			}
+				std::array<char, 4> u8Ch;
+				for (int i = 0; i < numBytes; i++) {
+					u8Ch[i] = u8Data[u8Pos + i];
+				}
+				u8Pos += numBytes;
 
-			u16Str.push_back(u16Ch[0]);
-			if (u16Ch[1] != 0) {
-				u16Str.push_back(u16Ch[1]);
+				std::array<char16_t, 2> u16Ch;
+				if (!ConvChU8ToU16(u8Ch, u16Ch)) {
+					return false;
+				}
+
+				u16Str.push_back(u16Ch[0]);
+				if (u16Ch[1] != 0) {
+					u16Str.push_back(u16Ch[1]);
+				}
 			}
 		}
 		return true;
 	}
 
 	bool ConvU8ToU32(const std::string& u8Str, std::u32string& u32Str) {
-		for (auto u8It = u8Str.begin(); u8It != u8Str.end(); ++u8It) {
-			auto numBytes = GetU8ByteCount((*u8It));
-			if (numBytes == 0) {
-				return false;
-			}
+		const char* u8Data = u8Str.data();
+		const size_t u8Size = u8Str.size();
+		u32Str.reserve(u32Str.size() + u8Size);
+		size_t u8Pos = 0;
+		while (u8Pos < u8Size) {
+			if (u8Pos + AsciiBlockSize <= u8Size && IsAsciiBlock(u8Data + u8Pos)) {
+				AppendAsciiBlock(u8Data + u8Pos, u32Str);
+				u8Pos += AsciiBlockSize;
+				continue;
+			}
+
+			const size_t blockEnd = std::min(u8Pos + AsciiBlockSize, u8Size);
+			while (u8Pos < blockEnd) {
+				auto numBytes = GetU8ByteCount(u8Data[u8Pos]);
+				if (numBytes == 0) {
+					return false;
+				}
+				if (u8Pos + numBytes > u8Size) {
+					return false;
+				}
+
+				std::array<char, 4> u8Ch;
+				for (int i = 0; i < numBytes; i++) {
+					u8Ch[i] = u8Data[u8Pos + i];
+				}
+				u8Pos += numBytes;
 
-			std::array<char, 4> u8Ch;
-			u8Ch[0] = (*u8It);
-			for (int i = 1; i < numBytes; i++) {
-				++u8It;
-				if (u8It == u8Str.end()) {
+				char32_t u32Ch;
+				if (!ConvChU8ToU32(u8Ch, u32Ch)) {
 					return false;
 				}
-				u8Ch[i] = (*u8It);
-			}
 
-			char32_t u32Ch;
-			if (!ConvChU8ToU32(u8Ch, u32Ch)) {
-				return false;
+				u32Str.push_back(u32Ch);
 			}
-
-			u32Str.push_back(u32Ch);
 		}
 		return true;
 	}
 
 	bool ConvU16ToU8(const std::u16string& u16Str, std::string& u8Str) {
-		for (auto u16It = u16Str.begin(); u16It != u16Str.end(); ++u16It) {
-			std::array<char16_t, 2> u16Ch;
-			if (IsU16HighSurrogate((*u16It))) {
-				u16Ch[0] = (*u16It);
-				++u16It;
-				if (u16It == u16Str.end()) {
-					return false;
+		const char16_t* u16Data = u16Str.data();
+		const size_t u16Size = u16Str.size();
+		u8Str.reserve(u8Str.size() + u16Size);
+		size_t u16Pos = 0;
+		while (u16Pos < u16Size) {
+			char asciiBlock[AsciiBlockSize];
+			if (u16Pos + AsciiBlockSize <= u16Size && NarrowAsciiBlock(u16Data + u16Pos, asciiBlock)) {
+				u8Str.append(asciiBlock, AsciiBlockSize);
+				u16Pos += AsciiBlockSize;
+				continue;
+			}
+
+			const size_t blockEnd = std::min(u16Pos + AsciiBlockSize, u16Size);
+			while (u16Pos < blockEnd) {
+				std::array<char16_t, 2> u16Ch;
+				if (IsU16HighSurrogate(u16Data[u16Pos])) {
+					u16Ch[0] = u16Data[u16Pos];
+					if (u16Pos + 1 >= u16Size) {
+						return false;
+					}
+					u16Ch[1] = u16Data[u16Pos + 1];
+					u16Pos += 2;
+				}
+				else {
+					u16Ch[0] = u16Data[u16Pos];
+					u16Ch[1] = 0;
+					u16Pos += 1;
 				}
-				u16Ch[1] = (*u16It);
-			}
-			else {
-				u16Ch[0] = (*u16It);
-				u16Ch[1] = 0;
-			}
 
-			std::array<char, 4> u8Ch;
-			if (!ConvChU16ToU8(u16Ch, u8Ch)) {
-				return false;
-			}
-			if (u8Ch[0] != 0) {
-				u8Str.push_back(u8Ch[0]);
-			}
-			if (u8Ch[1] != 0) {
-				u8Str.push_back(u8Ch[1]);
-			}
-			if (u8Ch[2] != 0) {
-				u8Str.push_back(u8Ch[2]);
-			}
-			if (u8Ch[3] != 0) {
-				u8Str.push_back(u8Ch[3]);
+				std::array<char, 4> u8Ch;
+				if (!ConvChU16ToU8(u16Ch, u8Ch)) {
+					return false;
+				}
+				if (u8Ch[0] != 0) {
+					u8Str.push_back(u8Ch[0]);
+				}
+				if (u8Ch[1] != 0) {
+					u8Str.push_back(u8Ch[1]);
+				}
+				if (u8Ch[2] != 0) {
+					u8Str.push_back(u8Ch[2]);
+				}
+				if (u8Ch[3] != 0) {
+					u8Str.push_back(u8Ch[3]);
+				}
 			}
 		}
 		return true;
@@ -386,24 +511,38 @@ namespace saba
 	}
 
 	bool ConvU32ToU8(const std::u32string& u32Str, std::string& u8Str) {
-		for (auto u32It = u32Str.begin(); u32It != u32Str.end(); ++u32It) {
-			std::array<char, 4> u8Ch;
-			if (!ConvChU32ToU8((*u32It), u8Ch)) {
-				return false;
-			}
+		const char32_t* u32Data = u32Str.data();
+		const size_t u32Size = u32Str.size();
+		u8Str.reserve(u8Str.size() + u32Size);
+		size_t u32Pos = 0;
+		while (u32Pos < u32Size) {
+			char asciiBlock[AsciiBlockSize];
+			if (u32Pos + AsciiBlockSize <= u32Size && NarrowAsciiBlock(u32Data + u32Pos, asciiBlock)) {
+				u8Str.append(asciiBlock, AsciiBlockSize);
+				u32Pos += AsciiBlockSize;
+				continue;
+			}
+
+			const size_t blockEnd = std::min(u32Pos + AsciiBlockSize, u32Size);
+			for (; u32Pos < blockEnd; u32Pos++) {
+				std::array<char, 4> u8Ch;
+				if (!ConvChU32ToU8(u32Data[u32Pos], u8Ch)) {
+					return false;
+				}
 
-			if (u8Ch[0] != 0) {
-				u8Str.push_back(u8Ch[0]);
-			}
-			if (u8Ch[1] != 0) {
-				u8Str.push_back(u8Ch[1]);
-			}
+				if (u8Ch[0] != 0) {
+					u8Str.push_back(u8Ch[0]);
+				}
+				if (u8Ch[1] != 0) {
+					u8Str.push_back(u8Ch[1]);
+				}
 
-			if (u8Ch[2] != 0) {
-				u8Str.push_back(u8Ch[2]);
-			}
-			if (u8Ch[3] != 0) {
-				u8Str.push_back(u8Ch[3]);
+				if (u8Ch[2] != 0) {
+					u8Str.push_back(u8Ch[2]);
+				}
+				if (u8Ch[3] != 0) {
+					u8Str.push_back(u8Ch[3]);
+				}
 			}
 		}
 		return true;
@@ -8,6 +8,7 @@
 
 #include <Saba/Base/UnicodeUtil.h>
 #include <Saba/Base/File.h>
+#include <Saba/Base/BinaryReader.h>
 
 #include "SjisToUnicode.h"
 
@@ -61,13 +62,18 @@ namespace saba
 		return file.Read(str->m_buffer, Size);
 	}
 
+	template <size_t Size>
+	bool Read(MMDFileString<Size>* str, BinaryReader& file)
+	{
+		return file.Read(str->m_buffer, Size);
+	}
+
 	template<size_t Size>
 	inline std::string MMDFileString<Size>::ToUtf8String() const
 	{
-		std::u16string u16Str = saba::ConvertSjisToU16String(m_buffer);
-		std::string u8Str;
-		saba::ConvU16ToU8(u16Str, u8Str);
-		return u8Str;
+		char u8Buffer[Size * SjisToU8MaxBytesPerByte];
+		size_t u8Length = ConvertSjisToU8(m_buffer, Size, u8Buffer);
+		return std::string(u8Buffer, u8Length);
 	}
 }
 
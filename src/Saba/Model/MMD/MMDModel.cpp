@@ -5,21 +5,49 @@
 
 #include "MMDModel.h"
 #include "MMDPhysics.h"
+#include "MMDPhysicsThread.h"
 #include "VPDFile.h"
 #include "VMDAnimation.h"
 
 #include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
 
 #include <Saba/Base/Log.h>
 
 namespace saba
 {
+	namespace
+	{
+		glm::mat4 BlendTransform(const glm::mat4& m0, const glm::mat4& m1, float w)
+		{
+			glm::quat q = glm::slerp(glm::quat_cast(glm::mat3(m0)), glm::quat_cast(glm::mat3(m1)), w);
+			glm::vec3 t = glm::mix(glm::vec3(m0[3]), glm::vec3(m1[3]), w);
+			glm::mat4 m = glm::mat4_cast(q);
+			m[3] = glm::vec4(t, 1);
+			return m;
+		}
+
+		glm::mat4 CalcNodeLocalTransform(const MMDNode* node)
+		{
+			auto parent = node->GetParent();
+			if (parent != nullptr)
+			{
+				return glm::inverse(parent->GetGlobalTransform()) * node->GetGlobalTransform();
+			}
+			return node->GetGlobalTransform();
+		}
+	}
+
 	MMDPhysicsManager::MMDPhysicsManager()
+		: m_ownerID(0)
+		, m_lodBaseFPS(0)
 	{
 	}
 
 	MMDPhysicsManager::~MMDPhysicsManager()
 	{
+		m_physicsThread.reset();
+
 		for (auto& joint : m_joints)
 		{
 			m_mmdPhysics->RemoveJoint(joint.get());
@@ -37,8 +65,22 @@ namespace saba
 
 	bool MMDPhysicsManager::Create()
 	{
-		m_mmdPhysics = std::make_unique<MMDPhysics>();
-		return m_mmdPhysics->Create();
+		return Create(m_createParams);
+	}
+
+	bool MMDPhysicsManager::Create(const MMDPhysicsCreateParams& params)
+	{
+		m_createParams = params;
+		if (m_sharedPhysics != nullptr)
+		{
+			m_mmdPhysics = m_sharedPhysics;
+			m_ownerID = m_mmdPhysics->AllocateOwnerID();
+			return true;
+		}
+
+		m_mmdPhysics = std::make_shared<MMDPhysics>();
+		m_ownerID = 0;
+		return m_mmdPhysics->Create(params);
 	}
 
 	MMDPhysics* MMDPhysicsManager::GetMMDPhysics()
@@ -46,10 +88,284 @@ namespace saba
 		return m_mmdPhysics.get();
 	}
 
+	bool MMDPhysicsManager::EnableAsyncPhysics(bool enable)
+	{
+		if (!enable)
+		{
+			if (m_physicsThread != nullptr)
+			{
+				m_physicsThread.reset();
+				for (auto& rb : m_rigidBodys)
+				{
+					rb->SetBufferedKinematic(false);
+				}
+			}
+			return true;
+		}
+
+		if (m_physicsThread != nullptr)
+		{
+			return true;
+		}
+		if (m_mmdPhysics == nullptr)
+		{
+			SABA_WARN("Async Physics : Physics is not created.");
+			return false;
+		}
+		if (IsSharedPhysics())
+		{
+			SABA_WARN("Async Physics : Shared physics world is not supported.");
+			return false;
+		}
+
+		for (auto& rb : m_rigidBodys)
+		{
+			rb->SetBufferedKinematic(true);
+		}
+		auto physicsThread = std::make_unique<MMDPhysicsThread>();
+		if (!physicsThread->Start(m_mmdPhysics.get()))
+		{
+			for (auto& rb : m_rigidBodys)
+			{
+				rb->SetBufferedKinematic(false);
+			}
+			return false;
+		}
+		m_physicsThread = std::move(physicsThread);
+
+		return true;
+	}
+
+	void MMDPhysicsManager::CaptureAsyncPhysics()
+	{
+		if (m_physicsThread == nullptr)
+		{
+			return;
+		}
+		// 更新中のスレッドが読んでいない側のバッファに書き込む
+		for (auto& rb : m_rigidBodys)
+		{
+			rb->CaptureKinematicTransform();
+		}
+	}
+
+	void MMDPhysicsManager::KickAsyncPhysics(float elapsed)
+	{
+		if (m_physicsThread == nullptr)
+		{
+			return;
+		}
+		m_physicsThread->Wait();
+		m_asyncPhysicsStats = GetMMDPhysics()->GetStats();
+		for (auto& rb : m_rigidBodys)
+		{
+			rb->SwapKinematicTransform();
+		}
+		m_physicsThread->Kick(elapsed);
+	}
+
+	void MMDPhysicsManager::WaitAsyncPhysics()
+	{
+		if (m_physicsThread != nullptr)
+		{
+			m_physicsThread->Wait();
+		}
+	}
+
+	MMDPhysicsStats MMDPhysicsManager::GetPhysicsStats()
+	{
+		if (m_physicsThread != nullptr)
+		{
+			return m_asyncPhysicsStats;
+		}
+		auto physics = GetMMDPhysics();
+		return physics != nullptr ? physics->GetStats() : MMDPhysicsStats();
+	}
+
+	void MMDPhysicsManager::ResetAsyncPhysics()
+	{
+		if (m_physicsThread == nullptr)
+		{
+			return;
+		}
+		m_physicsThread->Wait();
+		for (auto& rb : m_rigidBodys)
+		{
+			rb->SetBufferedKinematic(true);
+		}
+	}
+
+	void MMDPhysicsManager::SetLOD(const MMDPhysicsLOD& lod)
+	{
+		if (m_mmdPhysics == nullptr)
+		{
+			return;
+		}
+		WaitAsyncPhysics();
+
+		m_lod = lod;
+
+		// 更新レート (共有された Physics World は変更しない)
+		if (!IsSharedPhysics())
+		{
+			if (m_lodBaseFPS == 0)
+			{
+				m_lodBaseFPS = m_mmdPhysics->GetFPS();
+			}
+			m_mmdPhysics->SetFPS(m_lod.m_fps > 0 ? m_lod.m_fps : m_lodBaseFPS);
+		}
+
+		if (m_lodStates.size() != m_rigidBodys.size())
+		{
+			// ボーン追従の剛体を起点に、ジョイントで繋がった剛体の深さを求める
+			LODState initState;
+			initState.m_chainDepth = -1;
+			initState.m_kinematic = false;
+			initState.m_targetKinematic = false;
+			initState.m_blendFrame = 0;
+			m_lodStates.assign(m_rigidBodys.size(), initState);
+
+			std::vector<size_t> queue;
+			for (size_t i = 0; i < m_rigidBodys.size(); i++)
+			{
+				if (m_rigidBodys[i]->IsKinematic())
+				{
+					m_lodStates[i].m_chainDepth = 0;
+					queue.push_back(i);
+				}
+			}
+
+			auto findRigidBody = [this](const MMDRigidBody* rb)
+			{
+				for (size_t i = 0; i < m_rigidBodys.size(); i++)
+				{
+					if (m_rigidBodys[i].get() == rb)
+					{
+						return i;
+					}
+				}
+				return m_rigidBodys.size();
+			};
+			std::vector<std::pair<size_t, size_t>> links;
+			for (const auto& joint : m_joints)
+			{
+				size_t a = findRigidBody(joint->GetRigidBodyA());
+				size_t b = findRigidBody(joint->GetRigidBodyB());
+				if (a < m_rigidBodys.size() && b < m_rigidBodys.size())
+				{
+					links.emplace_back(a, b);
+				}
+			}
+
+			for (size_t qi = 0; qi < queue.size(); qi++)
+			{
+				const size_t i = queue[qi];
+				const int depth = m_lodStates[i].m_chainDepth + 1;
+				for (const auto& link : links)
+				{
+					size_t next = link.first == i ? link.second : (link.second == i ? link.first : m_rigidBodys.size());
+					if (next < m_rigidBodys.size() && m_lodStates[next].m_chainDepth < 0)
+					{
+						m_lodStates[next].m_chainDepth = depth;
+						queue.push_back(next);
+					}
+				}
+			}
+
+			// ボーン追従の剛体と繋がっていない剛体
+			for (auto& state : m_lodStates)
+			{
+				if (state.m_chainDepth < 0)
+				{
+					state.m_chainDepth = 1;
+				}
+			}
+		}
+
+		for (size_t i = 0; i < m_rigidBodys.size(); i++)
+		{
+			const auto& rb = m_rigidBodys[i];
+			auto& state = m_lodStates[i];
+			state.m_targetKinematic = false;
+			if (rb->IsKinematic())
+			{
+				continue;
+			}
+			if (m_lod.m_sleep ||
+				(m_lod.m_maxChainDepth >= 0 && state.m_chainDepth > m_lod.m_maxChainDepth) ||
+				(m_lod.m_kinematicGroupMask & (1 << rb->GetGroup())) != 0)
+			{
+				state.m_targetKinematic = true;
+			}
+		}
+	}
+
+	bool MMDPhysicsManager::IsLODKinematic(size_t rigidBodyIndex) const
+	{
+		if (rigidBodyIndex >= m_lodStates.size())
+		{
+			return false;
+		}
+		return m_lodStates[rigidBodyIndex].m_kinematic;
+	}
+
+	void MMDPhysicsManager::BeginLOD()
+	{
+		for (size_t i = 0; i < m_lodStates.size(); i++)
+		{
+			auto& state = m_lodStates[i];
+			if (state.m_kinematic == state.m_targetKinematic)
+			{
+				continue;
+			}
+			state.m_kinematic = state.m_targetKinematic;
+			if (state.m_kinematic)
+			{
+				// 最後の Physics の姿勢からアニメーションの姿勢へブレンドする
+				state.m_blendFrame = std::max(m_lod.m_blendFrameCount, 0);
+			}
+			else
+			{
+				// ボーン追従の間に更新されていない剛体をアニメーションの姿勢から再開する
+				// (ResetToNode で動的なモーションステートもノードの姿勢に合わせる)
+				state.m_blendFrame = 0;
+				m_rigidBodys[i]->ResetToNode(m_mmdPhysics.get());
+			}
+		}
+	}
+
+	void MMDPhysicsManager::EndLOD()
+	{
+		for (size_t i = 0; i < m_lodStates.size(); i++)
+		{
+			auto& state = m_lodStates[i];
+			auto node = m_rigidBodys[i]->GetNode();
+			if (node == nullptr || m_rigidBodys[i]->IsKinematic())
+			{
+				continue;
+			}
+
+			if (!state.m_kinematic)
+			{
+				state.m_physicsLocal = CalcNodeLocalTransform(node);
+			}
+			else if (state.m_blendFrame > 0)
+			{
+				const float w = float(state.m_blendFrame) / float(m_lod.m_blendFrameCount + 1);
+				glm::mat4 local = BlendTransform(CalcNodeLocalTransform(node), state.m_physicsLocal, w);
+				auto parent = node->GetParent();
+				node->SetGlobalTransform(parent != nullptr ? parent->GetGlobalTransform() * local : local);
+				node->UpdateChildTransform();
+				state.m_blendFrame--;
+			}
+		}
+	}
+
 	MMDRigidBody* MMDPhysicsManager::AddRigidBody()
 	{
 		SABA_ASSERT(m_mmdPhysics != nullptr);
 		auto rigidBody = std::make_unique<MMDRigidBody>();
+		rigidBody->SetOwnerID(m_ownerID);
 		auto ret = rigidBody.get();
 		m_rigidBodys.emplace_back(std::move(rigidBody));
 
@@ -169,6 +485,62 @@ namespace saba
 		UpdateNodeAnimation(true);
 	}
 
+	void MMDModel::BeginPhysicsAnimation()
+	{
+		auto physicsMan = GetPhysicsManager();
+		if (physicsMan->GetMMDPhysics() == nullptr)
+		{
+			return;
+		}
+
+		physicsMan->BeginLOD();
+
+		auto rigidbodys = physicsMan->GetRigidBodys();
+		for (size_t i = 0; i < rigidbodys->size(); i++)
+		{
+			(*rigidbodys)[i]->SetActivation(!physicsMan->IsLODKinematic(i));
+		}
+	}
+
+	void MMDModel::EndPhysicsAnimation()
+	{
+		auto physicsMan = GetPhysicsManager();
+		if (physicsMan->GetMMDPhysics() == nullptr)
+		{
+			return;
+		}
+
+		auto rigidbodys = physicsMan->GetRigidBodys();
+		for (size_t i = 0; i < rigidbodys->size(); i++)
+		{
+			// LOD でボーン追従にした剛体は、動的な剛体として最後に計算した姿勢を保持しているため反映しない
+			// (ノードはアニメーションの姿勢に従い、EndLOD で Physics の姿勢からブレンドする)
+			if (physicsMan->IsLODKinematic(i))
+			{
+				continue;
+			}
+			(*rigidbodys)[i]->ReflectGlobalTransform();
+		}
+
+		physicsMan->EndLOD();
+
+		for (auto& rb : (*rigidbodys))
+		{
+			rb->CalcLocalTransform();
+		}
+
+		auto nodeMan = GetNodeManager();
+		const size_t nodeCount = nodeMan->GetNodeCount();
+		for (size_t i = 0; i < nodeCount; i++)
+		{
+			auto node = nodeMan->GetMMDNode(i);
+			if (node->GetParent() == nullptr)
+			{
+				node->UpdateGlobalTransform();
+			}
+		}
+	}
+
 	void MMDModel::LoadPose(const VPDFile & vpd, int frameCount)
 	{
 		struct Pose
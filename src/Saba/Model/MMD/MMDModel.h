@@ -9,6 +9,7 @@
 #include "MMDNode.h"
 #include "MMDIkSolver.h"
 #include "MMDMorph.h"
+#include "MMDPhysics.h"
 
 #include <vector>
 #include <string>
@@ -86,6 +87,27 @@ namespace saba
 		}
 	};
 
+	class MMDPhysicsThread;
+
+	// Physics LOD (背景のモデルなど、精度が不要な場合に Physics を軽くする)
+	struct MMDPhysicsLOD
+	{
+		MMDPhysicsLOD()
+			: m_fps(0)
+			, m_maxChainDepth(-1)
+			, m_kinematicGroupMask(0)
+			, m_sleep(false)
+			, m_blendFrameCount(10)
+		{
+		}
+
+		float		m_fps;					// Physics の更新レート (0 : 変更しない)
+		int			m_maxChainDepth;		// ボーン追従の剛体からジョイントで辿った深さがこれを超える剛体をボーン追従にする (-1 : 無効)
+		uint16_t	m_kinematicGroupMask;	// ボーン追従にする剛体のグループ (1 << group)
+		bool		m_sleep;				// 全ての剛体をボーン追従にし、Physics を止める (画面外や遠方のモデル用)
+		int			m_blendFrameCount;		// ボーン追従に切り替える際、Physics の姿勢からブレンドするフレーム数
+	};
+
 	class MMDPhysicsManager
 	{
 	public:
@@ -96,9 +118,46 @@ namespace saba
 		~MMDPhysicsManager();
 
 		bool Create();
+		bool Create(const MMDPhysicsCreateParams& params);
+
+		// モデル読み込み前に設定すると、Create() で使用される
+		void SetCreateParams(const MMDPhysicsCreateParams& params) { m_createParams = params; }
+		const MMDPhysicsCreateParams& GetCreateParams() const { return m_createParams; }
+
+		// モデル読み込み前に設定すると、Create() で新しい Physics World を作らず、
+		// 指定した Physics World に剛体とジョイントを登録する。
+		// 共有された Physics World の更新 (MMDPhysics::Update) は呼び出し側で行う
+		void SetSharedPhysics(std::shared_ptr<MMDPhysics> physics) { m_sharedPhysics = std::move(physics); }
+		bool IsSharedPhysics() const { return m_sharedPhysics != nullptr; }
 
 		MMDPhysics* GetMMDPhysics();
 
+		// モデル読み込み後に有効にすると、Physics World の更新を専用スレッドで行う。
+		// 描画スレッドは前回の更新結果を反映するため、Physics は 1 ステップ遅れる。
+		// (共有された Physics World では使用できない)
+		bool EnableAsyncPhysics(bool enable);
+		bool IsAsyncPhysics() const { return m_physicsThread != nullptr; }
+		// Kinematic 剛体の姿勢を取得する (UpdateNodeAnimation(false) の後に呼ぶ)
+		void CaptureAsyncPhysics();
+		// 取得した姿勢で次の更新を開始する
+		void KickAsyncPhysics(float elapsed);
+		// 更新の完了を待つ。Physics World に触れる前に呼ぶ
+		void WaitAsyncPhysics();
+		// 更新の完了を待ち、Kinematic 剛体の姿勢を現在のノードから取り直す
+		void ResetAsyncPhysics();
+		// Physics の統計を取得する (非同期の場合は更新を待たず、前回の更新の完了時点のものを返す)
+		MMDPhysicsStats GetPhysicsStats();
+
+		// モデル読み込み後に設定する。
+		// ボーン追従に切り替えた剛体は、VMDAnimation::SyncPhysics と同様に数フレームかけてアニメーションの姿勢へブレンドする
+		void SetLOD(const MMDPhysicsLOD& lod);
+		const MMDPhysicsLOD& GetLOD() const { return m_lod; }
+		bool IsLODKinematic(size_t rigidBodyIndex) const;
+		bool IsLODSleeping() const { return m_lod.m_sleep && !m_lodStates.empty(); }
+		// BeginPhysicsAnimation と EndPhysicsAnimation から呼ばれる
+		void BeginLOD();
+		void EndLOD();
+
 		MMDRigidBody* AddRigidBody();
 		std::vector<RigidBodyPtr>* GetRigidBodys() { return &m_rigidBodys; }
 
@@ -107,10 +166,27 @@ namespace saba
 
 
 	private:
-		std::unique_ptr<MMDPhysics>	m_mmdPhysics;
+		std::shared_ptr<MMDPhysics>	m_mmdPhysics;
+		std::shared_ptr<MMDPhysics>	m_sharedPhysics;
+		MMDPhysicsCreateParams		m_createParams;
+		uint32_t					m_ownerID;
+		std::unique_ptr<MMDPhysicsThread>	m_physicsThread;
+		MMDPhysicsStats						m_asyncPhysicsStats;
 
 		std::vector<RigidBodyPtr>	m_rigidBodys;
 		std::vector<JointPtr>		m_joints;
+
+		struct LODState
+		{
+			int			m_chainDepth;
+			bool		m_kinematic;
+			bool		m_targetKinematic;
+			int			m_blendFrame;
+			glm::mat4	m_physicsLocal;	// 最後に Physics で求めたノードのローカル姿勢
+		};
+		MMDPhysicsLOD			m_lod;
+		std::vector<LODState>	m_lodStates;
+		float					m_lodBaseFPS;
 	};
 
 	struct MMDSubMesh
@@ -163,6 +239,8 @@ namespace saba
 		virtual void EndAnimation() = 0;
 		// Morph
 		virtual void UpdateMorphAnimation() = 0;
+		// ボーンモーフのみ反映する (頂点、UV、材質モーフは更新しない)
+		virtual void UpdateBoneMorphAnimation() = 0;
 		// ノードを更新する
 		[[deprecated("Please use UpdateAllAnimation() function")]]
 		void UpdateAnimation();
@@ -172,6 +250,11 @@ namespace saba
 		[[deprecated("Please use UpdateAllAnimation() function")]]
 		void UpdatePhysics(float elapsed);
 		virtual void UpdatePhysicsAnimation(float elapsed) = 0;
+		// UpdatePhysicsAnimation を MMDPhysics::Update の前後で分割したもの
+		// (Physics World を共有する場合、全モデルの BeginPhysicsAnimation の後に
+		// MMDPhysics::Update を一度呼び、各モデルの EndPhysicsAnimation を呼ぶ)
+		void BeginPhysicsAnimation();
+		void EndPhysicsAnimation();
 		// 頂点を更新する
 		virtual void Update() = 0;
 		virtual void SetParallelUpdateHint(uint32_t parallelCount) = 0;
@@ -11,9 +11,24 @@
 
 #include <glm/gtc/matrix_transform.hpp>
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <tuple>
+
 #include <btBulletCollisionCommon.h>
 #include <btBulletDynamicsCommon.h>
 
+#if BT_THREADSAFE
+#include <LinearMath/btThreads.h>
+#include <BulletCollision/CollisionDispatch/btCollisionDispatcherMt.h>
+#include <BulletDynamics/Dynamics/btDiscreteDynamicsWorldMt.h>
+#include <BulletDynamics/ConstraintSolver/btSequentialImpulseConstraintSolverMt.h>
+#include <thread>
+#endif // BT_THREADSAFE
+
 namespace saba
 {
 	class MMDMotionState : public btMotionState
@@ -21,6 +36,11 @@ namespace saba
 	public:
 		virtual void Reset() = 0;
 		virtual void ReflectGlobalTransform() = 0;
+
+		// 非同期 Physics 用 (Kinematic のみ)
+		virtual void SetBuffered(bool buffered) {}
+		virtual void CaptureTransform() {}
+		virtual void SwapTransform() {}
 	};
 
 	namespace
@@ -30,6 +50,87 @@ namespace saba
 			const glm::mat4 invZ = glm::scale(glm::mat4(1), glm::vec3(1, 1, -1));
 			return invZ * m * invZ;
 		}
+
+		// 同じ形状の btCollisionShape を共有する
+		enum class SharedShapeType
+		{
+			Sphere,
+			Box,
+			Capsule,
+		};
+
+		std::shared_ptr<btCollisionShape> GetSharedShape(SharedShapeType type, float x, float y = 0, float z = 0)
+		{
+			using Key = std::tuple<SharedShapeType, float, float, float>;
+			static std::mutex shapeMutex;
+			static std::map<Key, std::weak_ptr<btCollisionShape>> shapes;
+
+			std::lock_guard<std::mutex> lock(shapeMutex);
+			auto& sharedShape = shapes[Key(type, x, y, z)];
+			auto shape = sharedShape.lock();
+			if (shape != nullptr)
+			{
+				return shape;
+			}
+
+			// make_shared は BT_DECLARE_ALIGNED_ALLOCATOR を経由しないため、new で作成する
+			switch (type)
+			{
+			case SharedShapeType::Sphere:
+				shape = std::shared_ptr<btCollisionShape>(new btSphereShape(x));
+				break;
+			case SharedShapeType::Box:
+				shape = std::shared_ptr<btCollisionShape>(new btBoxShape(btVector3(x, y, z)));
+				break;
+			case SharedShapeType::Capsule:
+				shape = std::shared_ptr<btCollisionShape>(new btCapsuleShape(x, y));
+				break;
+			}
+			sharedShape = shape;
+
+			// 破棄された形状を取り除く
+			for (auto it = shapes.begin(); it != shapes.end();)
+			{
+				if (it->second.expired())
+				{
+					it = shapes.erase(it);
+				}
+				else
+				{
+					++it;
+				}
+			}
+
+			return shape;
+		}
+
+#if BT_THREADSAFE
+		int SetupTaskScheduler(int threadCount)
+		{
+			// タスクスケジューラはプロセスで共有される
+			if (btGetTaskScheduler() == nullptr)
+			{
+				btITaskScheduler* scheduler = btCreateDefaultTaskScheduler();
+				if (scheduler == nullptr)
+				{
+					return 0;
+				}
+				btSetTaskScheduler(scheduler);
+			}
+
+			auto scheduler = btGetTaskScheduler();
+			if (threadCount <= 0)
+			{
+				threadCount = int(std::thread::hardware_concurrency());
+			}
+			threadCount = std::max(1, std::min(threadCount, scheduler->getMaxNumThreads()));
+			if (scheduler->getNumThreads() < threadCount)
+			{
+				scheduler->setNumThreads(threadCount);
+			}
+			return scheduler->getNumThreads();
+		}
+#endif // BT_THREADSAFE
 	}
 
 	struct MMDFilterCallback : public btOverlapFilterCallback
@@ -45,17 +146,32 @@ namespace saba
 			{
 				return true;
 			}
+
+			// 異なるモデルの剛体 (Physics World を共有する場合)
+			auto rb0 = static_cast<const MMDRigidBody*>(static_cast<btCollisionObject*>(proxy0->m_clientObject)->getUserPointer());
+			auto rb1 = static_cast<const MMDRigidBody*>(static_cast<btCollisionObject*>(proxy1->m_clientObject)->getUserPointer());
+			if (rb0 != nullptr && rb1 != nullptr && rb0->GetOwnerID() != rb1->GetOwnerID())
+			{
+				return m_interModelCollision;
+			}
+
 			bool collides = (proxy0->m_collisionFilterGroup & proxy1->m_collisionFilterMask) != 0;
 			collides = collides && (proxy1->m_collisionFilterGroup & proxy0->m_collisionFilterMask);
 			return collides;
 		}
 
 		std::vector<btBroadphaseProxy*> m_nonFilterProxy;
+		bool	m_interModelCollision = true;
 	};
 
 	MMDPhysics::MMDPhysics()
 		: m_fps(120.0f)
 		, m_maxSubStepCount(10)
+		, m_localTime(0)
+		, m_budgetFPS(120.0f)
+		, m_budgetRaiseCount(0)
+		, m_backend(MMDPhysicsBackend::Default)
+		, m_nextOwnerID(1)
 	{
 	}
 
@@ -64,20 +180,66 @@ namespace saba
 		Destroy();
 	}
 
-	bool MMDPhysics::Create()
+	bool MMDPhysics::Create(const MMDPhysicsCreateParams& params)
 	{
+		m_backend = params.m_backend;
+#if BT_THREADSAFE
+		int threadCount = 0;
+		if (m_backend == MMDPhysicsBackend::Multithread)
+		{
+			threadCount = SetupTaskScheduler(params.m_threadCount);
+			if (threadCount == 0)
+			{
+				SABA_WARN("Failed to create Bullet task scheduler. Use default physics backend.");
+				m_backend = MMDPhysicsBackend::Default;
+			}
+		}
+#else // BT_THREADSAFE
+		if (m_backend == MMDPhysicsBackend::Multithread)
+		{
+			SABA_WARN("Bullet is not built with BT_THREADSAFE. Use default physics backend.");
+			m_backend = MMDPhysicsBackend::Default;
+		}
+#endif // BT_THREADSAFE
+
 		m_broadphase = std::make_unique<btDbvtBroadphase>();
-		m_collisionConfig = std::make_unique<btDefaultCollisionConfiguration>();
-		m_dispatcher = std::make_unique<btCollisionDispatcher>(m_collisionConfig.get());
 
-		m_solver = std::make_unique<btSequentialImpulseConstraintSolver>();
+#if BT_THREADSAFE
+		if (m_backend == MMDPhysicsBackend::Multithread)
+		{
+			btDefaultCollisionConstructionInfo cci;
+			cci.m_defaultMaxPersistentManifoldPoolSize = 80000;
+			cci.m_defaultMaxCollisionAlgorithmPoolSize = 80000;
+			m_collisionConfig = std::make_unique<btDefaultCollisionConfiguration>(cci);
+			m_dispatcher = std::make_unique<btCollisionDispatcherMt>(m_collisionConfig.get(), 40);
 
-		m_world = std::make_unique<btDiscreteDynamicsWorld>(
-			m_dispatcher.get(),
-			m_broadphase.get(),
-			m_solver.get(),
-			m_collisionConfig.get()
-			);
+			auto solverPool = std::make_unique<btConstraintSolverPoolMt>(threadCount);
+			m_solver = std::make_unique<btSequentialImpulseConstraintSolverMt>();
+
+			m_world = std::make_unique<btDiscreteDynamicsWorldMt>(
+				m_dispatcher.get(),
+				m_broadphase.get(),
+				solverPool.get(),
+				m_solver.get(),
+				m_collisionConfig.get()
+				);
+			m_solverPool = std::move(solverPool);
+		}
+		else
+#endif // BT_THREADSAFE
+		{
+			m_collisionConfig = std::make_unique<btDefaultCollisionConfiguration>();
+			m_dispatcher = std::make_unique<btCollisionDispatcher>(m_collisionConfig.get());
+
+			m_solver = std::make_unique<btSequentialImpulseConstraintSolver>();
+
+			m_world = std::make_unique<btDiscreteDynamicsWorld>(
+				m_dispatcher.get(),
+				m_broadphase.get(),
+				m_solver.get(),
+				m_collisionConfig.get()
+				);
+		}
 
 		m_world->setGravity(btVector3(0, -9.8f * 10.0f, 0));
 
@@ -113,14 +275,38 @@ namespace saba
 		m_dispatcher = nullptr;
 		m_solver = nullptr;
 		m_world = nullptr;
+		m_solverPool = nullptr;
 		m_groundShape = nullptr;
 		m_groundMS = nullptr;
 		m_groundRB = nullptr;
 	}
 
+	uint32_t MMDPhysics::AllocateOwnerID()
+	{
+		return m_nextOwnerID++;
+	}
+
+	void MMDPhysics::EnableInterModelCollision(bool enable)
+	{
+		if (m_filterCB != nullptr)
+		{
+			static_cast<MMDFilterCallback*>(m_filterCB.get())->m_interModelCollision = enable;
+		}
+	}
+
+	bool MMDPhysics::IsEnabledInterModelCollision() const
+	{
+		if (m_filterCB != nullptr)
+		{
+			return static_cast<MMDFilterCallback*>(m_filterCB.get())->m_interModelCollision;
+		}
+		return false;
+	}
+
 	void MMDPhysics::SetFPS(float fps)
 	{
 		m_fps = fps;
+		m_budgetFPS = fps;
 	}
 
 	float MMDPhysics::GetFPS() const
@@ -141,12 +327,214 @@ namespace saba
 
 	void MMDPhysics::Update(float time)
 	{
+		if (m_world == nullptr)
+		{
+			return;
+		}
+
+		double fps = m_fps;
+		int maxSubStepCount = m_maxSubStepCount;
+		if (m_timeBudget.m_enable)
+		{
+			fps = m_budgetFPS;
+			if (m_stats.m_stepCost > 0)
+			{
+				int budgetStepCount = int(m_timeBudget.m_budget / m_stats.m_stepCost);
+				maxSubStepCount = std::max(std::min(budgetStepCount, m_maxSubStepCount), 1);
+			}
+		}
+		const double fixedTimeStep = 1.0 / fps;
+
+		// Bullet と同じ方法で実行されるステップ数を求め、捨てられる時間を記録する
+		int stepCount = time > 0 ? 1 : 0;
+		if (maxSubStepCount > 0)
+		{
+			m_localTime += time;
+			stepCount = int(m_localTime / fixedTimeStep);
+			m_localTime -= stepCount * fixedTimeStep;
+			if (stepCount > maxSubStepCount)
+			{
+				m_stats.m_clampedCount++;
+				m_stats.m_droppedTime += (stepCount - maxSubStepCount) * fixedTimeStep;
+				stepCount = maxSubStepCount;
+			}
+		}
+
+		auto beginTime = std::chrono::steady_clock::now();
+		m_world->stepSimulation(time, maxSubStepCount, static_cast<btScalar>(fixedTimeStep));
+		auto endTime = std::chrono::steady_clock::now();
+
+		if (stepCount > 0)
+		{
+			double cost = std::chrono::duration<double>(endTime - beginTime).count() / stepCount;
+			if (m_stats.m_stepCost == 0)
+			{
+				m_stats.m_stepCost = cost;
+			}
+			else
+			{
+				m_stats.m_stepCost += (cost - m_stats.m_stepCost) * 0.1;
+			}
+		}
+		m_stats.m_updateCount++;
+		m_stats.m_stepCount += stepCount;
+		m_stats.m_currentFPS = float(fps);
+		m_stats.m_currentMaxSubStepCount = maxSubStepCount;
+
+		if (!m_timeBudget.m_enable || time <= 0)
+		{
+			return;
+		}
+
+		// 次回の更新レートを決める (上げる場合は余裕がしばらく続いてから)
+		const double minFPS = std::min(double(m_timeBudget.m_minFPS), m_fps);
+		const double expectedCost = time * fps * m_stats.m_stepCost;
+		if (expectedCost > m_timeBudget.m_budget)
+		{
+			m_budgetFPS = std::max(fps * 0.8, minFPS);
+			m_budgetRaiseCount = 0;
+		}
+		else if (fps < m_fps && expectedCost * 1.25 < m_timeBudget.m_budget * 0.5)
+		{
+			m_budgetRaiseCount++;
+			if (m_budgetRaiseCount >= 30)
+			{
+				m_budgetFPS = std::min(fps * 1.25, m_fps);
+				m_budgetRaiseCount = 0;
+			}
+		}
+		else
+		{
+			m_budgetRaiseCount = 0;
+		}
+	}
+
+	void MMDPhysics::SetTimeBudget(const MMDPhysicsTimeBudget& budget)
+	{
+		m_timeBudget = budget;
+		m_budgetFPS = m_fps;
+		m_budgetRaiseCount = 0;
+	}
+
+	void MMDPhysics::ResetStats()
+	{
+		m_stats = MMDPhysicsStats();
+	}
+
+	void MMDPhysics::GetMaxVelocity(float* linearVelocity, float* angularVelocity) const
+	{
+		btScalar maxLinear2 = 0;
+		btScalar maxAngular2 = 0;
 		if (m_world != nullptr)
 		{
-			m_world->stepSimulation(time, m_maxSubStepCount, static_cast<btScalar>(1.0 / m_fps));
+			const int numObjects = m_world->getNumCollisionObjects();
+			for (int i = 0; i < numObjects; i++)
+			{
+				auto rb = btRigidBody::upcast(m_world->getCollisionObjectArray()[i]);
+				if (rb == nullptr || rb->isStaticOrKinematicObject())
+				{
+					continue;
+				}
+				maxLinear2 = std::max(maxLinear2, rb->getLinearVelocity().length2());
+				maxAngular2 = std::max(maxAngular2, rb->getAngularVelocity().length2());
+			}
+		}
+
+		if (linearVelocity != nullptr)
+		{
+			*linearVelocity = std::sqrt(maxLinear2);
+		}
+		if (angularVelocity != nullptr)
+		{
+			*angularVelocity = std::sqrt(maxAngular2);
 		}
 	}
 
+	void MMDPhysics::SaveSnapshot(MMDPhysicsSnapshot* snapshot) const
+	{
+		snapshot->m_rigidBodyStates.clear();
+		if (m_world == nullptr)
+		{
+			return;
+		}
+
+		const int numObjects = m_world->getNumCollisionObjects();
+		snapshot->m_rigidBodyStates.reserve(numObjects);
+		for (int i = 0; i < numObjects; i++)
+		{
+			auto rb = btRigidBody::upcast(m_world->getCollisionObjectArray()[i]);
+			if (rb == nullptr || rb == m_groundRB.get())
+			{
+				continue;
+			}
+
+			MMDPhysicsSnapshot::RigidBodyState state;
+			rb->getCenterOfMassTransform().getOpenGLMatrix(&state.m_transform[0][0]);
+			const auto& lv = rb->getLinearVelocity();
+			const auto& av = rb->getAngularVelocity();
+			state.m_linearVelocity = glm::vec3(lv.x(), lv.y(), lv.z());
+			state.m_angularVelocity = glm::vec3(av.x(), av.y(), av.z());
+			snapshot->m_rigidBodyStates.push_back(state);
+		}
+	}
+
+	bool MMDPhysics::RestoreSnapshot(const MMDPhysicsSnapshot& snapshot)
+	{
+		if (m_world == nullptr)
+		{
+			return false;
+		}
+
+		std::vector<btRigidBody*> rigidBodys;
+		const int numObjects = m_world->getNumCollisionObjects();
+		rigidBodys.reserve(numObjects);
+		for (int i = 0; i < numObjects; i++)
+		{
+			auto rb = btRigidBody::upcast(m_world->getCollisionObjectArray()[i]);
+			if (rb != nullptr && rb != m_groundRB.get())
+			{
+				rigidBodys.push_back(rb);
+			}
+		}
+		if (rigidBodys.size() != snapshot.m_rigidBodyStates.size())
+		{
+			SABA_WARN("Physics snapshot mismatch. [{} != {}]", rigidBodys.size(), snapshot.m_rigidBodyStates.size());
+			return false;
+		}
+
+		auto cache = m_world->getPairCache();
+		for (size_t i = 0; i < rigidBodys.size(); i++)
+		{
+			auto rb = rigidBodys[i];
+			const auto& state = snapshot.m_rigidBodyStates[i];
+
+			btTransform transform;
+			transform.setFromOpenGLMatrix(&state.m_transform[0][0]);
+			btVector3 lv(state.m_linearVelocity.x, state.m_linearVelocity.y, state.m_linearVelocity.z);
+			btVector3 av(state.m_angularVelocity.x, state.m_angularVelocity.y, state.m_angularVelocity.z);
+
+			rb->setCenterOfMassTransform(transform);
+			rb->setInterpolationWorldTransform(transform);
+			rb->setLinearVelocity(lv);
+			rb->setAngularVelocity(av);
+			rb->setInterpolationLinearVelocity(lv);
+			rb->setInterpolationAngularVelocity(av);
+			rb->clearForces();
+			if (!rb->isKinematicObject() && rb->getMotionState() != nullptr)
+			{
+				rb->getMotionState()->setWorldTransform(transform);
+			}
+
+			// 古い接触情報を破棄する
+			if (cache != nullptr)
+			{
+				cache->cleanProxyFromPairs(rb->getBroadphaseHandle(), m_dispatcher.get());
+			}
+		}
+
+		return true;
+	}
+
 	void MMDPhysics::AddRigidBody(MMDRigidBody * mmdRB)
 	{
 		m_world->addRigidBody(
@@ -328,22 +716,20 @@ namespace saba
 		KinematicMotionState(MMDNode* node, const glm::mat4& offset)
 			: m_node(node)
 			, m_offset(offset)
+			, m_buffered(false)
+			, m_readIndex(0)
 		{
 		}
 
 		void getWorldTransform(btTransform& worldTransform) const override
 		{
-			glm::mat4 m;
-			if (m_node != nullptr)
+			if (m_buffered)
 			{
-				m = m_node->GetGlobalTransform() * m_offset;
+				// Physics スレッドからはノードを参照せず、取得済みの姿勢を使う
+				worldTransform = m_buffer[m_readIndex];
+				return;
 			}
-			else
-			{
-				m = m_offset;
-			}
-			m = InvZ(m);
-			worldTransform.setFromOpenGLMatrix(&m[0][0]);
+			CalcWorldTransform(worldTransform);
 		}
 
 		void setWorldTransform(const btTransform& worldTransform) override
@@ -358,9 +744,50 @@ namespace saba
 		{
 		}
 
+		void SetBuffered(bool buffered) override
+		{
+			m_buffered = buffered;
+			if (m_buffered)
+			{
+				CalcWorldTransform(m_buffer[0]);
+				m_buffer[1] = m_buffer[0];
+			}
+		}
+
+		void CaptureTransform() override
+		{
+			CalcWorldTransform(m_buffer[1 - m_readIndex]);
+		}
+
+		void SwapTransform() override
+		{
+			m_readIndex = 1 - m_readIndex;
+		}
+
+	private:
+		void CalcWorldTransform(btTransform& worldTransform) const
+		{
+			glm::mat4 m;
+			if (m_node != nullptr)
+			{
+				m = m_node->GetGlobalTransform() * m_offset;
+			}
+			else
+			{
+				m = m_offset;
+			}
+			m = InvZ(m);
+			worldTransform.setFromOpenGLMatrix(&m[0][0]);
+		}
+
 	private:
 		MMDNode*	m_node;
 		glm::mat4	m_offset;
+
+		// 描画スレッドが書き込む側と Physics スレッドが読み込む側のダブルバッファ
+		bool		m_buffered;
+		int			m_readIndex;
+		btTransform	m_buffer[2];
 	};
 
 	MMDRigidBody::MMDRigidBody()
@@ -369,6 +796,7 @@ namespace saba
 		, m_groupMask(0)
 		, m_node(0)
 		, m_offsetMat(1)
+		, m_ownerID(0)
 	{
 	}
 
@@ -383,17 +811,19 @@ namespace saba
 		switch (pmdRigidBody.m_shapeType)
 		{
 		case PMDRigidBodyShape::Sphere:
-			m_shape = std::make_unique<btSphereShape>(pmdRigidBody.m_shapeWidth);
+			m_shape = GetSharedShape(SharedShapeType::Sphere, pmdRigidBody.m_shapeWidth);
 			break;
 		case PMDRigidBodyShape::Box:
-			m_shape = std::make_unique<btBoxShape>(btVector3(
+			m_shape = GetSharedShape(
+				SharedShapeType::Box,
 				pmdRigidBody.m_shapeWidth,
 				pmdRigidBody.m_shapeHeight,
 				pmdRigidBody.m_shapeDepth
-			));
+			);
 			break;
 		case PMDRigidBodyShape::Capsule:
-			m_shape = std::make_unique<btCapsuleShape>(
+			m_shape = GetSharedShape(
+				SharedShapeType::Capsule,
 				pmdRigidBody.m_shapeWidth,
 				pmdRigidBody.m_shapeHeight
 				);
@@ -509,17 +939,19 @@ namespace saba
 		switch (pmxRigidBody.m_shape)
 		{
 		case PMXRigidbody::Shape::Sphere:
-			m_shape = std::make_unique<btSphereShape>(pmxRigidBody.m_shapeSize.x);
+			m_shape = GetSharedShape(SharedShapeType::Sphere, pmxRigidBody.m_shapeSize.x);
 			break;
 		case PMXRigidbody::Shape::Box:
-			m_shape = std::make_unique<btBoxShape>(btVector3(
+			m_shape = GetSharedShape(
+				SharedShapeType::Box,
 				pmxRigidBody.m_shapeSize.x,
 				pmxRigidBody.m_shapeSize.y,
 				pmxRigidBody.m_shapeSize.z
-			));
+			);
 			break;
 		case PMXRigidbody::Shape::Capsule:
-			m_shape = std::make_unique<btCapsuleShape>(
+			m_shape = GetSharedShape(
+				SharedShapeType::Capsule,
 				pmxRigidBody.m_shapeSize.x,
 				pmxRigidBody.m_shapeSize.y
 				);
@@ -640,6 +1072,26 @@ namespace saba
 		return m_groupMask;
 	}
 
+	MMDNode* MMDRigidBody::GetNode() const
+	{
+		return m_node;
+	}
+
+	void MMDRigidBody::SetOwnerID(uint32_t ownerID)
+	{
+		m_ownerID = ownerID;
+	}
+
+	uint32_t MMDRigidBody::GetOwnerID() const
+	{
+		return m_ownerID;
+	}
+
+	bool MMDRigidBody::IsKinematic() const
+	{
+		return m_rigidBodyType == RigidBodyType::Kinematic;
+	}
+
 	void MMDRigidBody::SetActivation(bool activation)
 	{
 		if (m_rigidBodyType != RigidBodyType::Kinematic)
@@ -682,6 +1134,51 @@ namespace saba
 		m_rigidBody->clearForces();
 	}
 
+	void MMDRigidBody::ResetToNode(MMDPhysics* physics)
+	{
+		glm::mat4 m;
+		if (m_node != nullptr)
+		{
+			m = m_node->GetGlobalTransform() * m_offsetMat;
+		}
+		else
+		{
+			m = m_offsetMat;
+		}
+		m = InvZ(m);
+		btTransform transform;
+		transform.setFromOpenGLMatrix(&m[0][0]);
+		m_rigidBody->setWorldTransform(transform);
+		m_rigidBody->setInterpolationWorldTransform(transform);
+
+		ResetTransform();
+		Reset(physics);
+	}
+
+	void MMDRigidBody::SetBufferedKinematic(bool buffered)
+	{
+		if (m_kinematicMotionState != nullptr)
+		{
+			m_kinematicMotionState->SetBuffered(buffered);
+		}
+	}
+
+	void MMDRigidBody::CaptureKinematicTransform()
+	{
+		if (m_kinematicMotionState != nullptr)
+		{
+			m_kinematicMotionState->CaptureTransform();
+		}
+	}
+
+	void MMDRigidBody::SwapKinematicTransform()
+	{
+		if (m_kinematicMotionState != nullptr)
+		{
+			m_kinematicMotionState->SwapTransform();
+		}
+	}
+
 	void MMDRigidBody::ReflectGlobalTransform()
 	{
 		if (m_activeMotionState != nullptr)
@@ -724,6 +1221,8 @@ namespace saba
 	// MMDJoint
 	//*******************
 	MMDJoint::MMDJoint()
+		: m_rigidBodyA(nullptr)
+		, m_rigidBodyB(nullptr)
 	{
 	}
 
@@ -812,6 +1311,8 @@ namespace saba
 		}
 
 		m_constraint = std::move(constraint);
+		m_rigidBodyA = rigidBodyA;
+		m_rigidBodyB = rigidBodyB;
 
 		return true;
 	}
@@ -897,6 +1398,8 @@ namespace saba
 		}
 
 		m_constraint = std::move(constraint);
+		m_rigidBodyA = rigidBodyA;
+		m_rigidBodyB = rigidBodyB;
 
 		return true;
 	}
@@ -904,6 +1407,8 @@ namespace saba
 	void MMDJoint::Destroy()
 	{
 		m_constraint = nullptr;
+		m_rigidBodyA = nullptr;
+		m_rigidBodyB = nullptr;
 	}
 
 	btTypedConstraint * MMDJoint::GetConstraint() const
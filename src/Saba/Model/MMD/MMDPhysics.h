@@ -25,6 +25,7 @@ class btBroadphaseInterface;
 class btDefaultCollisionConfiguration;
 class btCollisionDispatcher;
 class btSequentialImpulseConstraintSolver;
+class btConstraintSolver;
 class btMotionState;
 struct btOverlapFilterCallback;
 
@@ -51,10 +52,24 @@ namespace saba
 		btRigidBody* GetRigidBody() const;
 		uint16_t GetGroup() const;
 		uint16_t GetGroupMask() const;
+		MMDNode* GetNode() const;
+		bool IsKinematic() const;
+		// Physics World を共有する場合、モデル毎に異なる ID を設定する
+		void SetOwnerID(uint32_t ownerID);
+		uint32_t GetOwnerID() const;
 
 		void SetActivation(bool activation);
 		void ResetTransform();
 		void Reset(MMDPhysics* physics);
+		// 剛体をノードの姿勢に移動し、速度をリセットする
+		void ResetToNode(MMDPhysics* physics);
+
+		// 非同期 Physics 用 : Kinematic 剛体の姿勢をダブルバッファ化する
+		// CaptureKinematicTransform は描画スレッドで書き込み側に姿勢を取得し、
+		// SwapKinematicTransform は Physics の更新が止まっている間に呼ぶ
+		void SetBufferedKinematic(bool buffered);
+		void CaptureKinematicTransform();
+		void SwapKinematicTransform();
 
 		void ReflectGlobalTransform();
 		void CalcLocalTransform();
@@ -70,7 +85,7 @@ namespace saba
 		};
 
 	private:
-		std::unique_ptr<btCollisionShape>	m_shape;
+		std::shared_ptr<btCollisionShape>	m_shape;	// 同じ形状の剛体で共有する
 		std::unique_ptr<MMDMotionState>		m_activeMotionState;
 		std::unique_ptr<MMDMotionState>		m_kinematicMotionState;
 		std::unique_ptr<btRigidBody>		m_rigidBody;
@@ -81,6 +96,7 @@ namespace saba
 
 		MMDNode*	m_node;
 		glm::mat4	m_offsetMat;
+		uint32_t	m_ownerID;
 
 		std::string					m_name;
 	};
@@ -98,9 +114,81 @@ namespace saba
 		void Destroy();
 
 		btTypedConstraint* GetConstraint() const;
+		MMDRigidBody* GetRigidBodyA() const { return m_rigidBodyA; }
+		MMDRigidBody* GetRigidBodyB() const { return m_rigidBodyB; }
 
 	private:
 		std::unique_ptr<btTypedConstraint>	m_constraint;
+		MMDRigidBody*						m_rigidBodyA;
+		MMDRigidBody*						m_rigidBodyB;
+	};
+
+	enum class MMDPhysicsBackend
+	{
+		Default,		// btDiscreteDynamicsWorld
+		Multithread,	// btDiscreteDynamicsWorldMt (Bullet が BT_THREADSAFE でビルドされている必要がある)
+	};
+
+	struct MMDPhysicsCreateParams
+	{
+		MMDPhysicsCreateParams()
+			: m_backend(MMDPhysicsBackend::Default)
+			, m_threadCount(0)
+		{
+		}
+
+		MMDPhysicsBackend	m_backend;
+		int					m_threadCount;	// 0 : ハードウェアのスレッド数
+	};
+
+	// 1 フレームあたりの処理時間の上限から、内部の更新レートとサブステップ数を調整する
+	struct MMDPhysicsTimeBudget
+	{
+		MMDPhysicsTimeBudget()
+			: m_enable(false)
+			, m_budget(0.004f)
+			, m_minFPS(30.0f)
+		{
+		}
+
+		bool	m_enable;
+		float	m_budget;	// 秒
+		float	m_minFPS;	// 更新レートの下限 (上限は SetFPS の値)
+	};
+
+	struct MMDPhysicsStats
+	{
+		MMDPhysicsStats()
+			: m_updateCount(0)
+			, m_stepCount(0)
+			, m_clampedCount(0)
+			, m_droppedTime(0)
+			, m_stepCost(0)
+			, m_currentFPS(0)
+			, m_currentMaxSubStepCount(0)
+		{
+		}
+
+		uint32_t	m_updateCount;
+		uint32_t	m_stepCount;
+		uint32_t	m_clampedCount;				// サブステップ数が上限に達した回数
+		double		m_droppedTime;				// 上限を超えたため捨てた時間 (秒)
+		double		m_stepCost;					// 1 ステップの平均処理時間 (秒)
+		float		m_currentFPS;
+		int			m_currentMaxSubStepCount;
+	};
+
+	// 剛体の状態 (位置、速度) を保存する
+	struct MMDPhysicsSnapshot
+	{
+		struct RigidBodyState
+		{
+			glm::mat4	m_transform;
+			glm::vec3	m_linearVelocity;
+			glm::vec3	m_angularVelocity;
+		};
+
+		std::vector<RigidBodyState>	m_rigidBodyStates;
 	};
 
 	class MMDPhysics
@@ -112,15 +200,37 @@ namespace saba
 		MMDPhysics(const MMDPhysics& rhs) = delete;
 		MMDPhysics& operator = (const MMDPhysics& rhs) = delete;
 
-		bool Create();
+		bool Create(const MMDPhysicsCreateParams& params = MMDPhysicsCreateParams());
 		void Destroy();
 
+		MMDPhysicsBackend GetBackend() const { return m_backend; }
+
+		// 複数モデルで共有する場合に使用する
+		uint32_t AllocateOwnerID();
+		void EnableInterModelCollision(bool enable);
+		bool IsEnabledInterModelCollision() const;
+
 		void SetFPS(float fps);
 		float GetFPS() const;
 		void SetMaxSubStepCount(int numSteps);
 		int GetMaxSubStepCount() const;
 		void Update(float time);
 
+		// 有効にすると、処理時間が上限に収まるよう更新レート (m_minFPS - FPS) と
+		// サブステップ数 (1 - MaxSubStepCount) を下げる。
+		// 端数の時間は Bullet がモーションステートを補間する
+		void SetTimeBudget(const MMDPhysicsTimeBudget& budget);
+		const MMDPhysicsTimeBudget& GetTimeBudget() const { return m_timeBudget; }
+		const MMDPhysicsStats& GetStats() const { return m_stats; }
+		void ResetStats();
+
+		// 動的な剛体の最大速度を取得する (Physics の収束判定用)
+		void GetMaxVelocity(float* linearVelocity, float* angularVelocity) const;
+
+		// スナップショット (剛体の追加、削除を行うと無効になる)
+		void SaveSnapshot(MMDPhysicsSnapshot* snapshot) const;
+		bool RestoreSnapshot(const MMDPhysicsSnapshot& snapshot);
+
 		void AddRigidBody(MMDRigidBody* mmdRB);
 		void RemoveRigidBody(MMDRigidBody* mmdRB);
 		void AddJoint(MMDJoint* mmdJoint);
@@ -133,6 +243,7 @@ namespace saba
 		std::unique_ptr<btDefaultCollisionConfiguration>	m_collisionConfig;
 		std::unique_ptr<btCollisionDispatcher>				m_dispatcher;
 		std::unique_ptr<btSequentialImpulseConstraintSolver>	m_solver;
+		std::unique_ptr<btConstraintSolver>					m_solverPool;	// btConstraintSolverPoolMt
 		std::unique_ptr<btDiscreteDynamicsWorld>			m_world;
 		std::unique_ptr<btCollisionShape>					m_groundShape;
 		std::unique_ptr<btMotionState>						m_groundMS;
@@ -141,6 +252,14 @@ namespace saba
 
 		double	m_fps;
 		int		m_maxSubStepCount;
+		double	m_localTime;	// ステップに満たない端数の時間
+
+		MMDPhysicsTimeBudget	m_timeBudget;
+		double					m_budgetFPS;
+		int						m_budgetRaiseCount;
+		MMDPhysicsStats			m_stats;
+		MMDPhysicsBackend	m_backend;
+		uint32_t			m_nextOwnerID;
 	};
 
 }
@@ -0,0 +1,310 @@
+﻿//
+// Copyright(c) 2016-2017 benikabocha.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+//
+
+#include "MMDPhysicsCache.h"
+#include "MMDModel.h"
+#include "MMDPhysics.h"
+#include "VMDAnimation.h"
+
+#include <Saba/Base/File.h>
+#include <Saba/Base/Log.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace saba
+{
+	namespace
+	{
+		const char		PhysicsCacheMagic[8] = { 'S', 'a', 'b', 'a', 'P', 'h', 'y', 's' };
+		const uint32_t	PhysicsCacheVersion = 1;
+	}
+
+	MMDPhysicsCache::MMDPhysicsCache()
+		: m_model(nullptr)
+		, m_modelHash(0)
+		, m_motionHash(0)
+	{
+	}
+
+	bool MMDPhysicsCache::Create(MMDModel* model, uint64_t modelHash, uint64_t motionHash)
+	{
+		Destroy();
+
+		if (model == nullptr)
+		{
+			return false;
+		}
+
+		SetupRigidBodys(model);
+		m_modelHash = modelHash;
+		m_motionHash = motionHash;
+
+		return true;
+	}
+
+	void MMDPhysicsCache::Destroy()
+	{
+		m_model = nullptr;
+		m_rigidBodys.clear();
+		m_frames.clear();
+		m_modelHash = 0;
+		m_motionHash = 0;
+	}
+
+	void MMDPhysicsCache::Bake(VMDAnimation* vmdAnim, int32_t endFrame)
+	{
+		if (m_model == nullptr || vmdAnim == nullptr)
+		{
+			return;
+		}
+
+		// LOD でボーン追従やスリープになった剛体を記録しないよう、LOD を無効にして計算する
+		auto physicsMan = m_model->GetPhysicsManager();
+		const MMDPhysicsLOD lod = physicsMan->GetLOD();
+		physicsMan->SetLOD(MMDPhysicsLOD());
+
+		m_model->InitializeAnimation();
+		vmdAnim->SyncPhysics(0.0f);
+
+		for (int32_t frame = 0; frame <= endFrame; frame++)
+		{
+			m_model->BeginAnimation();
+			m_model->UpdateAllAnimation(vmdAnim, float(frame), 1.0f / 30.0f);
+			m_model->EndAnimation();
+
+			Record(frame);
+		}
+
+		physicsMan->SetLOD(lod);
+	}
+
+	void MMDPhysicsCache::Record(int32_t frame)
+	{
+		if (m_model == nullptr || frame < 0)
+		{
+			return;
+		}
+
+		if (size_t(frame) >= m_frames.size())
+		{
+			m_frames.resize(size_t(frame) + 1);
+		}
+
+		Frame& transforms = m_frames[frame];
+		transforms.resize(m_rigidBodys.size());
+		for (size_t i = 0; i < m_rigidBodys.size(); i++)
+		{
+			const glm::mat4& global = m_rigidBodys[i]->GetNode()->GetGlobalTransform();
+			transforms[i].m_translate = glm::vec3(global[3]);
+			transforms[i].m_rotate = glm::quat_cast(glm::mat3(global));
+		}
+	}
+
+	bool MMDPhysicsCache::IsRecorded(int32_t frame) const
+	{
+		if (frame < 0 || size_t(frame) >= m_frames.size())
+		{
+			return false;
+		}
+		return !m_frames[frame].empty() || m_rigidBodys.empty();
+	}
+
+	bool MMDPhysicsCache::Apply(float t)
+	{
+		if (m_model == nullptr || t < 0)
+		{
+			return false;
+		}
+
+		const int32_t frame0 = int32_t(t);
+		if (!IsRecorded(frame0))
+		{
+			return false;
+		}
+		const int32_t frame1 = IsRecorded(frame0 + 1) ? frame0 + 1 : frame0;
+
+		ReflectGlobalTransform(m_frames[frame0], m_frames[frame1], t - float(frame0));
+
+		return true;
+	}
+
+	bool MMDPhysicsCache::Save(const char* filename) const
+	{
+		File file;
+		if (!file.Create(filename))
+		{
+			SABA_WARN("Failed to create physics cache. [{}]", filename);
+			return false;
+		}
+
+		uint64_t modelHash = m_modelHash;
+		uint64_t motionHash = m_motionHash;
+		uint32_t version = PhysicsCacheVersion;
+		uint32_t rigidBodyCount = uint32_t(m_rigidBodys.size());
+		uint32_t frameCount = uint32_t(m_frames.size());
+		file.Write(PhysicsCacheMagic, sizeof(PhysicsCacheMagic));
+		file.Write(&version);
+		file.Write(&modelHash);
+		file.Write(&motionHash);
+		file.Write(&rigidBodyCount);
+		file.Write(&frameCount);
+
+		for (const auto& frame : m_frames)
+		{
+			uint8_t recorded = frame.empty() ? 0 : 1;
+			file.Write(&recorded);
+			if (!frame.empty())
+			{
+				file.Write(frame.data(), frame.size());
+			}
+		}
+
+		if (file.IsBad())
+		{
+			SABA_WARN("Failed to write physics cache. [{}]", filename);
+			return false;
+		}
+
+		return true;
+	}
+
+	bool MMDPhysicsCache::Load(const char* filename, MMDModel* model, uint64_t modelHash, uint64_t motionHash)
+	{
+		if (!Create(model, modelHash, motionHash))
+		{
+			return false;
+		}
+
+		File file;
+		if (!file.Open(filename))
+		{
+			return false;
+		}
+
+		char magic[8];
+		uint32_t version = 0;
+		uint64_t fileModelHash = 0;
+		uint64_t fileMotionHash = 0;
+		uint32_t rigidBodyCount = 0;
+		uint32_t frameCount = 0;
+		file.Read(magic, sizeof(magic));
+		file.Read(&version);
+		file.Read(&fileModelHash);
+		file.Read(&fileMotionHash);
+		file.Read(&rigidBodyCount);
+		file.Read(&frameCount);
+		if (file.IsBad() ||
+			std::memcmp(magic, PhysicsCacheMagic, sizeof(magic)) != 0 ||
+			version != PhysicsCacheVersion)
+		{
+			SABA_WARN("Invalid physics cache. [{}]", filename);
+			return false;
+		}
+
+		if (fileModelHash != modelHash ||
+			fileMotionHash != motionHash ||
+			rigidBodyCount != m_rigidBodys.size())
+		{
+			SABA_INFO("Physics cache is out of date. [{}]", filename);
+			return false;
+		}
+
+		const File::Offset frameSize = File::Offset(sizeof(Transform) * rigidBodyCount);
+		if (file.GetSize() - file.Tell() < File::Offset(frameCount))
+		{
+			SABA_WARN("Invalid physics cache. [{}]", filename);
+			return false;
+		}
+
+		m_frames.resize(frameCount);
+		bool truncated = false;
+		for (auto& frame : m_frames)
+		{
+			uint8_t recorded = 0;
+			if (!file.Read(&recorded))
+			{
+				break;
+			}
+			if (recorded != 0)
+			{
+				if (file.GetSize() - file.Tell() < frameSize)
+				{
+					truncated = true;
+					break;
+				}
+				frame.resize(rigidBodyCount);
+				if (!file.Read(frame.data(), frame.size()))
+				{
+					break;
+				}
+			}
+		}
+
+		if (truncated || file.IsBad())
+		{
+			SABA_WARN("Failed to read physics cache. [{}]", filename);
+			m_frames.clear();
+			return false;
+		}
+
+		return true;
+	}
+
+	void MMDPhysicsCache::SetupRigidBodys(MMDModel* model)
+	{
+		m_model = model;
+		m_rigidBodys.clear();
+
+		auto physicsMan = model->GetPhysicsManager();
+		if (physicsMan == nullptr)
+		{
+			return;
+		}
+
+		// Physics でノードを動かす剛体のみ記録する
+		for (const auto& rb : (*physicsMan->GetRigidBodys()))
+		{
+			if (!rb->IsKinematic() && rb->GetNode() != nullptr)
+			{
+				m_rigidBodys.push_back(rb.get());
+			}
+		}
+	}
+
+	void MMDPhysicsCache::ReflectGlobalTransform(const Frame& frame0, const Frame& frame1, float t)
+	{
+		// MMDRigidBody::ReflectGlobalTransform と同じ順序で反映する
+		for (size_t i = 0; i < m_rigidBodys.size(); i++)
+		{
+			const Transform& tr0 = frame0[i];
+			const Transform& tr1 = frame1[i];
+
+			glm::mat4 global = glm::mat4_cast(glm::slerp(tr0.m_rotate, tr1.m_rotate, t));
+			global[3] = glm::vec4(glm::mix(tr0.m_translate, tr1.m_translate, t), 1);
+
+			MMDNode* node = m_rigidBodys[i]->GetNode();
+			node->SetGlobalTransform(global);
+			node->UpdateChildTransform();
+		}
+
+		for (auto rb : m_rigidBodys)
+		{
+			rb->CalcLocalTransform();
+		}
+
+		auto nodeMan = m_model->GetNodeManager();
+		const size_t nodeCount = nodeMan->GetNodeCount();
+		for (size_t i = 0; i < nodeCount; i++)
+		{
+			auto node = nodeMan->GetMMDNode(i);
+			if (node->GetParent() == nullptr)
+			{
+				node->UpdateGlobalTransform();
+			}
+		}
+	}
+}
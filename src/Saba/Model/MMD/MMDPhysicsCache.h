@@ -0,0 +1,77 @@
+﻿//
+// Copyright(c) 2016-2017 benikabocha.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+//
+
+#ifndef SABA_MODEL_MMD_MMDPHYSICSCACHE_H_
+#define SABA_MODEL_MMD_MMDPHYSICSCACHE_H_
+
+#include <glm/vec3.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+namespace saba
+{
+	class MMDModel;
+	class MMDRigidBody;
+	class VMDAnimation;
+
+	/*
+	Physics の結果 (剛体が反映したノードの Transform) をフレーム毎に保存する。
+	モデルとモーションが同じであれば、Physics を計算する代わりに
+	キャッシュを反映できる。
+	*/
+	class MMDPhysicsCache
+	{
+	public:
+		MMDPhysicsCache();
+
+		bool Create(MMDModel* model, uint64_t modelHash, uint64_t motionHash);
+		void Destroy();
+
+		// フレーム 0 から endFrame まで Physics を計算して記録する (計算中は Physics の LOD を無効にする)
+		void Bake(VMDAnimation* vmdAnim, int32_t endFrame);
+		// UpdatePhysicsAnimation の後に呼び出し、結果を記録する
+		void Record(int32_t frame);
+		bool IsRecorded(int32_t frame) const;
+		int32_t GetFrameCount() const { return int32_t(m_frames.size()); }
+
+		// UpdatePhysicsAnimation の代わりに呼び出す
+		// 記録されていないフレームの場合は false を返す。
+		// その場合 Physics World はキャッシュを反映する前の状態のままなので、
+		// UpdatePhysicsAnimation に戻る前に ResetPhysics などで剛体を現在の姿勢に合わせる
+		bool Apply(float t);
+
+		bool Save(const char* filename) const;
+		bool Save(const std::string& filename) const { return Save(filename.c_str()); }
+		// ハッシュが一致しない場合は false を返す
+		bool Load(const char* filename, MMDModel* model, uint64_t modelHash, uint64_t motionHash);
+		bool Load(const std::string& filename, MMDModel* model, uint64_t modelHash, uint64_t motionHash)
+		{
+			return Load(filename.c_str(), model, modelHash, motionHash);
+		}
+
+	private:
+		struct Transform
+		{
+			glm::vec3	m_translate;
+			glm::quat	m_rotate;
+		};
+		using Frame = std::vector<Transform>;
+
+		void SetupRigidBodys(MMDModel* model);
+		void ReflectGlobalTransform(const Frame& frame0, const Frame& frame1, float t);
+
+	private:
+		MMDModel*					m_model;
+		std::vector<MMDRigidBody*>	m_rigidBodys;
+		std::vector<Frame>			m_frames;	// 空のフレームは未記録
+		uint64_t					m_modelHash;
+		uint64_t					m_motionHash;
+	};
+}
+
+#endif // !SABA_MODEL_MMD_MMDPHYSICSCACHE_H_
@@ -0,0 +1,99 @@
+﻿//
+// Copyright(c) 2016-2017 benikabocha.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+//
+
+#include "MMDPhysicsThread.h"
+#include "MMDPhysics.h"
+
+#include <Saba/Base/Log.h>
+
+namespace saba
+{
+	MMDPhysicsThread::MMDPhysicsThread()
+		: m_physics(nullptr)
+		, m_busy(false)
+		, m_exit(false)
+		, m_elapsed(0)
+	{
+	}
+
+	MMDPhysicsThread::~MMDPhysicsThread()
+	{
+		Stop();
+	}
+
+	bool MMDPhysicsThread::Start(MMDPhysics* physics)
+	{
+		Stop();
+
+		if (physics == nullptr)
+		{
+			SABA_WARN("MMDPhysicsThread : Physics is null.");
+			return false;
+		}
+
+		m_physics = physics;
+		m_busy = false;
+		m_exit = false;
+		m_thread = std::thread([this]() { Run(); });
+
+		return true;
+	}
+
+	void MMDPhysicsThread::Stop()
+	{
+		if (!m_thread.joinable())
+		{
+			return;
+		}
+
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_exit = true;
+		}
+		m_cv.notify_all();
+		m_thread.join();
+
+		m_physics = nullptr;
+		m_busy = false;
+	}
+
+	void MMDPhysicsThread::Kick(float elapsed)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_cv.wait(lock, [this]() { return !m_busy; });
+			m_elapsed = elapsed;
+			m_busy = true;
+		}
+		m_cv.notify_all();
+	}
+
+	void MMDPhysicsThread::Wait()
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_cv.wait(lock, [this]() { return !m_busy; });
+	}
+
+	void MMDPhysicsThread::Run()
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		while (true)
+		{
+			m_cv.wait(lock, [this]() { return m_busy || m_exit; });
+			if (m_exit)
+			{
+				break;
+			}
+
+			float elapsed = m_elapsed;
+			lock.unlock();
+			m_physics->Update(elapsed);
+			lock.lock();
+
+			m_busy = false;
+			m_cv.notify_all();
+		}
+	}
+}
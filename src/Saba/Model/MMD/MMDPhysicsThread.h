@@ -0,0 +1,57 @@
+﻿//
+// Copyright(c) 2016-2017 benikabocha.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+//
+
+#ifndef SABA_MODEL_MMD_MMDPHYSICSTHREAD_H_
+#define SABA_MODEL_MMD_MMDPHYSICSTHREAD_H_
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace saba
+{
+	class MMDPhysics;
+
+	/*
+	MMDPhysics::Update を専用スレッドで実行する。
+	Kick で更新を開始し、Wait で完了を待つ。
+	更新中は Physics World とモーションステートに触れてはいけない。
+
+	ステップ間の補間は Bullet の stepSimulation に任せる。
+	固定ステップで進めた後、余った時間の分だけ速度で外挿した姿勢をモーションステートに渡すため、
+	Kick に渡した経過時間ちょうどの姿勢が得られる。
+	描画側で前の 2 回の結果を補間すると、遅延がさらに 1 フレーム増えるだけになる。
+	*/
+	class MMDPhysicsThread
+	{
+	public:
+		MMDPhysicsThread();
+		~MMDPhysicsThread();
+
+		MMDPhysicsThread(const MMDPhysicsThread&) = delete;
+		MMDPhysicsThread& operator = (const MMDPhysicsThread&) = delete;
+
+		bool Start(MMDPhysics* physics);
+		void Stop();
+		bool IsStarted() const { return m_thread.joinable(); }
+
+		void Kick(float elapsed);
+		void Wait();
+
+	private:
+		void Run();
+
+	private:
+		MMDPhysics*				m_physics;
+		std::thread				m_thread;
+		std::mutex				m_mutex;
+		std::condition_variable	m_cv;
+		bool					m_busy;
+		bool					m_exit;
+		float					m_elapsed;
+	};
+}
+
+#endif // !SABA_MODEL_MMD_MMDPHYSICSTHREAD_H_
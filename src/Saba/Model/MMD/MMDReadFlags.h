@@ -0,0 +1,31 @@
+﻿//
+// Copyright(c) 2016-2017 benikabocha.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+//
+
+#ifndef SABA_MODEL_MMD_MMDREADFLAGS_H_
+#define SABA_MODEL_MMD_MMDREADFLAGS_H_
+
+#include <cstdint>
+
+namespace saba
+{
+	/*
+	PMX, PMD ファイルから読み込むセクション
+	指定されていないセクションは読み飛ばし、空のままにする
+	*/
+	struct MMDReadFlags
+	{
+		enum : uint32_t
+		{
+			Mesh = 0x01,			//!< 頂点、面、テクスチャ、材質
+			Bone = 0x02,			//!< ボーン、IK
+			Morph = 0x04,			//!< モーフ
+			DisplayFrame = 0x08,	//!< 表示枠
+			Physics = 0x10,			//!< 剛体、ジョイント、ソフトボディ
+			All = 0xFFFFFFFF,
+		};
+	};
+}
+
+#endif // !SABA_MODEL_MMD_MMDREADFLAGS_H_
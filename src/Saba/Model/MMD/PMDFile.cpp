@@ -5,7 +5,7 @@
 
 #include "PMDFile.h"
 
-#include <Saba/Base/File.h>
+#include <Saba/Base/BinaryReader.h>
 #include <Saba/Base/Log.h>
 
 #include <sstream>
@@ -16,12 +16,12 @@ namespace saba
 	namespace
 	{
 		template <typename T>
-		bool Read(T* data, File& file)
+		bool Read(T* data, BinaryReader& file)
 		{
 			return file.Read(data);
 		}
 
-		bool ReadHeader(PMDFile* pmdFile, File& file)
+		bool ReadHeader(PMDFile* pmdFile, BinaryReader& file)
 		{
 			if (file.IsBad())
 			{
@@ -51,7 +51,7 @@ namespace saba
 			return !file.IsBad();
 		}
 
-		bool ReadVertex(PMDFile* pmdFile, File& file)
+		bool ReadVertex(PMDFile* pmdFile, BinaryReader& file)
 		{
 			if (file.IsBad())
 			{
@@ -80,7 +80,7 @@ namespace saba
 			return !file.IsBad();
 		}
 
-		bool ReadFace(PMDFile* pmdFile, File& file)
+		bool ReadFace(PMDFile* pmdFile, BinaryReader& file)
 		{
 			if (file.IsBad())
 			{
@@ -105,7 +105,7 @@ namespace saba
 			return !file.IsBad();
 		}
 
-		bool ReadMaterial(PMDFile* pmdFile, File& file)
+		bool ReadMaterial(PMDFile* pmdFile, BinaryReader& file)
 		{
 			if (file.IsBad())
 			{
@@ -136,7 +136,7 @@ namespace saba
 			return !file.IsBad();
 		}
 
-		bool ReadBone(PMDFile* pmdFile, File& file)
+		bool ReadBone(PMDFile* pmdFile, BinaryReader& file)
 		{
 			if (file.IsBad())
 			{
@@ -164,7 +164,7 @@ namespace saba
 			return !file.IsBad();
 		}
 
-		bool ReadIK(PMDFile* pmdFile, File& file)
+		bool ReadIK(PMDFile* pmdFile, BinaryReader& file)
 		{
 			if (file.IsBad())
 			{
@@ -197,7 +197,7 @@ namespace saba
 			return !file.IsBad();
 		}
 
-		bool ReadBlendShape(PMDFile* pmdFile, File& file)
+		bool ReadBlendShape(PMDFile* pmdFile, BinaryReader& file)
 		{
 			if (file.IsBad())
 			{
@@ -233,7 +233,7 @@ namespace saba
 			return !file.IsBad();
 		}
 
-		bool ReadBlendShapeDisplayList(PMDFile* pmdFile, File& file)
+		bool ReadBlendShapeDisplayList(PMDFile* pmdFile, BinaryReader& file)
 		{
 			if (file.IsBad())
 			{
@@ -255,7 +255,7 @@ namespace saba
 			return !file.IsBad();
 		}
 
-		bool ReadBoneDisplayList(PMDFile* pmdFile, File& file)
+		bool ReadBoneDisplayList(PMDFile* pmdFile, BinaryReader& file)
 		{
 			if (file.IsBad())
 			{
@@ -301,7 +301,136 @@ namespace saba
 			return !file.IsBad();
 		}
 
-		bool ReadExt(PMDFile* pmdFile, File& file)
+		/*
+		読み飛ばしたセクションの要素数 (英語名の拡張を読むために使用する)
+		*/
+		struct SkipCounts
+		{
+			size_t	m_boneCount = 0;
+			size_t	m_morphCount = 0;
+			size_t	m_boneDisplayListCount = 0;
+		};
+
+		bool Skip(size_t size, BinaryReader& file)
+		{
+			return file.Seek(BinaryReader::Offset(size), BinaryReader::SeekDir::Current);
+		}
+
+		bool SkipMesh(BinaryReader& file)
+		{
+			// Vertex : Position, Normal, UV, Bone[2], BoneWeight, Edge
+			const size_t vertexSize = sizeof(glm::vec3) * 2 + sizeof(glm::vec2) + sizeof(uint16_t) * 2 + sizeof(uint8_t) * 2;
+			// Material : Diffuse, Alpha, SpecularPower, Specular, Ambient, ToonIndex, EdgeFlag, FaceVertexCount, TextureName
+			const size_t materialSize = sizeof(glm::vec3) + sizeof(float) * 2 + sizeof(glm::vec3) * 2 +
+				sizeof(uint8_t) * 2 + sizeof(uint32_t) + 20;
+
+			uint32_t vertexCount = 0;
+			if (!Read(&vertexCount, file) || !Skip(vertexSize * vertexCount, file))
+			{
+				return false;
+			}
+
+			uint32_t faceCount = 0;
+			if (!Read(&faceCount, file) || !Skip(sizeof(uint16_t) * faceCount, file))
+			{
+				return false;
+			}
+
+			uint32_t materialCount = 0;
+			if (!Read(&materialCount, file) || !Skip(materialSize * materialCount, file))
+			{
+				return false;
+			}
+
+			return !file.IsBad();
+		}
+
+		bool SkipBone(BinaryReader& file, SkipCounts* counts)
+		{
+			// Bone : Name, Parent, Tail, Type, IKParent, Position
+			const size_t boneSize = 20 + sizeof(uint16_t) * 2 + sizeof(uint8_t) + sizeof(uint16_t) + sizeof(glm::vec3);
+
+			uint16_t boneCount = 0;
+			if (!Read(&boneCount, file) || !Skip(boneSize * boneCount, file))
+			{
+				return false;
+			}
+			counts->m_boneCount = boneCount;
+
+			uint16_t ikCount = 0;
+			if (!Read(&ikCount, file))
+			{
+				return false;
+			}
+			for (uint16_t i = 0; i < ikCount; i++)
+			{
+				// IKNode, IKTarget
+				uint8_t numChain = 0;
+				if (!Skip(sizeof(uint16_t) * 2, file) || !Read(&numChain, file))
+				{
+					return false;
+				}
+				// NumIteration, RotateLimit, Chains
+				if (!Skip(sizeof(uint16_t) + sizeof(float) + sizeof(uint16_t) * numChain, file))
+				{
+					return false;
+				}
+			}
+
+			return !file.IsBad();
+		}
+
+		bool SkipBlendShape(BinaryReader& file, SkipCounts* counts)
+		{
+			uint16_t blendShapeCount = 0;
+			if (!Read(&blendShapeCount, file))
+			{
+				return false;
+			}
+			counts->m_morphCount = blendShapeCount;
+
+			for (uint16_t i = 0; i < blendShapeCount; i++)
+			{
+				uint32_t vertexCount = 0;
+				if (!Skip(20, file) || !Read(&vertexCount, file))
+				{
+					return false;
+				}
+				// MorphType, Vertices
+				if (!Skip(sizeof(uint8_t) + (sizeof(uint32_t) + sizeof(glm::vec3)) * vertexCount, file))
+				{
+					return false;
+				}
+			}
+
+			return !file.IsBad();
+		}
+
+		bool SkipDisplayList(BinaryReader& file, SkipCounts* counts)
+		{
+			uint8_t morphDisplayCount = 0;
+			if (!Read(&morphDisplayCount, file) || !Skip(sizeof(uint16_t) * morphDisplayCount, file))
+			{
+				return false;
+			}
+
+			uint8_t displayListCount = 0;
+			if (!Read(&displayListCount, file) || !Skip(size_t(50) * displayListCount, file))
+			{
+				return false;
+			}
+			counts->m_boneDisplayListCount = displayListCount;
+
+			uint32_t displayCount = 0;
+			if (!Read(&displayCount, file) || !Skip((sizeof(uint16_t) + sizeof(uint8_t)) * displayCount, file))
+			{
+				return false;
+			}
+
+			return !file.IsBad();
+		}
+
+		bool ReadExt(PMDFile* pmdFile, const SkipCounts& counts, BinaryReader& file)
 		{
 			if (file.IsBad())
 			{
@@ -323,6 +452,7 @@ namespace saba
 				{
 					Read(&bone.m_englishBoneNameExt, file);
 				}
+				Skip(size_t(20) * counts.m_boneCount, file);
 
 				// BlendShape Name
 				/*
@@ -334,6 +464,10 @@ namespace saba
 					auto& morpsh = pmdFile->m_morphs[bsIdx];
 					Read(&morpsh.m_englishShapeNameExt, file);
 				}
+				if (counts.m_morphCount > 1)
+				{
+					Skip(size_t(20) * (counts.m_morphCount - 1), file);
+				}
 
 				// BoneDisplayNameLists
 				/*
@@ -345,12 +479,13 @@ namespace saba
 					auto& display = pmdFile->m_boneDisplayLists[displayIdx];
 					Read(&display.m_englishNameExt, file);
 				}
+				Skip(size_t(50) * counts.m_boneDisplayListCount, file);
 			}
 
 			return !file.IsBad();
 		}
 
-		bool ReadToonTextureName(PMDFile* pmdFile, File& file)
+		bool ReadToonTextureName(PMDFile* pmdFile, BinaryReader& file)
 		{
 			if (file.IsBad())
 			{
@@ -365,7 +500,7 @@ namespace saba
 			return !file.IsBad();
 		}
 
-		bool ReadRigidBodyExt(PMDFile* pmdFile, File& file)
+		bool ReadRigidBodyExt(PMDFile* pmdFile, BinaryReader& file)
 		{
 			if (file.IsBad())
 			{
@@ -402,7 +537,7 @@ namespace saba
 			return !file.IsBad();
 		}
 
-		bool ReadJointExt(PMDFile* pmdFile, File& file)
+		bool ReadJointExt(PMDFile* pmdFile, BinaryReader& file)
 		{
 			if (file.IsBad())
 			{
@@ -434,7 +569,7 @@ namespace saba
 			return !file.IsBad();
 		}
 
-		bool ReadPMDFile(PMDFile* pmdFile, File& file)
+		bool ReadPMDFile(PMDFile* pmdFile, BinaryReader& file, uint32_t readFlags)
 		{
 			if (!ReadHeader(pmdFile, file))
 			{
@@ -442,52 +577,100 @@ namespace saba
 				return false;
 			}
 
-			if (!ReadVertex(pmdFile, file))
+			// 不要なセクションは読み飛ばす
+			// 英語名、Toon テクスチャ名の拡張は表示枠の後にあるため、Physics 以外は最後まで進める
+			SkipCounts skipCounts;
+
+			if ((readFlags & MMDReadFlags::Mesh) != 0)
 			{
-				SABA_ERROR("ReadVertex Fail.");
-				return false;
-			}
+				if (!ReadVertex(pmdFile, file))
+				{
+					SABA_ERROR("ReadVertex Fail.");
+					return false;
+				}
 
-			if (!ReadFace(pmdFile, file))
+				if (!ReadFace(pmdFile, file))
+				{
+					SABA_ERROR("ReadFace Fail.");
+					return false;
+				}
+
+				if (!ReadMaterial(pmdFile, file))
+				{
+					SABA_ERROR("ReadMaterial Fail.");
+					return false;
+				}
+			}
+			else
 			{
-				SABA_ERROR("ReadFace Fail.");
-				return false;
+				if (!SkipMesh(file))
+				{
+					SABA_ERROR("SkipMesh Fail.");
+					return false;
+				}
 			}
 
-			if (!ReadMaterial(pmdFile, file))
+			if ((readFlags & MMDReadFlags::Bone) != 0)
 			{
-				SABA_ERROR("ReadMaterial Fail.");
-				return false;
-			}
+				if (!ReadBone(pmdFile, file))
+				{
+					SABA_ERROR("ReadBone Fail.");
+					return false;
+				}
 
-			if (!ReadBone(pmdFile, file))
+				if (!ReadIK(pmdFile, file))
+				{
+					SABA_ERROR("ReadIK Fail.");
+					return false;
+				}
+			}
+			else
 			{
-				SABA_ERROR("ReadBone Fail.");
-				return false;
+				if (!SkipBone(file, &skipCounts))
+				{
+					SABA_ERROR("SkipBone Fail.");
+					return false;
+				}
 			}
 
-			if (!ReadIK(pmdFile, file))
+			if ((readFlags & MMDReadFlags::Morph) != 0)
 			{
-				SABA_ERROR("ReadIK Fail.");
-				return false;
+				if (!ReadBlendShape(pmdFile, file))
+				{
+					SABA_ERROR("ReadBlendShape Fail.");
+					return false;
+				}
 			}
-
-			if (!ReadBlendShape(pmdFile, file))
+			else
 			{
-				SABA_ERROR("ReadBlendShape Fail.");
-				return false;
+				if (!SkipBlendShape(file, &skipCounts))
+				{
+					SABA_ERROR("SkipBlendShape Fail.");
+					return false;
+				}
 			}
 
-			if (!ReadBlendShapeDisplayList(pmdFile, file))
+			if ((readFlags & MMDReadFlags::DisplayFrame) != 0)
 			{
-				SABA_ERROR("ReadBlendShapeDisplayList Fail.");
-				return false;
-			}
+				if (!ReadBlendShapeDisplayList(pmdFile, file))
+				{
+					SABA_ERROR("ReadBlendShapeDisplayList Fail.");
+					return false;
+				}
 
-			if (!ReadBoneDisplayList(pmdFile, file))
+				if (!ReadBoneDisplayList(pmdFile, file))
+				{
+					SABA_ERROR("ReadBoneDisplayList Fail.");
+					return false;
+				}
+			}
+			else
 			{
-				SABA_ERROR("ReadBoneDisplayList Fail.");
-				return false;
+				if (!SkipDisplayList(file, &skipCounts))
+				{
+					SABA_ERROR("SkipDisplayList Fail.");
+					return false;
+				}
 			}
 
 			size_t toonTexIdx = 1;
@@ -502,7 +685,7 @@ namespace saba
 
 			if (file.Tell() < file.GetSize())
 			{
-				if (!ReadExt(pmdFile, file))
+				if (!ReadExt(pmdFile, skipCounts, file))
 				{
 					SABA_ERROR("ReadExt Fail.");
 					return false;
@@ -518,6 +701,11 @@ namespace saba
 				}
 			}
 
+			if ((readFlags & MMDReadFlags::Physics) == 0)
+			{
+				return true;
+			}
+
 			if (file.Tell() < file.GetSize())
 			{
 				if (!ReadRigidBodyExt(pmdFile, file))
@@ -540,18 +728,18 @@ namespace saba
 		}
 	}
 
-	bool ReadPMDFile(PMDFile* pmdFile, const char * filename)
+	bool ReadPMDFile(PMDFile* pmdFile, const char * filename, uint32_t readFlags)
 	{
 		SABA_INFO("PMD File Open. {}", filename);
 
-		File file;
+		BinaryReader file;
 		if (!file.Open(filename))
 		{
 			SABA_INFO("PMD File Open Fail. {}", filename);
 			return false;
 		}
 
-		if (!ReadPMDFile(pmdFile, file))
+		if (!ReadPMDFile(pmdFile, file, readFlags))
 		{
 			SABA_INFO("PMD File Read Fail. {}", filename);
 			return false;
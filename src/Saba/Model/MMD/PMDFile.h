@@ -7,6 +7,7 @@
 #define SABA_MODEL_MMD_PMDFILE_H_
 
 #include "MMDFileString.h"
+#include "MMDReadFlags.h"
 
 #include <cstdint>
 #include <glm/vec2.hpp>
@@ -191,7 +192,8 @@ namespace saba
 		std::vector<PMDJointExt>		m_joints;
 	};
 
-	bool ReadPMDFile(PMDFile* pmdFile, const char* filename);
+	// readFlags (MMDReadFlags) に含まれないセクションは読み飛ばす
+	bool ReadPMDFile(PMDFile* pmdFile, const char* filename, uint32_t readFlags = MMDReadFlags::All);
 
 }
 
@@ -103,6 +103,10 @@ namespace saba
 	{
 	}
 
+	void PMDModel::UpdateBoneMorphAnimation()
+	{
+	}
+
 	void PMDModel::UpdateNodeAnimation(bool afterPhysicsAnim)
 	{
 		if (afterPhysicsAnim)
@@ -139,6 +143,8 @@ namespace saba
 			return;
 		}
 
+		physicsMan->ResetAsyncPhysics();
+
 		auto rigidbodys = physicsMan->GetRigidBodys();
 		auto joints = physicsMan->GetJoints();
 		for (auto& rb : (*rigidbodys))
@@ -182,31 +188,27 @@ namespace saba
 			return;
 		}
 
-		auto rigidbodys = physicsMan->GetRigidBodys();
-		auto joints = physicsMan->GetJoints();
-		for (auto& rb : (*rigidbodys))
+		if (physicsMan->IsAsyncPhysics())
 		{
-			rb->SetActivation(true);
+			// 前回の更新結果を反映し、今回の姿勢で次の更新を開始する
+			physicsMan->CaptureAsyncPhysics();
+			physicsMan->WaitAsyncPhysics();
+			BeginPhysicsAnimation();
+			EndPhysicsAnimation();
+			physicsMan->KickAsyncPhysics(elapsed);
+			return;
 		}
 
-		physics->Update(elapsed);
+		BeginPhysicsAnimation();
 
-		for (auto& rb : (*rigidbodys))
-		{
-			rb->ReflectGlobalTransform();
-		}
-		for (auto& rb : (*rigidbodys))
+		// 共有された Physics World は呼び出し側で更新する
+		// (LOD で全ての剛体がボーン追従の場合は更新しない)
+		if (!physicsMan->IsSharedPhysics() && !physicsMan->IsLODSleeping())
 		{
-			rb->CalcLocalTransform();
+			physics->Update(elapsed);
 		}
 
-		for (auto& node : (*m_nodeMan.GetNodes()))
-		{
-			if (node->GetParent() == nullptr)
-			{
-				node->UpdateGlobalTransform();
-			}
-		}
+		EndPhysicsAnimation();
 	}
 
 	void PMDModel::Update()
@@ -298,12 +300,16 @@ namespace saba
 		}
 	}
 
-	bool PMDModel::Load(const std::string& filepath, const std::string& mmdDataDir)
+	bool PMDModel::Load(const std::string& filepath, const std::string& mmdDataDir, uint32_t readFlags)
 	{
 		Destroy();
 
+		// PMDModel では Mesh, Bone は常に必要で、表示枠は使用しない
+		readFlags |= MMDReadFlags::Mesh | MMDReadFlags::Bone;
+		readFlags &= ~uint32_t(MMDReadFlags::DisplayFrame);
+
 		PMDFile pmd;
-		if (!ReadPMDFile(&pmd, filepath.c_str()))
+		if (!ReadPMDFile(&pmd, filepath.c_str(), readFlags))
 		{
 			return false;
 		}
@@ -530,52 +536,56 @@ namespace saba
 			solver->SetLimitAngle(ik.m_rotateLimit * 4.0f);
 		}
 
-		if (!m_physicsMan.Create())
-		{
-			SABA_ERROR("Create Physics Fail.");
-			return false;
-		}
-
-		for (const auto& pmdRB : pmd.m_rigidBodies)
+		// 読み込まない場合は Physics World を作成しない
+		if ((readFlags & MMDReadFlags::Physics) != 0)
 		{
-			auto rb = m_physicsMan.AddRigidBody();
-			MMDNode* node = nullptr;
-			if (pmdRB.m_boneIndex != 0xFFFF)
-			{
-				node = m_nodeMan.GetMMDNode(pmdRB.m_boneIndex);
-			}
-			if (!rb->Create(pmdRB, this, node))
+			if (!m_physicsMan.Create())
 			{
-				SABA_ERROR("Create Rigid Body Fail.\n");
+				SABA_ERROR("Create Physics Fail.");
 				return false;
 			}
-			m_physicsMan.GetMMDPhysics()->AddRigidBody(rb);
-		}
 
-		for (const auto& pmdJoint : pmd.m_joints)
-		{
-			if (pmdJoint.m_rigidBodyA != -1 &&
-				pmdJoint.m_rigidBodyB != -1 &&
-				pmdJoint.m_rigidBodyA != pmdJoint.m_rigidBodyB)
+			for (const auto& pmdRB : pmd.m_rigidBodies)
 			{
-				auto joint = m_physicsMan.AddJoint();
+				auto rb = m_physicsMan.AddRigidBody();
 				MMDNode* node = nullptr;
-				auto rigidBodys = m_physicsMan.GetRigidBodys();
-				bool ret = joint->CreateJoint(
-					pmdJoint,
-					(*rigidBodys)[pmdJoint.m_rigidBodyA].get(),
-					(*rigidBodys)[pmdJoint.m_rigidBodyB].get()
-				);
-				if (!ret)
+				if (pmdRB.m_boneIndex != 0xFFFF)
+				{
+					node = m_nodeMan.GetMMDNode(pmdRB.m_boneIndex);
+				}
+				if (!rb->Create(pmdRB, this, node))
 				{
-					SABA_ERROR("Create Joint Fail.\n");
+					SABA_ERROR("Create Rigid Body Fail.\n");
 					return false;
 				}
-				m_physicsMan.GetMMDPhysics()->AddJoint(joint);
+				m_physicsMan.GetMMDPhysics()->AddRigidBody(rb);
 			}
-			else
+
+			for (const auto& pmdJoint : pmd.m_joints)
 			{
-				SABA_WARN("Illegal Joint [{}]", pmdJoint.m_jointName.ToUtf8String());
+				if (pmdJoint.m_rigidBodyA != -1 &&
+					pmdJoint.m_rigidBodyB != -1 &&
+					pmdJoint.m_rigidBodyA != pmdJoint.m_rigidBodyB)
+				{
+					auto joint = m_physicsMan.AddJoint();
+					MMDNode* node = nullptr;
+					auto rigidBodys = m_physicsMan.GetRigidBodys();
+					bool ret = joint->CreateJoint(
+						pmdJoint,
+						(*rigidBodys)[pmdJoint.m_rigidBodyA].get(),
+						(*rigidBodys)[pmdJoint.m_rigidBodyB].get()
+					);
+					if (!ret)
+					{
+						SABA_ERROR("Create Joint Fail.\n");
+						return false;
+					}
+					m_physicsMan.GetMMDPhysics()->AddJoint(joint);
+				}
+				else
+				{
+					SABA_WARN("Illegal Joint [{}]", pmdJoint.m_jointName.ToUtf8String());
+				}
 			}
 		}
 
@@ -8,6 +8,7 @@
 
 #include "MMDMaterial.h"
 #include "MMDModel.h"
+#include "MMDReadFlags.h"
 
 #include <glm/vec2.hpp>
 #include <glm/vec3.hpp>
@@ -52,6 +53,7 @@ namespace saba
 		void EndAnimation() override;
 		// Morph
 		void UpdateMorphAnimation() override;
+		void UpdateBoneMorphAnimation() override;
 		// ノードを更新する
 		void UpdateNodeAnimation(bool afterPhysicsAnim) override;
 		// Physicsを更新する
@@ -61,7 +63,8 @@ namespace saba
 		void Update() override;
 		void SetParallelUpdateHint(uint32_t) override {}
 
-		bool Load(const std::string& filepath, const std::string& mmdDataDir);
+		// readFlags : MMDReadFlags (Mesh, Bone は常に読み込む。Physics を含まない場合は Physics World を作成しない)
+		bool Load(const std::string& filepath, const std::string& mmdDataDir, uint32_t readFlags = MMDReadFlags::All);
 		void Destroy();
 
 		const glm::vec3& GetBBoxMin() const { return m_bboxMin; }
@@ -6,10 +6,13 @@
 #include "PMXFile.h"
 
 #include <Saba/Base/Log.h>
+#include <Saba/Base/BinaryReader.h>
 #include <Saba/Base/File.h>
 #include <Saba/Base/UnicodeUtil.h>
 
 #include <vector>
+#include <limits>
+#include <algorithm>
 
 namespace saba
 {
@@ -17,18 +20,18 @@ namespace saba
 	{
 
 		template <typename T>
-		bool Read(T* val, File& file)
+		bool Read(T* val, BinaryReader& file)
 		{
 			return file.Read(val);
 		}
 
 		template <typename T>
-		bool Read(T* valArray, size_t size, File& file)
+		bool Read(T* valArray, size_t size, BinaryReader& file)
 		{
 			return file.Read(valArray, size);
 		}
 
-		bool ReadString(PMXFile* pmx, std::string* val, File& file)
+		bool ReadString(PMXFile* pmx, std::string* val, BinaryReader& file)
 		{
 			uint32_t bufSize;
 			if (!Read(&bufSize, file))
@@ -64,7 +67,7 @@ namespace saba
 			return !file.IsBad();
 		}
 
-		bool ReadIndex(int32_t* index, uint8_t indexSize, File& file)
+		bool ReadIndex(int32_t* index, uint8_t indexSize, BinaryReader& file)
 		{
 			switch (indexSize)
 			{
@@ -109,7 +112,7 @@ namespace saba
 			return !file.IsBad();
 		}
 
-		bool ReadHeader(PMXFile* pmxFile, File& file)
+		bool ReadHeader(PMXFile* pmxFile, BinaryReader& file)
 		{
 			auto& header = pmxFile->m_header;
 
@@ -131,7 +134,7 @@ namespace saba
 			return !file.IsBad();
 		}
 
-		bool ReadInfo(PMXFile* pmx, File& file)
+		bool ReadInfo(PMXFile* pmx, BinaryReader& file)
 		{
 			auto& info = pmx->m_info;
 
@@ -143,7 +146,7 @@ namespace saba
 			return !file.IsBad();
 		}
 
-		bool ReadVertex(PMXFile* pmx, File& file)
+		bool ReadVertex(PMXFile* pmx, BinaryReader& file)
 		{
 			int32_t vertexCount;
 			if (!Read(&vertexCount, file))
@@ -201,8 +204,8 @@ namespace saba
 					ReadIndex(&vertex.m_boneIndices[3], pmx->m_header.m_boneIndexSize, file);
 					Read(&vertex.m_boneWeights[0], file);
 					Read(&vertex.m_boneWeights[1], file);
+					Read(&vertex.m_boneWeights[2], file);
 					Read(&vertex.m_boneWeights[3], file);
-					Read(&vertex.m_boneWeights[4], file);
 					break;
 				default:
 					return false;
@@ -213,7 +216,7 @@ namespace saba
 			return !file.IsBad();
 		}
 
-		bool ReadFace(PMXFile* pmx, File& file)
+		bool ReadFace(PMXFile* pmx, BinaryReader& file)
 		{
 			int32_t faceCount = 0;
 			if (!Read(&faceCount, file))
@@ -269,7 +272,7 @@ namespace saba
 			return !file.IsBad();
 		}
 
-		bool ReadTexture(PMXFile* pmx, File& file)
+		bool ReadTexture(PMXFile* pmx, BinaryReader& file)
 		{
 			int32_t texCount = 0;
 			if (!Read(&texCount, file))
@@ -287,7 +290,7 @@ namespace saba
 			return !file.IsBad();
 		}
 
-		bool ReadMaterial(PMXFile* pmx, File& file)
+		bool ReadMaterial(PMXFile* pmx, BinaryReader& file)
 		{
 			int32_t matCount = 0;
 			if (!Read(&matCount, file))
@@ -340,7 +343,7 @@ namespace saba
 			return !file.IsBad();
 		}
 
-		bool ReadBone(PMXFile* pmx, File& file)
+		bool ReadBone(PMXFile* pmx, BinaryReader& file)
 		{
 			int32_t boneCount;
 			if (!Read(&boneCount, file))
@@ -423,7 +426,7 @@ namespace saba
 			return !file.IsBad();
 		}
 
-		bool ReadMorph(PMXFile* pmx, File& file)
+		bool ReadMorph(PMXFile* pmx, BinaryReader& file)
 		{
 			int32_t morphCount;
 			if (!Read(&morphCount, file))
@@ -537,7 +540,7 @@ namespace saba
 			return !file.IsBad();
 		}
 
-		bool ReadDisplayFrame(PMXFile* pmx, File& file)
+		bool ReadDisplayFrame(PMXFile* pmx, BinaryReader& file)
 		{
 			int32_t displayFrameCount;
 			if (!Read(&displayFrameCount, file))
@@ -580,7 +583,7 @@ namespace saba
 			return !file.IsBad();
 		}
 
-		bool ReadRigidbody(PMXFile* pmx, File& file)
+		bool ReadRigidbody(PMXFile* pmx, BinaryReader& file)
 		{
 			int32_t rbCount;
 			if (!Read(&rbCount, file))
@@ -617,7 +620,7 @@ namespace saba
 			return !file.IsBad();
 		}
 
-		bool ReadJoint(PMXFile* pmx, File& file)
+		bool ReadJoint(PMXFile* pmx, BinaryReader& file)
 		{
 			int32_t jointCount;
 			if (!Read(&jointCount, file))
@@ -651,7 +654,7 @@ namespace saba
 			return !file.IsBad();
 		}
 
-		bool ReadSoftbody(PMXFile* pmx, File& file)
+		bool ReadSoftbody(PMXFile* pmx, BinaryReader& file)
 		{
 			int32_t sbCount;
 			if (!Read(&sbCount, file))
@@ -740,105 +743,1290 @@ namespace saba
 			return !file.IsBad();
 		}
 
-		bool ReadPMXFile(PMXFile * pmxFile, File& file)
+		bool Skip(size_t size, BinaryReader& file)
+		{
+			return file.Seek(BinaryReader::Offset(size), BinaryReader::SeekDir::Current);
+		}
+
+		bool SkipString(BinaryReader& file)
 		{
-			if (!ReadHeader(pmxFile, file))
+			uint32_t bufSize;
+			if (!Read(&bufSize, file))
 			{
-				SABA_ERROR("ReadHeader Fail.");
 				return false;
 			}
+			return Skip(bufSize, file);
+		}
 
-			if (!ReadInfo(pmxFile, file))
+		bool SkipVertex(PMXFile* pmx, BinaryReader& file)
+		{
+			int32_t vertexCount;
+			if (!Read(&vertexCount, file))
 			{
-				SABA_ERROR("ReadInfo Fail.");
 				return false;
 			}
 
-			if (!ReadVertex(pmxFile, file))
+			const size_t boneIndexSize = pmx->m_header.m_boneIndexSize;
+			const size_t baseSize = sizeof(glm::vec3) * 2 + sizeof(glm::vec2) + sizeof(glm::vec4) * pmx->m_header.m_addUVNum;
+			for (int32_t i = 0; i < vertexCount; i++)
 			{
-				SABA_ERROR("ReadVertex Fail.");
-				return false;
+				PMXVertexWeight weightType;
+				if (!Skip(baseSize, file) || !Read(&weightType, file))
+				{
+					return false;
+				}
+
+				size_t weightSize = 0;
+				switch (weightType)
+				{
+				case PMXVertexWeight::BDEF1:
+					weightSize = boneIndexSize;
+					break;
+				case PMXVertexWeight::BDEF2:
+					weightSize = boneIndexSize * 2 + sizeof(float);
+					break;
+				case PMXVertexWeight::BDEF4:
+				case PMXVertexWeight::QDEF:
+					weightSize = boneIndexSize * 4 + sizeof(float) * 4;
+					break;
+				case PMXVertexWeight::SDEF:
+					weightSize = boneIndexSize * 2 + sizeof(float) + sizeof(glm::vec3) * 3;
+					break;
+				default:
+					return false;
+				}
+				// Edge
+				if (!Skip(weightSize + sizeof(float), file))
+				{
+					return false;
+				}
 			}
 
-			if (!ReadFace(pmxFile, file))
+			return !file.IsBad();
+		}
+
+		bool SkipFace(PMXFile* pmx, BinaryReader& file)
+		{
+			int32_t indexCount = 0;
+			if (!Read(&indexCount, file))
 			{
-				SABA_ERROR("ReadFace Fail.");
 				return false;
 			}
+			return Skip(size_t(indexCount) * pmx->m_header.m_vertexIndexSize, file);
+		}
 
-			if (!ReadTexture(pmxFile, file))
+		bool SkipTexture(PMXFile* pmx, BinaryReader& file)
+		{
+			int32_t texCount = 0;
+			if (!Read(&texCount, file))
 			{
-				SABA_ERROR("ReadTexture Fail.");
 				return false;
 			}
 
-			if (!ReadMaterial(pmxFile, file))
+			for (int32_t i = 0; i < texCount; i++)
 			{
-				SABA_ERROR("ReadMaterial Fail.");
-				return false;
+				if (!SkipString(file))
+				{
+					return false;
+				}
 			}
 
-			if (!ReadBone(pmxFile, file))
+			return !file.IsBad();
+		}
+
+		bool SkipMaterial(PMXFile* pmx, BinaryReader& file)
+		{
+			int32_t matCount = 0;
+			if (!Read(&matCount, file))
 			{
-				SABA_ERROR("ReadBone Fail.");
 				return false;
 			}
 
-			if (!ReadMorph(pmxFile, file))
+			const size_t texIndexSize = pmx->m_header.m_textureIndexSize;
+			// Diffuse, Specular, SpecularPower, Ambient, DrawMode, EdgeColor, EdgeSize
+			const size_t colorSize = sizeof(glm::vec4) + sizeof(glm::vec3) + sizeof(float) + sizeof(glm::vec3) +
+				sizeof(uint8_t) + sizeof(glm::vec4) + sizeof(float);
+			for (int32_t i = 0; i < matCount; i++)
 			{
-				SABA_ERROR("ReadMorph Fail.");
-				return false;
+				if (!SkipString(file))
+				{
+					return false;
+				}
+				if (!SkipString(file))
+				{
+					return false;
+				}
+				if (!Skip(colorSize + texIndexSize * 2 + sizeof(PMXSphereMode), file))
+				{
+					return false;
+				}
+
+				PMXToonMode toonMode;
+				if (!Read(&toonMode, file))
+				{
+					return false;
+				}
+				if (!Skip(toonMode == PMXToonMode::Separate ? texIndexSize : sizeof(uint8_t), file))
+				{
+					return false;
+				}
+
+				if (!SkipString(file))
+				{
+					return false;
+				}
+				if (!Skip(sizeof(int32_t), file))
+				{
+					return false;
+				}
 			}
 
-			if (!ReadDisplayFrame(pmxFile, file))
+			return !file.IsBad();
+		}
+
+		bool SkipBone(PMXFile* pmx, BinaryReader& file)
+		{
+			int32_t boneCount;
+			if (!Read(&boneCount, file))
 			{
-				SABA_ERROR("ReadDisplayFrame Fail.");
 				return false;
 			}
 
-			if (!ReadRigidbody(pmxFile, file))
+			const size_t boneIndexSize = pmx->m_header.m_boneIndexSize;
+			for (int32_t i = 0; i < boneCount; i++)
+			{
+				if (!SkipString(file))
+				{
+					return false;
+				}
+				if (!SkipString(file))
+				{
+					return false;
+				}
+				if (!Skip(sizeof(glm::vec3) + boneIndexSize + sizeof(int32_t), file))
+				{
+					return false;
+				}
+
+				PMXBoneFlags boneFlag;
+				if (!Read(&boneFlag, file))
+				{
+					return false;
+				}
+
+				size_t size = 0;
+				if (((uint16_t)boneFlag & (uint16_t)PMXBoneFlags::TargetShowMode) == 0)
+				{
+					size += sizeof(glm::vec3);
+				}
+				else
+				{
+					size += boneIndexSize;
+				}
+				if (((uint16_t)boneFlag & (uint16_t)PMXBoneFlags::AppendRotate) ||
+					((uint16_t)boneFlag & (uint16_t)PMXBoneFlags::AppendTranslate))
+				{
+					size += boneIndexSize + sizeof(float);
+				}
+				if ((uint16_t)boneFlag & (uint16_t)PMXBoneFlags::FixedAxis)
+				{
+					size += sizeof(glm::vec3);
+				}
+				if ((uint16_t)boneFlag & (uint16_t)PMXBoneFlags::LocalAxis)
+				{
+					size += sizeof(glm::vec3) * 2;
+				}
+				if ((uint16_t)boneFlag & (uint16_t)PMXBoneFlags::DeformOuterParent)
+				{
+					size += sizeof(int32_t);
+				}
+				if (!Skip(size, file))
+				{
+					return false;
+				}
+
+				if ((uint16_t)boneFlag & (uint16_t)PMXBoneFlags::IK)
+				{
+					if (!Skip(boneIndexSize + sizeof(int32_t) + sizeof(float), file))
+					{
+						return false;
+					}
+
+					int32_t linkCount;
+					if (!Read(&linkCount, file))
+					{
+						return false;
+					}
+					for (int32_t linkIdx = 0; linkIdx < linkCount; linkIdx++)
+					{
+						unsigned char enableLimit;
+						if (!Skip(boneIndexSize, file))
+						{
+							return false;
+						}
+						if (!Read(&enableLimit, file))
+						{
+							return false;
+						}
+						if (enableLimit != 0)
+						{
+							if (!Skip(sizeof(glm::vec3) * 2, file))
+							{
+								return false;
+							}
+						}
+					}
+				}
+			}
+
+			return !file.IsBad();
+		}
+
+		bool SkipMorph(PMXFile* pmx, BinaryReader& file)
+		{
+			int32_t morphCount;
+			if (!Read(&morphCount, file))
 			{
-				SABA_ERROR("ReadRigidbody Fail.");
 				return false;
 			}
 
-			if (!ReadJoint(pmxFile, file))
+			const auto& header = pmx->m_header;
+			for (int32_t i = 0; i < morphCount; i++)
+			{
+				if (!SkipString(file))
+				{
+					return false;
+				}
+				if (!SkipString(file))
+				{
+					return false;
+				}
+				if (!Skip(sizeof(uint8_t), file))
+				{
+					return false;
+				}
+
+				PMXMorphType morphType;
+				int32_t dataCount;
+				if (!Read(&morphType, file) || !Read(&dataCount, file))
+				{
+					return false;
+				}
+
+				size_t dataSize = 0;
+				switch (morphType)
+				{
+				case PMXMorphType::Position:
+					dataSize = header.m_vertexIndexSize + sizeof(glm::vec3);
+					break;
+				case PMXMorphType::UV:
+				case PMXMorphType::AddUV1:
+				case PMXMorphType::AddUV2:
+				case PMXMorphType::AddUV3:
+				case PMXMorphType::AddUV4:
+					dataSize = header.m_vertexIndexSize + sizeof(glm::vec4);
+					break;
+				case PMXMorphType::Bone:
+					dataSize = header.m_boneIndexSize + sizeof(glm::vec3) + sizeof(glm::quat);
+					break;
+				case PMXMorphType::Material:
+					// OpType, Diffuse, Specular, SpecularPower, Ambient, EdgeColor, EdgeSize, Texture/Sphere/Toon Factor
+					dataSize = header.m_materialIndexSize + sizeof(uint8_t) +
+						sizeof(glm::vec4) + sizeof(glm::vec3) + sizeof(float) + sizeof(glm::vec3) +
+						sizeof(glm::vec4) + sizeof(float) + sizeof(glm::vec4) * 3;
+					break;
+				case PMXMorphType::Group:
+				case PMXMorphType::Flip:
+					dataSize = header.m_morphIndexSize + sizeof(float);
+					break;
+				case PMXMorphType::Impluse:
+					dataSize = header.m_rigidbodyIndexSize + sizeof(uint8_t) + sizeof(glm::vec3) * 2;
+					break;
+				default:
+					SABA_ERROR("Unsupported Morph Type:[{}]", (int)morphType);
+					return false;
+				}
+				if (!Skip(dataSize * size_t(dataCount), file))
+				{
+					return false;
+				}
+			}
+
+			return !file.IsBad();
+		}
+
+		bool SkipDisplayFrame(PMXFile* pmx, BinaryReader& file)
+		{
+			int32_t displayFrameCount;
+			if (!Read(&displayFrameCount, file))
 			{
-				SABA_ERROR("ReadJoint Fail.");
 				return false;
 			}
 
-			if (file.Tell() < file.GetSize())
+			for (int32_t i = 0; i < displayFrameCount; i++)
 			{
-				if (!ReadSoftbody(pmxFile, file))
+				if (!SkipString(file))
+				{
+					return false;
+				}
+				if (!SkipString(file))
 				{
-					SABA_ERROR("ReadSoftbody Fail.");
 					return false;
 				}
+				if (!Skip(sizeof(uint8_t), file))
+				{
+					return false;
+				}
+
+				int32_t targetCount;
+				if (!Read(&targetCount, file))
+				{
+					return false;
+				}
+				for (int32_t targetIdx = 0; targetIdx < targetCount; targetIdx++)
+				{
+					PMXDisplayFrame::TargetType type;
+					if (!Read(&type, file))
+					{
+						return false;
+					}
+					if (type == PMXDisplayFrame::TargetType::BoneIndex)
+					{
+						if (!Skip(pmx->m_header.m_boneIndexSize, file))
+						{
+							return false;
+						}
+					}
+					else if (type == PMXDisplayFrame::TargetType::MorphIndex)
+					{
+						if (!Skip(pmx->m_header.m_morphIndexSize, file))
+						{
+							return false;
+						}
+					}
+					else
+					{
+						return false;
+					}
+				}
 			}
 
-			return true;
+			return !file.IsBad();
 		}
-	}
 
-	bool ReadPMXFile(PMXFile * pmxFile, const char* filename)
-	{
-		File file;
-		if (!file.Open(filename))
+		template <typename T>
+		bool Write(const T* val, File& file)
 		{
-			SABA_INFO("PMX File Open Fail. {}", filename);
-			return false;
+			return file.Write(val);
 		}
 
-		if (!ReadPMXFile(pmxFile, file))
+		template <typename T>
+		bool Write(const T* valArray, size_t size, File& file)
 		{
-			SABA_INFO("PMX File Read Fail. {}", filename);
-			return false;
+			if (size == 0)
+			{
+				return true;
+			}
+			return file.Write(valArray, size);
 		}
-		SABA_INFO("PMX File Read Successed. {}", filename);
 
-		return true;
-	}
+		bool WriteString(const std::string& val, File& file)
+		{
+			// 書き出しは常に UTF-8
+			uint32_t bufSize = uint32_t(val.size());
+			Write(&bufSize, file);
+			Write(val.data(), val.size(), file);
 
+			return !file.IsBad();
+		}
+
+		bool WriteIndex(int32_t index, uint8_t indexSize, File& file)
+		{
+			switch (indexSize)
+			{
+			case 1:
+			{
+				uint8_t idx = index == -1 ? uint8_t(0xFF) : uint8_t(index);
+				Write(&idx, file);
+			}
+				break;
+			case 2:
+			{
+				uint16_t idx = index == -1 ? uint16_t(0xFFFF) : uint16_t(index);
+				Write(&idx, file);
+			}
+				break;
+			case 4:
+			{
+				uint32_t idx = uint32_t(index);
+				Write(&idx, file);
+			}
+				break;
+			default:
+				return false;
+			}
+			return !file.IsBad();
+		}
+
+		// 頂点インデックスは符号なし
+		// (Saba の ReadIndex は 0xFF, 0xFFFF を -1 として読むため、それ未満に収める)
+		uint8_t CalcVertexIndexSize(size_t count)
+		{
+			if (count < 0xFF)
+			{
+				return 1;
+			}
+			else if (count < 0xFFFF)
+			{
+				return 2;
+			}
+			return 4;
+		}
+
+		// 頂点以外 (テクスチャ、材質、ボーン、モーフ、剛体) のインデックスは符号付き
+		uint8_t CalcIndexSize(size_t count)
+		{
+			if (count <= size_t(std::numeric_limits<int8_t>::max()))
+			{
+				return 1;
+			}
+			else if (count <= size_t(std::numeric_limits<int16_t>::max()))
+			{
+				return 2;
+			}
+			return 4;
+		}
+
+		template <typename T>
+		bool WriteCount(const std::vector<T>& values, File& file)
+		{
+			int32_t count = int32_t(values.size());
+			return Write(&count, file);
+		}
+
+		bool WriteHeader(const PMXHeader& header, File& file)
+		{
+			Write(header.m_magic.m_buffer, 4, file);
+			Write(&header.m_version, file);
+
+			Write(&header.m_dataSize, file);
+
+			Write(&header.m_encode, file);
+			Write(&header.m_addUVNum, file);
+
+			Write(&header.m_vertexIndexSize, file);
+			Write(&header.m_textureIndexSize, file);
+			Write(&header.m_materialIndexSize, file);
+			Write(&header.m_boneIndexSize, file);
+			Write(&header.m_morphIndexSize, file);
+			Write(&header.m_rigidbodyIndexSize, file);
+
+			return !file.IsBad();
+		}
+
+		bool WriteInfo(const PMXFile* pmx, File& file)
+		{
+			const auto& info = pmx->m_info;
+
+			WriteString(info.m_modelName, file);
+			WriteString(info.m_englishModelName, file);
+			WriteString(info.m_comment, file);
+			WriteString(info.m_englishComment, file);
+
+			return !file.IsBad();
+		}
+
+		bool WriteVertex(const PMXFile* pmx, const PMXHeader& header, File& file)
+		{
+			WriteCount(pmx->m_vertices, file);
+
+			for (const auto& vertex : pmx->m_vertices)
+			{
+				Write(&vertex.m_position, file);
+				Write(&vertex.m_normal, file);
+				Write(&vertex.m_uv, file);
+
+				for (uint8_t i = 0; i < header.m_addUVNum; i++)
+				{
+					Write(&vertex.m_addUV[i], file);
+				}
+
+				Write(&vertex.m_weightType, file);
+
+				switch (vertex.m_weightType)
+				{
+				case PMXVertexWeight::BDEF1:
+					WriteIndex(vertex.m_boneIndices[0], header.m_boneIndexSize, file);
+					break;
+				case PMXVertexWeight::BDEF2:
+					WriteIndex(vertex.m_boneIndices[0], header.m_boneIndexSize, file);
+					WriteIndex(vertex.m_boneIndices[1], header.m_boneIndexSize, file);
+					Write(&vertex.m_boneWeights[0], file);
+					break;
+				case PMXVertexWeight::BDEF4:
+				case PMXVertexWeight::QDEF:
+					WriteIndex(vertex.m_boneIndices[0], header.m_boneIndexSize, file);
+					WriteIndex(vertex.m_boneIndices[1], header.m_boneIndexSize, file);
+					WriteIndex(vertex.m_boneIndices[2], header.m_boneIndexSize, file);
+					WriteIndex(vertex.m_boneIndices[3], header.m_boneIndexSize, file);
+					Write(&vertex.m_boneWeights[0], file);
+					Write(&vertex.m_boneWeights[1], file);
+					Write(&vertex.m_boneWeights[2], file);
+					Write(&vertex.m_boneWeights[3], file);
+					break;
+				case PMXVertexWeight::SDEF:
+					WriteIndex(vertex.m_boneIndices[0], header.m_boneIndexSize, file);
+					WriteIndex(vertex.m_boneIndices[1], header.m_boneIndexSize, file);
+					Write(&vertex.m_boneWeights[0], file);
+					Write(&vertex.m_sdefC, file);
+					Write(&vertex.m_sdefR0, file);
+					Write(&vertex.m_sdefR1, file);
+					break;
+				default:
+					return false;
+				}
+				Write(&vertex.m_edgeMag, file);
+			}
+
+			return !file.IsBad();
+		}
+
+		bool WriteFace(const PMXFile* pmx, const PMXHeader& header, File& file)
+		{
+			int32_t indexCount = int32_t(pmx->m_faces.size() * 3);
+			Write(&indexCount, file);
+
+			switch (header.m_vertexIndexSize)
+			{
+			case 1:
+			{
+				std::vector<uint8_t> vertices;
+				vertices.reserve(indexCount);
+				for (const auto& face : pmx->m_faces)
+				{
+					vertices.push_back(uint8_t(face.m_vertices[0]));
+					vertices.push_back(uint8_t(face.m_vertices[1]));
+					vertices.push_back(uint8_t(face.m_vertices[2]));
+				}
+				Write(vertices.data(), vertices.size(), file);
+			}
+				break;
+			case 2:
+			{
+				std::vector<uint16_t> vertices;
+				vertices.reserve(indexCount);
+				for (const auto& face : pmx->m_faces)
+				{
+					vertices.push_back(uint16_t(face.m_vertices[0]));
+					vertices.push_back(uint16_t(face.m_vertices[1]));
+					vertices.push_back(uint16_t(face.m_vertices[2]));
+				}
+				Write(vertices.data(), vertices.size(), file);
+			}
+				break;
+			case 4:
+			{
+				std::vector<uint32_t> vertices;
+				vertices.reserve(indexCount);
+				for (const auto& face : pmx->m_faces)
+				{
+					vertices.push_back(face.m_vertices[0]);
+					vertices.push_back(face.m_vertices[1]);
+					vertices.push_back(face.m_vertices[2]);
+				}
+				Write(vertices.data(), vertices.size(), file);
+			}
+				break;
+			default:
+				return false;
+			}
+
+			return !file.IsBad();
+		}
+
+		bool WriteTexture(const PMXFile* pmx, File& file)
+		{
+			WriteCount(pmx->m_textures, file);
+
+			for (const auto& tex : pmx->m_textures)
+			{
+				WriteString(tex.m_textureName, file);
+			}
+
+			return !file.IsBad();
+		}
+
+		bool WriteMaterial(const PMXFile* pmx, const PMXHeader& header, File& file)
+		{
+			WriteCount(pmx->m_materials, file);
+
+			for (const auto& mat : pmx->m_materials)
+			{
+				WriteString(mat.m_name, file);
+				WriteString(mat.m_englishName, file);
+
+				Write(&mat.m_diffuse, file);
+				Write(&mat.m_specular, file);
+				Write(&mat.m_specularPower, file);
+				Write(&mat.m_ambient, file);
+
+				Write(&mat.m_drawMode, file);
+
+				Write(&mat.m_edgeColor, file);
+				Write(&mat.m_edgeSize, file);
+
+				WriteIndex(mat.m_textureIndex, header.m_textureIndexSize, file);
+				WriteIndex(mat.m_sphereTextureIndex, header.m_textureIndexSize, file);
+				Write(&mat.m_sphereMode, file);
+
+				Write(&mat.m_toonMode, file);
+				if (mat.m_toonMode == PMXToonMode::Separate)
+				{
+					WriteIndex(mat.m_toonTextureIndex, header.m_textureIndexSize, file);
+				}
+				else if (mat.m_toonMode == PMXToonMode::Common)
+				{
+					uint8_t toonIndex = uint8_t(mat.m_toonTextureIndex);
+					Write(&toonIndex, file);
+				}
+				else
+				{
+					return false;
+				}
+
+				WriteString(mat.m_memo, file);
+
+				Write(&mat.m_numFaceVertices, file);
+			}
+
+			return !file.IsBad();
+		}
+
+		bool WriteBone(const PMXFile* pmx, const PMXHeader& header, File& file)
+		{
+			WriteCount(pmx->m_bones, file);
+
+			for (const auto& bone : pmx->m_bones)
+			{
+				WriteString(bone.m_name, file);
+				WriteString(bone.m_englishName, file);
+
+				Write(&bone.m_position, file);
+				WriteIndex(bone.m_parentBoneIndex, header.m_boneIndexSize, file);
+				Write(&bone.m_deformDepth, file);
+
+				Write(&bone.m_boneFlag, file);
+
+				if (((uint16_t)bone.m_boneFlag & (uint16_t)PMXBoneFlags::TargetShowMode) == 0)
+				{
+					Write(&bone.m_positionOffset, file);
+				}
+				else
+				{
+					WriteIndex(bone.m_linkBoneIndex, header.m_boneIndexSize, file);
+				}
+
+				if (((uint16_t)bone.m_boneFlag & (uint16_t)PMXBoneFlags::AppendRotate) ||
+					((uint16_t)bone.m_boneFlag & (uint16_t)PMXBoneFlags::AppendTranslate))
+				{
+					WriteIndex(bone.m_appendBoneIndex, header.m_boneIndexSize, file);
+					Write(&bone.m_appendWeight, file);
+				}
+
+				if ((uint16_t)bone.m_boneFlag & (uint16_t)PMXBoneFlags::FixedAxis)
+				{
+					Write(&bone.m_fixedAxis, file);
+				}
+
+				if ((uint16_t)bone.m_boneFlag & (uint16_t)PMXBoneFlags::LocalAxis)
+				{
+					Write(&bone.m_localXAxis, file);
+					Write(&bone.m_localZAxis, file);
+				}
+
+				if ((uint16_t)bone.m_boneFlag & (uint16_t)PMXBoneFlags::DeformOuterParent)
+				{
+					Write(&bone.m_keyValue, file);
+				}
+
+				if ((uint16_t)bone.m_boneFlag & (uint16_t)PMXBoneFlags::IK)
+				{
+					WriteIndex(bone.m_ikTargetBoneIndex, header.m_boneIndexSize, file);
+					Write(&bone.m_ikIterationCount, file);
+					Write(&bone.m_ikLimit, file);
+
+					WriteCount(bone.m_ikLinks, file);
+					for (const auto& ikLink : bone.m_ikLinks)
+					{
+						WriteIndex(ikLink.m_ikBoneIndex, header.m_boneIndexSize, file);
+						Write(&ikLink.m_enableLimit, file);
+
+						if (ikLink.m_enableLimit != 0)
+						{
+							Write(&ikLink.m_limitMin, file);
+							Write(&ikLink.m_limitMax, file);
+						}
+					}
+				}
+			}
+
+			return !file.IsBad();
+		}
+
+		bool WriteMorph(const PMXFile* pmx, const PMXHeader& header, File& file)
+		{
+			WriteCount(pmx->m_morphs, file);
+
+			for (const auto& morph : pmx->m_morphs)
+			{
+				WriteString(morph.m_name, file);
+				WriteString(morph.m_englishName, file);
+
+				Write(&morph.m_controlPanel, file);
+				Write(&morph.m_morphType, file);
+
+				if (morph.m_morphType == PMXMorphType::Position)
+				{
+					WriteCount(morph.m_positionMorph, file);
+					for (const auto& data : morph.m_positionMorph)
+					{
+						WriteIndex(data.m_vertexIndex, header.m_vertexIndexSize, file);
+						Write(&data.m_position, file);
+					}
+				}
+				else if (morph.m_morphType == PMXMorphType::UV ||
+					morph.m_morphType == PMXMorphType::AddUV1 ||
+					morph.m_morphType == PMXMorphType::AddUV2 ||
+					morph.m_morphType == PMXMorphType::AddUV3 ||
+					morph.m_morphType == PMXMorphType::AddUV4
+					)
+				{
+					WriteCount(morph.m_uvMorph, file);
+					for (const auto& data : morph.m_uvMorph)
+					{
+						WriteIndex(data.m_vertexIndex, header.m_vertexIndexSize, file);
+						Write(&data.m_uv, file);
+					}
+				}
+				else if (morph.m_morphType == PMXMorphType::Bone)
+				{
+					WriteCount(morph.m_boneMorph, file);
+					for (const auto& data : morph.m_boneMorph)
+					{
+						WriteIndex(data.m_boneIndex, header.m_boneIndexSize, file);
+						Write(&data.m_position, file);
+						Write(&data.m_quaternion, file);
+					}
+				}
+				else if (morph.m_morphType == PMXMorphType::Material)
+				{
+					WriteCount(morph.m_materialMorph, file);
+					for (const auto& data : morph.m_materialMorph)
+					{
+						WriteIndex(data.m_materialIndex, header.m_materialIndexSize, file);
+						Write(&data.m_opType, file);
+						Write(&data.m_diffuse, file);
+						Write(&data.m_specular, file);
+						Write(&data.m_specularPower, file);
+						Write(&data.m_ambient, file);
+						Write(&data.m_edgeColor, file);
+						Write(&data.m_edgeSize, file);
+						Write(&data.m_textureFactor, file);
+						Write(&data.m_sphereTextureFactor, file);
+						Write(&data.m_toonTextureFactor, file);
+					}
+				}
+				else if (morph.m_morphType == PMXMorphType::Group)
+				{
+					WriteCount(morph.m_groupMorph, file);
+					for (const auto& data : morph.m_groupMorph)
+					{
+						WriteIndex(data.m_morphIndex, header.m_morphIndexSize, file);
+						Write(&data.m_weight, file);
+					}
+				}
+				else if (morph.m_morphType == PMXMorphType::Flip)
+				{
+					WriteCount(morph.m_flipMorph, file);
+					for (const auto& data : morph.m_flipMorph)
+					{
+						WriteIndex(data.m_morphIndex, header.m_morphIndexSize, file);
+						Write(&data.m_weight, file);
+					}
+				}
+				else if (morph.m_morphType == PMXMorphType::Impluse)
+				{
+					WriteCount(morph.m_impulseMorph, file);
+					for (const auto& data : morph.m_impulseMorph)
+					{
+						WriteIndex(data.m_rigidbodyIndex, header.m_rigidbodyIndexSize, file);
+						Write(&data.m_localFlag, file);
+						Write(&data.m_translateVelocity, file);
+						Write(&data.m_rotateTorque, file);
+					}
+				}
+				else
+				{
+					SABA_ERROR("Unsupported Morph Type:[{}]", (int)morph.m_morphType);
+					return false;
+				}
+			}
+
+			return !file.IsBad();
+		}
+
+		bool WriteDisplayFrame(const PMXFile* pmx, const PMXHeader& header, File& file)
+		{
+			WriteCount(pmx->m_displayFrames, file);
+
+			for (const auto& displayFrame : pmx->m_displayFrames)
+			{
+				WriteString(displayFrame.m_name, file);
+				WriteString(displayFrame.m_englishName, file);
+
+				Write(&displayFrame.m_flag, file);
+				WriteCount(displayFrame.m_targets, file);
+				for (const auto& target : displayFrame.m_targets)
+				{
+					Write(&target.m_type, file);
+					if (target.m_type == PMXDisplayFrame::TargetType::BoneIndex)
+					{
+						WriteIndex(target.m_index, header.m_boneIndexSize, file);
+					}
+					else if (target.m_type == PMXDisplayFrame::TargetType::MorphIndex)
+					{
+						WriteIndex(target.m_index, header.m_morphIndexSize, file);
+					}
+					else
+					{
+						return false;
+					}
+				}
+			}
+
+			return !file.IsBad();
+		}
+
+		bool WriteRigidbody(const PMXFile* pmx, const PMXHeader& header, File& file)
+		{
+			WriteCount(pmx->m_rigidbodies, file);
+
+			for (const auto& rb : pmx->m_rigidbodies)
+			{
+				WriteString(rb.m_name, file);
+				WriteString(rb.m_englishName, file);
+
+				WriteIndex(rb.m_boneIndex, header.m_boneIndexSize, file);
+				Write(&rb.m_group, file);
+				Write(&rb.m_collisionGroup, file);
+
+				Write(&rb.m_shape, file);
+				Write(&rb.m_shapeSize, file);
+
+				Write(&rb.m_translate, file);
+				Write(&rb.m_rotate, file);
+
+				Write(&rb.m_mass, file);
+				Write(&rb.m_translateDimmer, file);
+				Write(&rb.m_rotateDimmer, file);
+				Write(&rb.m_repulsion, file);
+				Write(&rb.m_friction, file);
+
+				Write(&rb.m_op, file);
+			}
+
+			return !file.IsBad();
+		}
+
+		bool WriteJoint(const PMXFile* pmx, const PMXHeader& header, File& file)
+		{
+			WriteCount(pmx->m_joints, file);
+
+			for (const auto& joint : pmx->m_joints)
+			{
+				WriteString(joint.m_name, file);
+				WriteString(joint.m_englishName, file);
+
+				Write(&joint.m_type, file);
+				WriteIndex(joint.m_rigidbodyAIndex, header.m_rigidbodyIndexSize, file);
+				WriteIndex(joint.m_rigidbodyBIndex, header.m_rigidbodyIndexSize, file);
+
+				Write(&joint.m_translate, file);
+				Write(&joint.m_rotate, file);
+
+				Write(&joint.m_translateLowerLimit, file);
+				Write(&joint.m_translateUpperLimit, file);
+				Write(&joint.m_rotateLowerLimit, file);
+				Write(&joint.m_rotateUpperLimit, file);
+
+				Write(&joint.m_springTranslateFactor, file);
+				Write(&joint.m_springRotateFactor, file);
+			}
+
+			return !file.IsBad();
+		}
+
+		bool WriteSoftbody(const PMXFile* pmx, const PMXHeader& header, File& file)
+		{
+			WriteCount(pmx->m_softbodies, file);
+
+			for (const auto& sb : pmx->m_softbodies)
+			{
+				WriteString(sb.m_name, file);
+				WriteString(sb.m_englishName, file);
+
+				Write(&sb.m_type, file);
+
+				WriteIndex(sb.m_materialIndex, header.m_materialIndexSize, file);
+
+				Write(&sb.m_group, file);
+				Write(&sb.m_collisionGroup, file);
+
+				Write(&sb.m_flag, file);
+
+				Write(&sb.m_BLinkLength, file);
+				Write(&sb.m_numClusters, file);
+
+				Write(&sb.m_totalMass, file);
+				Write(&sb.m_collisionMargin, file);
+
+				Write(&sb.m_aeroModel, file);
+
+				Write(&sb.m_VCF, file);
+				Write(&sb.m_DP, file);
+				Write(&sb.m_DG, file);
+				Write(&sb.m_LF, file);
+				Write(&sb.m_PR, file);
+				Write(&sb.m_VC, file);
+				Write(&sb.m_DF, file);
+				Write(&sb.m_MT, file);
+				Write(&sb.m_CHR, file);
+				Write(&sb.m_KHR, file);
+				Write(&sb.m_SHR, file);
+				Write(&sb.m_AHR, file);
+
+				Write(&sb.m_SRHR_CL, file);
+				Write(&sb.m_SKHR_CL, file);
+				Write(&sb.m_SSHR_CL, file);
+				Write(&sb.m_SR_SPLT_CL, file);
+				Write(&sb.m_SK_SPLT_CL, file);
+				Write(&sb.m_SS_SPLT_CL, file);
+
+				Write(&sb.m_V_IT, file);
+				Write(&sb.m_P_IT, file);
+				Write(&sb.m_D_IT, file);
+				Write(&sb.m_C_IT, file);
+
+				Write(&sb.m_LST, file);
+				Write(&sb.m_AST, file);
+				Write(&sb.m_VST, file);
+
+				WriteCount(sb.m_anchorRigidbodies, file);
+				for (const auto& ar : sb.m_anchorRigidbodies)
+				{
+					WriteIndex(ar.m_rigidBodyIndex, header.m_rigidbodyIndexSize, file);
+					WriteIndex(ar.m_vertexIndex, header.m_vertexIndexSize, file);
+					Write(&ar.m_nearMode, file);
+				}
+
+				WriteCount(sb.m_pinVertexIndices, file);
+				for (const auto& pv : sb.m_pinVertexIndices)
+				{
+					WriteIndex(pv, header.m_vertexIndexSize, file);
+				}
+			}
+
+			return !file.IsBad();
+		}
+	}
+
+	bool ReadPMXFile(PMXFile * pmxFile, BinaryReader& file, uint32_t readFlags)
+	{
+		if (!ReadHeader(pmxFile, file))
+		{
+			SABA_ERROR("ReadHeader Fail.");
+			return false;
+		}
+
+		if (!ReadInfo(pmxFile, file))
+		{
+			SABA_ERROR("ReadInfo Fail.");
+			return false;
+		}
+
+		// 不要なセクションは読み飛ばし、以降に必要なセクションが無ければ終了する
+		const uint32_t afterMesh = MMDReadFlags::Bone | MMDReadFlags::Morph | MMDReadFlags::DisplayFrame | MMDReadFlags::Physics;
+		const uint32_t afterBone = MMDReadFlags::Morph | MMDReadFlags::DisplayFrame | MMDReadFlags::Physics;
+		const uint32_t afterMorph = MMDReadFlags::DisplayFrame | MMDReadFlags::Physics;
+		const uint32_t afterDisplayFrame = MMDReadFlags::Physics;
+
+		if ((readFlags & MMDReadFlags::Mesh) != 0)
+		{
+			if (!ReadVertex(pmxFile, file))
+			{
+				SABA_ERROR("ReadVertex Fail.");
+				return false;
+			}
+
+			if (!ReadFace(pmxFile, file))
+			{
+				SABA_ERROR("ReadFace Fail.");
+				return false;
+			}
+
+			if (!ReadTexture(pmxFile, file))
+			{
+				SABA_ERROR("ReadTexture Fail.");
+				return false;
+			}
+
+			if (!ReadMaterial(pmxFile, file))
+			{
+				SABA_ERROR("ReadMaterial Fail.");
+				return false;
+			}
+		}
+		else if ((readFlags & afterMesh) != 0)
+		{
+			if (!SkipVertex(pmxFile, file) ||
+				!SkipFace(pmxFile, file) ||
+				!SkipTexture(pmxFile, file) ||
+				!SkipMaterial(pmxFile, file))
+			{
+				SABA_ERROR("SkipMesh Fail.");
+				return false;
+			}
+		}
+		else
+		{
+			return true;
+		}
+
+		if ((readFlags & MMDReadFlags::Bone) != 0)
+		{
+			if (!ReadBone(pmxFile, file))
+			{
+				SABA_ERROR("ReadBone Fail.");
+				return false;
+			}
+		}
+		else if ((readFlags & afterBone) != 0)
+		{
+			if (!SkipBone(pmxFile, file))
+			{
+				SABA_ERROR("SkipBone Fail.");
+				return false;
+			}
+		}
+		else
+		{
+			return true;
+		}
+
+		if ((readFlags & MMDReadFlags::Morph) != 0)
+		{
+			if (!ReadMorph(pmxFile, file))
+			{
+				SABA_ERROR("ReadMorph Fail.");
+				return false;
+			}
+		}
+		else if ((readFlags & afterMorph) != 0)
+		{
+			if (!SkipMorph(pmxFile, file))
+			{
+				SABA_ERROR("SkipMorph Fail.");
+				return false;
+			}
+		}
+		else
+		{
+			return true;
+		}
+
+		if ((readFlags & MMDReadFlags::DisplayFrame) != 0)
+		{
+			if (!ReadDisplayFrame(pmxFile, file))
+			{
+				SABA_ERROR("ReadDisplayFrame Fail.");
+				return false;
+			}
+		}
+		else if ((readFlags & afterDisplayFrame) != 0)
+		{
+			if (!SkipDisplayFrame(pmxFile, file))
+			{
+				SABA_ERROR("SkipDisplayFrame Fail.");
+				return false;
+			}
+		}
+		else
+		{
+			return true;
+		}
+
+		if ((readFlags & MMDReadFlags::Physics) == 0)
+		{
+			return true;
+		}
+
+		if (!ReadRigidbody(pmxFile, file))
+		{
+			SABA_ERROR("ReadRigidbody Fail.");
+			return false;
+		}
+
+		if (!ReadJoint(pmxFile, file))
+		{
+			SABA_ERROR("ReadJoint Fail.");
+			return false;
+		}
+
+		if (file.Tell() < file.GetSize())
+		{
+			if (!ReadSoftbody(pmxFile, file))
+			{
+				SABA_ERROR("ReadSoftbody Fail.");
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	bool ReadPMXFile(PMXFile * pmxFile, const char* filename, uint32_t readFlags)
+	{
+		BinaryReader file;
+		if (!file.Open(filename))
+		{
+			SABA_INFO("PMX File Open Fail. {}", filename);
+			return false;
+		}
+
+		if (!ReadPMXFile(pmxFile, file, readFlags))
+		{
+			SABA_INFO("PMX File Read Fail. {}", filename);
+			return false;
+		}
+		SABA_INFO("PMX File Read Successed. {}", filename);
+
+		return true;
+	}
+
+	bool WritePMXFile(const PMXFile * pmxFile, File& file)
+	{
+		PMXHeader header = pmxFile->m_header;
+		header.m_magic.Set("PMX ");
+		// 2.1 の機能 (フリップ、インパルスモーフ等) を使用している場合があるため、元のバージョンを保つ
+		header.m_version = std::max(pmxFile->m_header.m_version, 2.0f);
+		if (!pmxFile->m_softbodies.empty())
+		{
+			header.m_version = std::max(header.m_version, 2.1f);
+		}
+		header.m_dataSize = 8;
+		header.m_encode = 1;
+		header.m_vertexIndexSize = CalcVertexIndexSize(pmxFile->m_vertices.size());
+		header.m_textureIndexSize = CalcIndexSize(pmxFile->m_textures.size());
+		header.m_materialIndexSize = CalcIndexSize(pmxFile->m_materials.size());
+		header.m_boneIndexSize = CalcIndexSize(pmxFile->m_bones.size());
+		header.m_morphIndexSize = CalcIndexSize(pmxFile->m_morphs.size());
+		header.m_rigidbodyIndexSize = CalcIndexSize(pmxFile->m_rigidbodies.size());
+
+		if (!WriteHeader(header, file))
+		{
+			SABA_ERROR("WriteHeader Fail.");
+			return false;
+		}
+
+		if (!WriteInfo(pmxFile, file))
+		{
+			SABA_ERROR("WriteInfo Fail.");
+			return false;
+		}
+
+		if (!WriteVertex(pmxFile, header, file))
+		{
+			SABA_ERROR("WriteVertex Fail.");
+			return false;
+		}
+
+		if (!WriteFace(pmxFile, header, file))
+		{
+			SABA_ERROR("WriteFace Fail.");
+			return false;
+		}
+
+		if (!WriteTexture(pmxFile, file))
+		{
+			SABA_ERROR("WriteTexture Fail.");
+			return false;
+		}
+
+		if (!WriteMaterial(pmxFile, header, file))
+		{
+			SABA_ERROR("WriteMaterial Fail.");
+			return false;
+		}
+
+		if (!WriteBone(pmxFile, header, file))
+		{
+			SABA_ERROR("WriteBone Fail.");
+			return false;
+		}
+
+		if (!WriteMorph(pmxFile, header, file))
+		{
+			SABA_ERROR("WriteMorph Fail.");
+			return false;
+		}
+
+		if (!WriteDisplayFrame(pmxFile, header, file))
+		{
+			SABA_ERROR("WriteDisplayFrame Fail.");
+			return false;
+		}
+
+		if (!WriteRigidbody(pmxFile, header, file))
+		{
+			SABA_ERROR("WriteRigidbody Fail.");
+			return false;
+		}
+
+		if (!WriteJoint(pmxFile, header, file))
+		{
+			SABA_ERROR("WriteJoint Fail.");
+			return false;
+		}
+
+		if (!pmxFile->m_softbodies.empty())
+		{
+			if (!WriteSoftbody(pmxFile, header, file))
+			{
+				SABA_ERROR("WriteSoftbody Fail.");
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	bool WritePMXFile(const PMXFile * pmxFile, const char* filename)
+	{
+		File file;
+		if (!file.Create(filename))
+		{
+			SABA_INFO("PMX File Create Fail. {}", filename);
+			return false;
+		}
+
+		if (!WritePMXFile(pmxFile, file))
+		{
+			SABA_INFO("PMX File Write Fail. {}", filename);
+			return false;
+		}
+		SABA_INFO("PMX File Write Successed. {}", filename);
+
+		return true;
+	}
 
 }
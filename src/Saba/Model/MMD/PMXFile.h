@@ -7,6 +7,7 @@
 #define SABA_MODEL_PMXFILE_H_
 
 #include "MMDFileString.h"
+#include "MMDReadFlags.h"
 
 #include <cstdint>
 #include <string>
@@ -593,7 +594,13 @@ namespace saba
 		std::vector<PMXSoftbody>	m_softbodies;
 	};
 
-	bool ReadPMXFile(PMXFile* pmdFile, const char* filename);
+	// readFlags (MMDReadFlags) に含まれないセクションは読み飛ばす
+	bool ReadPMXFile(PMXFile* pmdFile, const char* filename, uint32_t readFlags = MMDReadFlags::All);
+	bool ReadPMXFile(PMXFile* pmdFile, BinaryReader& file, uint32_t readFlags = MMDReadFlags::All);
+
+	// 文字列は UTF-8、インデックスサイズは要素数から決めて書き出す
+	bool WritePMXFile(const PMXFile* pmxFile, const char* filename);
+	bool WritePMXFile(const PMXFile* pmxFile, File& file);
 }
 
 #endif // !SABA_MODEL_PMXFILE_H_
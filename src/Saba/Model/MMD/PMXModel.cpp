@@ -11,6 +11,7 @@
 
 #include <Saba/Base/Path.h>
 #include <Saba/Base/File.h>
+#include <Saba/Base/BinaryReader.h>
 #include <Saba/Base/Log.h>
 #include <Saba/Base/Singleton.h>
 
@@ -27,11 +28,126 @@
 #include <thread>
 #include <mutex>
 #include <condition_variable>
+#include <cstring>
 
 namespace saba
 {
+	namespace
+	{
+		const char		RuntimeCacheMagic[8] = { 'S', 'a', 'b', 'a', 'P', 'M', 'X', 'R' };
+		const uint32_t	RuntimeCacheVersion = 2;
+
+		template <typename T>
+		void WriteArray(const std::vector<T>& values, File& file)
+		{
+			uint32_t count = uint32_t(values.size());
+			file.Write(&count);
+			if (!values.empty())
+			{
+				file.Write(values.data(), values.size());
+			}
+		}
+
+		template <typename T>
+		bool ReadArray(std::vector<T>* values, BinaryReader& reader)
+		{
+			uint32_t count = 0;
+			if (!reader.Read(&count))
+			{
+				return false;
+			}
+			if (count > size_t(reader.GetSize() - reader.Tell()) / sizeof(T))
+			{
+				return false;
+			}
+			values->resize(count);
+			return count == 0 || reader.Read(values->data(), count);
+		}
+
+		void WriteString(const std::string& str, File& file)
+		{
+			uint32_t size = uint32_t(str.size());
+			file.Write(&size);
+			if (size != 0)
+			{
+				file.Write(str.data(), size);
+			}
+		}
+
+		bool ReadString(std::string* str, BinaryReader& reader)
+		{
+			uint32_t size = 0;
+			if (!reader.Read(&size))
+			{
+				return false;
+			}
+			const char* data = reader.ReadSpan(size);
+			if (data == nullptr && size != 0)
+			{
+				return false;
+			}
+			str->assign(data, size);
+			return true;
+		}
+
+		void WriteMaterial(const MMDMaterial& mat, File& file)
+		{
+			uint8_t flags[5] = {
+				mat.m_edgeFlag,
+				uint8_t(mat.m_bothFace ? 1 : 0),
+				uint8_t(mat.m_groundShadow ? 1 : 0),
+				uint8_t(mat.m_shadowCaster ? 1 : 0),
+				uint8_t(mat.m_shadowReceiver ? 1 : 0),
+			};
+			int32_t spTextureMode = int32_t(mat.m_spTextureMode);
+			file.Write(&mat.m_diffuse);
+			file.Write(&mat.m_alpha);
+			file.Write(&mat.m_specular);
+			file.Write(&mat.m_specularPower);
+			file.Write(&mat.m_ambient);
+			file.Write(&mat.m_edgeSize);
+			file.Write(&mat.m_edgeColor);
+			file.Write(&spTextureMode);
+			file.Write(flags, 5);
+			WriteString(mat.m_texture, file);
+			WriteString(mat.m_spTexture, file);
+			WriteString(mat.m_toonTexture, file);
+		}
+
+		bool ReadMaterial(MMDMaterial* mat, BinaryReader& reader)
+		{
+			uint8_t flags[5];
+			int32_t spTextureMode;
+			reader.Read(&mat->m_diffuse);
+			reader.Read(&mat->m_alpha);
+			reader.Read(&mat->m_specular);
+			reader.Read(&mat->m_specularPower);
+			reader.Read(&mat->m_ambient);
+			reader.Read(&mat->m_edgeSize);
+			reader.Read(&mat->m_edgeColor);
+			reader.Read(&spTextureMode);
+			reader.Read(flags, 5);
+			ReadString(&mat->m_texture, reader);
+			ReadString(&mat->m_spTexture, reader);
+			ReadString(&mat->m_toonTexture, reader);
+			if (reader.IsBad())
+			{
+				return false;
+			}
+
+			mat->m_spTextureMode = MMDMaterial::SphereTextureMode(spTextureMode);
+			mat->m_edgeFlag = flags[0];
+			mat->m_bothFace = flags[1] != 0;
+			mat->m_groundShadow = flags[2] != 0;
+			mat->m_shadowCaster = flags[3] != 0;
+			mat->m_shadowReceiver = flags[4] != 0;
+			return true;
+		}
+	}
+
 	PMXModel::PMXModel()
 		: m_parallelUpdateCount(0)
+		, m_runtimeCache(false)
 	{
 	}
 
@@ -140,6 +256,16 @@ namespace saba
 		EndMorphMaterial();
 	}
 
+	void PMXModel::UpdateBoneMorphAnimation()
+	{
+		const auto& morphs = (*m_morphMan.GetMorphs());
+		for (size_t i = 0; i < morphs.size(); i++)
+		{
+			const auto& morph = morphs[i];
+			MorphBoneOnly(morph.get(), morph->GetWeight());
+		}
+	}
+
 	void PMXModel::UpdateNodeAnimation(bool afterPhysicsAnim)
 	{
 		for (auto pmxNode : m_sortedNodes)
@@ -209,6 +335,8 @@ namespace saba
 			return;
 		}
 
+		physicsMan->ResetAsyncPhysics();
+
 		auto rigidbodys = physicsMan->GetRigidBodys();
 		for (auto& rb : (*rigidbodys))
 		{
@@ -252,31 +380,27 @@ namespace saba
 			return;
 		}
 
-		auto rigidbodys = physicsMan->GetRigidBodys();
-		for (auto& rb : (*rigidbodys))
+		if (physicsMan->IsAsyncPhysics())
 		{
-			rb->SetActivation(true);
+			// 前回の更新結果を反映し、今回の姿勢で次の更新を開始する
+			physicsMan->CaptureAsyncPhysics();
+			physicsMan->WaitAsyncPhysics();
+			BeginPhysicsAnimation();
+			EndPhysicsAnimation();
+			physicsMan->KickAsyncPhysics(elapsed);
+			return;
 		}
 
-		physics->Update(elapsed);
+		BeginPhysicsAnimation();
 
-		for (auto& rb : (*rigidbodys))
+		// 共有された Physics World は呼び出し側で更新する
+		// (LOD で全ての剛体がボーン追従の場合は更新しない)
+		if (!physicsMan->IsSharedPhysics() && !physicsMan->IsLODSleeping())
 		{
-			rb->ReflectGlobalTransform();
+			physics->Update(elapsed);
 		}
 
-		for (auto& rb : (*rigidbodys))
-		{
-			rb->CalcLocalTransform();
-		}
-
-		for (const auto& node : (*m_nodeMan.GetNodes()))
-		{
-			if (node->GetParent() == nullptr)
-			{
-				node->UpdateGlobalTransform();
-			}
-		}
+		EndPhysicsAnimation();
 	}
 
 	void PMXModel::Update()
@@ -324,18 +448,61 @@ namespace saba
 		m_parallelUpdateCount = parallelCount;
 	}
 
-	bool PMXModel::Load(const std::string& filepath, const std::string& mmdDataDir)
+	bool PMXModel::Load(const std::string& filepath, const std::string& mmdDataDir, uint32_t readFlags)
 	{
 		Destroy();
 
+		std::string dirPath = PathUtil::GetDirectoryName(filepath);
+
+		// PMXModel では Mesh, Bone は常に必要で、表示枠は使用しない
+		readFlags |= MMDReadFlags::Mesh | MMDReadFlags::Bone;
+		readFlags &= ~uint32_t(MMDReadFlags::DisplayFrame);
+
+		std::string cachePath;
+		uint64_t sourceHash = 0;
+		if (m_runtimeCache)
+		{
+			sourceHash = CalcFileHash(filepath.c_str());
+			if (sourceHash != 0)
+			{
+				cachePath = GetRuntimeCachePath(filepath, sourceHash);
+				PMXFile pmx;
+				std::vector<int32_t> sortedNodeOrder;
+				if (LoadRuntimeCache(cachePath, sourceHash, readFlags, dirPath, mmdDataDir, &pmx, &sortedNodeOrder))
+				{
+					SABA_INFO("PMX Runtime Cache Loaded. {}", cachePath);
+					return Setup(pmx, &sortedNodeOrder, readFlags);
+				}
+				Destroy();
+			}
+		}
+
 		PMXFile pmx;
-		if (!ReadPMXFile(&pmx, filepath.c_str()))
+		if (!ReadPMXFile(&pmx, filepath.c_str(), readFlags))
 		{
 			return false;
 		}
 
-		std::string dirPath = PathUtil::GetDirectoryName(filepath);
+		if (!SetupMesh(pmx, dirPath, mmdDataDir))
+		{
+			return false;
+		}
 
+		if (!Setup(pmx, nullptr, readFlags))
+		{
+			return false;
+		}
+
+		if (!cachePath.empty())
+		{
+			SaveRuntimeCache(cachePath, sourceHash, readFlags, dirPath, mmdDataDir, pmx);
+		}
+
+		return true;
+	}
+
+	bool PMXModel::SetupMesh(const PMXFile& pmx, const std::string& dirPath, const std::string& mmdDataDir)
+	{
 		size_t vertexCount = pmx.m_vertices.size();
 		m_positions.reserve(vertexCount);
 		m_normals.reserve(vertexCount);
@@ -428,11 +595,6 @@ namespace saba
 			m_bboxMax = glm::max(m_bboxMax, pos);
 			m_bboxMin = glm::min(m_bboxMin, pos);
 		}
-		m_morphPositions.resize(m_positions.size());
-		m_morphUVs.resize(m_positions.size());
-		m_updatePositions.resize(m_positions.size());
-		m_updateNormals.resize(m_normals.size());
-		m_updateUVs.resize(m_uvs.size());
 
 
 		m_indexElementSize = pmx.m_header.m_vertexIndexSize;
@@ -572,6 +734,49 @@ namespace saba
 
 			beginIndex = beginIndex + pmxMat.m_numFaceVertices;
 		}
+
+		// Position, UV Morph
+		for (const auto& pmxMorph : pmx.m_morphs)
+		{
+			if (pmxMorph.m_morphType == PMXMorphType::Position)
+			{
+				PositionMorphData morphData;
+				morphData.m_morphVertices.reserve(pmxMorph.m_positionMorph.size());
+				for (const auto& vtx : pmxMorph.m_positionMorph)
+				{
+					PositionMorph morphVtx;
+					morphVtx.m_index = vtx.m_vertexIndex;
+					morphVtx.m_position = vtx.m_position * glm::vec3(1, 1, -1);
+					morphData.m_morphVertices.push_back(morphVtx);
+				}
+				m_positionMorphDatas.emplace_back(std::move(morphData));
+			}
+			else if (pmxMorph.m_morphType == PMXMorphType::UV)
+			{
+				UVMorphData morphData;
+				morphData.m_morphUVs.reserve(pmxMorph.m_uvMorph.size());
+				for (const auto& uv : pmxMorph.m_uvMorph)
+				{
+					UVMorph morphUV;
+					morphUV.m_index = uv.m_vertexIndex;
+					morphUV.m_uv = uv.m_uv;
+					morphData.m_morphUVs.push_back(morphUV);
+				}
+				m_uvMorphDatas.emplace_back(std::move(morphData));
+			}
+		}
+
+		return true;
+	}
+
+	bool PMXModel::Setup(const PMXFile& pmx, const std::vector<int32_t>* sortedNodeOrder, uint32_t readFlags)
+	{
+		m_morphPositions.resize(m_positions.size());
+		m_morphUVs.resize(m_positions.size());
+		m_updatePositions.resize(m_positions.size());
+		m_updateNormals.resize(m_normals.size());
+		m_updateUVs.resize(m_uvs.size());
+
 		m_initMaterials = m_materials;
 		m_mulMaterialFactors.resize(m_materials.size());
 		m_addMaterialFactors.resize(m_materials.size());
@@ -663,16 +868,27 @@ namespace saba
 
 		m_sortedNodes.clear();
 		m_sortedNodes.reserve(m_nodeMan.GetNodeCount());
-		auto* pmxNodes = m_nodeMan.GetNodes();
-		for (auto& pmxNode : (*pmxNodes))
+		if (sortedNodeOrder != nullptr)
+		{
+			// キャッシュ済みの順序
+			for (auto nodeIdx : (*sortedNodeOrder))
+			{
+				m_sortedNodes.push_back(m_nodeMan.GetNode(nodeIdx));
+			}
+		}
+		else
 		{
-			m_sortedNodes.push_back(pmxNode.get());
+			auto* pmxNodes = m_nodeMan.GetNodes();
+			for (auto& pmxNode : (*pmxNodes))
+			{
+				m_sortedNodes.push_back(pmxNode.get());
+			}
+			std::stable_sort(
+				m_sortedNodes.begin(),
+				m_sortedNodes.end(),
+				[](const PMXNode* x, const PMXNode* y) {return x->GetDeformdepth() < y->GetDeformdepth(); }
+			);
 		}
-		std::stable_sort(
-			m_sortedNodes.begin(),
-			m_sortedNodes.end(),
-			[](const PMXNode* x, const PMXNode* y) {return x->GetDeformdepth() < y->GetDeformdepth(); }
-		);
 
 		// IK
 		for (size_t i = 0; i < pmx.m_bones.size(); i++)
@@ -716,6 +932,9 @@ namespace saba
 		}
 
 		// Morph
+		// Position, UV Morph のデータは SetupMesh (またはキャッシュ) で作成済み
+		size_t positionMorphCount = 0;
+		size_t uvMorphCount = 0;
 		for (const auto& pmxMorph : pmx.m_morphs)
 		{
 			auto morph = m_morphMan.AddMorph();
@@ -725,30 +944,14 @@ namespace saba
 			if (pmxMorph.m_morphType == PMXMorphType::Position)
 			{
 				morph->m_morphType = MorphType::Position;
-				morph->m_dataIndex = m_positionMorphDatas.size();
-				PositionMorphData morphData;
-				for (const auto& vtx : pmxMorph.m_positionMorph)
-				{
-					PositionMorph morphVtx;
-					morphVtx.m_index = vtx.m_vertexIndex;
-					morphVtx.m_position = vtx.m_position * glm::vec3(1, 1, -1);
-					morphData.m_morphVertices.push_back(morphVtx);
-				}
-				m_positionMorphDatas.emplace_back(std::move(morphData));
+				morph->m_dataIndex = positionMorphCount;
+				positionMorphCount++;
 			}
 			else if (pmxMorph.m_morphType == PMXMorphType::UV)
 			{
 				morph->m_morphType = MorphType::UV;
-				morph->m_dataIndex = m_uvMorphDatas.size();
-				UVMorphData morphData;
-				for (const auto& uv : pmxMorph.m_uvMorph)
-				{
-					UVMorph morphUV;
-					morphUV.m_index = uv.m_vertexIndex;
-					morphUV.m_uv = uv.m_uv;
-					morphData.m_morphUVs.push_back(morphUV);
-				}
-				m_uvMorphDatas.emplace_back(std::move(morphData));
+				morph->m_dataIndex = uvMorphCount;
+				uvMorphCount++;
 			}
 			else if (pmxMorph.m_morphType == PMXMorphType::Material)
 			{
@@ -847,58 +1050,314 @@ namespace saba
 		}
 
 		// Physics
-		if (!m_physicsMan.Create())
+		// 読み込まない場合は Physics World を作成しない
+		if ((readFlags & MMDReadFlags::Physics) != 0)
+		{
+			if (!m_physicsMan.Create())
+			{
+				SABA_ERROR("Create Physics Fail.");
+				return false;
+			}
+
+			for (const auto& pmxRB : pmx.m_rigidbodies)
+			{
+				auto rb = m_physicsMan.AddRigidBody();
+				MMDNode* node = nullptr;
+				if (pmxRB.m_boneIndex != -1)
+				{
+					node = m_nodeMan.GetMMDNode(pmxRB.m_boneIndex);
+				}
+				if (!rb->Create(pmxRB, this, node))
+				{
+					SABA_ERROR("Create Rigid Body Fail.\n");
+					return false;
+				}
+				m_physicsMan.GetMMDPhysics()->AddRigidBody(rb);
+			}
+
+			for (const auto& pmxJoint : pmx.m_joints)
+			{
+				if (pmxJoint.m_rigidbodyAIndex != -1 &&
+					pmxJoint.m_rigidbodyBIndex != -1 &&
+					pmxJoint.m_rigidbodyAIndex != pmxJoint.m_rigidbodyBIndex)
+				{
+					auto joint = m_physicsMan.AddJoint();
+					MMDNode* node = nullptr;
+					auto rigidBodys = m_physicsMan.GetRigidBodys();
+					bool ret = joint->CreateJoint(
+						pmxJoint,
+						(*rigidBodys)[pmxJoint.m_rigidbodyAIndex].get(),
+						(*rigidBodys)[pmxJoint.m_rigidbodyBIndex].get()
+					);
+					if (!ret)
+					{
+						SABA_ERROR("Create Joint Fail.\n");
+						return false;
+					}
+					m_physicsMan.GetMMDPhysics()->AddJoint(joint);
+				}
+				else
+				{
+					SABA_WARN("Illegal Joint [{}]", pmxJoint.m_name.c_str());
+				}
+			}
+		}
+
+		ResetPhysics();
+
+		SetupParallelUpdate();
+
+		return true;
+	}
+
+	std::string PMXModel::GetRuntimeCachePath(const std::string& filepath, uint64_t sourceHash) const
+	{
+		if (m_runtimeCacheDir.empty())
 		{
-			SABA_ERROR("Create Physics Fail.");
+			return filepath + ".sabacache";
+		}
+
+		std::stringstream ss;
+		ss << PathUtil::GetFilename(filepath) << "."
+			<< std::hex << std::setfill('0') << std::setw(16) << sourceHash
+			<< ".sabacache";
+		return PathUtil::Combine(m_runtimeCacheDir, ss.str());
+	}
+
+	bool PMXModel::SaveRuntimeCache(
+		const std::string& cachePath,
+		uint64_t sourceHash,
+		uint32_t readFlags,
+		const std::string& dirPath,
+		const std::string& mmdDataDir,
+		const PMXFile& pmx
+	) const
+	{
+		File file;
+		if (!file.Create(cachePath))
+		{
+			SABA_WARN("Failed to create PMX runtime cache. [{}]", cachePath);
 			return false;
 		}
 
-		for (const auto& pmxRB : pmx.m_rigidbodies)
+		uint32_t version = RuntimeCacheVersion;
+		file.Write(RuntimeCacheMagic, sizeof(RuntimeCacheMagic));
+		file.Write(&version);
+		file.Write(&sourceHash);
+		file.Write(&readFlags);
+		// パスは解決済みで保存するため、ディレクトリが変わった場合は作り直す
+		WriteString(dirPath, file);
+		WriteString(mmdDataDir, file);
+
+		// 変換済みの配列
+		WriteArray(m_positions, file);
+		WriteArray(m_normals, file);
+		WriteArray(m_uvs, file);
+		WriteArray(m_vertexBoneInfos, file);
+		file.Write(&m_bboxMin);
+		file.Write(&m_bboxMax);
+
+		uint32_t indexElementSize = uint32_t(m_indexElementSize);
+		uint32_t indexCount = uint32_t(m_indexCount);
+		file.Write(&indexElementSize);
+		file.Write(&indexCount);
+		WriteArray(m_indices, file);
+
+		uint32_t materialCount = uint32_t(m_materials.size());
+		file.Write(&materialCount);
+		for (const auto& mat : m_materials)
 		{
-			auto rb = m_physicsMan.AddRigidBody();
-			MMDNode* node = nullptr;
-			if (pmxRB.m_boneIndex != -1)
-			{
-				node = m_nodeMan.GetMMDNode(pmxRB.m_boneIndex);
-			}
-			if (!rb->Create(pmxRB, this, node))
+			WriteMaterial(mat, file);
+		}
+		WriteArray(m_subMeshes, file);
+
+		uint32_t positionMorphCount = uint32_t(m_positionMorphDatas.size());
+		file.Write(&positionMorphCount);
+		for (const auto& morphData : m_positionMorphDatas)
+		{
+			WriteArray(morphData.m_morphVertices, file);
+		}
+		uint32_t uvMorphCount = uint32_t(m_uvMorphDatas.size());
+		file.Write(&uvMorphCount);
+		for (const auto& morphData : m_uvMorphDatas)
+		{
+			WriteArray(morphData.m_morphUVs, file);
+		}
+
+		std::vector<int32_t> sortedNodeOrder;
+		sortedNodeOrder.reserve(m_sortedNodes.size());
+		for (const auto node : m_sortedNodes)
+		{
+			sortedNodeOrder.push_back(int32_t(node->GetIndex()));
+		}
+		WriteArray(sortedNodeOrder, file);
+
+		// ノード、IK、Morph、Physics を作るための PMX (頂点、面、Position/UV Morph を除く)
+		PMXFile setupPmx;
+		setupPmx.m_header = pmx.m_header;
+		setupPmx.m_info = pmx.m_info;
+		setupPmx.m_textures = pmx.m_textures;
+		setupPmx.m_materials = pmx.m_materials;
+		setupPmx.m_bones = pmx.m_bones;
+		setupPmx.m_morphs = pmx.m_morphs;
+		setupPmx.m_displayFrames = pmx.m_displayFrames;
+		setupPmx.m_rigidbodies = pmx.m_rigidbodies;
+		setupPmx.m_joints = pmx.m_joints;
+		for (auto& morph : setupPmx.m_morphs)
+		{
+			morph.m_positionMorph.clear();
+			morph.m_uvMorph.clear();
+		}
+		if (!WritePMXFile(&setupPmx, file) || file.IsBad())
+		{
+			SABA_WARN("Failed to write PMX runtime cache. [{}]", cachePath);
+			return false;
+		}
+
+		SABA_INFO("PMX Runtime Cache Saved. {}", cachePath);
+
+		return true;
+	}
+
+	bool PMXModel::LoadRuntimeCache(
+		const std::string& cachePath,
+		uint64_t sourceHash,
+		uint32_t readFlags,
+		const std::string& dirPath,
+		const std::string& mmdDataDir,
+		PMXFile* pmx,
+		std::vector<int32_t>* sortedNodeOrder
+	)
+	{
+		BinaryReader reader;
+		if (!reader.Open(cachePath))
+		{
+			return false;
+		}
+
+		char magic[8];
+		uint32_t version = 0;
+		uint64_t fileSourceHash = 0;
+		uint32_t fileReadFlags = 0;
+		reader.Read(magic, sizeof(magic));
+		reader.Read(&version);
+		reader.Read(&fileSourceHash);
+		reader.Read(&fileReadFlags);
+		if (reader.IsBad() ||
+			std::memcmp(magic, RuntimeCacheMagic, sizeof(magic)) != 0 ||
+			version != RuntimeCacheVersion)
+		{
+			SABA_WARN("Invalid PMX runtime cache. [{}]", cachePath);
+			return false;
+		}
+
+		std::string fileDirPath;
+		std::string fileMMDDataDir;
+		ReadString(&fileDirPath, reader);
+		ReadString(&fileMMDDataDir, reader);
+		if (fileSourceHash != sourceHash ||
+			fileReadFlags != readFlags ||
+			fileDirPath != dirPath ||
+			fileMMDDataDir != mmdDataDir)
+		{
+			SABA_INFO("PMX runtime cache is out of date. [{}]", cachePath);
+			return false;
+		}
+
+		bool ret = ReadArray(&m_positions, reader) &&
+			ReadArray(&m_normals, reader) &&
+			ReadArray(&m_uvs, reader) &&
+			ReadArray(&m_vertexBoneInfos, reader) &&
+			reader.Read(&m_bboxMin) &&
+			reader.Read(&m_bboxMax);
+
+		uint32_t indexElementSize = 0;
+		uint32_t indexCount = 0;
+		ret = ret &&
+			reader.Read(&indexElementSize) &&
+			reader.Read(&indexCount) &&
+			ReadArray(&m_indices, reader);
+		m_indexElementSize = indexElementSize;
+		m_indexCount = indexCount;
+
+		uint32_t materialCount = 0;
+		ret = ret && reader.Read(&materialCount);
+		if (ret)
+		{
+			m_materials.resize(materialCount);
+			for (auto& mat : m_materials)
 			{
-				SABA_ERROR("Create Rigid Body Fail.\n");
-				return false;
+				if (!ReadMaterial(&mat, reader))
+				{
+					ret = false;
+					break;
+				}
 			}
-			m_physicsMan.GetMMDPhysics()->AddRigidBody(rb);
 		}
+		ret = ret && ReadArray(&m_subMeshes, reader);
 
-		for (const auto& pmxJoint : pmx.m_joints)
+		uint32_t positionMorphCount = 0;
+		ret = ret && reader.Read(&positionMorphCount);
+		if (ret)
 		{
-			if (pmxJoint.m_rigidbodyAIndex != -1 &&
-				pmxJoint.m_rigidbodyBIndex != -1 &&
-				pmxJoint.m_rigidbodyAIndex != pmxJoint.m_rigidbodyBIndex)
+			m_positionMorphDatas.resize(positionMorphCount);
+			for (auto& morphData : m_positionMorphDatas)
 			{
-				auto joint = m_physicsMan.AddJoint();
-				MMDNode* node = nullptr;
-				auto rigidBodys = m_physicsMan.GetRigidBodys();
-				bool ret = joint->CreateJoint(
-					pmxJoint,
-					(*rigidBodys)[pmxJoint.m_rigidbodyAIndex].get(),
-					(*rigidBodys)[pmxJoint.m_rigidbodyBIndex].get()
-				);
-				if (!ret)
+				if (!ReadArray(&morphData.m_morphVertices, reader))
 				{
-					SABA_ERROR("Create Joint Fail.\n");
-					return false;
+					ret = false;
+					break;
 				}
-				m_physicsMan.GetMMDPhysics()->AddJoint(joint);
 			}
-			else
+		}
+		uint32_t uvMorphCount = 0;
+		ret = ret && reader.Read(&uvMorphCount);
+		if (ret)
+		{
+			m_uvMorphDatas.resize(uvMorphCount);
+			for (auto& morphData : m_uvMorphDatas)
 			{
-				SABA_WARN("Illegal Joint [{}]", pmxJoint.m_name.c_str());
+				if (!ReadArray(&morphData.m_morphUVs, reader))
+				{
+					ret = false;
+					break;
+				}
 			}
 		}
+		ret = ret && ReadArray(sortedNodeOrder, reader);
 
-		ResetPhysics();
+		if (!ret ||
+			m_normals.size() != m_positions.size() ||
+			m_uvs.size() != m_positions.size() ||
+			m_vertexBoneInfos.size() != m_positions.size() ||
+			m_indices.size() != size_t(m_indexElementSize) * m_indexCount)
+		{
+			SABA_WARN("Failed to read PMX runtime cache. [{}]", cachePath);
+			return false;
+		}
 
-		SetupParallelUpdate();
+		const size_t pmxSize = size_t(reader.GetSize() - reader.Tell());
+		const char* pmxData = reader.ReadSpan(pmxSize);
+		BinaryReader pmxReader(pmxData, pmxSize);
+		if (pmxData == nullptr || !ReadPMXFile(pmx, pmxReader))
+		{
+			SABA_WARN("Failed to read PMX runtime cache. [{}]", cachePath);
+			return false;
+		}
+
+		if (sortedNodeOrder->size() != pmx->m_bones.size())
+		{
+			SABA_WARN("Failed to read PMX runtime cache. [{}]", cachePath);
+			return false;
+		}
+		for (auto nodeIdx : (*sortedNodeOrder))
+		{
+			if (nodeIdx < 0 || size_t(nodeIdx) >= pmx->m_bones.size())
+			{
+				SABA_WARN("Failed to read PMX runtime cache. [{}]", cachePath);
+				return false;
+			}
+		}
 
 		return true;
 	}
@@ -915,6 +1374,10 @@ namespace saba
 
 		m_indices.clear();
 
+		m_positionMorphDatas.clear();
+		m_uvMorphDatas.clear();
+
+		m_sortedNodes.clear();
 		m_nodeMan.GetNodes()->clear();
 
 		m_updateRanges.clear();
@@ -1154,6 +1617,32 @@ namespace saba
 		}
 	}
 
+	void PMXModel::MorphBoneOnly(PMXMorph* morph, float weight)
+	{
+		switch (morph->m_morphType)
+		{
+		case MorphType::Bone:
+			MorphBone(
+				m_boneMorphDatas[morph->m_dataIndex],
+				weight
+			);
+			break;
+		case MorphType::Group:
+		{
+			auto& groupMorphData = m_groupMorphDatas[morph->m_dataIndex];
+			for (const auto& groupMorph : groupMorphData.m_groupMorphs)
+			{
+				if (groupMorph.m_morphIndex == -1) { continue; }
+				auto& elemMorph = (*m_morphMan.GetMorphs())[groupMorph.m_morphIndex];
+				MorphBoneOnly(elemMorph.get(), groupMorph.m_weight * weight);
+			}
+			break;
+		}
+		default:
+			break;
+		}
+	}
+
 	void PMXModel::MorphPosition(const PositionMorphData & morphData, float weight)
 	{
 		if (weight == 0)
@@ -109,6 +109,7 @@ namespace saba
 		void EndAnimation() override;
 		// Morph
 		void UpdateMorphAnimation() override;
+		void UpdateBoneMorphAnimation() override;
 		// ノードを更新する
 		void UpdateNodeAnimation(bool afterPhysicsAnim) override;
 		// Physicsを更新する
@@ -118,9 +119,19 @@ namespace saba
 		void Update() override;
 		void SetParallelUpdateHint(uint32_t parallelCount) override;
 
-		bool Load(const std::string& filepath, const std::string& mmdDataDir);
+		// readFlags : MMDReadFlags (Mesh, Bone は常に読み込む。Physics を含まない場合は Physics World を作成しない)
+		bool Load(const std::string& filepath, const std::string& mmdDataDir, uint32_t readFlags = MMDReadFlags::All);
 		void Destroy();
 
+		// 変換済みの頂点、インデックス、Morph 等をキャッシュし、次回の Load で読み込む
+		// cacheDir が空の場合はモデルと同じディレクトリに <model>.sabacache を作成する
+		void EnableRuntimeCache(bool enable, const std::string& cacheDir = std::string())
+		{
+			m_runtimeCache = enable;
+			m_runtimeCacheDir = cacheDir;
+		}
+		bool IsRuntimeCacheEnabled() const { return m_runtimeCache; }
+
 		const glm::vec3& GetBBoxMin() const { return m_bboxMin; }
 		const glm::vec3& GetBBoxMax() const { return m_bboxMax; }
 
@@ -155,6 +166,9 @@ namespace saba
 			};
 		};
 
+		// 頂点ごとのボーンインデックスとウェイト (GetVertexCount 個)
+		const VertexBoneInfo* GetVertexBoneInfos() const { return m_vertexBoneInfos.data(); }
+
 	private:
 		struct PositionMorph
 		{
@@ -244,6 +258,28 @@ namespace saba
 		};
 
 	private:
+		bool SetupMesh(const PMXFile& pmx, const std::string& dirPath, const std::string& mmdDataDir);
+		bool Setup(const PMXFile& pmx, const std::vector<int32_t>* sortedNodeOrder, uint32_t readFlags);
+
+		std::string GetRuntimeCachePath(const std::string& filepath, uint64_t sourceHash) const;
+		bool SaveRuntimeCache(
+			const std::string& cachePath,
+			uint64_t sourceHash,
+			uint32_t readFlags,
+			const std::string& dirPath,
+			const std::string& mmdDataDir,
+			const PMXFile& pmx
+		) const;
+		bool LoadRuntimeCache(
+			const std::string& cachePath,
+			uint64_t sourceHash,
+			uint32_t readFlags,
+			const std::string& dirPath,
+			const std::string& mmdDataDir,
+			PMXFile* pmx,
+			std::vector<int32_t>* sortedNodeOrder
+		);
+
 		void SetupParallelUpdate();
 		void Update(const UpdateRange& range);
 
@@ -258,6 +294,8 @@ namespace saba
 		void MorphMaterial(const MaterialMorphData& morphData, float weight);
 
 		void MorphBone(const BoneMorphData& morphData, float weight);
+		// グループモーフ内のボーンモーフのみ処理する
+		void MorphBoneOnly(PMXMorph* morph, float weight);
 
 	private:
 		std::vector<glm::vec3>	m_positions;
@@ -303,6 +341,9 @@ namespace saba
 		uint32_t							m_parallelUpdateCount;
 		std::vector<UpdateRange>			m_updateRanges;
 		std::vector<std::future<void>>		m_parallelUpdateFutures;
+
+		bool		m_runtimeCache;
+		std::string	m_runtimeCacheDir;
 	};
 }
 
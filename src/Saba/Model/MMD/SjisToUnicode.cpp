@@ -5,10 +5,18 @@
 
 #include "SjisToUnicode.h"
 
+#include <algorithm>
 #include <cstdint>
+#include <cstring>
+#include <memory>
 #include <string>
 #include <tuple>
 
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SABA_SJIS_SSE2 1
+#include <emmintrin.h>
+#endif
+
 namespace
 {
 	const int ASCIIBegin = 0x00;
@@ -9337,4 +9345,193 @@ namespace saba
 	{
 		return ConvertSjisToCharTString<char32_t>(sjisCode);
 	}
+
+	namespace
+	{
+		const int SjisSecondCount = SjisSecondEnd - SjisSecondBegin + 1;
+		const int SjisFirstCount1 = SjisFirstEnd1 - SjisFirstBegin1 + 1;
+		const int SjisFirstCount2 = SjisFirstEnd2 - SjisFirstBegin2 + 1;
+		const uint8_t NotSjisFirstByte = 0xFF;
+
+		// UTF-8 に変換済みの 1 文字 (3 バイト以内)
+		struct U8Char
+		{
+			uint8_t	m_bytes[3];
+			uint8_t	m_length;
+		};
+
+		/*
+		SJIS から UTF-8 への変換表。
+		1 バイト文字と 2 バイト文字の先頭バイトを m_single で引き、
+		2 バイト文字は m_firstIndex で求めた行を m_double で引く。
+		*/
+		struct SjisToU8Table
+		{
+			U8Char	m_single[256];
+			uint8_t	m_firstIndex[256];
+			U8Char	m_double[(SjisFirstCount1 + SjisFirstCount2) * SjisSecondCount];
+		};
+
+		U8Char MakeU8Char(char16_t ch)
+		{
+			// 変換できない文字は ・ にする (ConvertSjisToCharTString と同じ)
+			if (ch == 0xFFFF)
+			{
+				ch = 0x30FB;
+			}
+			U8Char u8Ch = {};
+			if (ch < 0x80)
+			{
+				u8Ch.m_bytes[0] = uint8_t(ch);
+				u8Ch.m_length = 1;
+			}
+			else if (ch < 0x800)
+			{
+				u8Ch.m_bytes[0] = uint8_t(0xC0 | (ch >> 6));
+				u8Ch.m_bytes[1] = uint8_t(0x80 | (ch & 0x3F));
+				u8Ch.m_length = 2;
+			}
+			else
+			{
+				u8Ch.m_bytes[0] = uint8_t(0xE0 | (ch >> 12));
+				u8Ch.m_bytes[1] = uint8_t(0x80 | ((ch >> 6) & 0x3F));
+				u8Ch.m_bytes[2] = uint8_t(0x80 | (ch & 0x3F));
+				u8Ch.m_length = 3;
+			}
+			return u8Ch;
+		}
+
+		SjisToU8Table* CreateSjisToU8Table()
+		{
+			auto table = new SjisToU8Table();
+			for (int ch = 0; ch < 256; ch++)
+			{
+				auto ret = ConvertSjisToU16Char(ch, 0);
+				table->m_single[ch] = MakeU8Char(std::get<0>(ret));
+				table->m_firstIndex[ch] = NotSjisFirstByte;
+				if (IsSjis1stByte1(ch))
+				{
+					table->m_firstIndex[ch] = uint8_t(ch - SjisFirstBegin1);
+				}
+				else if (IsSjis1stByte2(ch))
+				{
+					table->m_firstIndex[ch] = uint8_t(SjisFirstCount1 + ch - SjisFirstBegin2);
+				}
+			}
+			for (int code1 = 0; code1 < SjisFirstCount1; code1++)
+			{
+				for (int code2 = 0; code2 < SjisSecondCount; code2++)
+				{
+					table->m_double[code1 * SjisSecondCount + code2] = MakeU8Char(SjisTable1[code1][code2]);
+				}
+			}
+			for (int code1 = 0; code1 < SjisFirstCount2; code1++)
+			{
+				for (int code2 = 0; code2 < SjisSecondCount; code2++)
+				{
+					table->m_double[(SjisFirstCount1 + code1) * SjisSecondCount + code2] = MakeU8Char(SjisTable2[code1][code2]);
+				}
+			}
+			return table;
+		}
+
+		const SjisToU8Table& GetSjisToU8Table()
+		{
+			static const std::unique_ptr<SjisToU8Table> table(CreateSjisToU8Table());
+			return *table;
+		}
+
+		const size_t AsciiBlockSize = 16;
+
+		// 16 バイトがすべて変換の不要な ASCII (0x01 - 0x7E) の場合はそのままコピーする
+		bool CopySjisAsciiBlock(const char* src, char* dst)
+		{
+#if SABA_SJIS_SSE2
+			__m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+			int valid = _mm_movemask_epi8(_mm_cmpgt_epi8(data, _mm_setzero_si128()));
+			int del = _mm_movemask_epi8(_mm_cmpeq_epi8(data, _mm_set1_epi8(0x7F)));
+			if (valid != 0xFFFF || del != 0)
+			{
+				return false;
+			}
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst), data);
+#else // SABA_SJIS_SSE2
+			for (size_t i = 0; i < AsciiBlockSize; i++)
+			{
+				uint8_t ch = uint8_t(src[i]);
+				if (ch == 0 || ch > ASCIIEnd)
+				{
+					return false;
+				}
+			}
+			memcpy(dst, src, AsciiBlockSize);
+#endif // SABA_SJIS_SSE2
+			return true;
+		}
+	}
+
+	size_t ConvertSjisToU8(const char* sjisCode, size_t sjisLength, char* u8Buffer)
+	{
+		if (sjisCode == nullptr || u8Buffer == nullptr)
+		{
+			return 0;
+		}
+
+		const auto& table = GetSjisToU8Table();
+		const uint8_t* src = reinterpret_cast<const uint8_t*>(sjisCode);
+		char* dst = u8Buffer;
+		size_t i = 0;
+		while (i < sjisLength)
+		{
+			if (i + AsciiBlockSize <= sjisLength && CopySjisAsciiBlock(sjisCode + i, dst))
+			{
+				i += AsciiBlockSize;
+				dst += AsciiBlockSize;
+				continue;
+			}
+
+			// ASCII 以外を含むブロックは 1 文字ずつ変換する
+			const size_t blockEnd = std::min(i + AsciiBlockSize, sjisLength);
+			while (i < blockEnd)
+			{
+				const uint8_t ch1 = src[i];
+				if (ch1 == 0)
+				{
+					return size_t(dst - u8Buffer);
+				}
+
+				const U8Char* u8Ch = &table.m_single[ch1];
+				size_t sjisCount = 1;
+				const uint8_t firstIndex = table.m_firstIndex[ch1];
+				if (firstIndex != NotSjisFirstByte && i + 1 < sjisLength)
+				{
+					const uint8_t ch2 = src[i + 1];
+					if (IsSjis2ndByte(ch2))
+					{
+						u8Ch = &table.m_double[firstIndex * SjisSecondCount + (ch2 - SjisSecondBegin)];
+						sjisCount = 2;
+					}
+				}
+
+				// 1 文字あたり 1 バイト以上消費するので、3 バイト書き込んでもバッファーを超えない
+				memcpy(dst, u8Ch->m_bytes, 3);
+				dst += u8Ch->m_length;
+				i += sjisCount;
+			}
+		}
+		return size_t(dst - u8Buffer);
+	}
+
+	std::string ConvertSjisToU8String(const char* sjisCode)
+	{
+		if (sjisCode == nullptr)
+		{
+			return std::string();
+		}
+
+		const size_t sjisLength = strlen(sjisCode);
+		std::string u8Str(sjisLength * SjisToU8MaxBytesPerByte, '\0');
+		u8Str.resize(ConvertSjisToU8(sjisCode, sjisLength, &u8Str[0]));
+		return u8Str;
+	}
 }
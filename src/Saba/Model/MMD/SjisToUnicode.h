@@ -7,12 +7,24 @@
 #define SABA_MODEL_MMD_SJISTOUNICODE_H_
 
 #include <string>
+#include <cstddef>
 
 namespace saba
 {
 	char16_t ConvertSjisToU16Char(int ch);
 	std::u16string ConvertSjisToU16String(const char* sjisCode);
 	std::u32string ConvertSjisToU32String(const char* sjisCode);
+
+	// SJIS の 1 バイトあたりの UTF-8 の最大バイト数
+	const size_t SjisToU8MaxBytesPerByte = 3;
+
+	/*
+	SJIS を UTF-8 に直接変換する (1 パス、メモリ確保なし)。
+	sjisLength バイトか終端文字のどちらかに達するまで変換し、書き込んだバイト数を返す。
+	u8Buffer には sjisLength * SjisToU8MaxBytesPerByte バイトの領域が必要 (終端文字は書き込まない)。
+	*/
+	size_t ConvertSjisToU8(const char* sjisCode, size_t sjisLength, char* u8Buffer);
+	std::string ConvertSjisToU8String(const char* sjisCode);
 }
 
 #endif // !SABA_MODEL_MMD_SJISTOUNICODE_H_
@@ -10,7 +10,9 @@
 
 #include <algorithm>
 #include <iterator>
-#include <map>
+#include <cstring>
+#include <cmath>
+#include <unordered_map>
 #include <glm/gtc/matrix_transform.hpp>
 
 namespace saba
@@ -33,6 +35,224 @@ namespace saba
 			const glm::mat3 invZ = glm::scale(glm::mat4(1), glm::vec3(1, 1, -1));
 			return invZ * m * invZ;
 		}
+
+		// VMD の生の名前 (SJIS) 用のハッシュ。終端以降のゴミは無視する
+		template <size_t Size>
+		struct VMDStringHash
+		{
+			size_t operator()(const VMDString<Size>& str) const
+			{
+				// FNV-1a
+				uint64_t hash = 14695981039346656037ull;
+				for (size_t i = 0; i < Size && str.m_buffer[i] != '\0'; i++)
+				{
+					hash ^= uint8_t(str.m_buffer[i]);
+					hash *= 1099511628211ull;
+				}
+				return size_t(hash);
+			}
+		};
+
+		template <size_t Size>
+		struct VMDStringEqual
+		{
+			bool operator()(const VMDString<Size>& a, const VMDString<Size>& b) const
+			{
+				return std::strncmp(a.m_buffer, b.m_buffer, Size) == 0;
+			}
+		};
+
+		/*
+		VMD のレコードをコントローラーに振り分ける。
+		生の名前をキーにしてコントローラーを引くので、
+		SJIS -> UTF-8 の変換は名前の種類ごとに一度だけ行う。
+		モデルに存在しない名前も nullptr として覚えておく。
+		*/
+		template <typename ControllerType, size_t Size>
+		class ControllerBinder
+		{
+		public:
+			using ControllerPtr = std::unique_ptr<ControllerType>;
+
+			template <typename GetNameFunc>
+			ControllerBinder(std::vector<ControllerPtr>& controllers, GetNameFunc getName)
+				: m_controllers(controllers)
+			{
+				for (const auto& ctrl : m_controllers)
+				{
+					m_nameMap.emplace(getName(*ctrl), ctrl.get());
+				}
+			}
+
+			template <typename CreateFunc>
+			ControllerType* Bind(const VMDString<Size>& rawName, CreateFunc createController)
+			{
+				auto findIt = m_rawNameMap.find(rawName);
+				if (findIt != m_rawNameMap.end())
+				{
+					return (*findIt).second;
+				}
+
+				ControllerType* ctrl = nullptr;
+				std::string name = rawName.ToUtf8String();
+				auto nameIt = m_nameMap.find(name);
+				if (nameIt != m_nameMap.end())
+				{
+					ctrl = (*nameIt).second;
+				}
+				else
+				{
+					auto newCtrl = createController(name);
+					if (newCtrl != nullptr)
+					{
+						ctrl = newCtrl.get();
+						m_nameMap.emplace(std::move(name), ctrl);
+						m_controllers.emplace_back(std::move(newCtrl));
+					}
+				}
+				m_rawNameMap.emplace(rawName, ctrl);
+				return ctrl;
+			}
+
+		private:
+			using RawNameMap = std::unordered_map<
+				VMDString<Size>,
+				ControllerType*,
+				VMDStringHash<Size>,
+				VMDStringEqual<Size>
+			>;
+
+			std::vector<ControllerPtr>&							m_controllers;
+			std::unordered_map<std::string, ControllerType*>	m_nameMap;
+			RawNameMap											m_rawNameMap;
+		};
+
+		// VMD のレコードを受け取り、コントローラーにキーを追加する
+		class VMDAnimationBuilder : public VMDReadHandler
+		{
+		public:
+			VMDAnimationBuilder(
+				MMDModel*										model,
+				std::vector<std::unique_ptr<VMDNodeController>>&	nodeControllers,
+				std::vector<std::unique_ptr<VMDIKController>>&		ikControllers,
+				std::vector<std::unique_ptr<VMDMorphController>>&	morphControllers
+			)
+				: m_model(model)
+				, m_nodeControllers(nodeControllers)
+				, m_ikControllers(ikControllers)
+				, m_morphControllers(morphControllers)
+				, m_nodeBinder(nodeControllers, [](const VMDNodeController& ctrl) { return ctrl.GetNode()->GetName(); })
+				, m_ikBinder(ikControllers, [](const VMDIKController& ctrl) { return ctrl.GetIkSolver()->GetName(); })
+				, m_morphBinder(morphControllers, [](const VMDMorphController& ctrl) { return ctrl.GetMorph()->GetName(); })
+			{
+			}
+
+			void OnMotions(const VMDMotion* motions, size_t count) override
+			{
+				auto createNodeCtrl = [this](const std::string& name)
+				{
+					std::unique_ptr<VMDNodeController> nodeCtrl;
+					auto node = m_model->GetNodeManager()->GetMMDNode(name);
+					if (node != nullptr)
+					{
+						nodeCtrl = std::make_unique<VMDNodeController>();
+						nodeCtrl->SetNode(node);
+					}
+					return nodeCtrl;
+				};
+				for (size_t i = 0; i < count; i++)
+				{
+					const auto& motion = motions[i];
+					auto nodeCtrl = m_nodeBinder.Bind(motion.m_boneName, createNodeCtrl);
+					if (nodeCtrl != nullptr)
+					{
+						VMDNodeAnimationKey key;
+						key.Set(motion);
+						nodeCtrl->AddKey(key);
+					}
+				}
+			}
+
+			void OnMorphs(const VMDMorph* morphs, size_t count) override
+			{
+				auto createMorphCtrl = [this](const std::string& name)
+				{
+					std::unique_ptr<VMDMorphController> morphCtrl;
+					auto* mmdMorph = m_model->GetMorphManager()->GetMorph(name);
+					if (mmdMorph != nullptr)
+					{
+						morphCtrl = std::make_unique<VMDMorphController>();
+						morphCtrl->SetBlendKeyShape(mmdMorph);
+					}
+					return morphCtrl;
+				};
+				for (size_t i = 0; i < count; i++)
+				{
+					const auto& morph = morphs[i];
+					auto morphCtrl = m_morphBinder.Bind(morph.m_blendShapeName, createMorphCtrl);
+					if (morphCtrl != nullptr)
+					{
+						VMDMorphAnimationKey key;
+						key.m_time = int32_t(morph.m_frame);
+						key.m_weight = morph.m_weight;
+						morphCtrl->AddKey(key);
+					}
+				}
+			}
+
+			void OnIK(const VMDIk& ik) override
+			{
+				auto createIKCtrl = [this](const std::string& name)
+				{
+					std::unique_ptr<VMDIKController> ikCtrl;
+					auto* ikSolver = m_model->GetIKManager()->GetMMDIKSolver(name);
+					if (ikSolver != nullptr)
+					{
+						ikCtrl = std::make_unique<VMDIKController>();
+						ikCtrl->SetIKSolver(ikSolver);
+					}
+					return ikCtrl;
+				};
+				for (const auto& ikInfo : ik.m_ikInfos)
+				{
+					auto ikCtrl = m_ikBinder.Bind(ikInfo.m_name, createIKCtrl);
+					if (ikCtrl != nullptr)
+					{
+						VMDIKAnimationKey key;
+						key.m_time = int32_t(ik.m_frame);
+						key.m_enable = ikInfo.m_enable != 0;
+						ikCtrl->AddKey(key);
+					}
+				}
+			}
+
+			// 追加したキーを既存のキーへマージする
+			void Finish()
+			{
+				for (auto& nodeCtrl : m_nodeControllers)
+				{
+					nodeCtrl->SortKeys();
+				}
+				for (auto& ikCtrl : m_ikControllers)
+				{
+					ikCtrl->SortKeys();
+				}
+				for (auto& morphCtrl : m_morphControllers)
+				{
+					morphCtrl->SortKeys();
+				}
+			}
+
+		private:
+			MMDModel*											m_model;
+			std::vector<std::unique_ptr<VMDNodeController>>&	m_nodeControllers;
+			std::vector<std::unique_ptr<VMDIKController>>&		m_ikControllers;
+			std::vector<std::unique_ptr<VMDMorphController>>&	m_morphControllers;
+
+			ControllerBinder<VMDNodeController, 15>		m_nodeBinder;
+			ControllerBinder<VMDIKController, 20>		m_ikBinder;
+			ControllerBinder<VMDMorphController, 15>	m_morphBinder;
+		};
 	} // namespace
 
 	float VMDBezier::EvalX(float t) const
@@ -100,6 +320,7 @@ namespace saba
 
 	VMDNodeController::VMDNodeController()
 		: m_node(nullptr)
+		, m_sortedKeyCount(0)
 		, m_startKeyIndex(0)
 	{
 	}
@@ -174,14 +395,13 @@ namespace saba
 
 	void VMDNodeController::SortKeys()
 	{
-		std::sort(
-			std::begin(m_keys),
-			std::end(m_keys),
-			[](const KeyType& a, const KeyType& b) { return a.m_time < b.m_time; }
-		);
+		MergeSortedKeys(m_keys, m_sortedKeyCount);
+		m_sortedKeyCount = m_keys.size();
 	}
 
 	VMDAnimation::VMDAnimation()
+		: m_maxKeyTime(0)
+		, m_physicsSnapshotInterval(0)
 	{
 	}
 
@@ -193,155 +413,32 @@ namespace saba
 
 	bool VMDAnimation::Add(const VMDFile & vmd)
 	{
-		// Node Controller
-		std::map<std::string, NodeControllerPtr> nodeCtrlMap;
-		for (auto& nodeCtrl : m_nodeControllers)
-		{
-			std::string name = nodeCtrl->GetNode()->GetName();
-			nodeCtrlMap.emplace(std::make_pair(name, std::move(nodeCtrl)));
-		}
-		m_nodeControllers.clear();
-		for (const auto& motion : vmd.m_motions)
-		{
-			std::string nodeName = motion.m_boneName.ToUtf8String();
-			auto findIt = nodeCtrlMap.find(nodeName);
-			VMDNodeController* nodeCtrl = nullptr;
-			if (findIt == std::end(nodeCtrlMap))
-			{
-				auto node = m_model->GetNodeManager()->GetMMDNode(nodeName);
-				if (node != nullptr)
-				{
-					auto val = std::make_pair(
-						nodeName,
-						std::make_unique<VMDNodeController>()
-					);
-					nodeCtrl = val.second.get();
-					nodeCtrl->SetNode(node);
-					nodeCtrlMap.emplace(std::move(val));
-				}
-			}
-			else
-			{
-				nodeCtrl = (*findIt).second.get();
-			}
-
-			if (nodeCtrl != nullptr)
-			{
-				VMDNodeAnimationKey key;
-				key.Set(motion);
-				nodeCtrl->AddKey(key);
-			}
-		}
-		m_nodeControllers.reserve(nodeCtrlMap.size());
-		for (auto& pair : nodeCtrlMap)
-		{
-			pair.second->SortKeys();
-			m_nodeControllers.emplace_back(std::move(pair.second));
-		}
-		nodeCtrlMap.clear();
-
-		// IK Contoroller
-		std::map<std::string, IKControllerPtr> ikCtrlMap;
-		for (auto& ikCtrl : m_ikControllers)
-		{
-			std::string name = ikCtrl->GetIkSolver()->GetName();
-			ikCtrlMap.emplace(std::make_pair(name, std::move(ikCtrl)));
-		}
-		m_ikControllers.clear();
+		VMDAnimationBuilder builder(m_model.get(), m_nodeControllers, m_ikControllers, m_morphControllers);
+		builder.OnMotions(vmd.m_motions.data(), vmd.m_motions.size());
+		builder.OnMorphs(vmd.m_morphs.data(), vmd.m_morphs.size());
 		for (const auto& ik : vmd.m_iks)
 		{
-			for (const auto& ikInfo : ik.m_ikInfos)
-			{
-				std::string ikName = ikInfo.m_name.ToUtf8String();
-				auto findIt = ikCtrlMap.find(ikName);
-				VMDIKController* ikCtrl = nullptr;
-				if (findIt == std::end(ikCtrlMap))
-				{
-					auto* ikSolver = m_model->GetIKManager()->GetMMDIKSolver(ikName);
-					if (ikSolver != nullptr)
-					{
-						auto val = std::make_pair(
-							ikName,
-							std::make_unique<VMDIKController>()
-						);
-						ikCtrl = val.second.get();
-						ikCtrl->SetIKSolver(ikSolver);
-						ikCtrlMap.emplace(std::move(val));
-					}
-				}
-				else
-				{
-					ikCtrl = (*findIt).second.get();
-				}
-
-				if (ikCtrl != nullptr)
-				{
-					VMDIKAnimationKey key;
-					key.m_time = int32_t(ik.m_frame);
-					key.m_enable = ikInfo.m_enable != 0;
-					ikCtrl->AddKey(key);
-				}
-			}
-		}
-		m_ikControllers.reserve(ikCtrlMap.size());
-		for (auto& pair : ikCtrlMap)
-		{
-			pair.second->SortKeys();
-			m_ikControllers.emplace_back(std::move(pair.second));
+			builder.OnIK(ik);
 		}
-		ikCtrlMap.clear();
+		builder.Finish();
 
-		// Morph Controller
-		std::map<std::string, MorphControllerPtr> morphCtrlMap;
-		for (auto& morphCtrl : m_morphControllers)
-		{
-			std::string name = morphCtrl->GetMorph()->GetName();
-			morphCtrlMap.emplace(std::make_pair(name, std::move(morphCtrl)));
-		}
-		m_morphControllers.clear();
-		for (const auto& morph : vmd.m_morphs)
-		{
-			std::string morphName = morph.m_blendShapeName.ToUtf8String();
-			auto findIt = morphCtrlMap.find(morphName);
-			VMDMorphController* morphCtrl = nullptr;
-			if (findIt == std::end(morphCtrlMap))
-			{
-				auto* mmdMorph = m_model->GetMorphManager()->GetMorph(morphName);
-				if (mmdMorph != nullptr)
-				{
-					auto val = std::make_pair(
-						morphName,
-						std::make_unique<VMDMorphController>()
-					);
-					morphCtrl = val.second.get();
-					morphCtrl->SetBlendKeyShape(mmdMorph);
-					morphCtrlMap.emplace(std::move(val));
-				}
-			}
-			else
-			{
-				morphCtrl = (*findIt).second.get();
-			}
+		m_maxKeyTime = CalculateMaxKeyTime();
+		ClearPhysicsSnapshots();
 
-			if (morphCtrl != nullptr)
-			{
-				VMDMorphAnimationKey key;
-				key.m_time = int32_t(morph.m_frame);
-				key.m_weight = morph.m_weight;
-				morphCtrl->AddKey(key);
-			}
-		}
-		m_morphControllers.reserve(morphCtrlMap.size());
-		for (auto& pair : morphCtrlMap)
-		{
-			pair.second->SortKeys();
-			m_morphControllers.emplace_back(std::move(pair.second));
-		}
-		morphCtrlMap.clear();
+		return true;
+	}
+
+	bool VMDAnimation::AddFile(const char* filename)
+	{
+		VMDAnimationBuilder builder(m_model.get(), m_nodeControllers, m_ikControllers, m_morphControllers);
+		const auto sections = VMDSection::Motion | VMDSection::Morph | VMDSection::IK;
+		bool ret = ReadVMDFile(&builder, filename, sections);
+		builder.Finish();
 
 		m_maxKeyTime = CalculateMaxKeyTime();
+		ClearPhysicsSnapshots();
 
-		return true;
+		return ret;
 	}
 
 	void VMDAnimation::Destroy()
@@ -351,6 +448,7 @@ namespace saba
 		m_ikControllers.clear();
 		m_morphControllers.clear();
 		m_maxKeyTime = 0;
+		ClearPhysicsSnapshots();
 	}
 
 	void VMDAnimation::Evaluate(float t, float weight)
@@ -381,6 +479,12 @@ namespace saba
 		*/
 		m_model->SaveBaseAnimation();
 
+		if (m_model->GetPhysicsManager()->IsSharedPhysics())
+		{
+			SyncSharedPhysics(t);
+			return;
+		}
+
 		// Physicsを反映する
 		for (int i = 0; i < frameCount; i++)
 		{
@@ -400,6 +504,189 @@ namespace saba
 		}
 	}
 
+	void VMDAnimation::SyncPhysics(float t, const VMDSyncPhysicsParams& params)
+	{
+		m_model->SaveBaseAnimation();
+
+		if (m_model->GetPhysicsManager()->IsSharedPhysics())
+		{
+			SyncSharedPhysics(t);
+			return;
+		}
+
+		const int blendFrameCount = std::max(params.m_blendFrameCount, 1);
+		const int maxFrameCount = blendFrameCount + std::max(params.m_maxSettleFrameCount, 0);
+		auto physics = m_model->GetMMDPhysics();
+		for (int i = 0; i < maxFrameCount; i++)
+		{
+			const bool blending = i + 1 < blendFrameCount;
+			const float weight = blending ? float(1 + i) / float(blendFrameCount) : 1.0f;
+
+			m_model->BeginAnimation();
+
+			Evaluate(t, weight);
+
+			// 遷移中は剛体に影響するボーンモーフのみ反映し、
+			// 頂点、UV、材質モーフは最後にまとめて反映する
+			if (!blending || !params.m_skipMorph)
+			{
+				m_model->UpdateMorphAnimation();
+			}
+			else
+			{
+				m_model->UpdateBoneMorphAnimation();
+			}
+
+			m_model->UpdateNodeAnimation(false);
+
+			m_model->UpdatePhysicsAnimation(params.m_elapsed);
+
+			m_model->UpdateNodeAnimation(true);
+
+			m_model->EndAnimation();
+
+			if (!blending && physics != nullptr)
+			{
+				m_model->GetPhysicsManager()->WaitAsyncPhysics();
+				float linearVelocity;
+				float angularVelocity;
+				physics->GetMaxVelocity(&linearVelocity, &angularVelocity);
+				if (linearVelocity < params.m_linearVelocityThreshold &&
+					angularVelocity < params.m_angularVelocityThreshold)
+				{
+					break;
+				}
+			}
+		}
+	}
+
+	void VMDAnimation::SyncSharedPhysics(float t)
+	{
+		/*
+		共有された Physics World を進めると、他のモデルの剛体も動いてしまう。
+		ウォームアップは行わず、このモデルの剛体を目的のポーズへ配置し、速度を 0 にする。
+		*/
+		m_model->BeginAnimation();
+
+		Evaluate(t);
+
+		m_model->UpdateMorphAnimation();
+
+		m_model->UpdateNodeAnimation(false);
+
+		auto physicsMan = m_model->GetPhysicsManager();
+		for (auto& rb : (*physicsMan->GetRigidBodys()))
+		{
+			rb->ResetToNode(physicsMan->GetMMDPhysics());
+		}
+
+		m_model->UpdateNodeAnimation(true);
+
+		m_model->EndAnimation();
+	}
+
+	void VMDAnimation::SetPhysicsSnapshotInterval(int32_t interval)
+	{
+		m_physicsSnapshotInterval = std::max(interval, 0);
+		ClearPhysicsSnapshots();
+	}
+
+	void VMDAnimation::RecordPhysicsSnapshot(float t)
+	{
+		if (m_physicsSnapshotInterval <= 0 || m_model == nullptr)
+		{
+			return;
+		}
+		// 共有された Physics World は他のモデルの剛体を含むため記録しない
+		auto physics = m_model->GetMMDPhysics();
+		if (physics == nullptr || t < 0 || m_model->GetPhysicsManager()->IsSharedPhysics())
+		{
+			return;
+		}
+
+		const int32_t frame = int32_t(t);
+		if (frame % m_physicsSnapshotInterval != 0 ||
+			m_physicsSnapshots.find(frame) != m_physicsSnapshots.end())
+		{
+			return;
+		}
+
+		m_model->GetPhysicsManager()->WaitAsyncPhysics();
+
+		PhysicsSnapshot& snapshot = m_physicsSnapshots[frame];
+		snapshot.m_time = t;
+		physics->SaveSnapshot(&snapshot.m_snapshot);
+	}
+
+	bool VMDAnimation::RestorePhysicsSnapshot(float t)
+	{
+		if (m_physicsSnapshots.empty() || m_model == nullptr)
+		{
+			return false;
+		}
+		auto physics = m_model->GetMMDPhysics();
+		if (physics == nullptr)
+		{
+			return false;
+		}
+
+		// t 以前で最も近いスナップショットを探す
+		auto it = m_physicsSnapshots.upper_bound(int32_t(std::floor(t)));
+		while (it != m_physicsSnapshots.begin())
+		{
+			--it;
+			if (it->second.m_time <= t)
+			{
+				break;
+			}
+		}
+		if (it == m_physicsSnapshots.end() || it->second.m_time > t)
+		{
+			return false;
+		}
+		// 記録されていない区間を長く再生するより SyncPhysics の方が速い
+		if (t - it->second.m_time > float(m_physicsSnapshotInterval))
+		{
+			return false;
+		}
+
+		m_model->GetPhysicsManager()->WaitAsyncPhysics();
+		if (!physics->RestoreSnapshot(it->second.m_snapshot))
+		{
+			ClearPhysicsSnapshots();
+			return false;
+		}
+
+		// スナップショットの時間から t まで 1 フレームずつ進める
+		float time = it->second.m_time;
+		do
+		{
+			const float elapsed = std::min(t - time, 1.0f);
+			time += elapsed;
+
+			m_model->BeginAnimation();
+
+			Evaluate(time);
+
+			m_model->UpdateMorphAnimation();
+
+			m_model->UpdateNodeAnimation(false);
+
+			m_model->UpdatePhysicsAnimation(elapsed / 30.0f);
+
+			m_model->UpdateNodeAnimation(true);
+
+			m_model->EndAnimation();
+		} while (time < t);
+
+		return true;
+	}
+
+	void VMDAnimation::ClearPhysicsSnapshots()
+	{
+		m_physicsSnapshots.clear();
+	}
+
 	int32_t VMDAnimation::CalculateMaxKeyTime() const
 	{
 		int32_t maxTime = 0;
@@ -452,6 +739,7 @@ namespace saba
 
 	VMDIKController::VMDIKController()
 		: m_ikSolver(nullptr)
+		, m_sortedKeyCount(0)
 		, m_startKeyIndex(0)
 	{
 	}
@@ -510,15 +798,13 @@ namespace saba
 
 	void VMDIKController::SortKeys()
 	{
-		std::sort(
-			std::begin(m_keys),
-			std::end(m_keys),
-			[](const KeyType& a, const KeyType& b) { return a.m_time < b.m_time; }
-		);
+		MergeSortedKeys(m_keys, m_sortedKeyCount);
+		m_sortedKeyCount = m_keys.size();
 	}
 
 	VMDMorphController::VMDMorphController()
 		: m_morph(nullptr)
+		, m_sortedKeyCount(0)
 		, m_startKeyIndex(0)
 	{
 	}
@@ -574,10 +860,7 @@ namespace saba
 
 	void VMDMorphController::SortKeys()
 	{
-		std::sort(
-			std::begin(m_keys),
-			std::end(m_keys),
-			[](const KeyType& a, const KeyType& b) { return a.m_time < b.m_time; }
-		);
+		MergeSortedKeys(m_keys, m_sortedKeyCount);
+		m_sortedKeyCount = m_keys.size();
 	}
 }
@@ -10,10 +10,12 @@
 #include "MMDNode.h"
 #include "VMDFile.h"
 #include "MMDIkSolver.h"
+#include "MMDPhysics.h"
 
 #include <vector>
 #include <algorithm>
 #include <memory>
+#include <map>
 #include <glm/vec2.hpp>
 #include <glm/vec3.hpp>
 #include <glm/gtc/quaternion.hpp>
@@ -80,6 +82,7 @@ namespace saba
 	private:
 		MMDNode*				m_node;
 		std::vector<KeyType>	m_keys;
+		size_t					m_sortedKeyCount;
 		size_t					m_startKeyIndex;
 	};
 
@@ -105,6 +108,7 @@ namespace saba
 	private:
 		MMDMorph*				m_morph;
 		std::vector<KeyType>	m_keys;
+		size_t					m_sortedKeyCount;
 		size_t					m_startKeyIndex;
 	};
 
@@ -130,9 +134,32 @@ namespace saba
 	private:
 		MMDIkSolver*			m_ikSolver;
 		std::vector<KeyType>	m_keys;
+		size_t					m_sortedKeyCount;
 		size_t					m_startKeyIndex;
 	};
 
+	// SyncPhysics のウォームアップ設定
+	struct VMDSyncPhysicsParams
+	{
+		VMDSyncPhysicsParams()
+			: m_blendFrameCount(10)
+			, m_maxSettleFrameCount(20)
+			, m_elapsed(1.0f / 30.0f)
+			, m_skipMorph(true)
+			, m_linearVelocityThreshold(1.0f)
+			, m_angularVelocityThreshold(0.5f)
+		{
+		}
+
+		int		m_blendFrameCount;		// 目的のポーズへ遷移させるフレーム数
+		int		m_maxSettleFrameCount;	// 遷移後、収束を待つ最大フレーム数
+		float	m_elapsed;				// 1 フレームあたりの Physics の経過時間
+		bool	m_skipMorph;			// 遷移中はボーンモーフ以外のモーフの更新を省略する
+		// 剛体の速度がすべて閾値未満になれば収束したとみなす
+		float	m_linearVelocityThreshold;
+		float	m_angularVelocityThreshold;
+	};
+
 	class VMDAnimation
 	{
 	public:
@@ -140,16 +167,37 @@ namespace saba
 
 		bool Create(std::shared_ptr<MMDModel> model);
 		bool Add(const VMDFile& vmd);
+		// VMDFile を経由せず、ファイルから直接コントローラーへ読み込む
+		// (カメラ、照明、セルフシャドウは読み飛ばす)
+		bool AddFile(const char* filename);
+		bool AddFile(const std::string& filename) { return AddFile(filename.c_str()); }
 		void Destroy();
 
 		void Evaluate(float t, float weight = 1.0f);
 
 		// Physics を同期させる
+		// (Physics World を共有している場合は World を進めず、剛体を目的のポーズへ配置する)
 		void SyncPhysics(float t, int frameCount = 30);
+		// 剛体の速度が収束した時点で打ち切る
+		void SyncPhysics(float t, const VMDSyncPhysicsParams& params);
+
+		// Physics のスナップショットを interval フレーム毎に記録する (0 で無効)
+		// シークの高速化のためのもので、ループ再生のつなぎ目 (最後のキーから先頭のキー) は補間しない
+		void SetPhysicsSnapshotInterval(int32_t interval);
+		int32_t GetPhysicsSnapshotInterval() const { return m_physicsSnapshotInterval; }
+		// 再生中、Physics 更新後に呼び出す
+		void RecordPhysicsSnapshot(float t);
+		// t 以前で最も近いスナップショットを復元し、t まで Physics を進める
+		// スナップショットが無い場合、または interval フレーム以内に無い場合は
+		// false を返す (SyncPhysics を使用すること)
+		bool RestorePhysicsSnapshot(float t);
+		void ClearPhysicsSnapshots();
 
 		int32_t GetMaxKeyTime() const { return m_maxKeyTime; };
 	private:
 		int32_t CalculateMaxKeyTime() const;
+		// Physics World を共有している場合の SyncPhysics
+		void SyncSharedPhysics(float t);
 
 	private:
 		using NodeControllerPtr = std::unique_ptr<VMDNodeController>;
@@ -161,6 +209,14 @@ namespace saba
 		std::vector<IKControllerPtr>		m_ikControllers;
 		std::vector<MorphControllerPtr>		m_morphControllers;
 		uint32_t	m_maxKeyTime;
+
+		struct PhysicsSnapshot
+		{
+			float				m_time;
+			MMDPhysicsSnapshot	m_snapshot;
+		};
+		int32_t								m_physicsSnapshotInterval;
+		std::map<int32_t, PhysicsSnapshot>	m_physicsSnapshots;
 	};
 
 }
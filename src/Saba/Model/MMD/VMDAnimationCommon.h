@@ -8,6 +8,7 @@
 
 #include <cstdint>
 #include <vector>
+#include <algorithm>
 
 namespace saba
 {
@@ -59,6 +60,21 @@ namespace saba
 		});
 		return bundIt;
 	}
+
+	// keys[0, sortedCount) は整列済み。追加されたキーだけをソートしてマージする
+	template <typename KeyType>
+	void MergeSortedKeys(std::vector<KeyType>& keys, size_t sortedCount)
+	{
+		if (sortedCount >= keys.size())
+		{
+			return;
+		}
+
+		auto compare = [](const KeyType& a, const KeyType& b) { return a.m_time < b.m_time; };
+		auto mid = keys.begin() + sortedCount;
+		std::stable_sort(mid, keys.end(), compare);
+		std::inplace_merge(keys.begin(), mid, keys.end(), compare);
+	}
 }
 
 #endif // !SABA_MODEL_MMD_VMDANIMATIONCOMMON_H_
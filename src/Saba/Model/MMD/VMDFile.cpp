@@ -6,25 +6,28 @@
 #include "VMDFile.h"
 
 #include <Saba/Base/Log.h>
-#include <Saba/Base/File.h>
+#include <Saba/Base/BinaryReader.h>
+
+#include <algorithm>
+#include <cstring>
 
 namespace saba
 {
 	namespace
 	{
 		template <typename T>
-		bool Read(T* val, File& file)
+		bool Read(T* val, BinaryReader& file)
 		{
 			return file.Read(val);
 		}
 
-		bool ReadHeader(VMDFile* vmd, File& file)
+		bool ReadHeader(VMDHeader* header, BinaryReader& file)
 		{
-			Read(&vmd->m_header.m_header, file);
-			Read(&vmd->m_header.m_modelName, file);
+			Read(&header->m_header, file);
+			Read(&header->m_modelName, file);
 
-			if (vmd->m_header.m_header.ToString() != "Vocaloid Motion Data 0002" &&
-				vmd->m_header.m_header.ToString() != "Vocaloid Motion Data"
+			if (header->m_header.ToString() != "Vocaloid Motion Data 0002" &&
+				header->m_header.ToString() != "Vocaloid Motion Data"
 				)
 			{
 				SABA_WARN("VMD Header error.");
@@ -34,108 +37,134 @@ namespace saba
 			return !file.IsBad();
 		}
 
-		bool ReadMotion(VMDFile* vmd, File& file)
-		{
-			uint32_t motionCount = 0;
-			if (!Read(&motionCount, file))
-			{
-				return false;
-			}
+		// ファイル上のレコードサイズ
+		const size_t MotionRecordSize = 15 + 4 + 12 + 16 + 64;
+		const size_t MorphRecordSize = 15 + 4 + 4;
+		const size_t CameraRecordSize = 4 + 4 + 12 + 12 + 24 + 4 + 1;
+		const size_t LightRecordSize = 4 + 12 + 12;
+		const size_t ShadowRecordSize = 4 + 1 + 4;
+		const size_t IKInfoRecordSize = 20 + 1;
 
-			vmd->m_motions.resize(motionCount);
-			for (auto& motion : vmd->m_motions)
-			{
-				Read(&motion.m_boneName, file);
-				Read(&motion.m_frame, file);
-				Read(&motion.m_translate, file);
-				Read(&motion.m_quaternion, file);
-				Read(&motion.m_interpolation, file);
-			}
+		// 一度に読み込むレコード数
+		const size_t ChunkRecordCount = 4096;
 
-			return !file.IsBad();
+		template <typename T>
+		void Decode(T* val, const char*& data)
+		{
+			memcpy(val, data, sizeof(T));
+			data += sizeof(T);
 		}
 
-		bool ReadBlendShape(VMDFile* vmd, File& file)
+		template <size_t Size>
+		void Decode(MMDFileString<Size>* str, const char*& data)
 		{
-			uint32_t blendShapeCount = 0;
-			if (!Read(&blendShapeCount, file))
-			{
-				return false;
-			}
+			memcpy(str->m_buffer, data, Size);
+			data += Size;
+		}
 
-			vmd->m_morphs.resize(blendShapeCount);
-			for (auto& morph : vmd->m_morphs)
-			{
-				Read(&morph.m_blendShapeName, file);
-				Read(&morph.m_frame, file);
-				Read(&morph.m_weight, file);
-			}
+		void Decode(VMDMotion* motion, const char*& data)
+		{
+			Decode(&motion->m_boneName, data);
+			Decode(&motion->m_frame, data);
+			Decode(&motion->m_translate, data);
+			Decode(&motion->m_quaternion, data);
+			Decode(&motion->m_interpolation, data);
+		}
 
-			return !file.IsBad();
+		void Decode(VMDMorph* morph, const char*& data)
+		{
+			Decode(&morph->m_blendShapeName, data);
+			Decode(&morph->m_frame, data);
+			Decode(&morph->m_weight, data);
 		}
 
-		bool ReadCamera(VMDFile* vmd, File& file)
+		void Decode(VMDCamera* camera, const char*& data)
 		{
-			uint32_t cameraCount = 0;
-			if (!Read(&cameraCount, file))
-			{
-				return false;
-			}
+			Decode(&camera->m_frame, data);
+			Decode(&camera->m_distance, data);
+			Decode(&camera->m_interest, data);
+			Decode(&camera->m_rotate, data);
+			Decode(&camera->m_interpolation, data);
+			Decode(&camera->m_viewAngle, data);
+			Decode(&camera->m_isPerspective, data);
+		}
 
-			vmd->m_cameras.resize(cameraCount);
-			for (auto& camera : vmd->m_cameras)
-			{
-				Read(&camera.m_frame, file);
-				Read(&camera.m_distance, file);
-				Read(&camera.m_interest, file);
-				Read(&camera.m_rotate, file);
-				Read(&camera.m_interpolation, file);
-				Read(&camera.m_viewAngle, file);
-				Read(&camera.m_isPerspective, file);
-			}
+		void Decode(VMDLight* light, const char*& data)
+		{
+			Decode(&light->m_frame, data);
+			Decode(&light->m_color, data);
+			Decode(&light->m_position, data);
+		}
 
-			return !file.IsBad();
+		void Decode(VMDShadow* shadow, const char*& data)
+		{
+			Decode(&shadow->m_frame, data);
+			Decode(&shadow->m_shadowType, data);
+			Decode(&shadow->m_distance, data);
+		}
+
+		bool IsReadSection(VMDSection sections, VMDSection section)
+		{
+			return (uint32_t(sections) & uint32_t(section)) != 0;
 		}
 
-		bool ReadLight(VMDFile* vmd, File& file)
+		/*
+		固定長レコードのセクションを ChunkRecordCount 件ずつ読み込み、handler に渡す。
+		読み込まないセクションはシークで読み飛ばす。
+		*/
+		template <typename RecordType, typename EmitFunc>
+		bool ReadSection(
+			BinaryReader&	file,
+			VMDSection		section,
+			VMDSection		sections,
+			size_t			recordSize,
+			VMDReadHandler*	handler,
+			EmitFunc		emit
+		)
 		{
-			uint32_t lightCount = 0;
-			if (!Read(&lightCount, file))
+			uint32_t recordCount = 0;
+			if (!Read(&recordCount, file))
 			{
 				return false;
 			}
 
-			vmd->m_lights.resize(lightCount);
-			for (auto& light : vmd->m_lights)
+			if (!IsReadSection(sections, section))
 			{
-				Read(&light.m_frame, file);
-				Read(&light.m_color, file);
-				Read(&light.m_position, file);
+				if (file.Tell() + BinaryReader::Offset(recordCount) * BinaryReader::Offset(recordSize) > file.GetSize())
+				{
+					return false;
+				}
+				return file.Seek(BinaryReader::Offset(recordCount) * BinaryReader::Offset(recordSize), BinaryReader::SeekDir::Current);
 			}
 
-			return !file.IsBad();
-		}
+			handler->OnBeginSection(section, recordCount);
 
-		bool ReadShadow(VMDFile* vmd, File& file)
-		{
-			uint32_t shadowCount = 0;
-			if (!Read(&shadowCount, file))
+			size_t chunkCount = std::min(size_t(recordCount), ChunkRecordCount);
+			std::vector<RecordType> records(chunkCount);
+			size_t remainCount = recordCount;
+			while (remainCount > 0)
 			{
-				return false;
-			}
+				size_t readCount = std::min(remainCount, ChunkRecordCount);
+				// マップしたデータから直接デコードする
+				const char* data = file.ReadSpan(readCount * recordSize);
+				if (data == nullptr)
+				{
+					return false;
+				}
 
-			vmd->m_shadows.resize(shadowCount);
-			for (auto& shadow : vmd->m_shadows)
-			{
-				Read(&shadow.m_frame, file);
-				Read(&shadow.m_shadowType, file);
-				Read(&shadow.m_distance, file);
+				for (size_t i = 0; i < readCount; i++)
+				{
+					Decode(&records[i], data);
+				}
+				(handler->*emit)(records.data(), readCount);
+
+				remainCount -= readCount;
 			}
 
 			return !file.IsBad();
 		}
 
-		bool ReadIK(VMDFile* vmd, File& file)
+		bool ReadIK(VMDReadHandler* handler, BinaryReader& file)
 		{
 			uint32_t ikCount = 0;
 			if (!Read(&ikCount, file))
@@ -143,8 +172,10 @@ namespace saba
 				return false;
 			}
 
-			vmd->m_iks.resize(ikCount);
-			for (auto& ik : vmd->m_iks)
+			handler->OnBeginSection(VMDSection::IK, ikCount);
+
+			VMDIk ik;
+			for (uint32_t ikIdx = 0; ikIdx < ikCount; ikIdx++)
 			{
 				Read(&ik.m_frame, file);
 				Read(&ik.m_show, file);
@@ -153,26 +184,38 @@ namespace saba
 				{
 					return false;
 				}
+				if (file.Tell() + BinaryReader::Offset(ikInfoCount) * BinaryReader::Offset(IKInfoRecordSize) > file.GetSize())
+				{
+					return false;
+				}
+				const char* data = file.ReadSpan(ikInfoCount * IKInfoRecordSize);
+				if (data == nullptr)
+				{
+					return false;
+				}
 				ik.m_ikInfos.resize(ikInfoCount);
 				for (auto& ikInfo : ik.m_ikInfos)
 				{
-					Read(&ikInfo.m_name, file);
-					Read(&ikInfo.m_enable, file);
+					Decode(&ikInfo.m_name, data);
+					Decode(&ikInfo.m_enable, data);
 				}
+				handler->OnIK(ik);
 			}
 
 			return !file.IsBad();
 		}
 
-		bool ReadVMDFile(VMDFile* vmd, File& file)
+		bool ReadVMDFile(VMDReadHandler* handler, BinaryReader& file, VMDSection sections)
 		{
-			if (!ReadHeader(vmd, file))
+			VMDHeader header;
+			if (!ReadHeader(&header, file))
 			{
 				SABA_WARN("ReadHeader Fail.");
 				return false;
 			}
+			handler->OnHeader(header);
 
-			if (!ReadMotion(vmd, file))
+			if (!ReadSection<VMDMotion>(file, VMDSection::Motion, sections, MotionRecordSize, handler, &VMDReadHandler::OnMotions))
 			{
 				SABA_WARN("ReadMotion Fail.");
 				return false;
@@ -180,7 +223,7 @@ namespace saba
 
 			if (file.Tell() < file.GetSize())
 			{
-				if (!ReadBlendShape(vmd, file))
+				if (!ReadSection<VMDMorph>(file, VMDSection::Morph, sections, MorphRecordSize, handler, &VMDReadHandler::OnMorphs))
 				{
 					SABA_WARN("ReadBlednShape Fail.");
 					return false;
@@ -189,7 +232,7 @@ namespace saba
 
 			if (file.Tell() < file.GetSize())
 			{
-				if (!ReadCamera(vmd, file))
+				if (!ReadSection<VMDCamera>(file, VMDSection::Camera, sections, CameraRecordSize, handler, &VMDReadHandler::OnCameras))
 				{
 					SABA_WARN("ReadCamera Fail.");
 					return false;
@@ -198,7 +241,7 @@ namespace saba
 
 			if (file.Tell() < file.GetSize())
 			{
-				if (!ReadLight(vmd, file))
+				if (!ReadSection<VMDLight>(file, VMDSection::Light, sections, LightRecordSize, handler, &VMDReadHandler::OnLights))
 				{
 					SABA_WARN("ReadLight Fail.");
 					return false;
@@ -207,16 +250,17 @@ namespace saba
 
 			if (file.Tell() < file.GetSize())
 			{
-				if (!ReadShadow(vmd, file))
+				if (!ReadSection<VMDShadow>(file, VMDSection::Shadow, sections, ShadowRecordSize, handler, &VMDReadHandler::OnShadows))
 				{
 					SABA_WARN("ReadShadow Fail.");
 					return false;
 				}
 			}
 
-			if (file.Tell() < file.GetSize())
+			// IK は最後のセクションなので、不要なら読み込みを終了する
+			if (IsReadSection(sections, VMDSection::IK) && file.Tell() < file.GetSize())
 			{
-				if (!ReadIK(vmd, file))
+				if (!ReadIK(handler, file))
 				{
 					SABA_WARN("ReadIK Fail.");
 					return false;
@@ -225,18 +269,94 @@ namespace saba
 
 			return true;
 		}
+
+		class VMDFileReadHandler : public VMDReadHandler
+		{
+		public:
+			explicit VMDFileReadHandler(VMDFile* vmd) : m_vmd(vmd) {}
+
+			void OnHeader(const VMDHeader& header) override
+			{
+				m_vmd->m_header = header;
+			}
+
+			void OnBeginSection(VMDSection section, uint32_t count) override
+			{
+				switch (section)
+				{
+				case VMDSection::Motion: m_vmd->m_motions.reserve(count); break;
+				case VMDSection::Morph: m_vmd->m_morphs.reserve(count); break;
+				case VMDSection::Camera: m_vmd->m_cameras.reserve(count); break;
+				case VMDSection::Light: m_vmd->m_lights.reserve(count); break;
+				case VMDSection::Shadow: m_vmd->m_shadows.reserve(count); break;
+				case VMDSection::IK: m_vmd->m_iks.reserve(count); break;
+				default: break;
+				}
+			}
+
+			void OnMotions(const VMDMotion* motions, size_t count) override
+			{
+				m_vmd->m_motions.insert(m_vmd->m_motions.end(), motions, motions + count);
+			}
+
+			void OnMorphs(const VMDMorph* morphs, size_t count) override
+			{
+				m_vmd->m_morphs.insert(m_vmd->m_morphs.end(), morphs, morphs + count);
+			}
+
+			void OnCameras(const VMDCamera* cameras, size_t count) override
+			{
+				m_vmd->m_cameras.insert(m_vmd->m_cameras.end(), cameras, cameras + count);
+			}
+
+			void OnLights(const VMDLight* lights, size_t count) override
+			{
+				m_vmd->m_lights.insert(m_vmd->m_lights.end(), lights, lights + count);
+			}
+
+			void OnShadows(const VMDShadow* shadows, size_t count) override
+			{
+				m_vmd->m_shadows.insert(m_vmd->m_shadows.end(), shadows, shadows + count);
+			}
+
+			void OnIK(const VMDIk& ik) override
+			{
+				m_vmd->m_iks.push_back(ik);
+			}
+
+		private:
+			VMDFile*	m_vmd;
+		};
 	}
 
 	bool ReadVMDFile(VMDFile * vmd, const char * filename)
 	{
-		File file;
+		BinaryReader file;
+		if (!file.Open(filename))
+		{
+			SABA_WARN("VMD File Open Fail. {}", filename);
+			return false;
+		}
+
+		VMDFileReadHandler handler(vmd);
+		return ReadVMDFile(&handler, file, VMDSection::All);
+	}
+
+	bool ReadVMDFile(VMDReadHandler* handler, const char* filename, VMDSection sections)
+	{
+		if (handler == nullptr)
+		{
+			return false;
+		}
+
+		BinaryReader file;
 		if (!file.Open(filename))
 		{
 			SABA_WARN("VMD File Open Fail. {}", filename);
 			return false;
 		}
 
-		return ReadVMDFile(vmd, file);
+		return ReadVMDFile(handler, file, sections);
 	}
 
 }
@@ -93,6 +93,47 @@ namespace saba
 	};
 
 	bool ReadVMDFile(VMDFile* vmd, const char* filename);
+
+	enum class VMDSection : uint32_t
+	{
+		Motion = 0x01,
+		Morph = 0x02,
+		Camera = 0x04,
+		Light = 0x08,
+		Shadow = 0x10,
+		IK = 0x20,
+		All = 0x3F,
+	};
+
+	inline VMDSection operator | (VMDSection a, VMDSection b)
+	{
+		return VMDSection(uint32_t(a) | uint32_t(b));
+	}
+
+	/*
+	VMD をストリーミングで読み込むためのハンドラ。
+	レコードは一定数ずつまとめて渡される (ポインタはコールバック内でのみ有効)。
+	VMDFile 全体をメモリ上に展開しないため、長いモーションでもメモリ使用量が抑えられる。
+	*/
+	class VMDReadHandler
+	{
+	public:
+		virtual ~VMDReadHandler() = default;
+
+		virtual void OnHeader(const VMDHeader& header) {}
+		// 各セクションの読み込み開始時に呼ばれる (予約用)
+		virtual void OnBeginSection(VMDSection section, uint32_t count) {}
+
+		virtual void OnMotions(const VMDMotion* motions, size_t count) {}
+		virtual void OnMorphs(const VMDMorph* morphs, size_t count) {}
+		virtual void OnCameras(const VMDCamera* cameras, size_t count) {}
+		virtual void OnLights(const VMDLight* lights, size_t count) {}
+		virtual void OnShadows(const VMDShadow* shadows, size_t count) {}
+		virtual void OnIK(const VMDIk& ik) {}
+	};
+
+	// sections に含まれないセクションは読み飛ばす
+	bool ReadVMDFile(VMDReadHandler* handler, const char* filename, VMDSection sections = VMDSection::All);
 }
 
 #endif // !SABA_MODEL_MMD_VMDFILE_H_
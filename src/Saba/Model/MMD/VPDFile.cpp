@@ -258,10 +258,7 @@ namespace saba
 
 		for (auto& bone : bones)
 		{
-			std::u16string u16Str = saba::ConvertSjisToU16String(bone.m_boneName.c_str());
-			std::string u8Str;
-			saba::ConvU16ToU8(u16Str, u8Str);
-			bone.m_boneName = u8Str;
+			bone.m_boneName = saba::ConvertSjisToU8String(bone.m_boneName.c_str());
 		}
 
 		vpd->m_bones = std::move(bones);
@@ -356,10 +353,7 @@ namespace saba
 
 		for (auto& morph : morphs)
 		{
-			std::u16string u16Str = saba::ConvertSjisToU16String(morph.m_morphName.c_str());
-			std::string u8Str;
-			saba::ConvU16ToU8(u16Str, u8Str);
-			morph.m_morphName = u8Str;
+			morph.m_morphName = saba::ConvertSjisToU8String(morph.m_morphName.c_str());
 		}
 
 		vpd->m_morphs = std::move(morphs);
@@ -0,0 +1,642 @@
+﻿//
+// Copyright(c) 2016-2017 benikabocha.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+//
+
+#include "PointCache.h"
+
+#include <Saba/Base/Log.h>
+
+#include <glm/common.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace saba
+{
+	namespace
+	{
+		const char		PointCacheMagic[8] = { 'S', 'a', 'b', 'a', 'P', 't', 'C', 'h' };
+		const uint32_t	PointCacheVersion = 1;
+		const size_t	PointCacheHeaderSize = 64;
+		const size_t	PointCacheFrameCountOffset = 32;
+		const size_t	PointCacheSubMeshSize = sizeof(uint32_t) * 3;
+		const size_t	PointCacheMaterialSize = sizeof(uint32_t) * 4 + sizeof(float) * 11;
+
+		const char		PC2Magic[12] = { 'P', 'O', 'I', 'N', 'T', 'C', 'A', 'C', 'H', 'E', '2', '\0' };
+		const int32_t	PC2Version = 1;
+		const size_t	PC2HeaderSize = 32;
+		const size_t	PC2SampleCountOffset = 28;
+
+		size_t AlignSize(size_t size)
+		{
+			return (size + 15) & ~size_t(15);
+		}
+
+		size_t CalcFrameSize(uint32_t flags, size_t vertexCount)
+		{
+			size_t size = 0;
+			if ((flags & PointCacheFlags::Quantize) != 0)
+			{
+				// AABB の最小値とスケール + 16bit の位置
+				size = sizeof(float) * 6 + sizeof(uint16_t) * 3 * vertexCount;
+				if ((flags & PointCacheFlags::Normal) != 0)
+				{
+					size += sizeof(int16_t) * 3 * vertexCount;
+				}
+			}
+			else
+			{
+				size = sizeof(glm::vec3) * vertexCount;
+				if ((flags & PointCacheFlags::Normal) != 0)
+				{
+					size += sizeof(glm::vec3) * vertexCount;
+				}
+			}
+			return AlignSize(size);
+		}
+
+		template <typename T>
+		void WriteValue(uint8_t** dst, const T& value)
+		{
+			std::memcpy(*dst, &value, sizeof(T));
+			*dst += sizeof(T);
+		}
+
+		template <typename T>
+		T ReadValue(const uint8_t** src)
+		{
+			T value;
+			std::memcpy(&value, *src, sizeof(T));
+			*src += sizeof(T);
+			return value;
+		}
+	}
+
+	PointCacheWriter::PointCacheWriter()
+		: m_pc2(false)
+		, m_flags(0)
+		, m_vertexCount(0)
+		, m_frameCount(0)
+		, m_frameCountOffset(0)
+	{
+	}
+
+	PointCacheWriter::~PointCacheWriter()
+	{
+		Close();
+	}
+
+	bool PointCacheWriter::Create(const char * filename, const PointCacheMesh & mesh, uint32_t flags, float startFrame, float frameStep)
+	{
+		Close();
+
+		for (auto index : mesh.m_indices)
+		{
+			if (index >= mesh.m_vertexCount)
+			{
+				SABA_WARN("Point cache index out of range. {}", index);
+				return false;
+			}
+		}
+		if (!mesh.m_uvs.empty() && mesh.m_uvs.size() != mesh.m_vertexCount)
+		{
+			SABA_WARN("Point cache UV count mismatch.");
+			return false;
+		}
+
+		if (!m_file.Create(filename))
+		{
+			SABA_WARN("Failed to create point cache file. {}", filename);
+			return false;
+		}
+
+		// 文字列はまとめて後ろに置く
+		std::string strings;
+		std::vector<uint8_t> materials(mesh.m_materials.size() * PointCacheMaterialSize);
+		uint8_t* matDst = materials.data();
+		for (const auto& mat : mesh.m_materials)
+		{
+			WriteValue(&matDst, uint32_t(strings.size()));
+			WriteValue(&matDst, uint32_t(mat.m_name.size()));
+			strings += mat.m_name;
+			WriteValue(&matDst, uint32_t(strings.size()));
+			WriteValue(&matDst, uint32_t(mat.m_texture.size()));
+			strings += mat.m_texture;
+			WriteValue(&matDst, mat.m_diffuse);
+			WriteValue(&matDst, mat.m_specular);
+			WriteValue(&matDst, mat.m_specularPower);
+			WriteValue(&matDst, mat.m_ambient);
+		}
+
+		std::vector<uint32_t> subMeshes;
+		subMeshes.reserve(mesh.m_subMeshes.size() * 3);
+		for (const auto& subMesh : mesh.m_subMeshes)
+		{
+			subMeshes.push_back(subMesh.m_beginIndex);
+			subMeshes.push_back(subMesh.m_indexCount);
+			subMeshes.push_back(uint32_t(subMesh.m_materialID));
+		}
+
+		std::vector<glm::vec2> uvs = mesh.m_uvs;
+		uvs.resize(mesh.m_vertexCount, glm::vec2(0.0f));
+
+		size_t dataSize = PointCacheHeaderSize
+			+ sizeof(uint32_t) * mesh.m_indices.size()
+			+ sizeof(glm::vec2) * uvs.size()
+			+ sizeof(uint32_t) * subMeshes.size()
+			+ materials.size()
+			+ strings.size();
+		uint64_t frameOffset = AlignSize(dataSize);
+		uint64_t frameStride = CalcFrameSize(flags, mesh.m_vertexCount);
+
+		uint32_t version = PointCacheVersion;
+		uint32_t vertexCount = uint32_t(mesh.m_vertexCount);
+		uint32_t indexCount = uint32_t(mesh.m_indices.size());
+		uint32_t subMeshCount = uint32_t(mesh.m_subMeshes.size());
+		uint32_t materialCount = uint32_t(mesh.m_materials.size());
+		uint32_t frameCount = 0;
+		uint32_t stringSize = uint32_t(strings.size());
+		m_file.Write(PointCacheMagic, sizeof(PointCacheMagic));
+		m_file.Write(&version);
+		m_file.Write(&flags);
+		m_file.Write(&vertexCount);
+		m_file.Write(&indexCount);
+		m_file.Write(&subMeshCount);
+		m_file.Write(&materialCount);
+		m_file.Write(&frameCount);
+		m_file.Write(&startFrame);
+		m_file.Write(&frameStep);
+		m_file.Write(&stringSize);
+		m_file.Write(&frameOffset);
+		m_file.Write(&frameStride);
+
+		if (!mesh.m_indices.empty())
+		{
+			m_file.Write(mesh.m_indices.data(), mesh.m_indices.size());
+		}
+		if (!uvs.empty())
+		{
+			m_file.Write(uvs.data(), uvs.size());
+		}
+		if (!subMeshes.empty())
+		{
+			m_file.Write(subMeshes.data(), subMeshes.size());
+		}
+		if (!materials.empty())
+		{
+			m_file.Write(materials.data(), materials.size());
+		}
+		if (!strings.empty())
+		{
+			m_file.Write(strings.data(), strings.size());
+		}
+		std::vector<uint8_t> padding(size_t(frameOffset) - dataSize, 0);
+		if (!padding.empty())
+		{
+			m_file.Write(padding.data(), padding.size());
+		}
+
+		if (m_file.IsBad())
+		{
+			SABA_WARN("Failed to write point cache header. {}", filename);
+			m_file.Close();
+			return false;
+		}
+
+		m_pc2 = false;
+		m_flags = flags;
+		m_vertexCount = mesh.m_vertexCount;
+		m_frameCount = 0;
+		m_frameCountOffset = File::Offset(PointCacheFrameCountOffset);
+		m_frameBuffer.assign(size_t(frameStride), 0);
+
+		return true;
+	}
+
+	bool PointCacheWriter::CreatePC2(const char * filename, size_t vertexCount, float startFrame, float frameStep)
+	{
+		Close();
+
+		if (!m_file.Create(filename))
+		{
+			SABA_WARN("Failed to create PC2 file. {}", filename);
+			return false;
+		}
+
+		int32_t version = PC2Version;
+		int32_t numPoints = int32_t(vertexCount);
+		int32_t numSamples = 0;
+		m_file.Write(PC2Magic, sizeof(PC2Magic));
+		m_file.Write(&version);
+		m_file.Write(&numPoints);
+		m_file.Write(&startFrame);
+		m_file.Write(&frameStep);
+		m_file.Write(&numSamples);
+		if (m_file.IsBad())
+		{
+			SABA_WARN("Failed to write PC2 header. {}", filename);
+			m_file.Close();
+			return false;
+		}
+
+		m_pc2 = true;
+		m_flags = 0;
+		m_vertexCount = vertexCount;
+		m_frameCount = 0;
+		m_frameCountOffset = File::Offset(PC2SampleCountOffset);
+		m_frameBuffer.clear();
+
+		return true;
+	}
+
+	bool PointCacheWriter::WriteFrame(const glm::vec3 * positions, const glm::vec3 * normals)
+	{
+		if (!m_file.IsOpen())
+		{
+			return false;
+		}
+
+		if (m_pc2)
+		{
+			if (m_vertexCount != 0 && !m_file.Write(positions, m_vertexCount))
+			{
+				return false;
+			}
+			m_frameCount++;
+			return true;
+		}
+
+		bool writeNormal = (m_flags & PointCacheFlags::Normal) != 0;
+		if (writeNormal && normals == nullptr)
+		{
+			SABA_WARN("Point cache requires normals.");
+			return false;
+		}
+
+		if ((m_flags & PointCacheFlags::Quantize) != 0)
+		{
+			if (!WriteQuantizedFrame(positions, normals))
+			{
+				return false;
+			}
+		}
+		else
+		{
+			uint8_t* dst = m_frameBuffer.data();
+			std::memcpy(dst, positions, sizeof(glm::vec3) * m_vertexCount);
+			dst += sizeof(glm::vec3) * m_vertexCount;
+			if (writeNormal)
+			{
+				std::memcpy(dst, normals, sizeof(glm::vec3) * m_vertexCount);
+			}
+		}
+
+		if (!m_file.Write(m_frameBuffer.data(), m_frameBuffer.size()))
+		{
+			return false;
+		}
+		m_frameCount++;
+		return true;
+	}
+
+	bool PointCacheWriter::WriteQuantizedFrame(const glm::vec3 * positions, const glm::vec3 * normals)
+	{
+		glm::vec3 bboxMin(0.0f);
+		glm::vec3 bboxMax(0.0f);
+		if (m_vertexCount != 0)
+		{
+			bboxMin = positions[0];
+			bboxMax = positions[0];
+		}
+		for (size_t i = 1; i < m_vertexCount; i++)
+		{
+			bboxMin = glm::min(bboxMin, positions[i]);
+			bboxMax = glm::max(bboxMax, positions[i]);
+		}
+		glm::vec3 scale = (bboxMax - bboxMin) / 65535.0f;
+		glm::vec3 invScale;
+		for (int i = 0; i < 3; i++)
+		{
+			invScale[i] = scale[i] > 0.0f ? 1.0f / scale[i] : 0.0f;
+		}
+
+		uint8_t* dst = m_frameBuffer.data();
+		WriteValue(&dst, bboxMin);
+		WriteValue(&dst, scale);
+		for (size_t i = 0; i < m_vertexCount; i++)
+		{
+			glm::vec3 q = glm::clamp((positions[i] - bboxMin) * invScale + 0.5f, 0.0f, 65535.0f);
+			for (int j = 0; j < 3; j++)
+			{
+				WriteValue(&dst, uint16_t(q[j]));
+			}
+		}
+		if ((m_flags & PointCacheFlags::Normal) != 0)
+		{
+			for (size_t i = 0; i < m_vertexCount; i++)
+			{
+				glm::vec3 n = glm::clamp(normals[i], -1.0f, 1.0f) * 32767.0f;
+				for (int j = 0; j < 3; j++)
+				{
+					WriteValue(&dst, int16_t(std::round(n[j])));
+				}
+			}
+		}
+		return true;
+	}
+
+	bool PointCacheWriter::Close()
+	{
+		if (!m_file.IsOpen())
+		{
+			return false;
+		}
+
+		uint32_t frameCount = uint32_t(m_frameCount);
+		m_file.Seek(m_frameCountOffset, File::SeekDir::Begin);
+		m_file.Write(&frameCount);
+		bool ret = !m_file.IsBad();
+		m_file.Close();
+		m_frameBuffer.clear();
+		return ret;
+	}
+
+	PointCache::PointCache()
+		: m_flags(0)
+		, m_frameCount(0)
+		, m_startFrame(0.0f)
+		, m_frameStep(1.0f)
+		, m_frameOffset(0)
+		, m_frameStride(0)
+	{
+	}
+
+	PointCache::~PointCache()
+	{
+		Close();
+	}
+
+	bool PointCache::Open(const char * filename)
+	{
+		Close();
+
+		if (!m_file.Open(filename))
+		{
+			SABA_WARN("Failed to open point cache file. {}", filename);
+			return false;
+		}
+
+		bool ret = false;
+		if (m_file.GetSize() >= sizeof(PointCacheMagic) &&
+			std::memcmp(m_file.GetData(), PointCacheMagic, sizeof(PointCacheMagic)) == 0)
+		{
+			ret = OpenSaba();
+		}
+		else if (m_file.GetSize() >= sizeof(PC2Magic) &&
+			std::memcmp(m_file.GetData(), PC2Magic, sizeof(PC2Magic)) == 0)
+		{
+			ret = OpenPC2();
+		}
+
+		if (!ret)
+		{
+			SABA_WARN("Invalid point cache file. {}", filename);
+			Close();
+			return false;
+		}
+		return true;
+	}
+
+	bool PointCache::OpenSaba()
+	{
+		const size_t fileSize = m_file.GetSize();
+		if (fileSize < PointCacheHeaderSize)
+		{
+			return false;
+		}
+
+		const uint8_t* src = m_file.GetData() + sizeof(PointCacheMagic);
+		uint32_t version = ReadValue<uint32_t>(&src);
+		uint32_t flags = ReadValue<uint32_t>(&src);
+		uint32_t vertexCount = ReadValue<uint32_t>(&src);
+		uint32_t indexCount = ReadValue<uint32_t>(&src);
+		uint32_t subMeshCount = ReadValue<uint32_t>(&src);
+		uint32_t materialCount = ReadValue<uint32_t>(&src);
+		uint32_t frameCount = ReadValue<uint32_t>(&src);
+		float startFrame = ReadValue<float>(&src);
+		float frameStep = ReadValue<float>(&src);
+		uint32_t stringSize = ReadValue<uint32_t>(&src);
+		uint64_t frameOffset = ReadValue<uint64_t>(&src);
+		uint64_t frameStride = ReadValue<uint64_t>(&src);
+		if (version != PointCacheVersion)
+		{
+			return false;
+		}
+
+		uint64_t dataSize = PointCacheHeaderSize
+			+ uint64_t(sizeof(uint32_t)) * indexCount
+			+ uint64_t(sizeof(glm::vec2)) * vertexCount
+			+ uint64_t(PointCacheSubMeshSize) * subMeshCount
+			+ uint64_t(PointCacheMaterialSize) * materialCount
+			+ stringSize;
+		if (frameOffset != AlignSize(size_t(dataSize)) ||
+			frameStride != CalcFrameSize(flags, vertexCount) ||
+			frameOffset + frameStride * frameCount > fileSize)
+		{
+			return false;
+		}
+
+		PointCacheMesh mesh;
+		mesh.m_vertexCount = vertexCount;
+		mesh.m_indices.resize(indexCount);
+		if (indexCount != 0)
+		{
+			std::memcpy(mesh.m_indices.data(), src, sizeof(uint32_t) * indexCount);
+			src += sizeof(uint32_t) * indexCount;
+		}
+		for (auto index : mesh.m_indices)
+		{
+			if (index >= vertexCount)
+			{
+				return false;
+			}
+		}
+
+		mesh.m_uvs.resize(vertexCount);
+		if (vertexCount != 0)
+		{
+			std::memcpy(mesh.m_uvs.data(), src, sizeof(glm::vec2) * vertexCount);
+			src += sizeof(glm::vec2) * vertexCount;
+		}
+
+		mesh.m_subMeshes.resize(subMeshCount);
+		for (auto& subMesh : mesh.m_subMeshes)
+		{
+			subMesh.m_beginIndex = ReadValue<uint32_t>(&src);
+			subMesh.m_indexCount = ReadValue<uint32_t>(&src);
+			subMesh.m_materialID = ReadValue<int32_t>(&src);
+			if (uint64_t(subMesh.m_beginIndex) + subMesh.m_indexCount > indexCount)
+			{
+				return false;
+			}
+		}
+
+		const uint8_t* strings = src + PointCacheMaterialSize * materialCount;
+		mesh.m_materials.resize(materialCount);
+		for (auto& mat : mesh.m_materials)
+		{
+			uint32_t nameOffset = ReadValue<uint32_t>(&src);
+			uint32_t nameLength = ReadValue<uint32_t>(&src);
+			uint32_t textureOffset = ReadValue<uint32_t>(&src);
+			uint32_t textureLength = ReadValue<uint32_t>(&src);
+			if (uint64_t(nameOffset) + nameLength > stringSize ||
+				uint64_t(textureOffset) + textureLength > stringSize)
+			{
+				return false;
+			}
+			mat.m_name.assign((const char*)strings + nameOffset, nameLength);
+			mat.m_texture.assign((const char*)strings + textureOffset, textureLength);
+			mat.m_diffuse = ReadValue<glm::vec4>(&src);
+			mat.m_specular = ReadValue<glm::vec3>(&src);
+			mat.m_specularPower = ReadValue<float>(&src);
+			mat.m_ambient = ReadValue<glm::vec3>(&src);
+		}
+
+		m_mesh = std::move(mesh);
+		m_flags = flags;
+		m_frameCount = frameCount;
+		m_startFrame = startFrame;
+		m_frameStep = frameStep;
+		m_frameOffset = size_t(frameOffset);
+		m_frameStride = size_t(frameStride);
+		return true;
+	}
+
+	bool PointCache::OpenPC2()
+	{
+		const size_t fileSize = m_file.GetSize();
+		if (fileSize < PC2HeaderSize)
+		{
+			return false;
+		}
+
+		const uint8_t* src = m_file.GetData() + sizeof(PC2Magic);
+		int32_t version = ReadValue<int32_t>(&src);
+		int32_t numPoints = ReadValue<int32_t>(&src);
+		float startFrame = ReadValue<float>(&src);
+		float sampleRate = ReadValue<float>(&src);
+		int32_t numSamples = ReadValue<int32_t>(&src);
+		if (version != PC2Version || numPoints < 0 || numSamples < 0)
+		{
+			return false;
+		}
+
+		uint64_t frameStride = uint64_t(sizeof(glm::vec3)) * numPoints;
+		if (PC2HeaderSize + frameStride * numSamples > fileSize)
+		{
+			return false;
+		}
+
+		m_mesh = PointCacheMesh();
+		m_mesh.m_vertexCount = size_t(numPoints);
+		m_flags = 0;
+		m_frameCount = size_t(numSamples);
+		m_startFrame = startFrame;
+		m_frameStep = sampleRate;
+		m_frameOffset = PC2HeaderSize;
+		m_frameStride = size_t(frameStride);
+		return true;
+	}
+
+	void PointCache::Close()
+	{
+		m_file.Close();
+		m_mesh = PointCacheMesh();
+		m_flags = 0;
+		m_frameCount = 0;
+		m_startFrame = 0.0f;
+		m_frameStep = 1.0f;
+		m_frameOffset = 0;
+		m_frameStride = 0;
+	}
+
+	const uint8_t * PointCache::GetFrameData(size_t frame) const
+	{
+		if (frame >= m_frameCount)
+		{
+			return nullptr;
+		}
+		return m_file.GetData() + m_frameOffset + m_frameStride * frame;
+	}
+
+	bool PointCache::ReadFrame(size_t frame, glm::vec3 * positions, glm::vec3 * normals) const
+	{
+		const uint8_t* src = GetFrameData(frame);
+		if (src == nullptr)
+		{
+			return false;
+		}
+
+		const size_t vertexCount = m_mesh.m_vertexCount;
+		if ((m_flags & PointCacheFlags::Quantize) != 0)
+		{
+			glm::vec3 bboxMin = ReadValue<glm::vec3>(&src);
+			glm::vec3 scale = ReadValue<glm::vec3>(&src);
+			for (size_t i = 0; i < vertexCount; i++)
+			{
+				glm::vec3 q;
+				for (int j = 0; j < 3; j++)
+				{
+					q[j] = float(ReadValue<uint16_t>(&src));
+				}
+				positions[i] = bboxMin + q * scale;
+			}
+			if (HasNormal() && normals != nullptr)
+			{
+				for (size_t i = 0; i < vertexCount; i++)
+				{
+					glm::vec3 n;
+					for (int j = 0; j < 3; j++)
+					{
+						n[j] = float(ReadValue<int16_t>(&src)) / 32767.0f;
+					}
+					normals[i] = n;
+				}
+			}
+		}
+		else
+		{
+			std::memcpy(positions, src, sizeof(glm::vec3) * vertexCount);
+			if (HasNormal() && normals != nullptr)
+			{
+				std::memcpy(normals, src + sizeof(glm::vec3) * vertexCount, sizeof(glm::vec3) * vertexCount);
+			}
+		}
+		return true;
+	}
+
+	const glm::vec3 * PointCache::GetFramePositions(size_t frame) const
+	{
+		if ((m_flags & PointCacheFlags::Quantize) != 0)
+		{
+			return nullptr;
+		}
+		return reinterpret_cast<const glm::vec3*>(GetFrameData(frame));
+	}
+
+	const glm::vec3 * PointCache::GetFrameNormals(size_t frame) const
+	{
+		if ((m_flags & PointCacheFlags::Quantize) != 0 || !HasNormal())
+		{
+			return nullptr;
+		}
+		const uint8_t* data = GetFrameData(frame);
+		if (data == nullptr)
+		{
+			return nullptr;
+		}
+		return reinterpret_cast<const glm::vec3*>(data + sizeof(glm::vec3) * m_mesh.m_vertexCount);
+	}
+}
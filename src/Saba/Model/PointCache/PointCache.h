@@ -0,0 +1,151 @@
+﻿//
+// Copyright(c) 2016-2017 benikabocha.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+//
+
+#ifndef SABA_MODEL_POINTCACHE_POINTCACHE_H_
+#define SABA_MODEL_POINTCACHE_POINTCACHE_H_
+
+#include <Saba/Base/File.h>
+
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+namespace saba
+{
+	/*
+	頂点アニメーションのキャッシュ
+
+	Saba 形式 (.spc)
+	トポロジー、UV、マテリアルは先頭に一度だけ保存し、
+	サンプル (フレーム) ごとに位置と法線を保存する。
+	時間は PC2 と同じく開始フレームとサンプル間のフレーム数で表す。
+	フレームは固定長なので、MappedFile で任意のフレームを直接参照できる。
+	Quantize を指定すると、位置はフレームの AABB で 16bit に、法線は 16bit snorm に量子化する。
+
+	PC2 形式 (.pc2)
+	位置のみ。3ds Max / Blender などで読み込める。
+	*/
+	struct PointCacheSubMesh
+	{
+		uint32_t	m_beginIndex;
+		uint32_t	m_indexCount;
+		int32_t		m_materialID;
+	};
+
+	struct PointCacheMaterial
+	{
+		std::string	m_name;
+		glm::vec4	m_diffuse;
+		glm::vec3	m_specular;
+		float		m_specularPower;
+		glm::vec3	m_ambient;
+		std::string	m_texture;
+	};
+
+	struct PointCacheMesh
+	{
+		size_t								m_vertexCount = 0;
+		std::vector<uint32_t>				m_indices;
+		std::vector<glm::vec2>				m_uvs;
+		std::vector<PointCacheSubMesh>		m_subMeshes;
+		std::vector<PointCacheMaterial>		m_materials;
+	};
+
+	struct PointCacheFlags
+	{
+		enum
+		{
+			Normal = 0x01,
+			Quantize = 0x02,
+		};
+	};
+
+	class PointCacheWriter
+	{
+	public:
+		PointCacheWriter();
+		~PointCacheWriter();
+
+		PointCacheWriter(const PointCacheWriter&) = delete;
+		PointCacheWriter& operator = (const PointCacheWriter&) = delete;
+
+		// flags : PointCacheFlags
+		// frameStep : サンプル間のフレーム数 (PC2 の sampleRate)
+		bool Create(const char* filename, const PointCacheMesh& mesh, uint32_t flags, float startFrame, float frameStep);
+		bool CreatePC2(const char* filename, size_t vertexCount, float startFrame, float frameStep);
+
+		// normals は Normal フラグが無い場合は無視する (nullptr 可)
+		bool WriteFrame(const glm::vec3* positions, const glm::vec3* normals);
+
+		// フレーム数をヘッダーに書き込んで閉じる
+		bool Close();
+
+		size_t GetFrameCount() const { return m_frameCount; }
+
+	private:
+		bool WriteQuantizedFrame(const glm::vec3* positions, const glm::vec3* normals);
+
+	private:
+		File		m_file;
+		bool		m_pc2;
+		uint32_t	m_flags;
+		size_t		m_vertexCount;
+		size_t		m_frameCount;
+		File::Offset	m_frameCountOffset;
+		std::vector<uint8_t>	m_frameBuffer;
+	};
+
+	class PointCache
+	{
+	public:
+		PointCache();
+		~PointCache();
+
+		PointCache(const PointCache&) = delete;
+		PointCache& operator = (const PointCache&) = delete;
+
+		// Saba 形式と PC2 形式を読み込める
+		bool Open(const char* filename);
+		bool Open(const std::string& filename) { return Open(filename.c_str()); }
+		void Close();
+
+		// PC2 形式の場合、トポロジーとマテリアルは空
+		const PointCacheMesh& GetMesh() const { return m_mesh; }
+		size_t GetVertexCount() const { return m_mesh.m_vertexCount; }
+		size_t GetFrameCount() const { return m_frameCount; }
+		float GetStartFrame() const { return m_startFrame; }
+		float GetFrameStep() const { return m_frameStep; }
+		uint32_t GetFlags() const { return m_flags; }
+		bool HasNormal() const { return (m_flags & PointCacheFlags::Normal) != 0; }
+
+		// frame の位置と法線を展開する (normals は nullptr 可)
+		bool ReadFrame(size_t frame, glm::vec3* positions, glm::vec3* normals) const;
+
+		// 量子化していない場合はファイルの内容を直接参照できる (それ以外は nullptr)
+		const glm::vec3* GetFramePositions(size_t frame) const;
+		const glm::vec3* GetFrameNormals(size_t frame) const;
+
+	private:
+		bool OpenSaba();
+		bool OpenPC2();
+		const uint8_t* GetFrameData(size_t frame) const;
+
+	private:
+		MappedFile		m_file;
+		PointCacheMesh	m_mesh;
+		uint32_t		m_flags;
+		size_t			m_frameCount;
+		float			m_startFrame;
+		float			m_frameStep;
+		size_t			m_frameOffset;
+		size_t			m_frameStride;
+	};
+}
+
+#endif // !SABA_MODEL_POINTCACHE_POINTCACHE_H_
@@ -0,0 +1,455 @@
+﻿//
+// Copyright(c) 2016-2017 benikabocha.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+//
+
+#include "GLTextureCache.h"
+
+#include <Saba/Base/Path.h>
+#include <Saba/Base/Log.h>
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+namespace saba
+{
+	namespace
+	{
+		// 予算を超えていてもこれより小さくはしない
+		const int MinResolutionLimit = 256;
+	}
+
+	GLTextureCache::GLTextureCache()
+		: m_uploader(nullptr)
+		, m_budget(0)
+		, m_maxSize(0)
+		, m_resolutionLimit(0)
+	{
+	}
+
+	std::string GLTextureCache::MakeKey(const std::string& filename, bool genMipMap, bool rgba)
+	{
+		return PathUtil::Normalize(filename) + ":" +
+			std::to_string(genMipMap) + ":" +
+			std::to_string(rgba);
+	}
+
+	std::string GLTextureCache::MakeKey(const Request& request)
+	{
+		return MakeKey(request.m_filename, request.m_genMipMap, request.m_rgba);
+	}
+
+	GLTextureRef GLTextureCache::Get(const std::string& filename, bool genMipMap, bool rgba)
+	{
+		Request request;
+		request.m_filename = filename;
+		request.m_genMipMap = genMipMap;
+		request.m_rgba = rgba;
+		return Get(std::vector<Request>{ request })[0];
+	}
+
+	std::vector<GLTextureRef> GLTextureCache::Get(const std::vector<Request>& requests)
+	{
+		std::vector<GLTextureRef> textures(requests.size());
+		std::vector<std::string> keys(requests.size());
+		std::vector<bool> skip(requests.size(), true);
+		std::map<std::string, size_t> decodeKeys;
+		for (size_t i = 0; i < requests.size(); i++)
+		{
+			keys[i] = MakeKey(requests[i]);
+			textures[i] = Find(keys[i]);
+			if (textures[i] == 0 && decodeKeys.find(keys[i]) == decodeKeys.end())
+			{
+				decodeKeys.emplace(keys[i], i);
+				skip[i] = false;
+			}
+		}
+		if (decodeKeys.empty())
+		{
+			return textures;
+		}
+
+		std::vector<TextureImage> images;
+		Decode(&images, requests, &skip);
+		for (size_t i = 0; i < requests.size(); i++)
+		{
+			if (textures[i] != 0)
+			{
+				continue;
+			}
+			if (!skip[i])
+			{
+				SABA_INFO("LoadTexture: [{}]", requests[i].m_filename);
+				if (images[i].m_format != TextureImage::Format::Unknown)
+				{
+					textures[i] = Add(requests[i], std::move(images[i]));
+				}
+			}
+			else
+			{
+				textures[i] = textures[decodeKeys[keys[i]]];
+			}
+		}
+
+		return textures;
+	}
+
+	GLTextureRef GLTextureCache::Find(const std::string& key) const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		auto findIt = m_textures.find(key);
+		if (findIt == m_textures.end())
+		{
+			return GLTextureRef();
+		}
+		return (*findIt).second.m_texture;
+	}
+
+	bool GLTextureCache::Contains(const std::string& key) const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_textures.find(key) != m_textures.end();
+	}
+
+	GLTextureRef GLTextureCache::Add(const Request& request, TextureImage&& image)
+	{
+		Entry entry;
+		entry.m_request = request;
+		entry.m_format = image.m_format;
+		entry.m_width = image.m_width;
+		entry.m_height = image.m_height;
+		entry.m_sourceWidth = image.m_sourceWidth;
+		entry.m_sourceHeight = image.m_sourceHeight;
+		entry.m_bytes = CalcTextureImageBytes(image, request.m_genMipMap);
+
+		GLTextureRef texRef;
+		if (m_uploader != nullptr)
+		{
+			texRef = m_uploader->Upload(std::move(image), request.m_genMipMap);
+		}
+		else
+		{
+			auto tex = CreateTextureFromImage(image, request.m_genMipMap);
+			texRef = std::move(tex);
+		}
+		if (texRef == 0)
+		{
+			return texRef;
+		}
+		entry.m_texture = texRef;
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_textures[MakeKey(request)] = std::move(entry);
+		return texRef;
+	}
+
+	size_t GLTextureCache::Collect()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		size_t count = 0;
+		for (auto it = m_textures.begin(); it != m_textures.end();)
+		{
+			if ((*it).second.m_texture.GetRefCount() <= 1)
+			{
+				it = m_textures.erase(it);
+				count++;
+			}
+			else
+			{
+				++it;
+			}
+		}
+		return count;
+	}
+
+	void GLTextureCache::Clear()
+	{
+		if (m_streamFuture.valid())
+		{
+			m_streamFuture.wait();
+			m_streamFuture = std::future<StreamResult>();
+		}
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_textures.clear();
+	}
+
+	size_t GLTextureCache::GetCount() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_textures.size();
+	}
+
+	void GLTextureCache::Decode(
+		std::vector<TextureImage>* images,
+		const std::vector<Request>& requests,
+		const std::vector<bool>* skip,
+		std::atomic<int>* decodedCount
+	) const
+	{
+		images->clear();
+		images->resize(requests.size());
+
+		std::atomic<size_t> nextIndex(0);
+		auto decodeFunc = [&]()
+		{
+			size_t i;
+			while ((i = nextIndex++) < requests.size())
+			{
+				if (skip == nullptr || !(*skip)[i])
+				{
+					const auto& request = requests[i];
+					m_diskCache.Decode(&(*images)[i], request.m_filename, request.m_genMipMap, request.m_rgba, m_resolutionLimit);
+				}
+				if (decodedCount != nullptr)
+				{
+					(*decodedCount)++;
+				}
+			}
+		};
+
+		size_t threadCount = std::max(size_t(std::thread::hardware_concurrency()), size_t(1));
+		threadCount = std::min(threadCount, requests.size());
+		std::vector<std::future<void>> futures;
+		for (size_t i = 1; i < threadCount; i++)
+		{
+			futures.emplace_back(std::async(std::launch::async, decodeFunc));
+		}
+		decodeFunc();
+		for (auto& future : futures)
+		{
+			future.wait();
+		}
+	}
+
+	void GLTextureCache::Update()
+	{
+		if (m_streamFuture.valid())
+		{
+			if (m_streamFuture.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+			{
+				return;
+			}
+			FinishStream(m_streamFuture.get());
+		}
+
+		const int limit = CalcResolutionLimit();
+		m_resolutionLimit = limit;
+
+		// 転送中のテクスチャは置き換えない
+		if (m_uploader != nullptr && m_uploader->GetPendingCount() != 0)
+		{
+			return;
+		}
+
+		// 使用量の差が最も大きいものから 1 枚ずつ読み込み直す
+		std::string targetKey;
+		Request targetRequest;
+		size_t targetDiff = 0;
+		for (const auto& it : m_textures)
+		{
+			const auto& entry = it.second;
+			if (!IsStreamable(entry) || entry.m_texture.GetRefCount() <= 1)
+			{
+				continue;
+			}
+			int width, height;
+			CalcLimitedSize(entry, limit, &width, &height);
+			if (width == entry.m_width && height == entry.m_height)
+			{
+				continue;
+			}
+			size_t bytes = CalcTextureBytes(entry.m_format, width, height, entry.m_request.m_genMipMap);
+			size_t diff = bytes > entry.m_bytes ? bytes - entry.m_bytes : entry.m_bytes - bytes;
+			if (targetKey.empty() || diff > targetDiff)
+			{
+				targetKey = it.first;
+				targetRequest = entry.m_request;
+				targetDiff = diff;
+			}
+		}
+		if (targetKey.empty())
+		{
+			return;
+		}
+
+		m_streamFuture = std::async(std::launch::async, [targetKey, targetRequest, limit]()
+		{
+			StreamResult result;
+			result.m_key = targetKey;
+			if (DecodeTextureFromFile(&result.m_image, targetRequest.m_filename, targetRequest.m_rgba))
+			{
+				DownscaleTextureImage(&result.m_image, limit);
+			}
+			return result;
+		});
+	}
+
+	size_t GLTextureCache::GetTotalBytes() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		size_t bytes = 0;
+		for (const auto& it : m_textures)
+		{
+			bytes += it.second.m_bytes;
+		}
+		return bytes;
+	}
+
+	size_t GLTextureCache::GetTextureBytes(GLuint tex) const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		for (const auto& it : m_textures)
+		{
+			if (it.second.m_texture.Get() == tex)
+			{
+				return it.second.m_bytes;
+			}
+		}
+		return 0;
+	}
+
+	std::vector<GLTextureCache::TextureInfo> GLTextureCache::GetTextureInfos() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		std::vector<TextureInfo> infos;
+		infos.reserve(m_textures.size());
+		for (const auto& it : m_textures)
+		{
+			const auto& entry = it.second;
+			TextureInfo info;
+			info.m_filename = entry.m_request.m_filename;
+			info.m_width = entry.m_width;
+			info.m_height = entry.m_height;
+			info.m_sourceWidth = entry.m_sourceWidth;
+			info.m_sourceHeight = entry.m_sourceHeight;
+			info.m_bytes = entry.m_bytes;
+			info.m_refCount = entry.m_texture.GetRefCount() - 1;
+			infos.emplace_back(std::move(info));
+		}
+		return infos;
+	}
+
+	bool GLTextureCache::IsStreamable(const Entry& entry)
+	{
+		return entry.m_format != TextureImage::Format::DDS &&
+			entry.m_sourceWidth > 0 && entry.m_sourceHeight > 0;
+	}
+
+	void GLTextureCache::CalcLimitedSize(const Entry& entry, int limit, int* width, int* height)
+	{
+		// DownscaleTextureImage と同じ手順で縮小後のサイズを求める
+		int w = entry.m_sourceWidth;
+		int h = entry.m_sourceHeight;
+		if (limit > 0)
+		{
+			while (w > limit || h > limit)
+			{
+				w = std::max(w / 2, 1);
+				h = std::max(h / 2, 1);
+			}
+		}
+		*width = w;
+		*height = h;
+	}
+
+	size_t GLTextureCache::CalcTotalBytes(int limit) const
+	{
+		size_t bytes = 0;
+		for (const auto& it : m_textures)
+		{
+			const auto& entry = it.second;
+			if (IsStreamable(entry))
+			{
+				int width, height;
+				CalcLimitedSize(entry, limit, &width, &height);
+				bytes += CalcTextureBytes(entry.m_format, width, height, entry.m_request.m_genMipMap);
+			}
+			else
+			{
+				bytes += entry.m_bytes;
+			}
+		}
+		return bytes;
+	}
+
+	int GLTextureCache::CalcResolutionLimit() const
+	{
+		if (m_budget == 0)
+		{
+			return m_maxSize;
+		}
+
+		int limit = m_maxSize;
+		if (CalcTotalBytes(limit) > m_budget)
+		{
+			int maxSourceSize = 1;
+			for (const auto& it : m_textures)
+			{
+				if (IsStreamable(it.second))
+				{
+					maxSourceSize = std::max(maxSourceSize, std::max(it.second.m_sourceWidth, it.second.m_sourceHeight));
+				}
+			}
+			limit = 1;
+			while (limit < maxSourceSize)
+			{
+				limit *= 2;
+			}
+			if (m_maxSize > 0)
+			{
+				limit = std::min(limit, m_maxSize);
+			}
+			while (limit > MinResolutionLimit && CalcTotalBytes(limit) > m_budget)
+			{
+				limit /= 2;
+			}
+		}
+
+		// 上限を上げるのは予算の 9 割に収まる場合のみ (縮小と復元を繰り返さないように)
+		const int current = m_resolutionLimit;
+		if (current != 0 && (limit == 0 || limit > current))
+		{
+			if (CalcTotalBytes(limit) > m_budget / 10 * 9)
+			{
+				return current;
+			}
+		}
+		return limit;
+	}
+
+	void GLTextureCache::FinishStream(StreamResult&& result)
+	{
+		auto findIt = m_textures.find(result.m_key);
+		if (findIt == m_textures.end())
+		{
+			return;
+		}
+
+		auto& entry = (*findIt).second;
+		const auto& image = result.m_image;
+		bool successed = image.m_format == entry.m_format;
+		if (successed)
+		{
+			successed = LoadTextureFromImage(entry.m_texture, image, entry.m_request.m_genMipMap);
+			glBindTexture(GL_TEXTURE_2D, 0);
+		}
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (!successed)
+		{
+			// 以降は読み込み直さない
+			SABA_WARN("TextureCache: Failed to reload. [{}]", entry.m_request.m_filename);
+			entry.m_sourceWidth = 0;
+			entry.m_sourceHeight = 0;
+			return;
+		}
+		SABA_INFO("TextureCache: Reload [{}] {}x{}", entry.m_request.m_filename, image.m_width, image.m_height);
+		entry.m_width = image.m_width;
+		entry.m_height = image.m_height;
+		entry.m_sourceWidth = image.m_sourceWidth;
+		entry.m_sourceHeight = image.m_sourceHeight;
+		entry.m_bytes = CalcTextureImageBytes(image, entry.m_request.m_genMipMap);
+	}
+}
@@ -0,0 +1,151 @@
+﻿//
+// Copyright(c) 2016-2017 benikabocha.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+//
+
+#ifndef SABA_GL_TEXTURECACHE_H_
+#define SABA_GL_TEXTURECACHE_H_
+
+#include "GLObject.h"
+#include "GLTextureUtil.h"
+#include "GLTextureDiskCache.h"
+#include "GLTextureUploader.h"
+
+#include <atomic>
+#include <future>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace saba
+{
+	/*
+	複数のモデルで同じテクスチャを共有するためのキャッシュ。
+	正規化したパスと読み込みオプションをキーにして GLTextureRef を保持する。
+	Find, Add, Get, Collect, Update は GL スレッドから、Contains, Decode は任意のスレッドから呼び出せる。
+
+	予算 (バイト数) を設定すると、全テクスチャが予算に収まるように解像度の上限を決め、
+	Update で 1 枚ずつ縮小したテクスチャに読み込み直す (予算に余裕ができれば元に戻す)。
+	以降に読み込むテクスチャは最初からその上限で縮小される。
+	DDS は縮小できないため、使用量としてのみ扱う。
+	*/
+	class GLTextureCache
+	{
+	public:
+		struct Request
+		{
+			std::string	m_filename;
+			bool		m_genMipMap = true;
+			bool		m_rgba = false;
+		};
+
+		struct TextureInfo
+		{
+			std::string	m_filename;
+			int			m_width;
+			int			m_height;
+			int			m_sourceWidth;	//!< 縮小前の幅 (DDS は 0)
+			int			m_sourceHeight;	//!< 縮小前の高さ (DDS は 0)
+			size_t		m_bytes;
+			int			m_refCount;		//!< キャッシュ以外からの参照数
+		};
+
+		GLTextureCache();
+		GLTextureCache(const GLTextureCache&) = delete;
+		GLTextureCache& operator = (const GLTextureCache&) = delete;
+
+		static std::string MakeKey(const std::string& filename, bool genMipMap, bool rgba);
+		static std::string MakeKey(const Request& request);
+
+		// 読み込み済みであれば共有し、なければ読み込む
+		GLTextureRef Get(const std::string& filename, bool genMipMap = true, bool rgba = false);
+		// 読み込まれていないテクスチャを並列にデコードしてから転送する
+		std::vector<GLTextureRef> Get(const std::vector<Request>& requests);
+
+		GLTextureRef Find(const std::string& key) const;
+		bool Contains(const std::string& key) const;
+		// デコード済みのデータを転送して登録する
+		GLTextureRef Add(const Request& request, TextureImage&& image);
+
+		// 設定されている場合、転送は uploader を経由して少しずつ行う
+		void SetUploader(GLTextureUploader* uploader) { m_uploader = uploader; }
+
+		// デコード結果を DDS として保存するディスクキャッシュ (既定では無効)
+		GLTextureDiskCache* GetDiskCache() { return &m_diskCache; }
+		const GLTextureDiskCache* GetDiskCache() const { return &m_diskCache; }
+
+		// キャッシュ以外から参照されていないテクスチャを破棄する
+		size_t Collect();
+		void Clear();
+		size_t GetCount() const;
+
+		// 0 の場合は制限しない
+		void SetBudget(size_t bytes) { m_budget = bytes; }
+		size_t GetBudget() const { return m_budget; }
+		// 予算に関係なく適用する解像度の上限 (0 の場合は制限しない)
+		void SetMaxSize(int size) { m_maxSize = size; }
+		int GetMaxSize() const { return m_maxSize; }
+		// 現在の解像度の上限 (0 の場合は制限なし)
+		int GetResolutionLimit() const { return m_resolutionLimit; }
+
+		// 予算に合わせてテクスチャを縮小、または元の解像度に戻す (毎フレーム呼び出す)
+		void Update();
+
+		size_t GetTotalBytes() const;
+		// キャッシュに登録されていないテクスチャは 0
+		size_t GetTextureBytes(GLuint tex) const;
+		std::vector<TextureInfo> GetTextureInfos() const;
+
+		/*
+		requests を並列にデコードする。
+		skip[i] が true のものと失敗したものは Unknown のまま残る。
+		ディスクキャッシュが有効な場合はキャッシュの DDS を読み込む。
+		*/
+		void Decode(
+			std::vector<TextureImage>* images,
+			const std::vector<Request>& requests,
+			const std::vector<bool>* skip = nullptr,
+			std::atomic<int>* decodedCount = nullptr
+		) const;
+
+	private:
+		struct Entry
+		{
+			GLTextureRef	m_texture;
+			Request			m_request;
+			TextureImage::Format	m_format;
+			int				m_width;
+			int				m_height;
+			int				m_sourceWidth;
+			int				m_sourceHeight;
+			size_t			m_bytes;
+		};
+
+		struct StreamResult
+		{
+			std::string		m_key;
+			TextureImage	m_image;
+		};
+
+		// 縮小して読み込み直すことができるか
+		static bool IsStreamable(const Entry& entry);
+		static void CalcLimitedSize(const Entry& entry, int limit, int* width, int* height);
+		size_t CalcTotalBytes(int limit) const;
+		int CalcResolutionLimit() const;
+		void FinishStream(StreamResult&& result);
+
+	private:
+		mutable std::mutex				m_mutex;
+		std::map<std::string, Entry>	m_textures;
+		GLTextureUploader*				m_uploader;
+		GLTextureDiskCache				m_diskCache;
+
+		size_t							m_budget;
+		int								m_maxSize;
+		std::atomic<int>				m_resolutionLimit;
+		std::future<StreamResult>		m_streamFuture;
+	};
+}
+
+#endif // !SABA_GL_TEXTURECACHE_H_
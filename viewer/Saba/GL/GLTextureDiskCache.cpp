@@ -0,0 +1,458 @@
+﻿//
+// Copyright(c) 2016-2017 benikabocha.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+//
+
+#include "GLTextureDiskCache.h"
+
+#include <Saba/Base/File.h>
+#include <Saba/Base/Path.h>
+#include <Saba/Base/Log.h>
+
+#define STB_DXT_IMPLEMENTATION
+#include <stb_dxt.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+
+namespace saba
+{
+	namespace
+	{
+		// キャッシュの形式を変更した場合は更新する
+		const uint32_t DiskCacheVersion = 1;
+
+		const uint32_t DDSMagic = 0x20534444;	// "DDS "
+
+		const uint32_t DDSD_CAPS = 0x00000001;
+		const uint32_t DDSD_HEIGHT = 0x00000002;
+		const uint32_t DDSD_WIDTH = 0x00000004;
+		const uint32_t DDSD_PITCH = 0x00000008;
+		const uint32_t DDSD_PIXELFORMAT = 0x00001000;
+		const uint32_t DDSD_MIPMAPCOUNT = 0x00020000;
+		const uint32_t DDSD_LINEARSIZE = 0x00080000;
+
+		const uint32_t DDPF_ALPHAPIXELS = 0x00000001;
+		const uint32_t DDPF_FOURCC = 0x00000004;
+		const uint32_t DDPF_RGB = 0x00000040;
+
+		const uint32_t DDSCAPS_COMPLEX = 0x00000008;
+		const uint32_t DDSCAPS_TEXTURE = 0x00001000;
+		const uint32_t DDSCAPS_MIPMAP = 0x00400000;
+
+		struct DDSPixelFormat
+		{
+			uint32_t	m_size;
+			uint32_t	m_flags;
+			uint32_t	m_fourCC;
+			uint32_t	m_bitCount;
+			uint32_t	m_RBitMask;
+			uint32_t	m_GBitMask;
+			uint32_t	m_BBitMask;
+			uint32_t	m_ABitMask;
+		};
+
+		struct DDSHeader
+		{
+			uint32_t		m_size;
+			uint32_t		m_flags;
+			uint32_t		m_height;
+			uint32_t		m_width;
+			uint32_t		m_pitchOrLinearSize;
+			uint32_t		m_depth;
+			uint32_t		m_mipMapCount;
+			uint32_t		m_reserved1[11];
+			DDSPixelFormat	m_pixelFormat;
+			uint32_t		m_caps;
+			uint32_t		m_caps2;
+			uint32_t		m_caps3;
+			uint32_t		m_caps4;
+			uint32_t		m_reserved2;
+		};
+		static_assert(sizeof(DDSPixelFormat) == 32, "DDSPixelFormat size must be 32 bytes.");
+		static_assert(sizeof(DDSHeader) == 124, "DDSHeader size must be 124 bytes.");
+
+		uint32_t MakeFourCC(char ch0, char ch1, char ch2, char ch3)
+		{
+			return uint32_t(uint8_t(ch0)) |
+				(uint32_t(uint8_t(ch1)) << 8) |
+				(uint32_t(uint8_t(ch2)) << 16) |
+				(uint32_t(uint8_t(ch3)) << 24);
+		}
+
+		struct MipLevel
+		{
+			int						m_width;
+			int						m_height;
+			std::vector<uint8_t>	m_rgba;		// 上から下の行順
+		};
+
+		// stb のデコード結果 (下から上の行順) を上から下の行順の RGBA8 にする
+		void MakeBaseLevel(MipLevel* level, const TextureImage& image)
+		{
+			const int comp = image.m_format == TextureImage::Format::RGBA8 ? 4 : 3;
+			level->m_width = image.m_width;
+			level->m_height = image.m_height;
+			level->m_rgba.resize(size_t(image.m_width) * image.m_height * 4);
+			for (int y = 0; y < image.m_height; y++)
+			{
+				const uint8_t* src = &image.m_data[size_t(image.m_height - 1 - y) * image.m_width * comp];
+				uint8_t* dst = &level->m_rgba[size_t(y) * image.m_width * 4];
+				for (int x = 0; x < image.m_width; x++)
+				{
+					dst[0] = src[0];
+					dst[1] = src[1];
+					dst[2] = src[2];
+					dst[3] = comp == 4 ? src[3] : 255;
+					src += comp;
+					dst += 4;
+				}
+			}
+		}
+
+		// 2x2 の平均で 1 段小さいミップマップを作る
+		void MakeNextLevel(MipLevel* dst, const MipLevel& src)
+		{
+			dst->m_width = std::max(src.m_width / 2, 1);
+			dst->m_height = std::max(src.m_height / 2, 1);
+			dst->m_rgba.resize(size_t(dst->m_width) * dst->m_height * 4);
+			for (int y = 0; y < dst->m_height; y++)
+			{
+				const int y0 = std::min(y * 2, src.m_height - 1);
+				const int y1 = std::min(y * 2 + 1, src.m_height - 1);
+				for (int x = 0; x < dst->m_width; x++)
+				{
+					const int x0 = std::min(x * 2, src.m_width - 1);
+					const int x1 = std::min(x * 2 + 1, src.m_width - 1);
+					const uint8_t* p00 = &src.m_rgba[(size_t(y0) * src.m_width + x0) * 4];
+					const uint8_t* p01 = &src.m_rgba[(size_t(y0) * src.m_width + x1) * 4];
+					const uint8_t* p10 = &src.m_rgba[(size_t(y1) * src.m_width + x0) * 4];
+					const uint8_t* p11 = &src.m_rgba[(size_t(y1) * src.m_width + x1) * 4];
+					uint8_t* d = &dst->m_rgba[(size_t(y) * dst->m_width + x) * 4];
+					for (int c = 0; c < 4; c++)
+					{
+						d[c] = uint8_t((p00[c] + p01[c] + p10[c] + p11[c] + 2) / 4);
+					}
+				}
+			}
+		}
+
+		// 4x4 ブロック単位で BC1 / BC3 に圧縮する (端のブロックは端の画素で埋める)
+		void CompressBC(std::vector<uint8_t>* out, const MipLevel& level, bool alpha)
+		{
+			const int blockW = (level.m_width + 3) / 4;
+			const int blockH = (level.m_height + 3) / 4;
+			const size_t blockSize = alpha ? 16 : 8;
+			size_t offset = out->size();
+			out->resize(offset + size_t(blockW) * blockH * blockSize);
+
+			uint8_t block[4 * 4 * 4];
+			for (int by = 0; by < blockH; by++)
+			{
+				for (int bx = 0; bx < blockW; bx++)
+				{
+					for (int y = 0; y < 4; y++)
+					{
+						const int sy = std::min(by * 4 + y, level.m_height - 1);
+						for (int x = 0; x < 4; x++)
+						{
+							const int sx = std::min(bx * 4 + x, level.m_width - 1);
+							memcpy(&block[(y * 4 + x) * 4], &level.m_rgba[(size_t(sy) * level.m_width + sx) * 4], 4);
+						}
+					}
+					stb_compress_dxt_block(&(*out)[offset], block, alpha ? 1 : 0, STB_DXT_HIGHQUAL);
+					offset += blockSize;
+				}
+			}
+		}
+
+		void AppendUncompressed(std::vector<uint8_t>* out, const MipLevel& level, bool alpha)
+		{
+			size_t offset = out->size();
+			out->resize(offset + level.m_rgba.size());
+			if (alpha)
+			{
+				memcpy(&(*out)[offset], level.m_rgba.data(), level.m_rgba.size());
+			}
+			else
+			{
+				// BGRX
+				for (size_t i = 0; i < level.m_rgba.size(); i += 4)
+				{
+					(*out)[offset + i + 0] = level.m_rgba[i + 2];
+					(*out)[offset + i + 1] = level.m_rgba[i + 1];
+					(*out)[offset + i + 2] = level.m_rgba[i + 0];
+					(*out)[offset + i + 3] = 255;
+				}
+			}
+		}
+
+		bool WriteCacheFile(const std::string& cachePath, const std::vector<uint8_t>& data)
+		{
+			// 他のスレッドが書き込み途中のファイルを読まないように、一時ファイルに書いてから置き換える
+			std::stringstream ss;
+			ss << cachePath << "." << std::hash<std::thread::id>()(std::this_thread::get_id()) << ".tmp";
+			const std::string tmpPath = ss.str();
+			{
+				File file;
+				if (!file.Create(tmpPath))
+				{
+					return false;
+				}
+				if (!file.Write(data.data(), data.size()))
+				{
+					file.Close();
+					std::remove(tmpPath.c_str());
+					return false;
+				}
+			}
+			std::remove(cachePath.c_str());
+			if (std::rename(tmpPath.c_str(), cachePath.c_str()) != 0)
+			{
+				std::remove(tmpPath.c_str());
+				return false;
+			}
+			return true;
+		}
+
+		// 記録した内容のハッシュを読み込む (読み込めない場合は 0)
+		uint64_t ReadStampFile(const std::string& stampPath)
+		{
+			File file;
+			uint64_t hash = 0;
+			if (!file.Open(stampPath) || file.GetSize() != File::Offset(sizeof(hash)))
+			{
+				return 0;
+			}
+			if (!file.Read(&hash))
+			{
+				return 0;
+			}
+			return hash;
+		}
+	}
+
+	GLTextureDiskCache::GLTextureDiskCache()
+		: m_compression(Compression::BC)
+	{
+	}
+
+	bool GLTextureDiskCache::Decode(TextureImage* image, const std::string& filename, bool genMipMap, bool rgba, int maxSize) const
+	{
+		uint64_t sourceHash = 0;
+		if (IsEnabled() && PathUtil::GetExt(filename) != "dds")
+		{
+			// パス、サイズ、更新時刻が前回と同じなら、記録しておいた内容のハッシュを使う
+			// (ファイル内容のハッシュはキャッシュにない場合だけ計算する)
+			const std::string stampPath = GetStampPath(filename);
+			if (!stampPath.empty())
+			{
+				sourceHash = ReadStampFile(stampPath);
+			}
+			if (sourceHash == 0)
+			{
+				sourceHash = CalcFileHash(filename);
+				if (sourceHash != 0 && !stampPath.empty())
+				{
+					std::vector<uint8_t> stamp(sizeof(sourceHash));
+					memcpy(stamp.data(), &sourceHash, sizeof(sourceHash));
+					if (!WriteCacheFile(stampPath, stamp))
+					{
+						SABA_WARN("TextureDiskCache: Failed to write stamp. [{}]", stampPath);
+					}
+				}
+			}
+		}
+		if (sourceHash == 0)
+		{
+			if (!DecodeTextureFromFile(image, filename, rgba))
+			{
+				return false;
+			}
+			return DownscaleTextureImage(image, maxSize);
+		}
+
+		const std::string cachePath = GetCachePath(filename, sourceHash, genMipMap, rgba, maxSize);
+		{
+			File file;
+			if (file.Open(cachePath) && file.ReadAll(&image->m_data))
+			{
+				image->m_format = TextureImage::Format::DDS;
+				image->m_width = 0;
+				image->m_height = 0;
+				image->m_opaqueBC1 = true;
+				return true;
+			}
+		}
+
+		if (!DecodeTextureFromFile(image, filename, rgba))
+		{
+			return false;
+		}
+		if (!DownscaleTextureImage(image, maxSize))
+		{
+			return false;
+		}
+		if (image->m_format != TextureImage::Format::RGB8 &&
+			image->m_format != TextureImage::Format::RGBA8)
+		{
+			return true;
+		}
+
+		std::vector<uint8_t> dds;
+		if (!ConvertToDDS(&dds, *image, genMipMap, m_compression))
+		{
+			return true;
+		}
+		if (!WriteCacheFile(cachePath, dds))
+		{
+			SABA_WARN("TextureDiskCache: Failed to write cache. [{}]", cachePath);
+		}
+
+		// 作成した DDS をそのまま使う (ミップマップの生成を GL 側で行わずに済む)
+		image->m_format = TextureImage::Format::DDS;
+		image->m_width = 0;
+		image->m_height = 0;
+		image->m_opaqueBC1 = true;
+		image->m_data = std::move(dds);
+		return true;
+	}
+
+	std::string GLTextureDiskCache::GetCachePath(const std::string& filename, uint64_t sourceHash, bool genMipMap, bool rgba, int maxSize) const
+	{
+		uint64_t options = DiskCacheVersion;
+		options = (options << 1) | (genMipMap ? 1 : 0);
+		options = (options << 1) | (rgba ? 1 : 0);
+		options = (options << 4) | uint64_t(m_compression);
+		uint64_t hash = CombineHash(sourceHash, options);
+		hash = CombineHash(hash, uint64_t(std::max(maxSize, 0)));
+
+		std::stringstream ss;
+		ss << PathUtil::GetFilename(filename) << "."
+			<< std::hex << std::setfill('0') << std::setw(16) << hash
+			<< ".dds";
+		return PathUtil::Combine(m_cacheDir, ss.str());
+	}
+
+	std::string GLTextureDiskCache::GetStampPath(const std::string& filename) const
+	{
+		uint64_t size;
+		uint64_t modifiedTime;
+		if (!GetFileStamp(filename, &size, &modifiedTime))
+		{
+			return "";
+		}
+		uint64_t hash = CombineHash(CalcStringHash(filename), size);
+		hash = CombineHash(hash, modifiedTime);
+		hash = CombineHash(hash, DiskCacheVersion);
+
+		std::stringstream ss;
+		ss << PathUtil::GetFilename(filename) << "."
+			<< std::hex << std::setfill('0') << std::setw(16) << hash
+			<< ".stamp";
+		return PathUtil::Combine(m_cacheDir, ss.str());
+	}
+
+	bool GLTextureDiskCache::ConvertToDDS(
+		std::vector<uint8_t>* dds,
+		const TextureImage& image,
+		bool genMipMap,
+		Compression compression
+	)
+	{
+		if (dds == nullptr)
+		{
+			return false;
+		}
+		if (image.m_format != TextureImage::Format::RGB8 &&
+			image.m_format != TextureImage::Format::RGBA8)
+		{
+			return false;
+		}
+		if (image.m_width <= 0 || image.m_height <= 0)
+		{
+			return false;
+		}
+
+		const bool alpha = image.m_format == TextureImage::Format::RGBA8;
+		const bool bc = compression == Compression::BC;
+
+		std::vector<MipLevel> levels(1);
+		MakeBaseLevel(&levels[0], image);
+		if (genMipMap)
+		{
+			while (levels.back().m_width > 1 || levels.back().m_height > 1)
+			{
+				MipLevel next;
+				MakeNextLevel(&next, levels.back());
+				levels.emplace_back(std::move(next));
+			}
+		}
+
+		DDSHeader header;
+		memset(&header, 0, sizeof(header));
+		header.m_size = sizeof(DDSHeader);
+		header.m_flags = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_MIPMAPCOUNT;
+		header.m_width = uint32_t(image.m_width);
+		header.m_height = uint32_t(image.m_height);
+		header.m_mipMapCount = uint32_t(levels.size());
+		header.m_pixelFormat.m_size = sizeof(DDSPixelFormat);
+		if (bc)
+		{
+			const uint32_t blockSize = alpha ? 16 : 8;
+			header.m_flags |= DDSD_LINEARSIZE;
+			header.m_pitchOrLinearSize = uint32_t((image.m_width + 3) / 4) * uint32_t((image.m_height + 3) / 4) * blockSize;
+			header.m_pixelFormat.m_flags = DDPF_FOURCC;
+			header.m_pixelFormat.m_fourCC = alpha ? MakeFourCC('D', 'X', 'T', '5') : MakeFourCC('D', 'X', 'T', '1');
+		}
+		else
+		{
+			header.m_flags |= DDSD_PITCH;
+			header.m_pitchOrLinearSize = uint32_t(image.m_width) * 4;
+			header.m_pixelFormat.m_flags = DDPF_RGB | (alpha ? DDPF_ALPHAPIXELS : 0);
+			header.m_pixelFormat.m_bitCount = 32;
+			if (alpha)
+			{
+				header.m_pixelFormat.m_RBitMask = 0x000000ff;
+				header.m_pixelFormat.m_GBitMask = 0x0000ff00;
+				header.m_pixelFormat.m_BBitMask = 0x00ff0000;
+				header.m_pixelFormat.m_ABitMask = 0xff000000;
+			}
+			else
+			{
+				header.m_pixelFormat.m_RBitMask = 0x00ff0000;
+				header.m_pixelFormat.m_GBitMask = 0x0000ff00;
+				header.m_pixelFormat.m_BBitMask = 0x000000ff;
+				header.m_pixelFormat.m_ABitMask = 0x00000000;
+			}
+		}
+		header.m_caps = DDSCAPS_TEXTURE;
+		if (levels.size() > 1)
+		{
+			header.m_caps |= DDSCAPS_COMPLEX | DDSCAPS_MIPMAP;
+		}
+
+		dds->clear();
+		dds->resize(sizeof(DDSMagic) + sizeof(DDSHeader));
+		memcpy(&(*dds)[0], &DDSMagic, sizeof(DDSMagic));
+		memcpy(&(*dds)[sizeof(DDSMagic)], &header, sizeof(DDSHeader));
+		for (const auto& level : levels)
+		{
+			if (bc)
+			{
+				CompressBC(dds, level, alpha);
+			}
+			else
+			{
+				AppendUncompressed(dds, level, alpha);
+			}
+		}
+
+		return true;
+	}
+}
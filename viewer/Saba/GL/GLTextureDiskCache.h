@@ -0,0 +1,75 @@
+﻿//
+// Copyright(c) 2016-2017 benikabocha.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+//
+
+#ifndef SABA_GL_TEXTUREDISKCACHE_H_
+#define SABA_GL_TEXTUREDISKCACHE_H_
+
+#include "GLTextureUtil.h"
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace saba
+{
+	/*
+	デコードしたテクスチャをミップマップ付きの DDS に変換して保存するディスクキャッシュ。
+	2 回目以降は DDS をそのまま読み込むので、画像のデコードとミップマップの生成が不要になる。
+	キャッシュはファイル内容のハッシュで識別するため、元の画像が更新されると作り直される。
+	内容のハッシュはパス、サイズ、更新時刻をキーにした stamp ファイルに記録し、
+	これらが変わらない限りファイル全体を読み直さない。
+	BC1 はアルファなしの画像にだけ使うため、DDS はアルファなし (m_opaqueBC1) として返す。
+	Decode は任意のスレッドから呼び出せる (設定の変更は読み込み中に行わないこと)。
+	*/
+	class GLTextureDiskCache
+	{
+	public:
+		enum class Compression
+		{
+			None,	//!< 非圧縮 (RGBA8 / BGRX8)
+			BC,		//!< BC1 (アルファなし) / BC3 (アルファあり)
+		};
+
+		GLTextureDiskCache();
+
+		// 空の場合はキャッシュを使用しない
+		void SetCacheDir(const std::string& dir) { m_cacheDir = dir; }
+		const std::string& GetCacheDir() const { return m_cacheDir; }
+		bool IsEnabled() const { return !m_cacheDir.empty(); }
+
+		void SetCompression(Compression compression) { m_compression = compression; }
+		Compression GetCompression() const { return m_compression; }
+
+		/*
+		キャッシュがあれば DDS を読み込み、なければ画像をデコードしてキャッシュを作成する。
+		HDR 画像と DDS はキャッシュせず、DecodeTextureFromFile と同じ結果を返す。
+		maxSize が 0 以外の場合は、その大きさに収まるように縮小する。
+		*/
+		bool Decode(TextureImage* image, const std::string& filename, bool genMipMap, bool rgba, int maxSize = 0) const;
+
+		std::string GetCachePath(const std::string& filename, uint64_t sourceHash, bool genMipMap, bool rgba, int maxSize) const;
+
+		/*
+		デコード済みの画像 (RGB8 / RGBA8) を DDS に変換する。
+		genMipMap が true の場合は 1x1 までのミップマップを作成する。
+		*/
+		static bool ConvertToDDS(
+			std::vector<uint8_t>* dds,
+			const TextureImage& image,
+			bool genMipMap,
+			Compression compression
+		);
+
+	private:
+		// ファイルが見つからない場合は空文字列を返す
+		std::string GetStampPath(const std::string& filename) const;
+
+	private:
+		std::string	m_cacheDir;
+		Compression	m_compression;
+	};
+}
+
+#endif // !SABA_GL_TEXTUREDISKCACHE_H_
@@ -0,0 +1,322 @@
+﻿//
+// Copyright(c) 2016-2017 benikabocha.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+//
+
+#include "GLTextureUploader.h"
+
+#include <Saba/Base/Log.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace saba
+{
+	namespace
+	{
+		struct PixelFormat
+		{
+			GLint	m_internalFormat;
+			GLenum	m_format;
+			GLenum	m_type;
+			size_t	m_pixelSize;
+			GLint	m_alignment;
+		};
+
+		bool GetPixelFormat(TextureImage::Format format, PixelFormat* outFormat)
+		{
+			switch (format)
+			{
+			case TextureImage::Format::RGB8:
+				*outFormat = PixelFormat{ GL_RGB, GL_RGB, GL_UNSIGNED_BYTE, 3, 1 };
+				return true;
+			case TextureImage::Format::RGBA8:
+				*outFormat = PixelFormat{ GL_RGBA, GL_RGBA, GL_UNSIGNED_BYTE, 4, 4 };
+				return true;
+			case TextureImage::Format::RGB32F:
+				*outFormat = PixelFormat{ GL_RGB32F, GL_RGB, GL_FLOAT, 12, 4 };
+				return true;
+			case TextureImage::Format::RGBA32F:
+				*outFormat = PixelFormat{ GL_RGBA32F, GL_RGBA, GL_FLOAT, 16, 4 };
+				return true;
+			default:
+				return false;
+			}
+		}
+
+		struct CopyCommand
+		{
+			void*			m_dest;
+			const uint8_t*	m_src;
+			size_t			m_size;
+		};
+	}
+
+	GLTextureUploader::GLTextureUploader()
+		: m_slotSize(0)
+		, m_frameBudget(16 * 1024 * 1024)
+		, m_pendingCount(0)
+		, m_pendingBytes(0)
+	{
+	}
+
+	GLTextureUploader::~GLTextureUploader()
+	{
+		Destroy();
+	}
+
+	bool GLTextureUploader::Create(size_t slotCount, size_t slotSize)
+	{
+		Destroy();
+
+		m_slots.resize(slotCount);
+		for (auto& slot : m_slots)
+		{
+			if (!slot.m_pbo.Create())
+			{
+				SABA_ERROR("Failed to create PBO.");
+				Destroy();
+				return false;
+			}
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.m_pbo);
+			glBufferData(GL_PIXEL_UNPACK_BUFFER, slotSize, nullptr, GL_STREAM_DRAW);
+		}
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		m_slotSize = slotSize;
+
+		return true;
+	}
+
+	void GLTextureUploader::Destroy()
+	{
+		for (auto& slot : m_slots)
+		{
+			if (slot.m_copyFuture.valid())
+			{
+				slot.m_copyFuture.wait();
+			}
+			if (slot.m_mapped != nullptr)
+			{
+				glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.m_pbo);
+				glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+				glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+			}
+			if (slot.m_fence != nullptr)
+			{
+				glDeleteSync(slot.m_fence);
+			}
+		}
+		m_slots.clear();
+		m_jobs.clear();
+		m_slotSize = 0;
+		m_pendingCount = 0;
+		m_pendingBytes = 0;
+	}
+
+	GLTextureRef GLTextureUploader::Upload(TextureImage&& image, bool genMipMap)
+	{
+		PixelFormat pf;
+		const bool ringable = GetPixelFormat(image.m_format, &pf) &&
+			!m_slots.empty() &&
+			size_t(image.m_width) * pf.m_pixelSize <= m_slotSize;
+		if (!ringable)
+		{
+			auto tex = CreateTextureFromImage(image, genMipMap);
+			GLTextureRef texRef = std::move(tex);
+			return texRef;
+		}
+
+		GLTextureObject tex;
+		if (!tex.Create())
+		{
+			SABA_ERROR("Texture Create fail.");
+			return GLTextureRef();
+		}
+
+		// 本来のサイズで領域を確保し、最小のミップレベルにプレースホルダーを置く
+		int placeholderLevel = 0;
+		while ((std::max(image.m_width, image.m_height) >> (placeholderLevel + 1)) > 0)
+		{
+			placeholderLevel++;
+		}
+		const uint8_t white8[4] = { 255, 255, 255, 255 };
+		const float white32f[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+		const void* white = pf.m_type == GL_FLOAT ? (const void*)white32f : (const void*)white8;
+
+		glBindTexture(GL_TEXTURE_2D, tex);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		glTexImage2D(GL_TEXTURE_2D, 0, pf.m_internalFormat, image.m_width, image.m_height, 0, pf.m_format, pf.m_type, nullptr);
+		if (placeholderLevel != 0)
+		{
+			glTexImage2D(GL_TEXTURE_2D, placeholderLevel, pf.m_internalFormat, 1, 1, 0, pf.m_format, pf.m_type, white);
+		}
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, placeholderLevel);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, placeholderLevel);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glBindTexture(GL_TEXTURE_2D, 0);
+
+		auto job = std::make_shared<Job>();
+		job->m_texture = std::move(tex);
+		job->m_image = std::move(image);
+		job->m_genMipMap = genMipMap;
+		job->m_rowSize = size_t(job->m_image.m_width) * pf.m_pixelSize;
+		job->m_nextRow = 0;
+		job->m_uploadedRows = 0;
+		m_jobs.push_back(job);
+		m_pendingCount++;
+		m_pendingBytes += job->m_image.m_data.size();
+
+		return job->m_texture;
+	}
+
+	void GLTextureUploader::Update()
+	{
+		// PBO へのコピーが終わったものを転送する
+		for (auto& slot : m_slots)
+		{
+			if (slot.m_state == SlotState::Copying &&
+				slot.m_copyFuture.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+			{
+				SubmitSlot(slot);
+			}
+		}
+
+		// GPU が読み終えたスロットを空ける
+		for (auto& slot : m_slots)
+		{
+			if (slot.m_state == SlotState::InFlight)
+			{
+				GLenum ret = glClientWaitSync(slot.m_fence, 0, 0);
+				if (ret == GL_ALREADY_SIGNALED || ret == GL_CONDITION_SATISFIED)
+				{
+					glDeleteSync(slot.m_fence);
+					slot.m_fence = nullptr;
+					slot.m_state = SlotState::Free;
+				}
+			}
+		}
+
+		// 空いたスロットにバジェットの範囲で割り当て、まとめてワーカーでコピーする
+		std::vector<CopyCommand> copyCommands;
+		std::vector<Slot*> copySlots;
+		size_t budget = m_frameBudget;
+		for (auto& slot : m_slots)
+		{
+			if (m_jobs.empty() || (budget == 0 && !copySlots.empty()))
+			{
+				break;
+			}
+			if (slot.m_state != SlotState::Free)
+			{
+				continue;
+			}
+
+			auto job = m_jobs.front();
+			const int maxRows = int(std::max(m_slotSize / job->m_rowSize, size_t(1)));
+			const int rowCount = std::min(maxRows, job->m_image.m_height - job->m_nextRow);
+			const size_t size = job->m_rowSize * size_t(rowCount);
+
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.m_pbo);
+			slot.m_mapped = glMapBufferRange(
+				GL_PIXEL_UNPACK_BUFFER, 0, size,
+				GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT
+			);
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+			if (slot.m_mapped == nullptr)
+			{
+				SABA_WARN("Failed to map PBO.");
+				break;
+			}
+
+			slot.m_state = SlotState::Copying;
+			slot.m_job = job;
+			slot.m_beginRow = job->m_nextRow;
+			slot.m_rowCount = rowCount;
+			copyCommands.emplace_back(CopyCommand{
+				slot.m_mapped,
+				job->m_image.m_data.data() + job->m_rowSize * size_t(job->m_nextRow),
+				size
+			});
+			copySlots.push_back(&slot);
+
+			job->m_nextRow += rowCount;
+			if (job->m_nextRow == job->m_image.m_height)
+			{
+				m_jobs.pop_front();
+			}
+			budget -= std::min(budget, size);
+		}
+
+		if (!copyCommands.empty())
+		{
+			std::shared_future<void> copyFuture = std::async(
+				std::launch::async,
+				[copyCommands]()
+				{
+					for (const auto& cmd : copyCommands)
+					{
+						memcpy(cmd.m_dest, cmd.m_src, cmd.m_size);
+					}
+				}
+			).share();
+			for (auto slot : copySlots)
+			{
+				slot->m_copyFuture = copyFuture;
+			}
+		}
+	}
+
+	void GLTextureUploader::SubmitSlot(Slot& slot)
+	{
+		auto& job = *slot.m_job;
+		PixelFormat pf;
+		GetPixelFormat(job.m_image.m_format, &pf);
+
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.m_pbo);
+		glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+		slot.m_mapped = nullptr;
+
+		glBindTexture(GL_TEXTURE_2D, job.m_texture);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, pf.m_alignment);
+		glTexSubImage2D(
+			GL_TEXTURE_2D, 0,
+			0, slot.m_beginRow, job.m_image.m_width, slot.m_rowCount,
+			pf.m_format, pf.m_type, nullptr
+		);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+		slot.m_fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		slot.m_state = SlotState::InFlight;
+		slot.m_copyFuture = std::shared_future<void>();
+
+		job.m_uploadedRows += slot.m_rowCount;
+		if (job.m_uploadedRows == job.m_image.m_height)
+		{
+			FinishJob(job);
+		}
+		glBindTexture(GL_TEXTURE_2D, 0);
+		slot.m_job.reset();
+	}
+
+	void GLTextureUploader::FinishJob(Job& job)
+	{
+		// レベル 0 が揃ったので、プレースホルダーから切り替える
+		glBindTexture(GL_TEXTURE_2D, job.m_texture);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+		if (job.m_genMipMap)
+		{
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 1000);
+			glGenerateMipmap(GL_TEXTURE_2D);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+		}
+		else
+		{
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+		}
+
+		m_pendingCount--;
+		m_pendingBytes -= job.m_image.m_data.size();
+		job.m_image = TextureImage();
+	}
+}
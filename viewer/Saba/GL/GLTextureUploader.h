@@ -0,0 +1,94 @@
+﻿//
+// Copyright(c) 2016-2017 benikabocha.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+//
+
+#ifndef SABA_GL_TEXTUREUPLOADER_H_
+#define SABA_GL_TEXTUREUPLOADER_H_
+
+#include "GLObject.h"
+#include "GLTextureUtil.h"
+
+#include <deque>
+#include <future>
+#include <memory>
+#include <vector>
+
+namespace saba
+{
+	/*
+	PBO のリングを経由して、テクスチャを 1 フレームあたりのバイト数の範囲で少しずつ転送する。
+	PBO へのコピーはワーカースレッドで行い、GL の呼び出しは Update 内でのみ行う。
+	転送が終わるまでは 1x1 のプレースホルダー (白) が参照され、
+	ミップマップは転送完了時に生成する。
+	*/
+	class GLTextureUploader
+	{
+	public:
+		GLTextureUploader();
+		~GLTextureUploader();
+
+		GLTextureUploader(const GLTextureUploader&) = delete;
+		GLTextureUploader& operator = (const GLTextureUploader&) = delete;
+
+		bool Create(size_t slotCount = 4, size_t slotSize = 4 * 1024 * 1024);
+		void Destroy();
+
+		// テクスチャを作成して転送を予約する
+		// (DDS やスロットに 1 行も収まらない画像はその場で転送する)
+		GLTextureRef Upload(TextureImage&& image, bool genMipMap = true);
+
+		// 毎フレーム GL スレッドから呼び出す
+		void Update();
+
+		void SetFrameBudget(size_t bytes) { m_frameBudget = bytes; }
+		size_t GetFrameBudget() const { return m_frameBudget; }
+
+		size_t GetPendingCount() const { return m_pendingCount; }
+		size_t GetPendingBytes() const { return m_pendingBytes; }
+
+	private:
+		struct Job
+		{
+			GLTextureRef	m_texture;
+			TextureImage	m_image;
+			bool			m_genMipMap;
+			size_t			m_rowSize;
+			int				m_nextRow;
+			int				m_uploadedRows;
+		};
+		using JobPtr = std::shared_ptr<Job>;
+
+		enum class SlotState
+		{
+			Free,
+			Copying,
+			InFlight,
+		};
+
+		struct Slot
+		{
+			GLBufferObject	m_pbo;
+			SlotState		m_state = SlotState::Free;
+			void*			m_mapped = nullptr;
+			JobPtr			m_job;
+			int				m_beginRow = 0;
+			int				m_rowCount = 0;
+			std::shared_future<void>	m_copyFuture;
+			GLsync			m_fence = nullptr;
+		};
+
+		void SubmitSlot(Slot& slot);
+		void FinishJob(Job& job);
+
+	private:
+		std::vector<Slot>	m_slots;
+		size_t				m_slotSize;
+		size_t				m_frameBudget;
+		std::deque<JobPtr>	m_jobs;
+		size_t				m_pendingCount;
+		size_t				m_pendingBytes;
+	};
+}
+
+#endif // !SABA_GL_TEXTUREUPLOADER_H_
@@ -8,7 +8,9 @@
 #include <Saba/Base/Path.h>
 #include <Saba/Base/Log.h>
 
+#include <algorithm>
 #include <iostream>
+#include <type_traits>
 
 #define ENABLE_GLI 0
 
@@ -163,32 +165,6 @@ namespace saba
 					}
 			return true;
 		}
-
-		bool LoadTextureFromGLI(const GLTextureObject& tex, const char * filename)
-		{
-			File file;
-			if (!file.Open(filename))
-			{
-				return false;
-			}
-			std::vector<char> data;
-			if (!file.ReadAll(&data))
-			{
-				return false;
-			}
-
-			gli::texture gliTex = gli::load(&data[0], data.size());
-			if (gliTex.empty())
-			{
-				return false;
-			}
-			gliTex = gli::flip(gliTex);
-			if (!LoadTextureFromGLI(tex, gliTex))
-			{
-				return false;
-			}
-			return true;
-		}
 #endif // ENABLE_GLI
 
 		struct GLSwizzle {
@@ -199,6 +175,7 @@ namespace saba
 			DDSFile::DXGIFormat m_dxgiFormat;
 			GLenum m_type;
 			GLenum m_format;
+			GLenum m_internalFormat;	//!< glTexStorage に渡すサイズ付きのフォーマット
 			GLSwizzle m_swizzle;
 		};
 
@@ -212,12 +189,12 @@ namespace saba
 			};
 			using DXGIFmt = DDSFile::DXGIFormat;
 			static const GLFormat formats[] = {
-				{ DXGIFmt::R8G8B8A8_UNorm, GL_UNSIGNED_BYTE, GL_RGBA, sws[0] },
-				{ DXGIFmt::B8G8R8A8_UNorm, GL_UNSIGNED_BYTE, GL_RGBA, sws[1] },
-				{ DXGIFmt::B8G8R8X8_UNorm, GL_UNSIGNED_BYTE, GL_RGBA, sws[2] },
-				{ DXGIFmt::BC1_UNorm, 0, GL_COMPRESSED_RGBA_S3TC_DXT1_EXT, sws[0] },
-				{ DXGIFmt::BC2_UNorm, 0, GL_COMPRESSED_RGBA_S3TC_DXT3_EXT, sws[0] },
-				{ DXGIFmt::BC3_UNorm, 0, GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, sws[0] },
+				{ DXGIFmt::R8G8B8A8_UNorm, GL_UNSIGNED_BYTE, GL_RGBA, GL_RGBA8, sws[0] },
+				{ DXGIFmt::B8G8R8A8_UNorm, GL_UNSIGNED_BYTE, GL_RGBA, GL_RGBA8, sws[1] },
+				{ DXGIFmt::B8G8R8X8_UNorm, GL_UNSIGNED_BYTE, GL_RGBA, GL_RGB8, sws[2] },
+				{ DXGIFmt::BC1_UNorm, 0, GL_COMPRESSED_RGBA_S3TC_DXT1_EXT, GL_COMPRESSED_RGBA_S3TC_DXT1_EXT, sws[0] },
+				{ DXGIFmt::BC2_UNorm, 0, GL_COMPRESSED_RGBA_S3TC_DXT3_EXT, GL_COMPRESSED_RGBA_S3TC_DXT3_EXT, sws[0] },
+				{ DXGIFmt::BC3_UNorm, 0, GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, sws[0] },
 			};
 			for (const auto& format : formats)
 			{
@@ -246,7 +223,7 @@ namespace saba
 			}
 		}
 
-		bool LoadGLTexture(GLuint tex, DDSFile& dds)
+		bool LoadGLTexture(GLuint tex, DDSFile& dds, bool opaqueBC1)
 		{
 			GLenum target = GL_INVALID_ENUM;
 			bool isArray = false;
@@ -299,6 +276,13 @@ namespace saba
 			{
 				return false;
 			}
+			if (opaqueBC1 && format.m_internalFormat == GL_COMPRESSED_RGBA_S3TC_DXT1_EXT)
+			{
+				// RGB として転送し、IsAlphaTexture がアルファなしと判定できるようにする
+				format.m_format = GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+				format.m_internalFormat = GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+				format.m_swizzle = { GL_RED, GL_GREEN, GL_BLUE, GL_ONE };
+			}
 
 			glBindTexture(target, tex);
 			glTexParameteri(target, GL_TEXTURE_BASE_LEVEL, 0);
@@ -307,35 +291,37 @@ namespace saba
 			glTexParameteri(target, GL_TEXTURE_SWIZZLE_G, format.m_swizzle.m_g);
 			glTexParameteri(target, GL_TEXTURE_SWIZZLE_B, format.m_swizzle.m_b);
 			glTexParameteri(target, GL_TEXTURE_SWIZZLE_A, format.m_swizzle.m_a);
+			glTexParameteri(target, GL_TEXTURE_MIN_FILTER, dds.GetMipCount() > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+			glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
 			switch (target)
 			{
 			case GL_TEXTURE_1D:
-				glTexStorage1D(target, dds.GetMipCount(), format.m_format,
+				glTexStorage1D(target, dds.GetMipCount(), format.m_internalFormat,
 					dds.GetWidth());
 				break;
 			case GL_TEXTURE_1D_ARRAY:
-				glTexStorage2D(target, dds.GetMipCount(), format.m_format,
+				glTexStorage2D(target, dds.GetMipCount(), format.m_internalFormat,
 					dds.GetWidth(), dds.GetArraySize());
 				break;
 			case GL_TEXTURE_2D:
-				glTexStorage2D(target, dds.GetMipCount(), format.m_format,
+				glTexStorage2D(target, dds.GetMipCount(), format.m_internalFormat,
 					dds.GetWidth(), dds.GetHeight());
 				break;
 			case GL_TEXTURE_CUBE_MAP:
-				glTexStorage2D(target, dds.GetMipCount(), format.m_format,
+				glTexStorage2D(target, dds.GetMipCount(), format.m_internalFormat,
 					dds.GetWidth(), dds.GetHeight());
 				break;
 			case GL_TEXTURE_2D_ARRAY:
-				glTexStorage3D(target, dds.GetMipCount(), format.m_format,
+				glTexStorage3D(target, dds.GetMipCount(), format.m_internalFormat,
 					dds.GetWidth(), dds.GetHeight(), dds.GetArraySize());
 				break;
 			case GL_TEXTURE_3D:
-				glTexStorage3D(target, dds.GetMipCount(), format.m_format,
+				glTexStorage3D(target, dds.GetMipCount(), format.m_internalFormat,
 					dds.GetWidth(), dds.GetHeight(), dds.GetDepth());
 				break;
 			case GL_TEXTURE_CUBE_MAP_ARRAY:
-				glTexStorage3D(target, dds.GetMipCount(), format.m_format,
+				glTexStorage3D(target, dds.GetMipCount(), format.m_internalFormat,
 					dds.GetWidth(), dds.GetHeight(), dds.GetArraySize());
 				break;
 			default:
@@ -402,26 +388,15 @@ namespace saba
 			return true;
 		}
 
-		bool LoadTextureFromDDS(const GLTextureObject& tex, const char * filename)
+		bool LoadTextureFromDDS(GLuint tex, const std::vector<uint8_t>& data, bool opaqueBC1)
 		{
-			File file;
-			if (!file.Open(filename))
-			{
-				return false;
-			}
-			std::vector<uint8_t> data;
-			if (!file.ReadAll(&data))
-			{
-				return false;
-			}
-
 			tinyddsloader::DDSFile dds;
-			if (tinyddsloader::Result::Success != dds.Load(std::move(data)))
+			if (tinyddsloader::Result::Success != dds.Load(data.data(), data.size()))
 			{
 				return false;
 			}
 
-			if (!LoadGLTexture(tex, dds))
+			if (!LoadGLTexture(tex, dds, opaqueBC1))
 			{
 				return false;
 			}
@@ -429,10 +404,8 @@ namespace saba
 			return true;
 		}
 
-		bool LoadTextureFromStb(const GLTextureObject& tex, const char * filename, bool genMipMap, bool rgba)
+		bool DecodeTextureFromStb(TextureImage* image, const char * filename, bool rgba)
 		{
-			glBindTexture(GL_TEXTURE_2D, tex);
-
 			stbi_set_flip_vertically_on_load(true);
 
 			File file;
@@ -468,46 +441,63 @@ namespace saba
 			if (stbi_is_hdr_from_file(file.GetFilePointer()))
 			{
 				file.Seek(0, File::SeekDir::Begin);
-				float* image = stbi_loadf_from_file(file.GetFilePointer(), &x, &y, &comp, reqComp);
-				if (image == nullptr)
+				float* pixels = stbi_loadf_from_file(file.GetFilePointer(), &x, &y, &comp, reqComp);
+				if (pixels == nullptr)
 				{
 					return false;
 				}
 
-				if (reqComp == STBI_rgb_alpha)
-				{
-					glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
-					glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, x, y, 0, GL_RGBA, GL_FLOAT, image);
-				}
-				else
-				{
-					glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
-					glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB32F, x, y, 0, GL_RGB, GL_FLOAT, image);
-				}
-
-				stbi_image_free(image);
+				const uint8_t* begin = reinterpret_cast<const uint8_t*>(pixels);
+				image->m_data.assign(begin, begin + sizeof(float) * x * y * reqComp);
+				image->m_format = reqComp == STBI_rgb_alpha ? TextureImage::Format::RGBA32F : TextureImage::Format::RGB32F;
+				stbi_image_free(pixels);
 			}
 			else
 			{
 				file.Seek(0, File::SeekDir::Begin);
-				uint8_t* image = stbi_load_from_file(file.GetFilePointer(), &x, &y, &comp, reqComp);
-				if (image == nullptr)
+				uint8_t* pixels = stbi_load_from_file(file.GetFilePointer(), &x, &y, &comp, reqComp);
+				if (pixels == nullptr)
 				{
 					return false;
 				}
 
-				if (reqComp == STBI_rgb_alpha)
-				{
-					glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
-					glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, x, y, 0, GL_RGBA, GL_UNSIGNED_BYTE, image);
-				}
-				else
-				{
-					glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-					glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, x, y, 0, GL_RGB, GL_UNSIGNED_BYTE, image);
-				}
+				image->m_data.assign(pixels, pixels + x * y * reqComp);
+				image->m_format = reqComp == STBI_rgb_alpha ? TextureImage::Format::RGBA8 : TextureImage::Format::RGB8;
+				stbi_image_free(pixels);
+			}
+			image->m_width = x;
+			image->m_height = y;
+			image->m_sourceWidth = x;
+			image->m_sourceHeight = y;
+
+			return true;
+		}
 
-				stbi_image_free(image);
+		bool LoadTextureFromPixels(GLuint tex, const TextureImage& image, bool genMipMap)
+		{
+			glBindTexture(GL_TEXTURE_2D, tex);
+
+			const void* pixels = image.m_data.data();
+			switch (image.m_format)
+			{
+			case TextureImage::Format::RGB8:
+				glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+				glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, image.m_width, image.m_height, 0, GL_RGB, GL_UNSIGNED_BYTE, pixels);
+				break;
+			case TextureImage::Format::RGBA8:
+				glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+				glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image.m_width, image.m_height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+				break;
+			case TextureImage::Format::RGB32F:
+				glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+				glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB32F, image.m_width, image.m_height, 0, GL_RGB, GL_FLOAT, pixels);
+				break;
+			case TextureImage::Format::RGBA32F:
+				glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+				glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, image.m_width, image.m_height, 0, GL_RGBA, GL_FLOAT, pixels);
+				break;
+			default:
+				return false;
 			}
 
 			if (genMipMap)
@@ -525,6 +515,39 @@ namespace saba
 
 			return true;
 		}
+
+		template <typename T>
+		void DownscaleHalf(std::vector<uint8_t>* data, int width, int height, int comp)
+		{
+			const int dstW = std::max(width / 2, 1);
+			const int dstH = std::max(height / 2, 1);
+			const T* src = reinterpret_cast<const T*>(data->data());
+			std::vector<uint8_t> dstData(sizeof(T) * dstW * dstH * comp);
+			T* dst = reinterpret_cast<T*>(dstData.data());
+			for (int y = 0; y < dstH; y++)
+			{
+				const int y0 = std::min(y * 2, height - 1);
+				const int y1 = std::min(y * 2 + 1, height - 1);
+				for (int x = 0; x < dstW; x++)
+				{
+					const int x0 = std::min(x * 2, width - 1);
+					const int x1 = std::min(x * 2 + 1, width - 1);
+					for (int c = 0; c < comp; c++)
+					{
+						float sum = float(src[(y0 * width + x0) * comp + c]) +
+							float(src[(y0 * width + x1) * comp + c]) +
+							float(src[(y1 * width + x0) * comp + c]) +
+							float(src[(y1 * width + x1) * comp + c]);
+						if (std::is_integral<T>::value)
+						{
+							sum += 2.0f;
+						}
+						dst[(y * dstW + x) * comp + c] = T(sum / 4.0f);
+					}
+				}
+			}
+			*data = std::move(dstData);
+		}
 	}
 
 	GLTextureObject CreateTextureFromFile(const char * filename, bool genMipMap, bool rgba)
@@ -555,18 +578,85 @@ namespace saba
 	bool LoadTextureFromFile(const GLTextureObject& tex, const char* filename, bool genMipMap, bool rgba)
 	{
 		SABA_INFO("LoadTexture: [{}]", filename);
+		TextureImage image;
+		bool successed = DecodeTextureFromFile(&image, filename, rgba);
+		if (successed)
+		{
+			successed = LoadTextureFromImage(tex, image, genMipMap);
+		}
+
+		if (successed)
+		{
+			SABA_INFO("LoadTexture: [{}] Success", filename);
+		}
+		else
+		{
+			SABA_WARN("LoadTexture: [{}] Fail", filename);
+		}
+
+		return successed;
+	}
+
+	bool LoadTextureFromFile(const GLTextureObject & tex, const std::string & filename, bool genMipMap, bool rgba)
+	{
+		return LoadTextureFromFile(tex, filename.c_str(), genMipMap, rgba);
+	}
+
+	bool DecodeTextureFromFile(TextureImage* image, const char* filename, bool rgba)
+	{
+		if (image == nullptr)
+		{
+			return false;
+		}
+
+		*image = TextureImage();
 		std::string ext = PathUtil::GetExt(filename);
-		bool successed = false;
 		if (ext == "dds")
 		{
+			// DDS はファイルの内容をそのまま保持し、転送時に展開する
+			File file;
+			if (!file.Open(filename) || !file.ReadAll(&image->m_data))
+			{
+				SABA_WARN("DecodeTexture: Failed to read DDS. [{}]", filename);
+				return false;
+			}
+			image->m_format = TextureImage::Format::DDS;
+		}
+		else
+		{
+			if (!DecodeTextureFromStb(image, filename, rgba))
+			{
+				SABA_WARN("DecodeTextureFromStb fail.");
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	bool DecodeTextureFromFile(TextureImage* image, const std::string& filename, bool rgba)
+	{
+		return DecodeTextureFromFile(image, filename.c_str(), rgba);
+	}
+
+	bool LoadTextureFromImage(GLuint tex, const TextureImage& image, bool genMipMap)
+	{
+		bool successed = false;
+		if (image.m_format == TextureImage::Format::DDS)
+		{
 #if ENABLE_GLI
-			successed = LoadTextureFromGLI(tex, filename);
+			gli::texture gliTex = gli::load((const char*)image.m_data.data(), image.m_data.size());
+			if (!gliTex.empty())
+			{
+				gliTex = gli::flip(gliTex);
+				successed = LoadTextureFromGLI(tex, gliTex);
+			}
 			if (!successed)
 			{
 				SABA_WARN("LoadTextureFromGLI fail.");
 			}
 #else // ENABLE_GLI
-			successed = LoadTextureFromDDS(tex, filename);
+			successed = LoadTextureFromDDS(tex, image.m_data, image.m_opaqueBC1);
 			if (!successed)
 			{
 				SABA_WARN("LoadTextureFromDDS fail.");
@@ -575,28 +665,108 @@ namespace saba
 		}
 		else
 		{
-			successed = LoadTextureFromStb(tex, filename, genMipMap, rgba);
+			successed = LoadTextureFromPixels(tex, image, genMipMap);
 			if (!successed)
 			{
-				SABA_WARN("LoadTextureFromStb fail.");
+				SABA_WARN("LoadTextureFromPixels fail.");
 			}
 		}
 
-		if (successed)
+		return successed;
+	}
+
+	GLTextureObject CreateTextureFromImage(const TextureImage& image, bool genMipMap)
+	{
+		GLTextureObject tex;
+		if (!tex.Create())
 		{
-			SABA_INFO("LoadTexture: [{}] Success", filename);
+			SABA_ERROR("Texture Create fail.");
+			return GLTextureObject();
 		}
-		else
+
+		bool ret = LoadTextureFromImage(tex, image, genMipMap);
+		glBindTexture(GL_TEXTURE_2D, 0);
+
+		if (!ret)
 		{
-			SABA_WARN("LoadTexture: [{}] Fail", filename);
+			return GLTextureObject();
 		}
 
-		return successed;
+		return tex;
 	}
 
-	bool LoadTextureFromFile(const GLTextureObject & tex, const std::string & filename, bool genMipMap, bool rgba)
+	bool DownscaleTextureImage(TextureImage* image, int maxSize)
 	{
-		return LoadTextureFromFile(tex, filename.c_str(), genMipMap, rgba);
+		if (image == nullptr)
+		{
+			return false;
+		}
+		if (maxSize <= 0 || image->m_format == TextureImage::Format::DDS)
+		{
+			return true;
+		}
+
+		while (image->m_width > maxSize || image->m_height > maxSize)
+		{
+			switch (image->m_format)
+			{
+			case TextureImage::Format::RGB8:
+				DownscaleHalf<uint8_t>(&image->m_data, image->m_width, image->m_height, 3);
+				break;
+			case TextureImage::Format::RGBA8:
+				DownscaleHalf<uint8_t>(&image->m_data, image->m_width, image->m_height, 4);
+				break;
+			case TextureImage::Format::RGB32F:
+				DownscaleHalf<float>(&image->m_data, image->m_width, image->m_height, 3);
+				break;
+			case TextureImage::Format::RGBA32F:
+				DownscaleHalf<float>(&image->m_data, image->m_width, image->m_height, 4);
+				break;
+			default:
+				return false;
+			}
+			image->m_width = std::max(image->m_width / 2, 1);
+			image->m_height = std::max(image->m_height / 2, 1);
+		}
+		return true;
+	}
+
+	size_t CalcTextureBytes(TextureImage::Format format, int width, int height, bool genMipMap)
+	{
+		size_t pixelSize = 0;
+		switch (format)
+		{
+		case TextureImage::Format::RGB8:
+		case TextureImage::Format::RGBA8:
+			// RGB8 もドライバー内部では 4 バイトで保持されることが多い
+			pixelSize = 4;
+			break;
+		case TextureImage::Format::RGB32F:
+			pixelSize = 12;
+			break;
+		case TextureImage::Format::RGBA32F:
+			pixelSize = 16;
+			break;
+		default:
+			return 0;
+		}
+		size_t bytes = size_t(width) * size_t(height) * pixelSize;
+		if (genMipMap)
+		{
+			bytes = bytes * 4 / 3;
+		}
+		return bytes;
+	}
+
+	size_t CalcTextureImageBytes(const TextureImage& image, bool genMipMap)
+	{
+		if (image.m_format == TextureImage::Format::DDS)
+		{
+			// ヘッダー (128 バイト) 以外はそのまま転送される
+			const size_t DDSHeaderSize = 128;
+			return image.m_data.size() > DDSHeaderSize ? image.m_data.size() - DDSHeaderSize : 0;
+		}
+		return CalcTextureBytes(image.m_format, image.m_width, image.m_height, genMipMap);
 	}
 
 	bool IsAlphaTexture(GLuint tex)
@@ -9,6 +9,8 @@
 #include "GLObject.h"
 
 #include <string>
+#include <vector>
+#include <cstdint>
 
 namespace saba
 {
@@ -18,6 +20,42 @@ namespace saba
 	bool LoadTextureFromFile(const GLTextureObject& tex, const char* filename, bool genMipMap = true, bool rgba = false);
 	bool LoadTextureFromFile(const GLTextureObject& tex, const std::string& filename, bool genMipMap = true, bool rgba = false);
 
+	// GL に転送する前のデコード済みテクスチャ
+	// (GL コンテキストを持たないスレッドでも作成できる)
+	struct TextureImage
+	{
+		enum class Format
+		{
+			Unknown,
+			RGB8,
+			RGBA8,
+			RGB32F,
+			RGBA32F,
+			DDS,	//!< DDS ファイルの内容 (転送時に展開する)
+		};
+
+		Format					m_format = Format::Unknown;
+		int						m_width = 0;
+		int						m_height = 0;
+		int						m_sourceWidth = 0;	//!< 縮小前の幅 (DDS は 0)
+		int						m_sourceHeight = 0;	//!< 縮小前の高さ (DDS は 0)
+		std::vector<uint8_t>	m_data;
+		bool					m_opaqueBC1 = false;	//!< DDS の BC1 をアルファなし (RGB) として転送する
+	};
+
+	bool DecodeTextureFromFile(TextureImage* image, const char* filename, bool rgba = false);
+	bool DecodeTextureFromFile(TextureImage* image, const std::string& filename, bool rgba = false);
+
+	GLTextureObject CreateTextureFromImage(const TextureImage& image, bool genMipMap = true);
+	// DDS 以外は同じテクスチャに別の解像度で読み込み直すことができる
+	bool LoadTextureFromImage(GLuint tex, const TextureImage& image, bool genMipMap = true);
+
+	// 幅と高さが maxSize 以下になるまで 1/2 に縮小する (maxSize が 0 の場合と DDS は何もしない)
+	bool DownscaleTextureImage(TextureImage* image, int maxSize);
+	// 転送後に GPU で使用するおおよそのバイト数
+	size_t CalcTextureImageBytes(const TextureImage& image, bool genMipMap);
+	size_t CalcTextureBytes(TextureImage::Format format, int width, int height, bool genMipMap);
+
 	bool IsAlphaTexture(GLuint tex);
 }
 
@@ -8,10 +8,14 @@
 
 #include "GLObject.h"
 
+#include <Saba/Base/MeshOptimizer.h>
+
 #include <vector>
 #include <cstdint>
+#include <cstring>
 #include <memory>
 #include <algorithm>
+#include <unordered_set>
 
 #include <glm/vec2.hpp>
 #include <glm/vec3.hpp>
@@ -237,6 +241,19 @@ namespace saba
 		};
 
 	private:
+		static size_t HashBytes(const void* data, size_t size)
+		{
+			// FNV-1a
+			const uint8_t* bytes = (const uint8_t*)data;
+			uint64_t hash = 14695981039346656037ull;
+			for (size_t i = 0; i < size; i++)
+			{
+				hash ^= bytes[i];
+				hash *= 1099511628211ull;
+			}
+			return size_t(hash);
+		}
+
 		class Component
 		{
 		public:
@@ -257,8 +274,19 @@ namespace saba
 				m_polygons[polygonID] = polygon;
 			}
 
+			const Polygon& GetPolygon(size_t polygonID) const
+			{
+				return m_polygons[polygonID];
+			}
+
+			// 同じ値の頂点を最初に現れた頂点のインデックスにまとめる
+			virtual void MakeCanonicalIndices(std::vector<int>* canonical) const = 0;
+
 			virtual GLBufferObject CreateVBO(const std::vector<Face>& faces) = 0;
 
+			// Weld した頂点 (keys[vertex * keyStride + keyOffset]) から VBO を作成する
+			virtual GLBufferObject CreateIndexedVBO(const std::vector<int>& keys, size_t keyStride, size_t keyOffset) = 0;
+
 			virtual VertexBinder MakeVertexBinder() = 0;
 
 		protected:
@@ -305,6 +333,44 @@ namespace saba
 				return saba::CreateVBO(bufferData);
 			}
 
+			void MakeCanonicalIndices(std::vector<int>* canonical) const override
+			{
+				// 値の比較はビット単位で行う (許容誤差による結合はしない)
+				const auto* vertices = m_vertices.data();
+				auto hashFunc = [vertices](int vi) { return HashBytes(&vertices[vi], sizeof(T)); };
+				auto equalFunc = [vertices](int a, int b) { return std::memcmp(&vertices[a], &vertices[b], sizeof(T)) == 0; };
+				std::unordered_set<int, decltype(hashFunc), decltype(equalFunc)> uniqueVertices(
+					m_vertices.size(), hashFunc, equalFunc
+				);
+
+				canonical->resize(m_vertices.size());
+				for (size_t vi = 0; vi < m_vertices.size(); vi++)
+				{
+					auto ret = uniqueVertices.insert(int(vi));
+					(*canonical)[vi] = *ret.first;
+				}
+			}
+
+			GLBufferObject CreateIndexedVBO(const std::vector<int>& keys, size_t keyStride, size_t keyOffset) override
+			{
+				std::vector<T> bufferData;
+				bufferData.reserve(keys.size() / keyStride);
+				for (size_t i = keyOffset; i < keys.size(); i += keyStride)
+				{
+					auto idx = keys[i];
+					if (idx == -1)
+					{
+						bufferData.push_back(m_defaultValue);
+					}
+					else
+					{
+						bufferData.push_back(m_vertices[idx]);
+					}
+				}
+
+				return saba::CreateVBO(bufferData);
+			}
+
 			VertexBinder MakeVertexBinder() override
 			{
 				return saba::MakeVertexBinder<T>();
@@ -320,6 +386,7 @@ namespace saba
 	public:
 		MeshBuilder()
 			: m_polygonCount(0)
+			, m_welded(false)
 		{
 		}
 
@@ -328,6 +395,9 @@ namespace saba
 			m_components.clear();
 			m_faces.clear();
 			m_polygonCount = 0;
+			m_welded = false;
+			m_weldKeys.clear();
+			m_indices.clear();
 		}
 
 		template <typename T>
@@ -381,11 +451,140 @@ namespace saba
 			);
 		}
 
+		// 全コンポーネントの値が一致する頂点を共有して、インデックスを作成する
+		// optimizeVertexCache が true の場合、マテリアルごとに三角形を頂点キャッシュ向けに並び替える
+		// SortFaces の後に呼び出す
+		void Weld(bool optimizeVertexCache = true)
+		{
+			m_welded = false;
+			m_weldKeys.clear();
+			m_indices.clear();
+
+			const size_t compoCount = m_components.size();
+			if (compoCount == 0 || m_faces.empty())
+			{
+				return;
+			}
+
+			std::vector<std::vector<int>> canonicals(compoCount);
+			for (size_t compoID = 0; compoID < compoCount; compoID++)
+			{
+				m_components[compoID]->MakeCanonicalIndices(&canonicals[compoID]);
+			}
+
+			// 頂点 v のキーは m_weldKeys[v * compoCount] から compoCount 個
+			auto hashFunc = [this, compoCount](uint32_t v)
+			{
+				return HashBytes(&m_weldKeys[v * compoCount], sizeof(int) * compoCount);
+			};
+			auto equalFunc = [this, compoCount](uint32_t a, uint32_t b)
+			{
+				return std::memcmp(
+					&m_weldKeys[a * compoCount],
+					&m_weldKeys[b * compoCount],
+					sizeof(int) * compoCount
+				) == 0;
+			};
+			std::unordered_set<uint32_t, decltype(hashFunc), decltype(equalFunc)> vertexSet(
+				m_faces.size() * 3, hashFunc, equalFunc
+			);
+
+			m_indices.reserve(m_faces.size() * 3);
+			for (const auto& face : m_faces)
+			{
+				for (int i = 0; i < 3; i++)
+				{
+					size_t keyPos = m_weldKeys.size();
+					for (size_t compoID = 0; compoID < compoCount; compoID++)
+					{
+						auto idx = m_components[compoID]->GetPolygon(face.m_polygon).m_indices[i];
+						m_weldKeys.push_back(idx == -1 ? -1 : canonicals[compoID][idx]);
+					}
+
+					auto ret = vertexSet.insert(uint32_t(keyPos / compoCount));
+					if (!ret.second)
+					{
+						m_weldKeys.resize(keyPos);
+					}
+					m_indices.push_back(*ret.first);
+				}
+			}
+
+			if (optimizeVertexCache)
+			{
+				size_t beginFace = 0;
+				while (beginFace < m_faces.size())
+				{
+					size_t endFace = beginFace + 1;
+					while (endFace < m_faces.size() &&
+						m_faces[endFace].m_material == m_faces[beginFace].m_material)
+					{
+						endFace++;
+					}
+					OptimizeVertexCache(&m_indices[beginFace * 3], (endFace - beginFace) * 3);
+					beginFace = endFace;
+				}
+			}
+
+			// 描画時に参照される順番に頂点を並べ替える
+			const size_t vertexCount = m_weldKeys.size() / compoCount;
+			std::vector<uint32_t> remap;
+			MakeVertexFetchRemap(&remap, m_indices.data(), m_indices.size(), vertexCount);
+
+			std::vector<int> weldKeys(m_weldKeys.size());
+			for (size_t v = 0; v < vertexCount; v++)
+			{
+				std::copy(
+					m_weldKeys.begin() + v * compoCount,
+					m_weldKeys.begin() + (v + 1) * compoCount,
+					weldKeys.begin() + remap[v] * compoCount
+				);
+			}
+			m_weldKeys.swap(weldKeys);
+			for (auto& index : m_indices)
+			{
+				index = remap[index];
+			}
+
+			m_welded = true;
+		}
+
 		GLBufferObject CreateVBO(size_t compoID)
 		{
+			if (m_welded)
+			{
+				return m_components[compoID]->CreateIndexedVBO(m_weldKeys, m_components.size(), compoID);
+			}
 			return m_components[compoID]->CreateVBO(m_faces);
 		}
 
+		// Weld 後のインデックスバッファを作成する
+		// 頂点数が 65536 以下の場合は 16bit インデックスを使う
+		GLBufferObject CreateIBO()
+		{
+			if (!m_welded)
+			{
+				return GLBufferObject();
+			}
+
+			if (GetIndexType() == GL_UNSIGNED_SHORT)
+			{
+				std::vector<uint16_t> indices(m_indices.begin(), m_indices.end());
+				return saba::CreateIBO(indices);
+			}
+			return saba::CreateIBO(m_indices);
+		}
+
+		GLenum GetIndexType() const
+		{
+			return GetVertexCount() <= 65536 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+		}
+
+		size_t GetIndexTypeSize() const
+		{
+			return GetIndexType() == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(uint32_t);
+		}
+
 		VertexBinder MakeVertexBinder(size_t compoID)
 		{
 			return m_components[compoID]->MakeVertexBinder();
@@ -428,10 +627,25 @@ namespace saba
 		size_t GetComponentCount() const { return m_components.size(); }
 		size_t GetPolygonCount() const { return m_polygonCount; }
 
+		bool IsWelded() const { return m_welded; }
+		size_t GetVertexCount() const
+		{
+			if (m_welded)
+			{
+				return m_weldKeys.size() / m_components.size();
+			}
+			return m_faces.size() * 3;
+		}
+		const std::vector<uint32_t>& GetIndices() const { return m_indices; }
+
 	private:
 		std::vector<ComponentPtr>	m_components;
 		size_t						m_polygonCount;
 		std::vector<Face>			m_faces;
+
+		bool						m_welded;
+		std::vector<int>			m_weldKeys;
+		std::vector<uint32_t>		m_indices;
 	};
 }
 
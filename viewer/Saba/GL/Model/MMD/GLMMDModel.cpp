@@ -8,10 +8,12 @@
 #include <Saba/GL/GLTextureUtil.h>
 #include <Saba/Base/Log.h>
 #include <Saba/Base/Time.h>
+#include <Saba/Base/File.h>
 
 #include <string>
 #include <map>
 #include <memory>
+#include <algorithm>
 
 namespace saba
 {
@@ -19,6 +21,8 @@ namespace saba
 		: m_animTime(0)
 		, m_indexType(0)
 		, m_indexTypeSize(0)
+		, m_lastPhysicsElapsed(0)
+		, m_physicsCacheApplied(false)
 		, m_enablePhysics(true)
 		, m_enableEdge(true)
 		, m_enableGroundShadow(true)
@@ -35,6 +39,7 @@ namespace saba
 		using TextureManager = std::map<std::string, GLTextureRef>;
 		GLTextureRef CreateMMDTexture(
 			TextureManager& texMan,
+			const GLMMDModel::TextureMap& textures,
 			const std::string& filename,
 			bool genMipmap = true,
 			bool rgba = false
@@ -48,6 +53,12 @@ namespace saba
 			{
 				return (*findIt).second;
 			}
+			auto loadedIt = textures.find(filename);
+			if (loadedIt != textures.end())
+			{
+				texMan.emplace(std::make_pair(key, (*loadedIt).second));
+				return (*loadedIt).second;
+			}
 			else
 			{
 				auto tex = CreateTextureFromFile(filename.c_str());
@@ -59,6 +70,11 @@ namespace saba
 	}
 
 	bool GLMMDModel::Create(std::shared_ptr<MMDModel> mmdModel)
+	{
+		return Create(mmdModel, TextureMap());
+	}
+
+	bool GLMMDModel::Create(std::shared_ptr<MMDModel> mmdModel, const TextureMap& textures)
 	{
 		Destroy();
 
@@ -119,7 +135,7 @@ namespace saba
 			dest.m_edgeColor = src.m_edgeColor;
 			if (!src.m_texture.empty())
 			{
-				dest.m_texture = CreateMMDTexture(texMan, src.m_texture, true, true);
+				dest.m_texture = CreateMMDTexture(texMan, textures, src.m_texture, true, true);
 				dest.m_textureHaveAlpha = IsAlphaTexture(dest.m_texture);
 			}
 			dest.m_textureMulFactor = src.m_textureMulFactor;
@@ -127,7 +143,7 @@ namespace saba
 
 			if (!src.m_spTexture.empty())
 			{
-				dest.m_spTexture = CreateMMDTexture(texMan, src.m_spTexture, false, true);
+				dest.m_spTexture = CreateMMDTexture(texMan, textures, src.m_spTexture, false, true);
 			}
 			dest.m_spTextureMode = src.m_spTextureMode;
 			dest.m_spTextureMulFactor = src.m_spTextureMulFactor;
@@ -135,7 +151,7 @@ namespace saba
 
 			if (!src.m_toonTexture.empty())
 			{
-				dest.m_toonTexture = CreateMMDTexture(texMan, src.m_toonTexture);
+				dest.m_toonTexture = CreateMMDTexture(texMan, textures, src.m_toonTexture);
 			}
 			dest.m_toonTextureMulFactor = src.m_toonTextureMulFactor;
 			dest.m_toonTextureAddFactor = src.m_toonTextureAddFactor;
@@ -167,6 +183,7 @@ namespace saba
 
 	void GLMMDModel::Destroy()
 	{
+		m_physicsCache.reset();
 		m_mmdModel.reset();
 
 		m_posVBO.Destroy();
@@ -175,7 +192,7 @@ namespace saba
 		m_ibo.Destroy();
 	}
 
-	bool GLMMDModel::LoadAnimation(const VMDFile& vmd)
+	bool GLMMDModel::LoadAnimation(const VMDFile& vmd, const std::string& vmdFilepath)
 	{
 		if (m_mmdModel == nullptr)
 		{
@@ -191,16 +208,21 @@ namespace saba
 				m_vmdAnim.reset();
 				return false;
 			}
+			// シーク時に Physics を復元できるようにする
+			m_vmdAnim->SetPhysicsSnapshotInterval(30);
 		}
 
 		if (!m_vmdAnim->Add(vmd))
 		{
 			m_vmdAnim.reset();
+			m_motionFilepaths.clear();
 			return false;
 		}
+		m_physicsCache.reset();
+		m_motionFilepaths.push_back(vmdFilepath);
 
 		// Physicsを同期する
-		m_vmdAnim->SyncPhysics(float(m_animTime * 30.0), 30);
+		m_vmdAnim->SyncPhysics(float(m_animTime * 30.0), VMDSyncPhysicsParams());
 
 		return true;
 	}
@@ -218,17 +240,83 @@ namespace saba
 		m_mmdModel->InitializeAnimation();
 		if (m_vmdAnim != nullptr)
 		{
-			m_vmdAnim->SyncPhysics(float(m_animTime * 30.0));
+			const float frame = float(m_animTime * 30.0);
+			if (!m_enablePhysics || !m_vmdAnim->RestorePhysicsSnapshot(frame))
+			{
+				m_vmdAnim->SyncPhysics(frame, VMDSyncPhysicsParams());
+			}
 		}
+		m_physicsCacheApplied = false;
 	}
 
 	void GLMMDModel::ClearAnimation()
 	{
 		m_vmdAnim.reset();
+		m_physicsCache.reset();
+		m_motionFilepaths.clear();
 		m_animTime = 0;
+		m_physicsCacheApplied = false;
 		m_mmdModel->InitializeAnimation();
 	}
 
+	bool GLMMDModel::LoadPhysicsCache(const std::string& filename, bool bake)
+	{
+		if (m_mmdModel == nullptr || m_vmdAnim == nullptr)
+		{
+			SABA_WARN("Physics cache requires an animation.");
+			return false;
+		}
+		auto isUnknown = [](const std::string& filepath) { return filepath.empty(); };
+		if (m_modelFilepath.empty() ||
+			std::any_of(m_motionFilepaths.begin(), m_motionFilepaths.end(), isUnknown))
+		{
+			SABA_WARN("Physics cache requires the model and motion filepaths.");
+			return false;
+		}
+
+		// mmd2obj と同じハッシュを使用する
+		uint64_t modelHash = CalcFileHash(m_modelFilepath);
+		uint64_t motionHash = 0;
+		for (const auto& motionFilepath : m_motionFilepaths)
+		{
+			motionHash = CombineHash(motionHash, CalcFileHash(motionFilepath));
+		}
+
+		auto physicsCache = std::make_unique<MMDPhysicsCache>();
+		if (!physicsCache->Load(filename, m_mmdModel.get(), modelHash, motionHash))
+		{
+			if (!bake)
+			{
+				return false;
+			}
+			auto physicsMan = m_mmdModel->GetPhysicsManager();
+			if (physicsMan->IsSharedPhysics())
+			{
+				SABA_WARN("Can not bake physics cache in shared physics world.");
+				return false;
+			}
+
+			SABA_INFO("Bake physics cache. [{}]", filename);
+			// 非同期の場合は結果が 1 フレーム遅れるため、同期して計算する
+			const bool asyncPhysics = physicsMan->IsAsyncPhysics();
+			physicsMan->EnableAsyncPhysics(false);
+			physicsCache->Create(m_mmdModel.get(), modelHash, motionHash);
+			physicsCache->Bake(m_vmdAnim.get(), m_vmdAnim->GetMaxKeyTime());
+			physicsMan->EnableAsyncPhysics(asyncPhysics);
+			if (!physicsCache->Save(filename))
+			{
+				SABA_WARN("Failed to save physics cache. [{}]", filename);
+			}
+
+			// Bake でポーズと Physics が変わるため、現在の時間に戻す
+			m_physicsCache.reset();
+			ResetAnimation();
+		}
+		m_physicsCache = std::move(physicsCache);
+
+		return true;
+	}
+
 	void GLMMDModel::SetAnimationTime(double time)
 	{
 		m_animTime = time;
@@ -275,11 +363,24 @@ namespace saba
 		};
 	}
 	void GLMMDModel::UpdateAnimation(double animTime, double elapsed)
+	{
+		BeginUpdateAnimation(animTime);
+		UpdatePhysicsAnimation(elapsed);
+		EndUpdateAnimation(true);
+	}
+
+	void GLMMDModel::UpdateAnimationIgnoreVMD(double elapsed)
+	{
+		BeginUpdateAnimationIgnoreVMD();
+		UpdatePhysicsAnimation(elapsed);
+		EndUpdateAnimation(false);
+	}
+
+	void GLMMDModel::BeginUpdateAnimation(double animTime)
 	{
 		Perf setupAnimPerf;
 		Perf updateMorphAnimPerf;
 		Perf updateNodeAnimPerf;
-		Perf updatePhysicsAnimPerf;
 
 		// Begin animation
 		setupAnimPerf.Start();
@@ -299,38 +400,24 @@ namespace saba
 		// Update node animation (before physics animation)
 		updateNodeAnimPerf.Start();
 		m_mmdModel->UpdateNodeAnimation(false);
-		updateNodeAnimPerf.Stop();;
+		updateNodeAnimPerf.Stop();
 
-		if (m_enablePhysics)
+		// Physics World を共有する場合、World の更新前に剛体を有効にする
+		if (m_enablePhysics && m_mmdModel->GetPhysicsManager()->IsSharedPhysics())
 		{
-			// Update physics animation
-			updatePhysicsAnimPerf.Start();
-			m_mmdModel->UpdatePhysicsAnimation((float)elapsed);
-			updatePhysicsAnimPerf.Stop();
+			m_mmdModel->BeginPhysicsAnimation();
 		}
 
-		// Update node animation (after physics animation)
-		updateNodeAnimPerf.Start();
-		m_mmdModel->UpdateNodeAnimation(true);
-		updateNodeAnimPerf.Stop();
-
-		// End animation
-		setupAnimPerf.Start();
-		m_mmdModel->EndAnimation();
-		setupAnimPerf.Stop();
-
-		m_perfInfo.m_setupAnimTime = setupAnimPerf.GetPerfTime();
-		m_perfInfo.m_updateMorphAnimTime = updateMorphAnimPerf.GetPerfTime();
-		m_perfInfo.m_updateNodeAnimTime = updateNodeAnimPerf.GetPerfTime();
-		m_perfInfo.m_updatePhysicsAnimTime = updatePhysicsAnimPerf.GetPerfTime();
+		m_perfInfo.m_setupAnimTime += setupAnimPerf.GetPerfTime();
+		m_perfInfo.m_updateMorphAnimTime += updateMorphAnimPerf.GetPerfTime();
+		m_perfInfo.m_updateNodeAnimTime += updateNodeAnimPerf.GetPerfTime();
 	}
 
-	void GLMMDModel::UpdateAnimationIgnoreVMD(double elapsed)
+	void GLMMDModel::BeginUpdateAnimationIgnoreVMD()
 	{
 		Perf setupAnimPerf;
 		Perf updateMorphAnimPerf;
 		Perf updateNodeAnimPerf;
-		Perf updatePhysicsAnimPerf;
 
 		// Save animation (save node TRS)
 		setupAnimPerf.Start();
@@ -357,13 +444,71 @@ namespace saba
 		m_mmdModel->UpdateNodeAnimation(false);
 		updateNodeAnimPerf.Stop();
 
-		if (m_enablePhysics)
+		// Physics World を共有する場合、World の更新前に剛体を有効にする
+		if (m_enablePhysics && m_mmdModel->GetPhysicsManager()->IsSharedPhysics())
 		{
-			// Update physics animation
-			updatePhysicsAnimPerf.Start();
+			m_mmdModel->BeginPhysicsAnimation();
+		}
+
+		m_perfInfo.m_setupAnimTime += setupAnimPerf.GetPerfTime();
+		m_perfInfo.m_updateMorphAnimTime += updateMorphAnimPerf.GetPerfTime();
+		m_perfInfo.m_updateNodeAnimTime += updateNodeAnimPerf.GetPerfTime();
+	}
+
+	void GLMMDModel::UpdatePhysicsAnimation(double elapsed)
+	{
+		if (!m_enablePhysics)
+		{
+			return;
+		}
+
+		Perf updatePhysicsAnimPerf;
+
+		// Update physics animation
+		updatePhysicsAnimPerf.Start();
+		const bool physicsCacheApplied = m_physicsCache != nullptr && m_physicsCache->Apply(float(m_animTime * 30.0));
+		if (!physicsCacheApplied)
+		{
+			if (m_physicsCacheApplied)
+			{
+				// キャッシュを反映している間は Physics World が更新されていないため、現在の姿勢から再開する
+				ResetPhysicsToPose();
+			}
 			m_mmdModel->UpdatePhysicsAnimation((float)elapsed);
-			updatePhysicsAnimPerf.Stop();
 		}
+		m_physicsCacheApplied = physicsCacheApplied;
+		updatePhysicsAnimPerf.Stop();
+
+		m_lastPhysicsElapsed = elapsed;
+		m_perfInfo.m_updatePhysicsAnimTime += updatePhysicsAnimPerf.GetPerfTime();
+	}
+
+	void GLMMDModel::ResetPhysicsToPose()
+	{
+		auto physicsMan = m_mmdModel->GetPhysicsManager();
+		if (physicsMan->GetMMDPhysics() == nullptr)
+		{
+			return;
+		}
+		if (physicsMan->IsSharedPhysics())
+		{
+			// 共有された Physics World は進めず、このモデルの剛体だけを配置し直す
+			for (auto& rb : (*physicsMan->GetRigidBodys()))
+			{
+				rb->ResetToNode(physicsMan->GetMMDPhysics());
+			}
+		}
+		else
+		{
+			m_mmdModel->ResetPhysics();
+		}
+	}
+
+	void GLMMDModel::EndUpdateAnimation(bool recordPhysicsSnapshot)
+	{
+		Perf setupAnimPerf;
+		Perf updateNodeAnimPerf;
+		Perf updatePhysicsAnimPerf;
 
 		// Update node animation (after physics animation)
 		updateNodeAnimPerf.Start();
@@ -375,10 +520,18 @@ namespace saba
 		m_mmdModel->EndAnimation();
 		setupAnimPerf.Stop();
 
-		m_perfInfo.m_setupAnimTime = setupAnimPerf.GetPerfTime();
-		m_perfInfo.m_updateMorphAnimTime = updateMorphAnimPerf.GetPerfTime();
-		m_perfInfo.m_updateNodeAnimTime = updateNodeAnimPerf.GetPerfTime();
-		m_perfInfo.m_updatePhysicsAnimTime = updatePhysicsAnimPerf.GetPerfTime();
+		// Record physics snapshot (for seek)
+		if (recordPhysicsSnapshot && m_enablePhysics && m_vmdAnim != nullptr && m_lastPhysicsElapsed > 0)
+		{
+			updatePhysicsAnimPerf.Start();
+			m_vmdAnim->RecordPhysicsSnapshot(float(m_animTime * 30.0));
+			updatePhysicsAnimPerf.Stop();
+		}
+		m_lastPhysicsElapsed = 0;
+
+		m_perfInfo.m_setupAnimTime += setupAnimPerf.GetPerfTime();
+		m_perfInfo.m_updateNodeAnimTime += updateNodeAnimPerf.GetPerfTime();
+		m_perfInfo.m_updatePhysicsAnimTime += updatePhysicsAnimPerf.GetPerfTime();
 	}
 
 	void GLMMDModel::UpdateMorph()
@@ -12,8 +12,11 @@
 #include <Saba/Model/MMD/MMDMaterial.h>
 
 #include <Saba/Model/MMD/VMDAnimation.h>
+#include <Saba/Model/MMD/MMDPhysicsCache.h>
 
 #include <memory>
+#include <map>
+#include <string>
 
 namespace saba
 {
@@ -51,10 +54,15 @@ namespace saba
 		GLMMDModel();
 		~GLMMDModel();
 
+		// 別スレッドで読み込み済みのテクスチャ (ファイル名 → テクスチャ)
+		using TextureMap = std::map<std::string, GLTextureRef>;
+
 		bool Create(std::shared_ptr<MMDModel> mmdModel);
+		bool Create(std::shared_ptr<MMDModel> mmdModel, const TextureMap& textures);
 		void Destroy();
 
-		bool LoadAnimation(const VMDFile& vmd);
+		// vmdFilepath は Physics キャッシュの照合に使用する (空の場合はキャッシュを使用できない)
+		bool LoadAnimation(const VMDFile& vmd, const std::string& vmdFilepath = "");
 		void LoadPose(const VPDFile& vpd, int frameCount = 30);
 
 		/*
@@ -71,6 +79,12 @@ namespace saba
 		void EvaluateAnimation(double animTime);
 		void UpdateAnimation(double animTime, double elapsed);
 		void UpdateAnimationIgnoreVMD(double elapsed);
+		// UpdateAnimation を Physics の前後で分割したもの
+		// (複数モデルの Physics を並列に更新する場合に使用する)
+		void BeginUpdateAnimation(double animTime);
+		void BeginUpdateAnimationIgnoreVMD();
+		void UpdatePhysicsAnimation(double elapsed);
+		void EndUpdateAnimation(bool recordPhysicsSnapshot);
 		void UpdateMorph();
 		void Update();
 
@@ -111,6 +125,15 @@ namespace saba
 
 		VMDAnimation* GetVMDAnimation() const { return m_vmdAnim.get(); }
 
+		// 記録済みのフレームでは Physics の代わりにキャッシュを使用する
+		void SetPhysicsCache(std::unique_ptr<MMDPhysicsCache>&& physicsCache) { m_physicsCache = std::move(physicsCache); }
+		MMDPhysicsCache* GetPhysicsCache() const { return m_physicsCache.get(); }
+		// Physics キャッシュの照合に使用するモデルのファイルパス
+		void SetModelFilepath(const std::string& filepath) { m_modelFilepath = filepath; }
+		// モデルとモーションのファイル内容が一致する Physics キャッシュを読み込む
+		// bake が true の場合、読み込めなければモーション全体を計算して保存する
+		bool LoadPhysicsCache(const std::string& filename, bool bake);
+
 		void EnablePhysics(bool enable) { m_enablePhysics = enable; }
 		bool IsEnabledPhysics() const { return m_enablePhysics; }
 
@@ -120,11 +143,18 @@ namespace saba
 		void EnableGroundShadow(bool enable) { m_enableGroundShadow = enable; }
 		bool IsEnableGroundShadow() const { return m_enableGroundShadow; }
 
+	private:
+		// 剛体を現在のノードの姿勢に配置し直し、速度を 0 にする
+		void ResetPhysicsToPose();
+
 	private:
 		std::shared_ptr<MMDModel>		m_mmdModel;
 
 		std::unique_ptr<VMDAnimation>	m_vmdAnim;
 		double							m_animTime;
+		std::unique_ptr<MMDPhysicsCache>	m_physicsCache;
+		std::string						m_modelFilepath;
+		std::vector<std::string>		m_motionFilepaths;
 
 		GLBufferObject	m_posVBO;
 		GLBufferObject	m_norVBO;
@@ -142,6 +172,8 @@ namespace saba
 		std::vector<MMDSubMesh>		m_subMeshes;
 
 		PerfInfo					m_perfInfo;
+		double						m_lastPhysicsElapsed;
+		bool						m_physicsCacheApplied;	// 前回の更新で Physics キャッシュを反映したか
 
 		bool	m_enablePhysics;
 		bool	m_enableEdge;
@@ -246,27 +246,67 @@ namespace saba
 				m_selectedNode = clickNode;
 			}
 		}
-		if (ImGui::TreeNode("Physics"))
+		if (m_mmdModel->GetMMDModel()->GetMMDPhysics() != nullptr && ImGui::TreeNode("Physics"))
 		{
 			bool enabledPhysics = m_mmdModel->IsEnabledPhysics();
 			if (ImGui::Checkbox("Enable", &enabledPhysics))
 			{
 				m_mmdModel->EnablePhysics(enabledPhysics);
 			}
+			auto physicsMan = m_mmdModel->GetMMDModel()->GetPhysicsManager();
+			bool asyncPhysics = physicsMan->IsAsyncPhysics();
+			if (ImGui::Checkbox("Async", &asyncPhysics))
+			{
+				physicsMan->EnableAsyncPhysics(asyncPhysics);
+			}
 			auto physics = m_mmdModel->GetMMDModel()->GetMMDPhysics();
 			float fps = physics->GetFPS();
 			if (ImGui::InputFloat("FPS", &fps, 0, 0, 1))
 			{
 				if (1 <= fps)
 				{
+					physicsMan->WaitAsyncPhysics();
 					physics->SetFPS(fps);
 				}
 			}
 			int subStepCount = physics->GetMaxSubStepCount();
 			if (ImGui::SliderInt("Max Sub Step", &subStepCount, 1, 100))
 			{
+				physicsMan->WaitAsyncPhysics();
 				physics->SetMaxSubStepCount(subStepCount);
 			}
+			// 非同期の Physics を待つのは設定を変更する時のみとする
+			auto timeBudget = physics->GetTimeBudget();
+			bool changedBudget = ImGui::Checkbox("Time Budget", &timeBudget.m_enable);
+			float budgetMS = timeBudget.m_budget * 1000.0f;
+			if (ImGui::SliderFloat("Budget (ms)", &budgetMS, 0.5f, 16.0f))
+			{
+				timeBudget.m_budget = budgetMS / 1000.0f;
+				changedBudget = true;
+			}
+			changedBudget |= ImGui::SliderFloat("Min FPS", &timeBudget.m_minFPS, 10.0f, 120.0f);
+			if (changedBudget)
+			{
+				physicsMan->WaitAsyncPhysics();
+				physics->SetTimeBudget(timeBudget);
+			}
+			const auto stats = physicsMan->GetPhysicsStats();
+			ImGui::Text("Rate : %.1f fps, Sub Step : %d", stats.m_currentFPS, stats.m_currentMaxSubStepCount);
+			ImGui::Text("Step Cost : %.3f ms", stats.m_stepCost * 1000.0);
+			ImGui::Text("Clamped : %u, Dropped : %.3f s", stats.m_clampedCount, stats.m_droppedTime);
+			if (ImGui::Button("Reset Stats"))
+			{
+				physicsMan->WaitAsyncPhysics();
+				physics->ResetStats();
+			}
+			auto lod = physicsMan->GetLOD();
+			bool changedLOD = ImGui::InputFloat("LOD FPS", &lod.m_fps, 0, 0, 1);
+			changedLOD |= ImGui::SliderInt("LOD Max Chain Depth", &lod.m_maxChainDepth, -1, 10);
+			changedLOD |= ImGui::Checkbox("LOD Sleep", &lod.m_sleep);
+			if (changedLOD)
+			{
+				physicsMan->SetLOD(lod);
+			}
 			ImGui::TreePop();
 		}
 		if (ImGui::TreeNode("Morph"))
@@ -371,19 +411,36 @@ namespace saba
 	}
 
 	void GLMMDModelDrawer::Update(ViewerContext * ctxt)
+	{
+		BeginUpdate(ctxt);
+		UpdatePhysics(ctxt);
+		EndUpdate(ctxt);
+	}
+
+	void GLMMDModelDrawer::BeginUpdate(ViewerContext * ctxt)
 	{
 		m_mmdModel->ClearPerfInfo();
 
 		double animTime = ctxt->GetAnimationTime();
-		double elapsed = ctxt->GetElapsed();
 		if (ctxt->GetPlayMode() != ViewerContext::PlayMode::Stop)
 		{
-			m_mmdModel->UpdateAnimation(animTime, elapsed);
+			m_mmdModel->BeginUpdateAnimation(animTime);
 		}
 		else
 		{
-			m_mmdModel->UpdateAnimationIgnoreVMD(elapsed);
+			m_mmdModel->BeginUpdateAnimationIgnoreVMD();
 		}
+	}
+
+	void GLMMDModelDrawer::UpdatePhysics(ViewerContext * ctxt)
+	{
+		m_mmdModel->UpdatePhysicsAnimation(ctxt->GetElapsed());
+	}
+
+	void GLMMDModelDrawer::EndUpdate(ViewerContext * ctxt)
+	{
+		bool useVMD = ctxt->GetPlayMode() != ViewerContext::PlayMode::Stop;
+		m_mmdModel->EndUpdateAnimation(useVMD);
 
 		m_mmdModel->Update();
 	}
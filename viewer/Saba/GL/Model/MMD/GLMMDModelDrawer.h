@@ -36,6 +36,9 @@ namespace saba
 
 		void ResetAnimation(ViewerContext* ctxt) override;
 		void Update(ViewerContext* ctxt) override;
+		void BeginUpdate(ViewerContext* ctxt) override;
+		void UpdatePhysics(ViewerContext* ctxt) override;
+		void EndUpdate(ViewerContext* ctxt) override;
 		void DrawUI(ViewerContext* ctxt) override;
 		void DrawShadowMap(ViewerContext* ctxt, size_t csmIdx) override;
 		void Draw(ViewerContext* ctxt) override;
@@ -10,6 +10,8 @@
 namespace saba
 {
 	GLOBJModel::GLOBJModel()
+		: m_indexType(GL_UNSIGNED_INT)
+		, m_indexTypeSize(sizeof(uint32_t))
 	{
 	}
 
@@ -88,6 +90,7 @@ namespace saba
 			mb.SetFaceMaterial(polyID, face.m_material);
 		}
 		mb.SortFaces();
+		mb.Weld();
 
 		std::vector<MB::SubMesh> objSubMeshes;
 		mb.MakeSubMeshList(&objSubMeshes);
@@ -106,6 +109,9 @@ namespace saba
 		m_posVBO = mb.CreateVBO(posID);
 		m_norVBO = mb.CreateVBO(norID);
 		m_uvVBO = mb.CreateVBO(uvID);
+		m_ibo = mb.CreateIBO();
+		m_indexType = mb.GetIndexType();
+		m_indexTypeSize = mb.GetIndexTypeSize();
 
 		m_posBinder = mb.MakeVertexBinder(posID);
 		m_norBinder = mb.MakeVertexBinder(norID);
@@ -119,6 +125,7 @@ namespace saba
 		m_posVBO.Destroy();
 		m_norVBO.Destroy();
 		m_uvVBO.Destroy();
+		m_ibo.Destroy();
 		m_materials.clear();
 		m_subMeshes.clear();
 	}
@@ -51,6 +51,9 @@ namespace saba
 		const GLBufferObject& GetPositionVBO() const { return m_posVBO; }
 		const GLBufferObject& GetNormalVBO() const { return m_norVBO; }
 		const GLBufferObject& GetUVVBO() const { return m_uvVBO; }
+		const GLBufferObject& GetIBO() const { return m_ibo; }
+		GLenum GetIndexType() const { return m_indexType; }
+		size_t GetIndexTypeSize() const { return m_indexTypeSize; }
 
 		const VertexBinder& GetPositionBinder() const { return m_posBinder; }
 		const VertexBinder& GetNormalBinder() const { return m_norBinder; }
@@ -63,6 +66,9 @@ namespace saba
 		GLBufferObject	m_posVBO;
 		GLBufferObject	m_norVBO;
 		GLBufferObject	m_uvVBO;
+		GLBufferObject	m_ibo;
+		GLenum			m_indexType;
+		size_t			m_indexTypeSize;
 
 		VertexBinder	m_posBinder;
 		VertexBinder	m_norBinder;
@@ -58,15 +58,13 @@ namespace saba
 					}
 					else
 					{
-						auto tex = CreateTextureFromFile(xmat.m_texture);
-						mat.m_texture = std::move(tex);
+						mat.m_texture = ctxt->GetTextureCache()->Get(xmat.m_texture);
 					}
 				}
 				mat.m_spTextureMode = xmat.m_spTextureMode;
 				if (!xmat.m_spTexture.empty())
 				{
-					auto tex = CreateTextureFromFile(xmat.m_spTexture);
-					mat.m_spTexture = std::move(tex);
+					mat.m_spTexture = ctxt->GetTextureCache()->Get(xmat.m_spTexture);
 				}
 				mesh->m_materials.emplace_back(std::move(mat));
 			}
@@ -93,6 +91,7 @@ namespace saba
 				mb.SetFaceMaterial(polyID, xface.m_material);
 			}
 			mb.SortFaces();
+			mb.Weld();
 
 			std::vector<MB::SubMesh> mbSubMeshes;
 			mb.MakeSubMeshList(&mbSubMeshes);
@@ -108,6 +107,9 @@ namespace saba
 			mesh->m_posVBO = mb.CreateVBO(posID);
 			mesh->m_norVBO = mb.CreateVBO(norID);
 			mesh->m_uvVBO = mb.CreateVBO(uvID);
+			mesh->m_ibo = mb.CreateIBO();
+			mesh->m_indexType = mb.GetIndexType();
+			mesh->m_indexTypeSize = mb.GetIndexTypeSize();
 
 			mesh->m_posBinder = mb.MakeVertexBinder(posID);
 			mesh->m_norBinder = mb.MakeVertexBinder(norID);
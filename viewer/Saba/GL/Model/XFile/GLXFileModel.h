@@ -42,6 +42,9 @@ namespace saba
 			GLBufferObject	m_posVBO;
 			GLBufferObject	m_norVBO;
 			GLBufferObject	m_uvVBO;
+			GLBufferObject	m_ibo;
+			GLenum			m_indexType;
+			size_t			m_indexTypeSize;
 
 			VertexBinder	m_posBinder;
 			VertexBinder	m_norBinder;
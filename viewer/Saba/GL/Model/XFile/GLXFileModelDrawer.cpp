@@ -67,6 +67,8 @@ namespace saba
 					glEnableVertexAttribArray(shader->m_inUV);
 				}
 
+				glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh->m_ibo);
+
 				glEnable(GL_CULL_FACE);
 				glCullFace(GL_BACK);
 
@@ -173,7 +175,13 @@ namespace saba
 				glEnable(GL_CULL_FACE);
 				glCullFace(GL_BACK);
 
-				glDrawArrays(GL_TRIANGLES, subMesh.m_beginIndex, subMesh.m_vertexCount);
+				size_t offset = subMesh.m_beginIndex * mesh->m_indexTypeSize;
+				glDrawElements(
+					GL_TRIANGLES,
+					subMesh.m_vertexCount,
+					mesh->m_indexType,
+					(GLvoid*)offset
+				);
 
 				glActiveTexture(GL_TEXTURE0 + 1);
 				glBindTexture(GL_TEXTURE_2D, 0);
@@ -34,6 +34,11 @@ namespace saba
 		virtual void ResetAnimation(ViewerContext* ctxt) = 0;
 		virtual void DrawUI(ViewerContext* ctxt) = 0;
 		virtual void Update(ViewerContext* ctxt) = 0;
+		// Update を Physics の前後で分割する (Physics を並列に更新するため)
+		// UpdatePhysics は複数モデルで同時に呼ばれる場合がある
+		virtual void BeginUpdate(ViewerContext* ctxt) {}
+		virtual void UpdatePhysics(ViewerContext* ctxt) {}
+		virtual void EndUpdate(ViewerContext* ctxt) { Update(ctxt); }
 		virtual void DrawShadowMap(ViewerContext* ctxt, size_t csmIdx) = 0;
 		virtual void Draw(ViewerContext* ctxt) = 0;
 
@@ -42,8 +42,10 @@
 #include <deque>
 #include <sstream>
 #include <iomanip>
+#include <set>
 #include <string>
 #include <thread>
+#include <mutex>
 
 namespace saba
 {
@@ -58,6 +60,8 @@ namespace saba
 
 		void log(const spdlog::details::log_msg& msg) override
 		{
+			// 非同期読み込みのワーカースレッドからも呼ばれる
+			std::lock_guard<std::mutex> lock(m_mutex);
 			while (m_buffer.size() >= m_maxBufferSize)
 			{
 				if (m_buffer.empty())
@@ -81,6 +85,7 @@ namespace saba
 			std::string					m_message;
 		};
 		const std::deque<LogMessage>& GetBuffer() const { return m_buffer; }
+		std::mutex& GetMutex() { return m_mutex; }
 
 		bool IsAdded() const { return m_added; }
 		void ClearAddedFlag() { m_added = false; }
@@ -89,6 +94,7 @@ namespace saba
 		size_t					m_maxBufferSize;
 		std::deque<LogMessage>	m_buffer;
 		bool					m_added;
+		std::mutex				m_mutex;
 	};
 
 	Viewer::InitializeParameter::InitializeParameter()
@@ -107,6 +113,9 @@ namespace saba
 
 	Viewer::MMDModelConfig::MMDModelConfig()
 		: m_parallelUpdateCount(0)
+		, m_sharedPhysics(false)
+		, m_asyncPhysics(false)
+		, m_runtimeCache(false)
 	{
 	}
 
@@ -142,6 +151,12 @@ namespace saba
 		, m_bgColor2(DefaultBGColor2)
 		, m_cameraOverride(true)
 		, m_clipElapsed(true)
+		, m_parallelPhysics(true)
+		, m_physicsLOD(false)
+		, m_physicsLODApplied(false)
+		, m_physicsLODDistance(200.0f)
+		, m_asyncLoad(true)
+		, m_loadUploadBudget(4.0f)
 		, m_currentFrameBufferWidth(-1)
 		, m_currentFrameBufferHeight(-1)
 		, m_currentMSAAEnable(false)
@@ -282,6 +297,10 @@ namespace saba
 
 	void Viewer::Uninitislize()
 	{
+		// ワーカーの終了を待ち、GL コンテキストが有効なうちに破棄する
+		m_loadTasks.clear();
+		m_physicsWorkers.Destroy();
+
 		auto logger = Singleton<saba::Logger>::Get();
 		logger->RemoveSink(m_imguiLogSink.get());
 		m_imguiLogSink.reset();
@@ -355,6 +374,9 @@ namespace saba
 				DrawMenuBar();
 			}
 
+			m_context.GetTextureUploader()->Update();
+			m_context.GetTextureCache()->Update();
+			UpdateLoadTasks();
 			Update();
 
 			if (m_context.IsShadowEnabled())
@@ -500,10 +522,44 @@ namespace saba
 
 		if (update)
 		{
+			UpdatePhysicsLOD();
+
 			for (auto& modelDrawer : m_modelDrawers)
 			{
-				// Update
-				modelDrawer->Update(&m_context);
+				// Update (before physics)
+				modelDrawer->BeginUpdate(&m_context);
+			}
+
+			// 共有された Physics World は全モデルで一度だけ更新する
+			if (m_sharedPhysics != nullptr)
+			{
+				m_sharedPhysics->Update(float(m_context.GetElapsed()));
+			}
+
+			if (CanUpdatePhysicsInParallel())
+			{
+				if (m_physicsWorkers.GetThreadCount() == 0)
+				{
+					size_t threadCount = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+					m_physicsWorkers.Create(threadCount);
+				}
+				m_physicsWorkers.Execute(
+					m_modelDrawers.size(),
+					[this](size_t i) { m_modelDrawers[i]->UpdatePhysics(&m_context); }
+				);
+			}
+			else
+			{
+				for (auto& modelDrawer : m_modelDrawers)
+				{
+					modelDrawer->UpdatePhysics(&m_context);
+				}
+			}
+
+			for (auto& modelDrawer : m_modelDrawers)
+			{
+				// Update (after physics)
+				modelDrawer->EndUpdate(&m_context);
 			}
 		}
 
@@ -836,6 +892,7 @@ namespace saba
 				}
 				ImGui::MenuItem("ClipElapsed", nullptr, &m_clipElapsed);
 				ImGui::MenuItem("Grid", nullptr, &m_gridEnabled);
+				ImGui::MenuItem("AsyncLoad", nullptr, &m_asyncLoad);
 				ImGui::EndMenu();
 			}
 			if (ImGui::BeginMenu("Animation"))
@@ -854,6 +911,8 @@ namespace saba
 				{
 					m_animFixedUpdate = !m_animFixedUpdate;
 				}
+				ImGui::MenuItem("Parallel Physics", nullptr, &m_parallelPhysics);
+				ImGui::MenuItem("Physics LOD", nullptr, &m_physicsLOD);
 				ImGui::EndMenu();
 			}
 			if (ImGui::BeginMenu("CustomCommand"))
@@ -906,6 +965,7 @@ namespace saba
 			DrawManip();
 		}
 		DrawCtrlUI();
+		DrawLoadUI();
 
 		DrawLightGuide();
 	}
@@ -960,6 +1020,32 @@ namespace saba
 			}
 			return sum / count;
 		}
+
+		float ToMB(size_t bytes)
+		{
+			return float(bytes) / (1024.0f * 1024.0f);
+		}
+
+		// モデルが参照しているテクスチャの使用量 (共有しているテクスチャも含む)
+		size_t CalcMMDTextureBytes(const GLMMDModel* model, const GLTextureCache* textureCache)
+		{
+			std::set<GLuint> textures;
+			for (const auto& mat : model->GetMaterials())
+			{
+				textures.insert(mat.m_texture.Get());
+				textures.insert(mat.m_spTexture.Get());
+				textures.insert(mat.m_toonTexture.Get());
+			}
+			size_t bytes = 0;
+			for (auto tex : textures)
+			{
+				if (tex != 0)
+				{
+					bytes += textureCache->GetTextureBytes(tex);
+				}
+			}
+			return bytes;
+		}
 	} // namespace
 
 	void Viewer::DrawInfoUI()
@@ -983,6 +1069,53 @@ namespace saba
 		if (m_enableMoreInfoUI)
 		{
 			ImGui::Text("FPS ave:%.2f min:%.2f max time:%.2f[ms]", aveFps, minFps, 1000.0f / minFps);
+			auto textureCache = m_context.GetTextureCache();
+			ImGui::Text("Texture Cache : %d (%.1f MB)", int(textureCache->GetCount()), ToMB(textureCache->GetTotalBytes()));
+			if (textureCache->GetBudget() != 0 || textureCache->GetResolutionLimit() != 0)
+			{
+				ImGui::Text("Texture Budget : %.1f MB (limit %d)", ToMB(textureCache->GetBudget()), textureCache->GetResolutionLimit());
+			}
+			auto uploader = m_context.GetTextureUploader();
+			if (uploader->GetPendingCount() != 0)
+			{
+				ImGui::Text("Texture Upload : %d (%.1f MB)",
+					int(uploader->GetPendingCount()),
+					float(uploader->GetPendingBytes()) / (1024.0f * 1024.0f)
+				);
+			}
+			if (ImGui::TreeNode("Texture Memory"))
+			{
+				for (const auto& modelDrawer : m_modelDrawers)
+				{
+					if (modelDrawer->GetType() == ModelDrawerType::MMDModelDrawer)
+					{
+						auto mmdModelDrawer = reinterpret_cast<GLMMDModelDrawer*>(modelDrawer.get());
+						ImGui::Text("%s : %.1f MB", modelDrawer->GetName().c_str(),
+							ToMB(CalcMMDTextureBytes(mmdModelDrawer->GetModel(), textureCache)));
+					}
+				}
+				if (ImGui::TreeNode("Textures"))
+				{
+					auto infos = textureCache->GetTextureInfos();
+					std::sort(infos.begin(), infos.end(), [](const GLTextureCache::TextureInfo& a, const GLTextureCache::TextureInfo& b)
+					{
+						return a.m_bytes > b.m_bytes;
+					});
+					for (const auto& info : infos)
+					{
+						ImGui::Text("%6.2f MB %4dx%-4d ref:%d %s",
+							ToMB(info.m_bytes), info.m_width, info.m_height, info.m_refCount,
+							PathUtil::GetFilename(info.m_filename).c_str());
+						if (info.m_sourceWidth != info.m_width || info.m_sourceHeight != info.m_height)
+						{
+							ImGui::SameLine();
+							ImGui::Text("(%dx%d)", info.m_sourceWidth, info.m_sourceHeight);
+						}
+					}
+					ImGui::TreePop();
+				}
+				ImGui::TreePop();
+			}
 		}
 
 		if (m_selectedModelDrawer != nullptr && m_selectedModelDrawer->GetType() == ModelDrawerType::MMDModelDrawer)
@@ -992,6 +1125,7 @@ namespace saba
 			if (mmdModel != nullptr)
 			{
 				ImGui::Text("MMD Model Update Time %.3f ms", mmdModel->GetUpdateTime() * 1000.0);
+				ImGui::Text("MMD Model Texture Memory %.1f MB", ToMB(CalcMMDTextureBytes(mmdModel, m_context.GetTextureCache())));
 				const auto& perfInfo = mmdModel->GetPerfInfo();
 
 				PushPerfLap(m_perfMMDSetupAnimTimeLap, perfInfo.m_setupAnimTime);
@@ -1068,6 +1202,7 @@ namespace saba
 		ImGui::Begin("Log", &m_enableLogUI);
 		ImGui::BeginChild("scrolling", ImVec2(0, 0), false, ImGuiWindowFlags_HorizontalScrollbar);
 
+		std::lock_guard<std::mutex> lock(m_imguiLogSink->GetMutex());
 		for (const auto& log : m_imguiLogSink->GetBuffer())
 		{
 			ImVec4 col = ImColor(255, 255, 255, 255);
@@ -1641,6 +1776,54 @@ namespace saba
 		ImGui::PopID();
 	}
 
+	void Viewer::DrawLoadUI()
+	{
+		if (m_loadTasks.empty())
+		{
+			return;
+		}
+
+		float width = 400;
+		ImGui::SetNextWindowSize(ImVec2(width, 0), ImGuiCond_FirstUseEver);
+		ImGui::SetNextWindowPos(
+			ImVec2(((float)m_context.GetWindowWidth() - width) * 0.5f, 40),
+			ImGuiCond_FirstUseEver
+		);
+		ImGui::Begin("Loading", nullptr, ImGuiWindowFlags_NoSavedSettings);
+		ImGui::SliderFloat("Budget (ms)", &m_loadUploadBudget, 0.5f, 16.0f);
+		for (const auto& task : m_loadTasks)
+		{
+			int textureCount = task->m_textureCount;
+			int decodedCount = task->m_decodedCount;
+			float progress = 0.0f;
+			std::stringstream ss;
+			if (task->m_loadOnRenderThread)
+			{
+				ss << "Waiting";
+			}
+			else if (!task->m_workerFinished)
+			{
+				if (textureCount == 0)
+				{
+					ss << "Loading";
+				}
+				else
+				{
+					ss << "Decoding textures " << decodedCount << "/" << textureCount;
+					progress = 0.5f * float(decodedCount) / float(textureCount);
+				}
+			}
+			else
+			{
+				ss << "Uploading textures " << task->m_uploadedCount << "/" << textureCount;
+				progress = 0.5f + 0.5f * float(task->m_uploadedCount) / float(std::max(textureCount, 1));
+			}
+			ImGui::TextUnformatted(PathUtil::GetFilename(task->m_filepath).c_str());
+			ImGui::ProgressBar(progress, ImVec2(-1, 0), ss.str().c_str());
+		}
+		ImGui::End();
+	}
+
 	void Viewer::UpdateAnimation()
 	{
 		double animTime = m_context.GetAnimationTime();
@@ -1706,6 +1889,8 @@ namespace saba
 		m_commands.emplace_back(Command{ "clearSceneAnimation", [this](const Args& args) { return CmdClearSceneAnimation(args); } });
 		m_commands.emplace_back(Command{ "setMMDConfig", [this](const Args& args) { return CmdSetMMDConfig(args); } });
 		m_commands.emplace_back(Command{ "setMSAA", [this](const Args& args) {return CmdSetMSAA(args); } });
+		m_commands.emplace_back(Command{ "setTextureConfig", [this](const Args& args) { return CmdSetTextureConfig(args); } });
+		m_commands.emplace_back(Command{ "physicsCache", [this](const Args& args) { return CmdPhysicsCache(args); } });
 	}
 
 	void Viewer::RefreshCustomCommand()
@@ -1914,6 +2099,11 @@ namespace saba
 		}
 
 		std::string filepath = args[0];
+		if (args.size() >= 2 && args[1] == "-async")
+		{
+			return LoadFileAsync(filepath);
+		}
+
 		std::string ext = PathUtil::GetExt(filepath);
 		SABA_INFO("Open File. [{}]", filepath);
 		if (ext == "obj")
@@ -1990,6 +2180,7 @@ namespace saba
 				);
 				m_modelDrawers.erase(removeIt, m_modelDrawers.end());
 				m_selectedModelDrawer = nullptr;
+				m_context.GetTextureCache()->Collect();
 			}
 		}
 		else
@@ -1999,6 +2190,7 @@ namespace saba
 				m_selectedModelDrawer = nullptr;
 				m_modelDrawers.clear();
 				m_cameraOverrider.reset();
+				m_context.GetTextureCache()->Collect();
 
 				InitializeScene();
 			}
@@ -2273,6 +2465,9 @@ namespace saba
 		if (args.empty())
 		{
 			SABA_INFO("Parallel : {}", m_mmdModelConfig.m_parallelUpdateCount);
+			SABA_INFO("SharedPhysics : {}", m_mmdModelConfig.m_sharedPhysics);
+			SABA_INFO("AsyncPhysics : {}", m_mmdModelConfig.m_asyncPhysics);
+			SABA_INFO("RuntimeCache : {} [{}]", m_mmdModelConfig.m_runtimeCache, m_mmdModelConfig.m_runtimeCacheDir);
 		}
 		auto argIt = args.begin();
 		for (; argIt != args.end(); ++argIt)
@@ -2310,6 +2505,44 @@ namespace saba
 					return false;
 				}
 			}
+			else if ((*argIt) == "-sharedPhysics")
+			{
+				++argIt;
+				if (argIt == args.end())
+				{
+					return false;
+				}
+				// 以降に読み込むモデルに適用する
+				m_mmdModelConfig.m_sharedPhysics = (*argIt) == "true";
+			}
+			else if ((*argIt) == "-asyncPhysics")
+			{
+				++argIt;
+				if (argIt == args.end())
+				{
+					return false;
+				}
+				// 以降に読み込むモデルに適用する
+				m_mmdModelConfig.m_asyncPhysics = (*argIt) == "true";
+			}
+			else if ((*argIt) == "-runtimeCache")
+			{
+				++argIt;
+				if (argIt == args.end())
+				{
+					return false;
+				}
+				m_mmdModelConfig.m_runtimeCache = (*argIt) == "true";
+			}
+			else if ((*argIt) == "-runtimeCacheDir")
+			{
+				++argIt;
+				if (argIt == args.end())
+				{
+					return false;
+				}
+				m_mmdModelConfig.m_runtimeCacheDir = *argIt;
+			}
 			else
 			{
 				SABA_WARN("unknown arg : {}", *argIt);
@@ -2344,6 +2577,377 @@ namespace saba
 		return true;
 	}
 
+	bool Viewer::CmdSetTextureConfig(const std::vector<std::string>& args)
+	{
+		auto textureCache = m_context.GetTextureCache();
+		auto diskCache = textureCache->GetDiskCache();
+		if (args.empty())
+		{
+			SABA_INFO("DiskCache : [{}]", diskCache->GetCacheDir());
+			SABA_INFO("Compression : {}",
+				diskCache->GetCompression() == GLTextureDiskCache::Compression::BC ? "bc" : "none");
+			SABA_INFO("Budget : {} MB", textureCache->GetBudget() / (1024 * 1024));
+			SABA_INFO("MaxSize : {}", textureCache->GetMaxSize());
+			return true;
+		}
+		if (!m_loadTasks.empty())
+		{
+			// 読み込み中のスレッドが設定を参照しているため
+			SABA_WARN("setTextureConfig : Loading in progress.");
+			return false;
+		}
+
+		auto argIt = args.begin();
+		for (; argIt != args.end(); ++argIt)
+		{
+			if ((*argIt) == "-diskCache")
+			{
+				++argIt;
+				if (argIt == args.end())
+				{
+					return false;
+				}
+				// 空の場合は無効
+				diskCache->SetCacheDir(*argIt);
+			}
+			else if ((*argIt) == "-compression")
+			{
+				++argIt;
+				if (argIt == args.end())
+				{
+					return false;
+				}
+				if ((*argIt) == "bc")
+				{
+					diskCache->SetCompression(GLTextureDiskCache::Compression::BC);
+				}
+				else if ((*argIt) == "none")
+				{
+					diskCache->SetCompression(GLTextureDiskCache::Compression::None);
+				}
+				else
+				{
+					SABA_WARN("compression : bc | none");
+					return false;
+				}
+			}
+			else if ((*argIt) == "-budget" || (*argIt) == "-maxSize")
+			{
+				const std::string& name = *argIt;
+				++argIt;
+				if (argIt == args.end())
+				{
+					return false;
+				}
+				int value = 0;
+				try
+				{
+					value = std::stoi(*argIt);
+				}
+				catch (std::exception& e)
+				{
+					SABA_WARN("exception : {}", e.what());
+					return false;
+				}
+				if (value < 0)
+				{
+					SABA_WARN("{} : {} < 0", name, value);
+					return false;
+				}
+				// 0 の場合は制限しない
+				if (name == "-budget")
+				{
+					textureCache->SetBudget(size_t(value) * 1024 * 1024);
+				}
+				else
+				{
+					textureCache->SetMaxSize(value);
+				}
+			}
+			else
+			{
+				SABA_WARN("unknown arg : {}", *argIt);
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool Viewer::CmdPhysicsCache(const std::vector<std::string>& args)
+	{
+		GLMMDModel* mmdModel = nullptr;
+		if (m_selectedModelDrawer != nullptr && m_selectedModelDrawer->GetType() == ModelDrawerType::MMDModelDrawer)
+		{
+			auto mmdModelDrawer = reinterpret_cast<GLMMDModelDrawer*>(m_selectedModelDrawer.get());
+			mmdModel = mmdModelDrawer->GetModel();
+		}
+		if (mmdModel == nullptr)
+		{
+			SABA_INFO("MMD Model not selected.");
+			return false;
+		}
+
+		if (args.empty())
+		{
+			auto physicsCache = mmdModel->GetPhysicsCache();
+			SABA_INFO("PhysicsCache : {} frames", physicsCache != nullptr ? physicsCache->GetFrameCount() : 0);
+			return true;
+		}
+
+		// physicsCache <file> [-bake] : キャッシュを読み込む (-bake : 無い場合は作成する)
+		// physicsCache -clear : キャッシュを使用しない
+		std::string filename;
+		bool bake = false;
+		for (const auto& arg : args)
+		{
+			if (arg == "-clear")
+			{
+				mmdModel->SetPhysicsCache(nullptr);
+				return true;
+			}
+			else if (arg == "-bake")
+			{
+				bake = true;
+			}
+			else
+			{
+				filename = arg;
+			}
+		}
+		if (filename.empty())
+		{
+			return false;
+		}
+
+		if (!mmdModel->LoadPhysicsCache(filename, bake))
+		{
+			SABA_WARN("Failed to load physics cache. [{}]", filename);
+			return false;
+		}
+		SABA_INFO("PhysicsCache : {} frames [{}]", mmdModel->GetPhysicsCache()->GetFrameCount(), filename);
+
+		return true;
+	}
+
+	namespace
+	{
+		// GLMMDModel::Create と同じ条件で読み込むテクスチャを列挙する
+		std::vector<GLTextureCache::Request> CollectMMDTextures(const MMDModel* mmdModel)
+		{
+			std::set<std::string> textureFiles;
+			size_t matCount = mmdModel->GetMaterialCount();
+			const MMDMaterial* materials = matCount != 0 ? mmdModel->GetMaterials() : nullptr;
+			for (size_t matIdx = 0; matIdx < matCount; matIdx++)
+			{
+				const auto& mat = materials[matIdx];
+				for (const auto* filename : { &mat.m_texture, &mat.m_spTexture, &mat.m_toonTexture })
+				{
+					if (!filename->empty())
+					{
+						textureFiles.insert(*filename);
+					}
+				}
+			}
+
+			std::vector<GLTextureCache::Request> requests;
+			for (const auto& filename : textureFiles)
+			{
+				GLTextureCache::Request request;
+				request.m_filename = filename;
+				requests.emplace_back(std::move(request));
+			}
+			return requests;
+		}
+	}
+
+	bool Viewer::LoadFileAsync(const std::string& filename)
+	{
+		std::string ext = PathUtil::GetExt(filename);
+		SABA_INFO("Open File (Async). [{}]", filename);
+
+		auto task = std::make_unique<LoadTask>();
+		task->m_filepath = filename;
+		task->m_ext = ext;
+		task->m_mmdModelConfig = m_mmdModelConfig;
+		task->m_mmdDataDir = PathUtil::Combine(
+			m_context.GetResourceDir(),
+			"mmd"
+		);
+		task->m_textureCache = m_context.GetTextureCache();
+		if (ext == "pmd" || ext == "pmx")
+		{
+			// 共有の Physics World は描画スレッドで更新しているため、
+			// ワーカースレッドから剛体を追加できない
+			task->m_loadOnRenderThread = m_mmdModelConfig.m_sharedPhysics;
+		}
+		else if (ext == "vmd")
+		{
+		}
+		else if (ext == "obj" || ext == "vpd" || ext == "x")
+		{
+			// 読み込む順番を保つため、キューに積んでから描画スレッドで読み込む
+			task->m_loadOnRenderThread = true;
+		}
+		else
+		{
+			SABA_INFO("Unknown File Ext [{}]", ext);
+			return false;
+		}
+
+		if (!task->m_loadOnRenderThread)
+		{
+			task->m_future = std::async(std::launch::async, LoadOnWorker, task.get());
+		}
+		m_loadTasks.emplace_back(std::move(task));
+
+		return true;
+	}
+
+	bool Viewer::LoadOnWorker(LoadTask* task)
+	{
+		if (task->m_ext == "vmd")
+		{
+			return ReadVMDFile(&task->m_vmd, task->m_filepath.c_str());
+		}
+
+		const auto& config = task->m_mmdModelConfig;
+		if (task->m_ext == "pmd")
+		{
+			auto pmdModel = std::make_shared<PMDModel>();
+			pmdModel->SetParallelUpdateHint(config.m_parallelUpdateCount);
+			if (!pmdModel->Load(task->m_filepath, task->m_mmdDataDir))
+			{
+				SABA_WARN("PMD Load Fail.");
+				return false;
+			}
+			task->m_bboxMin = pmdModel->GetBBoxMin();
+			task->m_bboxMax = pmdModel->GetBBoxMax();
+			task->m_mmdModel = std::move(pmdModel);
+		}
+		else
+		{
+			auto pmxModel = std::make_shared<PMXModel>();
+			pmxModel->SetParallelUpdateHint(config.m_parallelUpdateCount);
+			pmxModel->EnableRuntimeCache(config.m_runtimeCache, config.m_runtimeCacheDir);
+			if (!pmxModel->Load(task->m_filepath, task->m_mmdDataDir))
+			{
+				SABA_WARN("PMX Load Fail.");
+				return false;
+			}
+			task->m_bboxMin = pmxModel->GetBBoxMin();
+			task->m_bboxMax = pmxModel->GetBBoxMax();
+			task->m_mmdModel = std::move(pmxModel);
+		}
+
+		// キャッシュにないテクスチャを並列にデコードしておく
+		// (失敗したものは Unknown のまま残し、空のテクスチャとして扱う)
+		task->m_textureRequests = CollectMMDTextures(task->m_mmdModel.get());
+		task->m_textureCached.resize(task->m_textureRequests.size());
+		for (size_t i = 0; i < task->m_textureRequests.size(); i++)
+		{
+			auto key = GLTextureCache::MakeKey(task->m_textureRequests[i]);
+			task->m_textureCached[i] = task->m_textureCache->Contains(key);
+		}
+		task->m_textureCount = int(task->m_textureRequests.size());
+		task->m_textureCache->Decode(
+			&task->m_textureImages,
+			task->m_textureRequests,
+			&task->m_textureCached,
+			&task->m_decodedCount
+		);
+
+		return true;
+	}
+
+	void Viewer::UpdateLoadTasks()
+	{
+		// 先頭のタスクから順に、時間の許す限り GL オブジェクトを作成する
+		double startTime = GetTime();
+		while (!m_loadTasks.empty())
+		{
+			LoadTask* task = m_loadTasks.front().get();
+			if (task->m_future.valid() &&
+				task->m_future.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+			{
+				break;
+			}
+
+			if (ProcessLoadTask(task))
+			{
+				m_loadTasks.pop_front();
+			}
+
+			if ((GetTime() - startTime) * 1000.0 >= m_loadUploadBudget)
+			{
+				break;
+			}
+		}
+	}
+
+	bool Viewer::ProcessLoadTask(LoadTask* task)
+	{
+		if (task->m_loadOnRenderThread)
+		{
+			CmdOpen(std::vector<std::string>{ task->m_filepath });
+			return true;
+		}
+
+		if (!task->m_workerFinished)
+		{
+			task->m_workerResult = task->m_future.get();
+			task->m_workerFinished = true;
+			if (!task->m_workerResult)
+			{
+				SABA_WARN("Failed to load file. [{}]", task->m_filepath);
+				return true;
+			}
+		}
+
+		if (task->m_ext == "vmd")
+		{
+			InitializeAnimation();
+			LoadVMD(task->m_vmd, task->m_filepath);
+			return true;
+		}
+
+		// テクスチャは 1 回に 1 枚ずつ転送する
+		if (task->m_uploadedCount < task->m_textureImages.size())
+		{
+			size_t texIdx = task->m_uploadedCount;
+			const auto& request = task->m_textureRequests[texIdx];
+			auto& image = task->m_textureImages[texIdx];
+			auto textureCache = m_context.GetTextureCache();
+			auto key = GLTextureCache::MakeKey(request);
+			GLTextureRef texRef = textureCache->Find(key);
+			if (texRef == 0)
+			{
+				if (image.m_format != TextureImage::Format::Unknown)
+				{
+					SABA_INFO("LoadTexture: [{}]", request.m_filename);
+					texRef = textureCache->Add(request, std::move(image));
+				}
+				else if (task->m_textureCached[texIdx])
+				{
+					// デコード後にキャッシュから破棄された
+					texRef = textureCache->Get(request.m_filename, request.m_genMipMap, request.m_rgba);
+				}
+			}
+			task->m_textures.emplace(std::make_pair(request.m_filename, texRef));
+			image = TextureImage();
+			task->m_uploadedCount++;
+			return false;
+		}
+
+		if (task->m_mmdModelConfig.m_asyncPhysics)
+		{
+			task->m_mmdModel->GetPhysicsManager()->EnableAsyncPhysics(true);
+		}
+		InitializeAnimation();
+		AddMMDModel(task->m_mmdModel, task->m_bboxMin, task->m_bboxMax, task->m_textures, task->m_filepath);
+
+		return true;
+	}
+
 	bool Viewer::LoadOBJFile(const std::string & filename)
 	{
 		OBJModel objModel;
@@ -2381,6 +2985,111 @@ namespace saba
 		return true;
 	}
 
+	void Viewer::SetupSharedPhysics(MMDPhysicsManager* physicsMan)
+	{
+		if (!m_mmdModelConfig.m_sharedPhysics)
+		{
+			return;
+		}
+
+		if (m_sharedPhysics == nullptr)
+		{
+			auto physics = std::make_shared<MMDPhysics>();
+			if (!physics->Create())
+			{
+				SABA_WARN("Failed to create shared physics.");
+				return;
+			}
+			m_sharedPhysics = std::move(physics);
+		}
+		physicsMan->SetSharedPhysics(m_sharedPhysics);
+	}
+
+	void Viewer::UpdatePhysicsLOD()
+	{
+		// 無効の場合はモデル毎の設定 (GLMMDModelDrawer の LOD Sleep) を変更しない
+		// (無効にした時点で、自動で止めたモデルの Physics を再開する)
+		if (!m_physicsLOD && !m_physicsLODApplied)
+		{
+			return;
+		}
+		m_physicsLODApplied = m_physicsLOD;
+
+		const auto camera = m_context.GetCamera();
+		const auto& view = camera->GetViewMatrix();
+		const auto& proj = camera->GetProjectionMatrix();
+		const glm::vec3 eyePos = camera->GetEyePostion();
+
+		for (auto& modelDrawer : m_modelDrawers)
+		{
+			if (modelDrawer->GetType() != ModelDrawerType::MMDModelDrawer)
+			{
+				continue;
+			}
+			auto mmdModelDrawer = static_cast<GLMMDModelDrawer*>(modelDrawer.get());
+			auto physicsMan = mmdModelDrawer->GetModel()->GetMMDModel()->GetPhysicsManager();
+			if (physicsMan->GetMMDPhysics() == nullptr)
+			{
+				continue;
+			}
+
+			bool sleep = false;
+			if (m_physicsLOD)
+			{
+				// バウンディングスフィアで画面外、遠方を判定する
+				const glm::vec3 center = (modelDrawer->GetBBoxMin() + modelDrawer->GetBBoxMax()) * 0.5f;
+				const float radius = glm::length(modelDrawer->GetBBoxMax() - modelDrawer->GetBBoxMin()) * 0.5f;
+				const glm::vec3 worldCenter = glm::vec3(modelDrawer->GetTransform() * glm::vec4(center, 1));
+				const glm::vec3 viewCenter = glm::vec3(view * glm::vec4(worldCenter, 1));
+				const float depth = -viewCenter.z;
+				const bool behind = depth < -radius;
+				const bool outsideX = std::abs(viewCenter.x) - radius * 2.0f > std::max(depth, 0.0f) / proj[0][0];
+				const bool outsideY = std::abs(viewCenter.y) - radius * 2.0f > std::max(depth, 0.0f) / proj[1][1];
+				const bool far = glm::length(worldCenter - eyePos) - radius > m_physicsLODDistance;
+				sleep = behind || outsideX || outsideY || far;
+			}
+
+			if (physicsMan->GetLOD().m_sleep != sleep)
+			{
+				auto lod = physicsMan->GetLOD();
+				lod.m_sleep = sleep;
+				physicsMan->SetLOD(lod);
+			}
+		}
+	}
+
+	bool Viewer::CanUpdatePhysicsInParallel() const
+	{
+		if (!m_parallelPhysics || m_modelDrawers.size() <= 1)
+		{
+			return false;
+		}
+
+		// 共有された Physics World は複数のモデルの剛体を含むため、並列に更新できない
+		if (m_sharedPhysics != nullptr)
+		{
+			return false;
+		}
+
+		// マルチスレッド版の Bullet はプロセスで一つのタスクスケジューラを使用するため、
+		// 複数のスレッドから同時に更新できない
+		for (const auto& modelDrawer : m_modelDrawers)
+		{
+			if (modelDrawer->GetType() != ModelDrawerType::MMDModelDrawer)
+			{
+				continue;
+			}
+			auto mmdModelDrawer = reinterpret_cast<GLMMDModelDrawer*>(modelDrawer.get());
+			auto physics = mmdModelDrawer->GetModel()->GetMMDModel()->GetMMDPhysics();
+			if (physics != nullptr && physics->GetBackend() == MMDPhysicsBackend::Multithread)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
 	bool Viewer::LoadPMDFile(const std::string & filename)
 	{
 		std::shared_ptr<PMDModel> pmdModel = std::make_shared<PMDModel>();
@@ -2389,38 +3098,18 @@ namespace saba
 			"mmd"
 		);
 		pmdModel->SetParallelUpdateHint(m_mmdModelConfig.m_parallelUpdateCount);
+		SetupSharedPhysics(pmdModel->GetPhysicsManager());
 		if (!pmdModel->Load(filename, mmdDataDir))
 		{
 			SABA_WARN("PMD Load Fail.");
 			return false;
 		}
-
-		std::shared_ptr<GLMMDModel> glMMDModel = std::make_shared<GLMMDModel>();
-		if (!glMMDModel->Create(pmdModel))
+		if (m_mmdModelConfig.m_asyncPhysics)
 		{
-			SABA_WARN("GLMMDModel Create Fail.");
-			return false;
+			pmdModel->GetPhysicsManager()->EnableAsyncPhysics(true);
 		}
 
-		auto mmdDrawer = std::make_unique<GLMMDModelDrawer>(
-			m_mmdModelDrawContext.get(),
-			glMMDModel
-			);
-		if (!mmdDrawer->Create())
-		{
-			SABA_WARN("GLMMDModelDrawer Create Fail.");
-			return false;
-		}
-		m_modelDrawers.emplace_back(std::move(mmdDrawer));
-		m_selectedModelDrawer = m_modelDrawers[m_modelDrawers.size() - 1];
-		m_selectedModelDrawer->SetName(GetNewModelName());
-		m_selectedModelDrawer->SetBBox(pmdModel->GetBBoxMin(), pmdModel->GetBBoxMax());
-
-		InitializeScene();
-
-		m_prevTime = GetTime();
-
-		return true;
+		return AddMMDModel(pmdModel, pmdModel->GetBBoxMin(), pmdModel->GetBBoxMax(), LoadMMDTextures(pmdModel.get()), filename);
 	}
 
 	bool Viewer::LoadPMXFile(const std::string & filename)
@@ -2431,18 +3120,49 @@ namespace saba
 			"mmd"
 		);
 		pmxModel->SetParallelUpdateHint(m_mmdModelConfig.m_parallelUpdateCount);
+		pmxModel->EnableRuntimeCache(m_mmdModelConfig.m_runtimeCache, m_mmdModelConfig.m_runtimeCacheDir);
+		SetupSharedPhysics(pmxModel->GetPhysicsManager());
 		if (!pmxModel->Load(filename, mmdDataDir))
 		{
 			SABA_WARN("PMD Load Fail.");
 			return false;
 		}
+		if (m_mmdModelConfig.m_asyncPhysics)
+		{
+			pmxModel->GetPhysicsManager()->EnableAsyncPhysics(true);
+		}
 
+		return AddMMDModel(pmxModel, pmxModel->GetBBoxMin(), pmxModel->GetBBoxMax(), LoadMMDTextures(pmxModel.get()), filename);
+	}
+
+	GLMMDModel::TextureMap Viewer::LoadMMDTextures(const MMDModel* mmdModel)
+	{
+		auto requests = CollectMMDTextures(mmdModel);
+		auto textures = m_context.GetTextureCache()->Get(requests);
+
+		GLMMDModel::TextureMap textureMap;
+		for (size_t i = 0; i < requests.size(); i++)
+		{
+			textureMap.emplace(std::make_pair(requests[i].m_filename, textures[i]));
+		}
+		return textureMap;
+	}
+
+	bool Viewer::AddMMDModel(
+		std::shared_ptr<MMDModel> mmdModel,
+		const glm::vec3& bboxMin,
+		const glm::vec3& bboxMax,
+		const GLMMDModel::TextureMap& textures,
+		const std::string& filepath
+	)
+	{
 		std::shared_ptr<GLMMDModel> glMMDModel = std::make_shared<GLMMDModel>();
-		if (!glMMDModel->Create(pmxModel))
+		if (!glMMDModel->Create(mmdModel, textures))
 		{
 			SABA_WARN("GLMMDModel Create Fail.");
 			return false;
 		}
+		glMMDModel->SetModelFilepath(filepath);
 
 		auto mmdDrawer = std::make_unique<GLMMDModelDrawer>(
 			m_mmdModelDrawContext.get(),
@@ -2456,7 +3176,7 @@ namespace saba
 		m_modelDrawers.emplace_back(std::move(mmdDrawer));
 		m_selectedModelDrawer = m_modelDrawers[m_modelDrawers.size() - 1];
 		m_selectedModelDrawer->SetName(GetNewModelName());
-		m_selectedModelDrawer->SetBBox(pmxModel->GetBBoxMin(), pmxModel->GetBBoxMax());
+		m_selectedModelDrawer->SetBBox(bboxMin, bboxMax);
 
 		InitializeScene();
 
@@ -2466,6 +3186,17 @@ namespace saba
 	}
 
 	bool Viewer::LoadVMDFile(const std::string & filename)
+	{
+		VMDFile vmd;
+		if (!ReadVMDFile(&vmd, filename.c_str()))
+		{
+			return false;
+		}
+
+		return LoadVMD(vmd, filename);
+	}
+
+	bool Viewer::LoadVMD(const VMDFile& vmd, const std::string& filepath)
 	{
 		GLMMDModel* mmdModel = nullptr;
 		if (m_selectedModelDrawer != nullptr && m_selectedModelDrawer->GetType() == ModelDrawerType::MMDModelDrawer)
@@ -2479,12 +3210,6 @@ namespace saba
 			return false;
 		}
 
-		VMDFile vmd;
-		if (!ReadVMDFile(&vmd, filename.c_str()))
-		{
-			return false;
-		}
-
 		if (!vmd.m_cameras.empty())
 		{
 			auto vmdCamOverrider = std::make_unique<VMDCameraOverrider>();
@@ -2495,7 +3220,7 @@ namespace saba
 			m_cameraOverrider = std::move(vmdCamOverrider);
 		}
 
-		return mmdModel->LoadAnimation(vmd);
+		return mmdModel->LoadAnimation(vmd, filepath);
 	}
 
 	bool Viewer::LoadVPDFile(const std::string & filename)
@@ -2841,6 +3566,17 @@ namespace saba
 	{
 		if (count > 0)
 		{
+			if (m_asyncLoad)
+			{
+				// ドロップされた順に読み込む
+				for (int i = 0; i < count; i++)
+				{
+					SABA_INFO("Drop File. {}", paths[i]);
+					LoadFileAsync(paths[i]);
+				}
+				return;
+			}
+
 			std::vector<std::string> args;
 			for (int i = 0; i < count; i++)
 			{
@@ -14,22 +14,29 @@
 #include "Grid.h"
 #include "ModelDrawer.h"
 #include "CameraOverrider.h"
+#include "WorkerPool.h"
 
 #include <Saba/GL/GLObject.h>
+#include <Saba/GL/GLTextureUtil.h>
+#include <Saba/GL/GLTextureCache.h>
 #include <Saba/GL/Model/MMD/GLMMDModel.h>
 #include <Saba/GL/Model/OBJ/GLOBJModelDrawContext.h>
 #include <Saba/GL/Model/MMD/GLMMDModelDrawContext.h>
 #include <Saba/GL/Model/XFile/GLXFileModelDrawContext.h>
+#include <Saba/Model/MMD/VMDFile.h>
 
 #include <imgui.h>
 #include <ImGuizmo.h>
 
 #include <sol.hpp>
 
+#include <atomic>
 #include <map>
 #include <string>
 #include <memory>
 #include <deque>
+#include <vector>
+#include <future>
 
 namespace saba
 {
@@ -138,8 +145,46 @@ namespace saba
 		{
 			MMDModelConfig();
 			uint32_t	m_parallelUpdateCount;	//!< 0 - 16 (0:auto)
+			bool		m_sharedPhysics;		//!< 以降に読み込むモデルの Physics World を共有する
+			bool		m_asyncPhysics;			//!< 以降に読み込むモデルの Physics を専用スレッドで更新する
+			bool		m_runtimeCache;			//!< PMX の変換済みデータをキャッシュする
+			std::string	m_runtimeCacheDir;		//!< キャッシュの保存先 (空の場合はモデルと同じ場所)
 		};
 
+		// 非同期読み込み
+		// ファイルの読み込みとテクスチャのデコードはワーカースレッドで行い、
+		// GL オブジェクトの作成のみを描画スレッドで行う
+		struct LoadTask
+		{
+			std::string		m_filepath;
+			std::string		m_ext;
+			MMDModelConfig	m_mmdModelConfig;
+			std::string		m_mmdDataDir;
+			GLTextureCache*	m_textureCache = nullptr;
+			bool			m_loadOnRenderThread = false;	//!< ワーカーを使わず、順番が来たら描画スレッドで読み込む
+
+			// ワーカースレッドで作成する
+			std::shared_ptr<MMDModel>	m_mmdModel;
+			glm::vec3					m_bboxMin;
+			glm::vec3					m_bboxMax;
+			VMDFile						m_vmd;
+			std::vector<GLTextureCache::Request>	m_textureRequests;
+			std::vector<bool>			m_textureCached;	//!< キャッシュ済みのためデコードしなかった
+			std::vector<TextureImage>	m_textureImages;
+			std::atomic<int>			m_textureCount{ 0 };
+			std::atomic<int>			m_decodedCount{ 0 };
+
+			// 描画スレッドで作成する
+			bool					m_workerResult = false;
+			bool					m_workerFinished = false;
+			GLMMDModel::TextureMap	m_textures;
+			size_t					m_uploadedCount = 0;
+
+			// 破棄時にワーカーの終了を待つため、最後に宣言する
+			std::future<bool>		m_future;
+		};
+		using LoadTaskPtr = std::unique_ptr<LoadTask>;
+
 	private:
 		using ModelDrawerPtr = std::shared_ptr<ModelDrawer>;
 
@@ -166,6 +211,7 @@ namespace saba
 		void DrawLightGuide();
 		void DrawModelCtrl();
 		void DrawBGCtrl();
+		void DrawLoadUI();
 		void UpdateAnimation();
 		void InitializeAnimation();
 		void ResetAnimation();
@@ -186,11 +232,30 @@ namespace saba
 		bool CmdClearSceneAnimation(const std::vector<std::string>& args);
 		bool CmdSetMMDConfig(const std::vector<std::string>& args);
 		bool CmdSetMSAA(const std::vector<std::string>& args);
+		bool CmdSetTextureConfig(const std::vector<std::string>& args);
+		bool CmdPhysicsCache(const std::vector<std::string>& args);
+
+		bool LoadFileAsync(const std::string& filename);
+		static bool LoadOnWorker(LoadTask* task);
+		void UpdateLoadTasks();
+		bool ProcessLoadTask(LoadTask* task);
 
 		bool LoadOBJFile(const std::string& filename);
+		void SetupSharedPhysics(MMDPhysicsManager* physicsMan);
+		void UpdatePhysicsLOD();
+		bool CanUpdatePhysicsInParallel() const;
 		bool LoadPMDFile(const std::string& filename);
 		bool LoadPMXFile(const std::string& filename);
+		GLMMDModel::TextureMap LoadMMDTextures(const MMDModel* mmdModel);
+		bool AddMMDModel(
+			std::shared_ptr<MMDModel> mmdModel,
+			const glm::vec3& bboxMin,
+			const glm::vec3& bboxMax,
+			const GLMMDModel::TextureMap& textures,
+			const std::string& filepath
+		);
 		bool LoadVMDFile(const std::string& filename);
+		bool LoadVMD(const VMDFile& vmd, const std::string& filepath);
 		bool LoadVPDFile(const std::string& filename);
 		bool LoadXFile(const std::string& filename);
 
@@ -263,6 +328,7 @@ namespace saba
 
 		// MMDModelConfig
 		MMDModelConfig	m_mmdModelConfig;
+		std::shared_ptr<MMDPhysics>	m_sharedPhysics;
 
 		// Performance
 		std::deque<float>	m_perfFramerateLap;
@@ -316,6 +382,20 @@ namespace saba
 		// Clip Elapsed
 		bool	m_clipElapsed;
 
+		// モデル毎の Physics を並列に更新する
+		bool		m_parallelPhysics;
+		WorkerPool	m_physicsWorkers;
+
+		// 画面外や遠方のモデルの Physics を止める
+		bool	m_physicsLOD;
+		bool	m_physicsLODApplied;	//!< 前回の UpdatePhysicsLOD で LOD を適用した
+		float	m_physicsLODDistance;
+
+		// 非同期読み込み
+		bool	m_asyncLoad;
+		float	m_loadUploadBudget;	//!< 1 フレームで GL オブジェクトの作成に使う時間 (ms)
+		std::deque<LoadTaskPtr>	m_loadTasks;
+
 		// CurrentFrameBuffer
 		int		m_currentFrameBufferWidth;
 		int		m_currentFrameBufferHeight;
@@ -7,6 +7,7 @@
 
 #include <Saba/Base/UnicodeUtil.h>
 #include <Saba/Base/Path.h>
+#include <Saba/Base/Log.h>
 
 #include <vector>
 
@@ -57,7 +58,9 @@ namespace saba
 			return false;
 		}
 		glBindTexture(GL_TEXTURE_2D, dummyColorTex);
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+		// 転送中のテクスチャのプレースホルダーと同じ白にしておく
+		const uint8_t white[4] = { 255, 255, 255, 255 };
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white);
 		glBindTexture(GL_TEXTURE_2D, 0);
 		m_dummyColorTexture = std::move(dummyColorTex);
 
@@ -94,6 +97,15 @@ namespace saba
 		glBindTexture(GL_TEXTURE_2D, 0);
 		m_captureTex = std::move(captureTex);
 
+		if (m_textureUploader.Create())
+		{
+			m_textureCache.SetUploader(&m_textureUploader);
+		}
+		else
+		{
+			SABA_WARN("Failed to create texture uploader.");
+		}
+
 		return true;
 	}
 
@@ -102,6 +114,9 @@ namespace saba
 		m_dummyColorTexture.Release();
 		m_dummyShadowDepthTexture.Release();
 		m_captureTex.Release();
+		m_textureCache.SetUploader(nullptr);
+		m_textureCache.Clear();
+		m_textureUploader.Destroy();
 	}
 
 	void ViewerContext::SetElapsedTime(double elapsed)
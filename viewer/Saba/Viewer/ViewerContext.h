@@ -13,6 +13,8 @@
 #include <string>
 #include "../GL/GLSLUtil.h"
 #include "../GL/GLObject.h"
+#include "../GL/GLTextureCache.h"
+#include "../GL/GLTextureUploader.h"
 
 #include <glm/vec3.hpp>
 
@@ -64,6 +66,10 @@ namespace saba
 		GLTextureRef GetDummyShadowDepthTexture() const { return m_dummyShadowDepthTexture; }
 		GLTextureRef GetCaptureTexture() const { return m_captureTex; }
 
+		// モデル間で共有するテクスチャ
+		GLTextureCache* GetTextureCache() { return &m_textureCache; }
+		GLTextureUploader* GetTextureUploader() { return &m_textureUploader; }
+
 		const glm::vec4& GetMMDGroundShadowColor() const { return m_mmdGroundShadowColor; };
 
 	private:
@@ -94,6 +100,8 @@ namespace saba
 		GLTextureRef	m_dummyColorTexture;
 		GLTextureRef	m_dummyShadowDepthTexture;
 		GLTextureRef	m_captureTex;
+		GLTextureUploader	m_textureUploader;
+		GLTextureCache		m_textureCache;
 
 		Camera	m_camera;
 		Light	m_light;
@@ -0,0 +1,114 @@
+﻿//
+// Copyright(c) 2016-2017 benikabocha.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+//
+
+#include "WorkerPool.h"
+
+namespace saba
+{
+	WorkerPool::WorkerPool()
+		: m_func(nullptr)
+		, m_count(0)
+		, m_next(0)
+		, m_finished(0)
+		, m_generation(0)
+		, m_exit(false)
+	{
+	}
+
+	WorkerPool::~WorkerPool()
+	{
+		Destroy();
+	}
+
+	void WorkerPool::Create(size_t threadCount)
+	{
+		Destroy();
+
+		m_exit = false;
+		for (size_t i = 0; i < threadCount; i++)
+		{
+			m_threads.emplace_back([this]() { Run(); });
+		}
+	}
+
+	void WorkerPool::Destroy()
+	{
+		if (m_threads.empty())
+		{
+			return;
+		}
+
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_exit = true;
+		}
+		m_cv.notify_all();
+		for (auto& thread : m_threads)
+		{
+			thread.join();
+		}
+		m_threads.clear();
+	}
+
+	void WorkerPool::Execute(size_t count, const std::function<void(size_t)>& func)
+	{
+		if (m_threads.empty() || count <= 1)
+		{
+			for (size_t i = 0; i < count; i++)
+			{
+				func(i);
+			}
+			return;
+		}
+
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_func = &func;
+		m_count = count;
+		m_next = 0;
+		m_finished = 0;
+		m_generation++;
+		m_cv.notify_all();
+
+		Process(lock);
+
+		m_finishedCv.wait(lock, [this]() { return m_finished == m_count; });
+		m_func = nullptr;
+	}
+
+	void WorkerPool::Run()
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		uint64_t generation = m_generation;
+		while (true)
+		{
+			m_cv.wait(lock, [this, generation]() { return m_exit || m_generation != generation; });
+			if (m_exit)
+			{
+				break;
+			}
+
+			generation = m_generation;
+			Process(lock);
+		}
+	}
+
+	void WorkerPool::Process(std::unique_lock<std::mutex>& lock)
+	{
+		while (m_func != nullptr && m_next < m_count)
+		{
+			const size_t index = m_next++;
+			const auto* func = m_func;
+			lock.unlock();
+			(*func)(index);
+			lock.lock();
+
+			m_finished++;
+			if (m_finished == m_count)
+			{
+				m_finishedCv.notify_all();
+			}
+		}
+	}
+}
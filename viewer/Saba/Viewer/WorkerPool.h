@@ -0,0 +1,57 @@
+﻿//
+// Copyright(c) 2016-2017 benikabocha.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+//
+
+#ifndef SABA_VIEWER_WORKERPOOL_H_
+#define SABA_VIEWER_WORKERPOOL_H_
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <cstdint>
+
+namespace saba
+{
+	/*
+	常駐するワーカースレッドで処理を分配する。
+	フレーム毎にスレッドを作成しないために使用する。
+	*/
+	class WorkerPool
+	{
+	public:
+		WorkerPool();
+		~WorkerPool();
+
+		WorkerPool(const WorkerPool&) = delete;
+		WorkerPool& operator = (const WorkerPool&) = delete;
+
+		void Create(size_t threadCount);
+		void Destroy();
+		size_t GetThreadCount() const { return m_threads.size(); }
+
+		// func(0) ～ func(count - 1) をワーカーと呼び出し元のスレッドで実行し、
+		// すべての完了を待つ
+		void Execute(size_t count, const std::function<void(size_t)>& func);
+
+	private:
+		void Run();
+		void Process(std::unique_lock<std::mutex>& lock);
+
+	private:
+		std::vector<std::thread>			m_threads;
+		std::mutex							m_mutex;
+		std::condition_variable				m_cv;
+		std::condition_variable				m_finishedCv;
+		const std::function<void(size_t)>*	m_func;
+		size_t								m_count;
+		size_t								m_next;
+		size_t								m_finished;
+		uint64_t							m_generation;
+		bool								m_exit;
+	};
+}
+
+#endif // !SABA_VIEWER_WORKERPOOL_H_